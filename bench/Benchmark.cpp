@@ -0,0 +1,859 @@
+// The tests of test/ are built with the same sources and have their own main
+#ifndef PIO_UNIT_TESTING
+
+#include <Arduino.h>
+#include <complex>
+#include <math.h>
+#include <stdlib.h>
+#include <chrono>
+#include <new>
+
+#include "BiquadFilter.h"
+#include "ChirpZ.h"
+#include "DataReader.h"
+#include "DataVisualizer.h"
+#include "DecimationChain.h"
+#include "FftPlan.h"
+#include "FilterCoefficients.h"
+#include "FilterSections.h"
+#include "FirFilter.h"
+#include "FixedFft.h"
+#include "FixedFirFilter.h"
+#include "GlobalValues.h"
+#include "PeakExtractor.h"
+#include "SensorFifo.h"
+#include "SlidingDft.h"
+#include "TraceReplay.h"
+#include "VisualizerEvents.h"
+#include "WelchPsd.h"
+
+using namespace std;
+
+// Parameters of the firmware (see main.cpp)
+#define FFT_SIZE 256
+#define SAMPLING_FREQUENCY 25
+
+// Decimation factor of the front end benchmarks
+const uint8_t BENCHMARK_DECIMATION = 4;
+// Frequencies of the comparison of the filters in Hz
+const float RESPONSE_FREQUENCIES[] = { 0.1, 0.3, 0.5, 0.7, 1.0, 1.5, 2.0, 3.0, 3.5, 4.0, 5.0, 8.0 };
+// Duration of the sine of each frequency of the comparison in samples
+const uint32_t RESPONSE_SAMPLES = 3000;
+// Amplitude of the sine of the comparison
+const float RESPONSE_AMPLITUDE = 1000;
+// Frequency step of the group delay of the comparison in Hz
+const float RESPONSE_STEP = 0.05;
+// Samples pushed into the sliding DFT before its benchmark, long enough for the rounding
+// errors to build up (about 13 minutes at 25 Hz)
+const uint32_t SLIDING_DFT_SAMPLES = 20000;
+// Second band of the benchmark of the zoom spectrum in Hz, and its bins
+const float ZOOM_BAND_LOW_FREQUENCY = 1.0;
+const float ZOOM_BAND_HIGH_FREQUENCY = 2.0;
+const uint16_t ZOOM_BAND_BINS = 32;
+// Segments of the samples of the benchmark of the Welch PSD
+const uint16_t WELCH_BENCHMARK_SEGMENTS = 64;
+
+// Samples of the waveform message of the frame sizes, the default batch of the visualizer
+const uint16_t WAVEFORM_BENCHMARK_SAMPLES = 5;
+
+// Minimum time measured for each benchmark in ms
+const uint32_t BENCHMARK_TIME = 500;
+// Calls before the measure starts
+const uint32_t WARMUP_CALLS = 16;
+// Maximum number of benchmarks
+const uint8_t MAX_BENCHMARKS = 27;
+// Maximum number of frame sizes
+const uint8_t MAX_FRAME_SIZES = 4;
+
+// Allocations made since the start of the program
+static volatile size_t allocations = 0;
+
+void* operator new ( size_t size )
+{
+    allocations++;
+    void* pointer = malloc(size ? size : 1);
+    if (pointer == NULL) throw bad_alloc();
+    return pointer;
+}
+
+void* operator new[] ( size_t size )
+{
+    allocations++;
+    void* pointer = malloc(size ? size : 1);
+    if (pointer == NULL) throw bad_alloc();
+    return pointer;
+}
+
+void operator delete ( void* pointer ) noexcept { free(pointer); }
+
+void operator delete[] ( void* pointer ) noexcept { free(pointer); }
+
+void operator delete ( void* pointer, size_t size ) noexcept { (void)size; free(pointer); }
+
+void operator delete[] ( void* pointer, size_t size ) noexcept { (void)size; free(pointer); }
+
+/** Synthetic sensor FIFO class
+ *
+ * @brief FIFO of a pulse sensor that generates a synthetic PPG signal.
+ *
+ * @details Each check() makes a batch of new samples: a pulse of 72 bpm with its second
+ *          harmonic over the DC level of the sensor, plus a small deterministic noise.
+ *
+ * @param sample Number of samples generated
+ * @param position Position of the next sample of the batch
+ * @param count Number of samples of the batch
+ * @param ir IR samples of the batch
+ * @param red Red samples of the batch
+ * @param noise State of the noise generator
+ * @param checkTime Time of the last batch in ms
+ *
+ */
+class syntheticFifo : public sensorFifo {
+    uint32_t sample = 0;
+    uint8_t position = 0;
+    uint8_t count = 0;
+    uint32_t ir[SENSOR_FIFO_DEPTH];
+    uint32_t red[SENSOR_FIFO_DEPTH];
+    uint32_t noise = 1;
+    uint32_t checkTime = 0;
+
+    uint32_t nextNoise ()
+    {
+        noise = noise * 1664525 + 1013904223;
+        return noise >> 24;
+    }
+
+    public:
+        bool begin () { return true; }
+
+        uint16_t getSampleRate () { return SAMPLING_FREQUENCY; }
+
+        bool dataPending () { return true; }
+
+        uint16_t check ()
+        {
+            const float pulseFrequency = 1.2;
+            for (count = 0; count < 8; count++, sample++)
+            {
+                float phase = 2 * M_PI * pulseFrequency * sample / SAMPLING_FREQUENCY;
+                float pulse = sin(phase) + 0.3 * sin(2 * phase);
+                ir[count] = uint32_t(50000 + 2000 * pulse) + nextNoise();
+                red[count] = uint32_t(40000 + 1200 * pulse) + nextNoise();
+            }
+            position = 0;
+            checkTime = sample * 1000 / SAMPLING_FREQUENCY;
+            return count;
+        }
+
+        uint32_t getCheckTime () { return checkTime; }
+
+        uint8_t available () { return count - position; }
+
+        uint32_t getFIFOIR () { return ir[position]; }
+
+        uint32_t getFIFORed () { return red[position]; }
+
+        void nextSample () { if (position < count) position++; }
+};
+
+/** Vector FIR filter class
+ *
+ * @brief FIR filter of the IR and red channels as doFiltering did it before firFilter,
+ *        kept as the baseline of its benchmark.
+ *
+ * @details Each sample is pushed back into a vector per channel, the convolution runs over
+ *          the last taps samples and then the oldest sample is erased, which moves the
+ *          whole delay line twice per sample.
+ *
+ * @param coefs Coefficients of the filter
+ * @param inputIRData Last IR samples
+ * @param inputRedData Last red samples
+ *
+ */
+class vectorFirFilter {
+    vector<float> coefs;
+    vector<float> inputIRData;
+    vector<float> inputRedData;
+
+    public:
+        void setCoefficients ( const float* pCoefs, int size ) { coefs.assign(pCoefs, pCoefs + size); }
+
+        void pushSample ( float valueIR, float valueRed )
+        {
+            inputIRData.push_back(valueIR);
+            inputRedData.push_back(valueRed);
+        }
+
+        void filter ( float& resultOfIR, float& resultOfRed )
+        {
+            resultOfIR = 0;
+            resultOfRed = 0;
+            for (int n = coefs.size() - 1; n >= 0; n--)
+            {
+                resultOfIR += coefs[n] * inputIRData[inputIRData.size() - n - 1];
+                resultOfRed += coefs[n] * inputRedData[inputRedData.size() - n - 1];
+            }
+            // delete the oldest sample from the list
+            inputIRData.erase(inputIRData.begin());
+            inputRedData.erase(inputRedData.begin());
+        }
+};
+
+/** Benchmark result struct
+ *
+ * @brief Measure of a hot path.
+ *
+ * @param name Name of the function measured
+ * @param size Items processed by each call
+ * @param iterations Number of calls measured
+ * @param nsPerCall Average time of a call in ns
+ * @param nsPerItem Average time of an item in ns
+ * @param allocsPerCall Average number of allocations of a call
+ *
+ */
+struct benchmarkResult {
+    const char* name;
+    uint32_t size;
+    uint32_t iterations;
+    double nsPerCall;
+    double nsPerItem;
+    double allocsPerCall;
+};
+
+benchmarkResult results[MAX_BENCHMARKS];
+uint8_t resultsCount = 0;
+
+/** Frame size struct
+ *
+ * @brief Bytes of a message of the web page in both protocols.
+ *
+ * @param name Name of the message
+ * @param jsonBytes Bytes of the JSON message
+ * @param binaryBytes Bytes of the binary frame
+ *
+ */
+struct frameSize {
+    const char* name;
+    size_t jsonBytes;
+    size_t binaryBytes;
+};
+
+frameSize frameSizes[MAX_FRAME_SIZES];
+uint8_t frameSizesCount = 0;
+
+/** Add frame size function
+ *
+ * @brief This function keeps the sizes of a message in both protocols for the results.
+ *
+ * @param name Name of the message.
+ * @param jsonBytes Bytes of the JSON message.
+ * @param binaryBytes Bytes of the binary frame.
+ *
+ */
+void addFrameSize ( const char* name, size_t jsonBytes, size_t binaryBytes )
+{
+    frameSize size = { name, jsonBytes, binaryBytes };
+    if (frameSizesCount < MAX_FRAME_SIZES) frameSizes[frameSizesCount++] = size;
+    fprintf(stderr, "%-24s %6zu bytes JSON %6zu bytes binary (%.1fx)\n", name, jsonBytes, binaryBytes,
+            binaryBytes > 0 ? double(jsonBytes) / binaryBytes : 0.0);
+}
+
+/** Run benchmark function
+ *
+ * @brief This function measures a function called repeatedly.
+ *
+ * @param name Name of the function.
+ * @param size Items processed by each call.
+ * @param function Function to measure.
+ *
+ * @details The function is called WARMUP_CALLS times, and then it is called in rounds of
+ *          doubling size until a round lasts BENCHMARK_TIME. The allocations are counted
+ *          in the last round.
+ *
+ */
+template <typename F>
+void runBenchmark ( const char* name, uint32_t size, F function )
+{
+    for (uint32_t i = 0; i < WARMUP_CALLS; i++) function();
+
+    uint32_t iterations = 1;
+    double elapsed = 0;
+    size_t allocated = 0;
+    for (;;)
+    {
+        size_t startAllocations = allocations;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) function();
+        elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        allocated = allocations - startAllocations;
+        if (elapsed >= BENCHMARK_TIME * 1e6 || iterations >= (1u << 30)) break;
+        iterations *= 2;
+    }
+
+    benchmarkResult result = { name, size, iterations, elapsed / iterations,
+                               elapsed / iterations / size, double(allocated) / iterations };
+    if (resultsCount < MAX_BENCHMARKS) results[resultsCount++] = result;
+    fprintf(stderr, "%-24s %6u items %10.1f ns/call %8.2f ns/item %6.2f allocs/call\n",
+            result.name, result.size, result.nsPerCall, result.nsPerItem, result.allocsPerCall);
+}
+
+/** Replay trace function
+ *
+ * @brief This function feeds a whole trace through a new data reader.
+ *
+ * @param replay Replay of the trace.
+ * @param events Events of the visualizer.
+ * @param samples Number of samples of the trace.
+ * @param output Output of the results of each block, NULL to not print them.
+ *
+ * @return FNV-1a hash of the heart rate, the SpO2 and the spectrum of every block.
+ *
+ */
+uint32_t replayTrace ( traceReplay& replay, visualizerEvents& events, uint32_t& samples, FILE* output )
+{
+    globalDataReader dataReader(replay);
+    globalValues dataStorage;
+    dataReader.setup(SAMPLING_FREQUENCY, FFT_SIZE);
+
+    uint32_t hash = 2166136261u;
+    uint32_t blocks = 0;
+    while (!replay.isFinished())
+    {
+        dataReader.readData(dataStorage, events);
+        while (dataReader.analyzeData(dataStorage, events, 0));
+        dataStorage.updateSpectrum();
+        if (!dataStorage.update()) continue;
+
+        int32_t values[2] = { dataStorage.getBeatsPerMinute(), dataStorage.getSpo2Percentage() };
+        dataView<fundamentalsFreqs> freqs = dataStorage.getFreqs();
+        const uint8_t* data = (const uint8_t*)values;
+        for (size_t i = 0; i < sizeof(values); i++) hash = (hash ^ data[i]) * 16777619u;
+        for (size_t i = 0; i < freqs.size(); i++)
+        {
+            data = (const uint8_t*)&freqs[i];
+            for (size_t j = 0; j < sizeof(fundamentalsFreqs); j++) hash = (hash ^ data[j]) * 16777619u;
+        }
+        if (output != NULL)
+        {
+            fprintf(output, "block %u: %d bpm, %d %%, %u peaks, hash %08x\n", 
+                    blocks, values[0], values[1], (unsigned)freqs.size(), hash);
+        }
+        blocks++;
+    }
+    samples = replay.getReplayedSamples();
+    return hash;
+}
+
+/** Benchmark front ends function
+ *
+ * @brief This function compares the cost of running the sensor BENCHMARK_DECIMATION times
+ *        faster with a single rate FIR and with the decimation chains.
+ *
+ * @param dataReader Data reader, whose band pass filter runs after the decimation.
+ *
+ * @details Without decimation, the band pass filter has to run at the rate of the sensor
+ *          with BENCHMARK_DECIMATION times more taps for the same response, and for every
+ *          input. With decimation, the chain runs first and the band pass filter of the
+ *          analysis rate only runs for each output. Each call makes one output at the
+ *          analysis rate, and the multiply accumulates per output are printed.
+ *
+ */
+void benchmarkFrontEnds ( globalDataReader& dataReader )
+{
+    const uint16_t inputRate = BENCHMARK_DECIMATION * SAMPLING_FREQUENCY;
+    float valueIR = 0.0;
+    float valueRed = 0.0;
+    uint32_t input = 0;
+    auto nextInput = [&]() {
+        float phase = 2 * M_PI * 1.2 * input++ / inputRate;
+        valueIR = 50000 + 2000 * sin(phase);
+        valueRed = 40000 + 1200 * sin(phase);
+    };
+
+    static firFilter singleRate(BENCHMARK_DECIMATION * (FILTER_TAPS - 1) + 1);
+    singleRate.setCoefficients(FILTER_COEFFICIENTS, FILTER_TAPS);
+    runBenchmark("singleRateFir", 1, [&]() {
+        for (uint8_t i = 0; i < BENCHMARK_DECIMATION; i++)
+        {
+            nextInput();
+            singleRate.pushSample(valueIR, valueRed);
+            singleRate.filter(valueIR, valueRed);
+        }
+    });
+
+    decimationChain firChain;
+    decimationChain cicChain;
+    firChain.begin(inputRate, SAMPLING_FREQUENCY, false);
+    cicChain.begin(inputRate, SAMPLING_FREQUENCY, true);
+    decimationChain* chains[2] = { &firChain, &cicChain };
+    const char* names[2] = { "firDecimation", "cicDecimation" };
+    filterSample resultOfIR = 0;
+    filterSample resultOfRed = 0;
+    for (uint8_t c = 0; c < 2; c++)
+    {
+        decimationChain& chain = *chains[c];
+        runBenchmark(names[c], 1, [&]() {
+            do { nextInput(); } while (!chain.push(valueIR, valueRed));
+            dataReader.doFiltering(resultOfIR, resultOfRed);
+        });
+    }
+
+    fprintf(stderr, "MACs per %u Hz output and channel from %u Hz: single rate FIR %u, FIR decimation %.0f + %u, "
+                    "CIC decimation %.0f + %u (and %u additions)\n", SAMPLING_FREQUENCY, inputRate, 
+            unsigned(BENCHMARK_DECIMATION * singleRate.getTaps()), firChain.getMacsPerOutput(), FILTER_TAPS,
+            cicChain.getMacsPerOutput(), FILTER_TAPS, cicChain.getCicOperationsPerOutput());
+}
+
+/** Measure response function
+ *
+ * @brief This function measures the response of a filter to a sine.
+ *
+ * @param filter FIR or biquad filter.
+ * @param frequency Frequency of the sine in Hz.
+ *
+ * @return Gain and phase of the filter at the frequency.
+ *
+ * @details The sine is added to a DC like the one of the sensor. After the first half of
+ *          the RESPONSE_SAMPLES samples, the output is correlated with the input.
+ *
+ */
+template<typename F>
+complex<float> measureResponse ( F& filter, float frequency )
+{
+    filter.reset();
+    complex<float> correlation = 0;
+    uint32_t correlated = 0;
+    for (uint32_t n = 0; n < RESPONSE_SAMPLES; n++)
+    {
+        float phase = 2 * M_PI * frequency * n / SAMPLING_FREQUENCY;
+        filter.pushSample(50000 + RESPONSE_AMPLITUDE * sin(phase), 0.0);
+        if ( !filter.isReady() ) continue;
+
+        float valueIR = 0.0;
+        float valueRed = 0.0;
+        filter.filter(valueIR, valueRed);
+        if ( n < RESPONSE_SAMPLES / 2 ) continue;
+        correlation += valueIR * polar(1.0f, float(-phase));
+        correlated++;
+    }
+    // the input is the imaginary part of exp(j * phase)
+    return correlation * complex<float>(0, 2.0f / (correlated * RESPONSE_AMPLITUDE));
+}
+
+/** Print response function
+ *
+ * @brief This function prints the gain and the group delay of a filter.
+ *
+ * @param filter FIR or biquad filter.
+ * @param frequency Frequency in Hz.
+ *
+ * @details The group delay is the slope of the phase between frequency and frequency +
+ *          RESPONSE_STEP, which does not wrap for delays below 1 / (2 * RESPONSE_STEP).
+ *
+ */
+template<typename F>
+void printResponse ( F& filter, float frequency )
+{
+    complex<float> response = measureResponse(filter, frequency);
+    complex<float> next = measureResponse(filter, frequency + RESPONSE_STEP);
+    float delay = -arg(next / response) / (2 * M_PI * RESPONSE_STEP);
+    fprintf(stderr, " %10.1f %10.0f", 20 * log10(abs(response) + 1e-9), 1000 * delay);
+}
+
+/** Benchmark filters function
+ *
+ * @brief This function measures the FIR filter of data/coefficients.txt and the biquad
+ *        filter of data/sections.txt.
+ *
+ * @details Both filters are measured per sample, the FIR also against the vector and
+ *          erase version it replaced, and their gain and group delay are printed for the
+ *          RESPONSE_FREQUENCIES. The heart rate of each one and their stopband are
+ *          checked by the tests of test/.
+ *
+ */
+void benchmarkFilters ( )
+{
+    static firFilter fir(FILTER_TAPS);
+    static biquadFilter biquad(FILTER_SECTIONS);
+    fir.setCoefficients(FILTER_COEFFICIENTS, FILTER_TAPS);
+    biquad.setCoefficients(FILTER_SECTION_COEFFICIENTS, BIQUAD_COEFFICIENTS * FILTER_SECTIONS);
+
+    static vectorFirFilter baseline;
+    baseline.setCoefficients(FILTER_COEFFICIENTS, FILTER_TAPS);
+    for (uint32_t i = 0; i + 1 < FILTER_TAPS; i++) baseline.pushSample(50000, 40000);
+
+    float valueIR = 0.0;
+    float valueRed = 0.0;
+    runBenchmark("vectorFirFilter", 1, [&]() {
+        baseline.pushSample(50000, 40000);
+        baseline.filter(valueIR, valueRed);
+    });
+    const benchmarkResult& baselineResult = results[resultsCount - 1];
+    runBenchmark("firFilter", 1, [&]() {
+        fir.pushSample(50000, 40000);
+        fir.filter(valueIR, valueRed);
+    });
+    const benchmarkResult& firResult = results[resultsCount - 1];
+    fprintf(stderr, "FIR of %u taps: vector + erase %.2f M samples/s, firFilter %.2f M samples/s (%.2fx)\n",
+            FILTER_TAPS, 1e3 / baselineResult.nsPerItem, 1e3 / firResult.nsPerItem, 
+            baselineResult.nsPerItem / firResult.nsPerItem);
+    runBenchmark("biquadFilter", 1, [&]() {
+        biquad.pushSample(50000, 40000);
+        biquad.filter(valueIR, valueRed);
+    });
+
+    fprintf(stderr, "Filters: FIR %u MACs per sample and channel, first output after %u samples; "
+                    "biquad %u MACs, first output after 1 sample\n", FILTER_TAPS, FILTER_TAPS,
+            unsigned(BIQUAD_COEFFICIENTS * FILTER_SECTIONS));
+    fprintf(stderr, "%10s %10s %10s %10s %10s\n", "Hz", "FIR dB", "FIR ms", "biquad dB", "biquad ms");
+    for (size_t i = 0; i < sizeof(RESPONSE_FREQUENCIES) / sizeof(float); i++)
+    {
+        fprintf(stderr, "%10.1f", RESPONSE_FREQUENCIES[i]);
+        printResponse(fir, RESPONSE_FREQUENCIES[i]);
+        printResponse(biquad, RESPONSE_FREQUENCIES[i]);
+        fprintf(stderr, "\n");
+    }
+}
+
+/** Benchmark fixed point function
+ *
+ * @brief This function measures the fixed point filter and FFT of FIXED_POINT, and the
+ *        float FFT plan.
+ *
+ * @details The FFTs transform a block of a pulse of 1.2 Hz with its second harmonic, like
+ *          the filtered samples. Their accuracy is checked by the tests of test/.
+ *
+ */
+void benchmarkFixedPoint ( )
+{
+    static fixedFirFilter fixedFilter(FILTER_TAPS);
+    static fftPlan plan;
+    static fixedFft transform;
+    fixedFilter.setCoefficients(FILTER_COEFFICIENTS, FILTER_TAPS);
+    plan.begin(FFT_SIZE, MAX_BLOCK_SAMPLES, FFT_ANALYSIS_WINDOW);
+    transform.begin(FFT_SIZE, MAX_BLOCK_SAMPLES, FFT_ANALYSIS_WINDOW);
+
+    int32_t block[MAX_BLOCK_SAMPLES];
+    for (int n = 0; n < MAX_BLOCK_SAMPLES; n++)
+    {
+        float phase = 2 * M_PI * 1.2 * n / SAMPLING_FREQUENCY;
+        block[n] = lroundf(3000 * sin(phase) + 900 * sin(2 * phase));
+    }
+
+    int32_t fixedIR = 0;
+    int32_t fixedRed = 0;
+    runBenchmark("fixedFirFilter", 1, [&]() {
+        fixedFilter.pushSample(120000, 90000);
+        fixedFilter.filter(fixedIR, fixedRed);
+    });
+    runBenchmark("fftPlan", FFT_SIZE, [&]() {
+        plan.magnitudes(block);
+    });
+    runBenchmark("fixedFft", FFT_SIZE, [&]() {
+        transform.magnitudes(block);
+    });
+}
+
+/** Benchmark sliding DFT function
+ *
+ * @brief This function measures the sliding DFT of SLIDING_DFT per sample.
+ *
+ * @details The input is a pulse of 1.2 Hz with its second harmonic and noise, pushed for
+ *          SLIDING_DFT_SAMPLES samples before the measure. The FFT of a block costs the 
+ *          "fftPlan" benchmark every MAX_BLOCK_SAMPLES samples.
+ *
+ */
+void benchmarkSlidingDft ( )
+{
+    static slidingDft spectrum;
+    spectrum.begin(SAMPLING_FREQUENCY, SLIDING_DFT_LENGTH, SPECTRUM_LOW_FREQUENCY, SPECTRUM_HIGH_FREQUENCY, 
+                   FFT_ANALYSIS_WINDOW);
+
+    vector<float> input(SLIDING_DFT_SAMPLES);
+    uint32_t noise = 1;
+    for (uint32_t n = 0; n < SLIDING_DFT_SAMPLES; n++)
+    {
+        float phase = 2 * M_PI * 1.2 * n / SAMPLING_FREQUENCY;
+        noise = noise * 1664525 + 1013904223;
+        input[n] = 2000 * sin(phase) + 600 * sin(2 * phase) + float(noise >> 24) - 127.5f;
+        spectrum.push(input[n]);
+    }
+
+    uint32_t n = 0;
+    runBenchmark("slidingDft", 1, [&]() {
+        spectrum.push(input[n]);
+        if (++n == SLIDING_DFT_SAMPLES) n = 0;
+    });
+    runBenchmark("slidingDftMagnitudes", spectrum.getBins(), [&]() {
+        spectrum.magnitudes();
+    });
+}
+
+/** Benchmark zoom function
+ *
+ * @brief This function measures the chirp Z transform of ZOOM_SPECTRUM.
+ *
+ * @details The input is a block of a pulse of 1.2 Hz with its second harmonic. "chirpZ" 
+ *          keeps the band of the firmware and "chirpZBand" changes it in every call, to a
+ *          band of ZOOM_BAND_BINS bins and back.
+ *
+ */
+void benchmarkZoom ( )
+{
+    static chirpZ zoom;
+    zoom.begin(MAX_BLOCK_SAMPLES, MAX_FREQS, FFT_ANALYSIS_WINDOW);
+
+    int32_t block[MAX_BLOCK_SAMPLES];
+    for (int n = 0; n < MAX_BLOCK_SAMPLES; n++)
+    {
+        float phase = 2 * M_PI * 1.2 * n / SAMPLING_FREQUENCY;
+        block[n] = lroundf(2000 * sin(phase) + 600 * sin(2 * phase));
+    }
+
+    const float lows[2] = { ZOOM_LOW_FREQUENCY, ZOOM_BAND_LOW_FREQUENCY };
+    const float highs[2] = { ZOOM_HIGH_FREQUENCY, ZOOM_BAND_HIGH_FREQUENCY };
+    const uint16_t bins[2] = { ZOOM_BINS, ZOOM_BAND_BINS };
+    runBenchmark("chirpZ", ZOOM_BINS, [&]() {
+        zoom.magnitudes(block, ZOOM_LOW_FREQUENCY, ZOOM_HIGH_FREQUENCY, ZOOM_BINS, SAMPLING_FREQUENCY);
+    });
+    int call = 0;
+    runBenchmark("chirpZBand", ZOOM_BINS, [&]() {
+        int c = call++ & 1;
+        zoom.magnitudes(block, lows[c], highs[c], bins[c], SAMPLING_FREQUENCY);
+    });
+}
+
+/** Benchmark peaks function
+ *
+ * @brief This function measures the peak extractor on the spectrum of the FFT plan.
+ *
+ * @details The input is a block of a pulse of 1.2 Hz with its second harmonic, plus a
+ *          breathing tone of 0.3 Hz.
+ *
+ */
+void benchmarkPeaks ( )
+{
+    static fftPlan plan;
+    static peakExtractor extractor;
+    plan.begin(FFT_SIZE, MAX_BLOCK_SAMPLES, FFT_ANALYSIS_WINDOW);
+
+    int32_t block[MAX_BLOCK_SAMPLES];
+    for (int n = 0; n < MAX_BLOCK_SAMPLES; n++)
+    {
+        float phase = 2 * M_PI * 1.2 * n / SAMPLING_FREQUENCY;
+        float breathing = 2 * M_PI * 0.3 * n / SAMPLING_FREQUENCY;
+        block[n] = lroundf(2000 * sin(phase) + 1200 * sin(2 * phase) + 800 * sin(breathing));
+    }
+    const float* magnitudes = plan.magnitudes(block);
+    float step = float(SAMPLING_FREQUENCY) / FFT_SIZE;
+
+    runBenchmark("peakExtractor", FFT_SIZE / 2, [&]() {
+        extractor.extract(magnitudes, FFT_SIZE / 2, 0, step);
+    });
+}
+
+/** Benchmark Welch function
+ *
+ * @brief This function measures the Welch PSD with the segments of the firmware.
+ *
+ * @details The input is a pulse of 1.2 Hz plus noise, and "welchPsd" pushes the samples of
+ *          a segment into an exponential average of WELCH_DEPTH segments.
+ *
+ */
+void benchmarkWelch ( )
+{
+    static welchPsd exponential;
+    exponential.begin(FFT_SIZE, WELCH_OVERLAP, WELCH_DEPTH, WELCH_AVERAGE_EXPONENTIAL, FFT_ANALYSIS_WINDOW);
+    uint16_t hop = exponential.getHop();
+
+    vector<int32_t> samples(FFT_SIZE + WELCH_BENCHMARK_SEGMENTS * hop);
+    uint32_t noise = 12345;
+    for (size_t n = 0; n < samples.size(); n++)
+    {
+        noise = noise * 1664525u + 1013904223u;
+        samples[n] = lroundf(1000 * sin(2 * M_PI * 1.2 * n / SAMPLING_FREQUENCY)) + int32_t(noise >> 21) - 1024;
+    }
+    exponential.push(samples.data(), FFT_SIZE, SAMPLING_FREQUENCY);
+
+    uint32_t position = 0;
+    runBenchmark("welchPsd", hop, [&]() {
+        exponential.push(&samples[FFT_SIZE + position * hop], hop, SAMPLING_FREQUENCY);
+        position = (position + 1) % WELCH_BENCHMARK_SEGMENTS;
+    });
+}
+
+/** Write results function
+ *
+ * @brief This function writes the results of the benchmarks and the frame sizes in a JSON file.
+ *
+ * @param fileName Name of the file.
+ *
+ * @return True if the file has been written, false if not.
+ *
+ */
+bool writeResults ( const char* fileName )
+{
+    FILE* file = fopen(fileName, "w");
+    if (file == NULL) return false;
+
+#if defined(__clang__)
+    const char* compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    const char* compiler = "gcc " __VERSION__;
+#else
+    const char* compiler = "unknown";
+#endif
+
+    fprintf(file, "{\n  \"compiler\": \"%s\",\n  \"benchmarks\": [\n", compiler);
+    for (uint8_t i = 0; i < resultsCount; i++)
+    {
+        fprintf(file, "    {\"name\": \"%s\", \"size\": %u, \"iterations\": %u, \"ns_per_call\": %.2f, "
+                      "\"ns_per_item\": %.3f, \"items_per_second\": %.0f, \"allocs_per_call\": %.3f}%s\n",
+                results[i].name, results[i].size, results[i].iterations, results[i].nsPerCall,
+                results[i].nsPerItem, 1e9 / results[i].nsPerItem, results[i].allocsPerCall, 
+                i + 1 < resultsCount ? "," : "");
+    }
+    fprintf(file, "  ],\n  \"frame_sizes\": [\n");
+    for (uint8_t i = 0; i < frameSizesCount; i++)
+    {
+        fprintf(file, "    {\"name\": \"%s\", \"json_bytes\": %zu, \"binary_bytes\": %zu}%s\n",
+                frameSizes[i].name, frameSizes[i].jsonBytes, frameSizes[i].binaryBytes,
+                i + 1 < frameSizesCount ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+/** Main function
+ *
+ * @brief This function runs the benchmarks of the hot paths of the processing.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments: the name of the results file, by default "bench_results.json",
+ *             and the name of a sensor trace.
+ *
+ * @return 0 if the results have been written, 1 if not or if two replays of the trace
+ *         are not equal.
+ *
+ * @details The reader is fed with the synthetic sensor, or with the trace if it is given,
+ *          until the first block is published, so the buffers of the reader and the global
+ *          values hold real data. The trace is also replayed twice through the whole
+ *          reader, the results of each block are printed and both replays have to give
+ *          the same results. The Serial output of the firmware is discarded while measuring.
+ *
+ */
+int main ( int argc, char** argv )
+{
+    const char* fileName = argc > 1 ? argv[1] : "bench_results.json";
+    const char* traceName = argc > 2 ? argv[2] : NULL;
+
+    static syntheticFifo synthetic;
+    static traceReplay replay(File(traceName ? fopen(traceName, "rb") : NULL));
+    sensorFifo& sensor = traceName ? (sensorFifo&)replay : (sensorFifo&)synthetic;
+    static globalDataReader dataReader(sensor);
+    static globalValues dataStorage;
+    static visualizerEvents events;
+    static globalDataVisualizer dataVisualizer(U8G2_R0, 18, 23, 5, 32, 33);
+
+    Serial.setOutput(NULL);
+    events.begin();
+
+    bool deterministic = true;
+    if (traceName != NULL)
+    {
+        uint32_t samples = 0;
+        if (!replay.begin())
+        {
+            fprintf(stderr, "Failed to read the trace %s\n", traceName);
+            return 1;
+        }
+        uint32_t hash = replayTrace(replay, events, samples, stdout);
+        deterministic = replayTrace(replay, events, samples, NULL) == hash;
+        fprintf(stderr, "Trace %s: %u samples at %u Hz, %u overflowed, %u records skipped, results hash %08x%s\n", 
+                traceName, samples, replay.getSampleRate(), replay.getReplayedOverflows(), replay.getSkippedRecords(), hash,
+                deterministic ? "" : ", NOT EQUAL IN THE SECOND REPLAY");
+
+        runBenchmark("readData (replay)", samples, [&]() {
+            uint32_t replayed = 0;
+            replayTrace(replay, events, replayed, NULL);
+        });
+    }
+
+    dataReader.setup(SAMPLING_FREQUENCY, FFT_SIZE);
+    vector<int> buttonPins;
+    buttonPins.push_back(26);
+    buttonPins.push_back(25);
+    buttonPins.push_back(27);
+    dataVisualizer.setup(buttonPins, "native", "native");
+    while (!dataReader.isDataReady() && !(traceName && replay.isFinished()))
+    {
+        dataReader.readData(dataStorage, events);
+        dataReader.analyzeData(dataStorage, events, 0);
+    }
+    dataStorage.update();
+    dataView<int32_t> heartRateData = dataStorage.getHeartRateDataArray();
+    int32_t irSamples[MAX_BLOCK_SAMPLES] = {};
+    for (size_t i = 0; i < MAX_BLOCK_SAMPLES && i < heartRateData.size(); i++) irSamples[i] = heartRateData[i];
+
+    filterSample resultOfIR = 0;
+    filterSample resultOfRed = 0;
+    runBenchmark("doFiltering", 1, [&]() {
+        dataReader.doFiltering(resultOfIR, resultOfRed);
+    });
+
+    benchmarkFrontEnds(dataReader);
+    benchmarkFilters();
+    benchmarkFixedPoint();
+    benchmarkSlidingDft();
+    benchmarkZoom();
+    benchmarkPeaks();
+    benchmarkWelch();
+
+    runBenchmark("fft", FFT_SIZE, [&]() {
+        dataReader.fft(dataStorage, irSamples, SAMPLING_FREQUENCY);
+    });
+
+    float vReal[FFT_SIZE / 2];
+    for (int i = 0; i < FFT_SIZE / 2; i++) vReal[i] = 1000.0 / (i + 1) * (1.5 + cos(0.9 * i));
+    runBenchmark("getFFTResults", FFT_SIZE / 2, [&]() {
+        dataReader.getFFTResults(vReal, FFT_SIZE, SAMPLING_FREQUENCY);
+    });
+
+    uint32_t discretizedSize = dataVisualizer.defaultDiscretization(heartRateData).size();
+    runBenchmark("defaultDiscretization", discretizedSize, [&]() {
+        dataVisualizer.defaultDiscretization(heartRateData);
+    });
+
+    runBenchmark("getJSON", MAX_PEAKS, [&]() {
+        dataVisualizer.getJSON(dataStorage);
+    });
+
+    runBenchmark("getBinaryFrame", MAX_PEAKS, [&]() {
+        dataVisualizer.getBinaryFrame(dataStorage);
+    });
+
+    // the samples less their mean, so that the message has negative samples
+    int64_t waveformSum = 0;
+    for (uint16_t i = 0; i < WAVEFORM_BENCHMARK_SAMPLES; i++) waveformSum += irSamples[i];
+    int32_t waveformMean = int32_t(waveformSum / WAVEFORM_BENCHMARK_SAMPLES);
+    waveformSample waveform[WAVEFORM_BENCHMARK_SAMPLES];
+    for (uint16_t i = 0; i < WAVEFORM_BENCHMARK_SAMPLES; i++)
+    {
+        waveformSample sample = { i, i * 1000u / SAMPLING_FREQUENCY, irSamples[i] - waveformMean };
+        waveform[i] = sample;
+    }
+    addFrameSize("values", dataVisualizer.getJSON(dataStorage).size(), dataVisualizer.getBinaryFrame(dataStorage).size());
+    addFrameSize("waveform", dataVisualizer.getWaveformJSON(waveform, WAVEFORM_BENCHMARK_SAMPLES).size(),
+                 dataVisualizer.getWaveformFrame(waveform, WAVEFORM_BENCHMARK_SAMPLES).size());
+
+    Serial.setOutput(stdout);
+    if (!writeResults(fileName))
+    {
+        fprintf(stderr, "Failed to write %s\n", fileName);
+        return 1;
+    }
+    fprintf(stderr, "Results written to %s\n", fileName);
+    return deterministic ? 0 : 1;
+}
+
+#endif /* PIO_UNIT_TESTING */
@@ -1,86 +1,224 @@
-// Constants
-const maxDataLength = 32;
-// Arrays
-let heartRateArray = [];
-let timeArray = [];
-let freqsHz = [];
-let freqsAmplitude = [];
-
-// Last values
-let lastFreqsHz = [];
-let lastFreqsAmplitude = [];
-let lastRawTime = 0;
-
-// Values vars
-let beatsPerMinuteValue = "Calculating BPM...";
-let spo2PercentageValue = "Calculating SPO2...";
-
-// Conectar al WebSocket del ESP32
-var socket = new WebSocket('ws://' + location.hostname + '/ws');
-socket.onmessage = function (event) {
-    // get new data
-    var jsonData = JSON.parse(event.data);
-
-    // update beats per minute and spo2
-    var beatsPerMinute = jsonData.beatsPerMinute;
-    beatsPerMinuteValue = beatsPerMinute + " BPM";
-    document.getElementById('heartrate').innerHTML = beatsPerMinuteValue;
-    
-    var spo2Percentage = jsonData.spo2Percentage;
-    spo2PercentageValue = spo2Percentage + " %";
-    document.getElementById('spo2').innerHTML = spo2PercentageValue;
-
-    // update heartRateArray, spo2Array and timeArray
-    var newHeartRateData = jsonData.heartRateData;
-    heartRateArray.push(newHeartRateData);
-    if (heartRateArray.length >= maxDataLength) heartRateArray.shift();
-
-    if(lastRawTime != 0)
-    {
-        var actualTime = Date.now();
-        var millisTimeDifference = actualTime - lastRawTime;
-        var timeDifferenceBetweenData = millisTimeDifference/1000;
-        
-        // calculate accomulated time and round it to 3 decimals
-        var accomulatedTime = Math.floor((timeArray[timeArray.length - 1] + timeDifferenceBetweenData)*1000)/1000;        
-        lastRawTime = actualTime;
-        timeArray.push(accomulatedTime);
-    } else {
-        lastRawTime = Date.now();
-        timeArray.push(0);
-    }
-    if ( timeArray.length > maxDataLength ) timeArray.shift();
-    
-    cardiogramaChart.update();
-    
-    // update freqsHz and freqsAmplitude
-    var freqsDataHz = jsonData.freqsHz;
-    var similarityBetweenHzArrays =  (lastFreqsHz.length == freqsDataHz.length) 
-        && lastFreqsHz.every(function(element, index) {
-        return element === freqsDataHz[index]; 
-    });
-
-    if (!similarityBetweenHzArrays){
-        freqsHz.length = 0;
-        for(var i = 0; i < freqsDataHz.length; i++)
-        {
-            freqsHz.push(freqsDataHz[i]);
-        }
-        lastFreqsHz = freqsDataHz;
-    }
-    
-    var freqsDataAmplitude = jsonData.freqsAmplitude;
-    var similarityBetweenAmplitudeArrays = (lastFreqsAmplitude.length == freqsDataAmplitude.length) 
-        && lastFreqsAmplitude.every(function(element, index) {
-        return element === freqsDataAmplitude[index]; 
-    });
-    if (!similarityBetweenAmplitudeArrays){
-        freqsAmplitude.length = 0;
-        for(var i = 0; i < freqsDataAmplitude.length; i++){
-            freqsAmplitude.push(freqsDataAmplitude[i]);
-        }
-        lastFreqsAmplitude = freqsDataAmplitude;
-        
-        freqsChart.update();
-    }
-}
\ No newline at end of file
+// Constants
+const maxDataLength = 250; // 10 s of filtered samples at 25 Hz
+// Arrays
+let heartRateArray = [];
+let timeArray = [];
+let freqsHz = [];
+let freqsAmplitude = [];
+
+// Last values
+let lastFreqsHz = [];
+let lastFreqsAmplitude = [];
+let lastRawTime = 0;
+
+// Waveform stream
+let streamingWaveform = false;
+let nextSampleSequence = -1;
+let firstSampleTimestamp = -1;
+let missedSamples = 0;
+
+// Values vars
+let beatsPerMinuteValue = "Calculating BPM...";
+let spo2PercentageValue = "Calculating SPO2...";
+
+// Binary protocol (pulsiox.bin.v1), add ?protocol=json to the page URL to use JSON
+const binaryProtocolName = 'pulsiox.bin.v1';
+const useBinaryProtocol = new URLSearchParams(location.search).get('protocol') != 'json';
+
+// Conectar al WebSocket del ESP32
+var socket = useBinaryProtocol 
+    ? new WebSocket('ws://' + location.host + '/ws?protocol=binary', [binaryProtocolName])
+    : new WebSocket('ws://' + location.host + '/ws');
+socket.binaryType = 'arraybuffer';
+socket.onmessage = function (event) {
+    // get new data
+    var jsonData = (event.data instanceof ArrayBuffer) ? decodeBinaryFrame(event.data) : JSON.parse(event.data);
+    if (jsonData == null) return;
+
+    // waveform stream message
+    if (jsonData.samples !== undefined) {
+        appendWaveformSamples(jsonData);
+        return;
+    }
+
+    // update beats per minute and spo2
+    var beatsPerMinute = jsonData.beatsPerMinute;
+    beatsPerMinuteValue = beatsPerMinute + " BPM";
+    document.getElementById('heartrate').innerHTML = beatsPerMinuteValue;
+    
+    var spo2Percentage = jsonData.spo2Percentage;
+    spo2PercentageValue = spo2Percentage + " %";
+    document.getElementById('spo2').innerHTML = spo2PercentageValue;
+
+    // update heartRateArray, spo2Array and timeArray, if the waveform is not streamed
+    if (!streamingWaveform) updateHeartRateData(jsonData.heartRateData);
+    
+    // update freqsHz and freqsAmplitude
+    var freqsDataHz = jsonData.freqsHz;
+    var similarityBetweenHzArrays =  (lastFreqsHz.length == freqsDataHz.length) 
+        && lastFreqsHz.every(function(element, index) {
+        return element === freqsDataHz[index]; 
+    });
+
+    if (!similarityBetweenHzArrays){
+        freqsHz.length = 0;
+        for(var i = 0; i < freqsDataHz.length; i++)
+        {
+            freqsHz.push(freqsDataHz[i]);
+        }
+        lastFreqsHz = freqsDataHz;
+    }
+    
+    var freqsDataAmplitude = jsonData.freqsAmplitude;
+    var similarityBetweenAmplitudeArrays = (lastFreqsAmplitude.length == freqsDataAmplitude.length) 
+        && lastFreqsAmplitude.every(function(element, index) {
+        return element === freqsDataAmplitude[index]; 
+    });
+    if (!similarityBetweenAmplitudeArrays){
+        freqsAmplitude.length = 0;
+        for(var i = 0; i < freqsDataAmplitude.length; i++){
+            freqsAmplitude.push(freqsDataAmplitude[i]);
+        }
+        lastFreqsAmplitude = freqsDataAmplitude;
+        
+        freqsChart.update();
+    }
+}
+
+// Append the value sent with the vitals, when the waveform is not streamed
+function updateHeartRateData(newHeartRateData) {
+    heartRateArray.push(newHeartRateData);
+    if (heartRateArray.length >= maxDataLength) heartRateArray.shift();
+
+    if(lastRawTime != 0)
+    {
+        var actualTime = Date.now();
+        var millisTimeDifference = actualTime - lastRawTime;
+        var timeDifferenceBetweenData = millisTimeDifference/1000;
+        
+        // calculate accomulated time and round it to 3 decimals
+        var accomulatedTime = Math.floor((timeArray[timeArray.length - 1] + timeDifferenceBetweenData)*1000)/1000;        
+        lastRawTime = actualTime;
+        timeArray.push(accomulatedTime);
+    } else {
+        lastRawTime = Date.now();
+        timeArray.push(0);
+    }
+    if ( timeArray.length > maxDataLength ) timeArray.shift();
+    
+    cardiogramaChart.update();
+}
+
+// Append a batch of filtered samples, breaking the line where samples were missed
+function appendWaveformSamples(data) {
+    streamingWaveform = true;
+    if (nextSampleSequence >= 0 && data.sequence != nextSampleSequence) {
+        var missed = data.sequence - nextSampleSequence;
+        missedSamples += missed > 0 ? missed : 0;
+        console.log('Missed ' + missed + ' samples, ' + missedSamples + ' in total');
+        heartRateArray.push(null);
+        timeArray.push(timeArray.length > 0 ? timeArray[timeArray.length - 1] : 0);
+    }
+    if (firstSampleTimestamp < 0 && data.timestamps.length > 0) firstSampleTimestamp = data.timestamps[0];
+
+    for (var i = 0; i < data.samples.length; i++) {
+        heartRateArray.push(data.samples[i]);
+        timeArray.push((data.timestamps[i] - firstSampleTimestamp) / 1000);
+    }
+    while (heartRateArray.length > maxDataLength) {
+        heartRateArray.shift();
+        timeArray.shift();
+    }
+    nextSampleSequence = data.sequence + data.samples.length;
+
+    cardiogramaChart.update({ duration: 0 });
+}
+
+// Decode a binary frame into the same object as the JSON message
+function decodeBinaryFrame(buffer) {
+    var view = new DataView(buffer);
+    var offset = 0;
+    function uint8() { var value = view.getUint8(offset); offset += 1; return value; }
+    function uint16() { var value = view.getUint16(offset, true); offset += 2; return value; }
+    function uint32() { var value = view.getUint32(offset, true); offset += 4; return value; }
+    function int32() { var value = view.getInt32(offset, true); offset += 4; return value; }
+    function float32() { var value = view.getFloat32(offset, true); offset += 4; return value; }
+    function varint() {
+        var value = 0, shift = 0, byte;
+        do {
+            byte = uint8();
+            value += (byte & 0x7F) * Math.pow(2, shift);
+            shift += 7;
+        } while (byte & 0x80);
+        return value;
+    }
+    function zigzag(value) { return (value % 2) ? -(value + 1) / 2 : value / 2; }
+
+    // header
+    if (uint8() != 0x50 || uint8() != 1) return null;
+    var sections = uint8();
+    uint8(); // reserved
+    var data = { sequence: uint16() };
+
+    // vitals
+    if (sections & 0x01) {
+        data.beatsPerMinute = uint16() / 10;
+        data.spo2Percentage = uint16() / 10;
+    }
+
+    // waveform
+    if (sections & 0x02) {
+        var count = uint16();
+        data.heartRateSamples = [];
+        if (count > 0) {
+            var sample = int32();
+            data.heartRateSamples.push(sample);
+            for (var i = 1; i < count; i++) {
+                // the samples are signed and their differences wrap around 32 bits
+                sample = (sample + zigzag(varint())) | 0;
+                data.heartRateSamples.push(sample);
+            }
+            data.heartRateData = data.heartRateSamples[0];
+        }
+    }
+
+    // spectrum
+    if (sections & 0x04) {
+        var bins = uint16();
+        var axisType = uint8();
+        data.freqsHz = [];
+        data.freqsAmplitude = [];
+        if (axisType == 0) {
+            var start = float32();
+            var step = float32();
+            for (var i = 0; i < bins; i++) data.freqsHz.push(Math.round((start + i * step) * 100) / 100);
+        } else {
+            for (var i = 0; i < bins; i++) data.freqsHz.push(uint16() / 100);
+        }
+        var maxAmplitude = float32();
+        for (var i = 0; i < bins; i++) {
+            data.freqsAmplitude.push(Math.round(uint16() / 65535 * maxAmplitude * 100) / 100);
+        }
+    }
+
+    // stream
+    if (sections & 0x08) {
+        data.sequence = uint32();
+        var count = uint16();
+        data.timestamps = [];
+        data.samples = [];
+        if (count > 0) {
+            var timestamp = uint32();
+            var sample = int32();
+            data.timestamps.push(timestamp);
+            data.samples.push(sample);
+            for (var i = 1; i < count; i++) {
+                timestamp += zigzag(varint());
+                sample = (sample + zigzag(varint())) | 0;
+                data.timestamps.push(timestamp);
+                data.samples.push(sample);
+            }
+        }
+    }
+    return data;
+}
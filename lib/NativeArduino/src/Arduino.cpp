@@ -0,0 +1,294 @@
+#include "Arduino.h"
+
+#include <stdarg.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+HardwareSerial Serial;
+
+static const chrono::steady_clock::time_point bootTime = chrono::steady_clock::now();
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base)
+{
+    char buffer[72];
+    if (base == DEC) snprintf(buffer, sizeof(buffer), "%ld", value);
+    else snprintf(buffer, sizeof(buffer), "%lx", (unsigned long)value);
+    text = buffer;
+}
+
+String::String(unsigned long value, unsigned char base)
+{
+    char buffer[72];
+    snprintf(buffer, sizeof(buffer), base == DEC ? "%lu" : "%lx", value);
+    text = buffer;
+}
+
+String::String(double value, unsigned char decimals)
+{
+    char buffer[72];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    text = buffer;
+}
+
+int String::indexOf(const String& value, unsigned int from) const
+{
+    size_t position = text.find(value.text, from);
+    return position == string::npos ? -1 : (int)position;
+}
+
+String String::substring(unsigned int from, unsigned int to) const
+{
+    if (from > to) swap(from, to);
+    if (from >= text.size()) return String();
+    return String(text.substr(from, to - from));
+}
+
+String operator+(const String& left, const String& right)
+{
+    return String(left.text + right.text);
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    size_t written = 0;
+    while (size--) written += write(*buffer++);
+    return written;
+}
+
+size_t Print::print(long value, int base)
+{
+    return print(String(value, base));
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    return print(String(value, base));
+}
+
+size_t Print::print(double value, int decimals)
+{
+    return print(String(value, decimals));
+}
+
+size_t Print::printf(const char* format, ...)
+{
+    char buffer[256];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, arguments);
+    va_end(arguments);
+    if (length < 0) return 0;
+    if ((size_t)length < sizeof(buffer)) return write((const uint8_t*)buffer, length);
+
+    string text(length + 1, '\0');
+    va_start(arguments, format);
+    vsnprintf(&text[0], text.size(), format, arguments);
+    va_end(arguments);
+    return write((const uint8_t*)text.data(), length);
+}
+
+size_t HardwareSerial::write(uint8_t value)
+{
+    return write(&value, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size)
+{
+    if (output == NULL) return size;
+    return fwrite(buffer, 1, size, output);
+}
+
+EspClass ESP;
+
+uint32_t EspClass::getCycleCount()
+{
+    uint64_t ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - bootTime).count();
+    return (uint32_t)(ns * getCpuFreqMHz() / 1000);
+}
+
+unsigned long millis()
+{
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long micros()
+{
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - bootTime).count();
+}
+
+void delay(uint32_t ms)
+{
+    this_thread::sleep_for(chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    this_thread::sleep_for(chrono::microseconds(us));
+}
+
+// The pins are only levels: inputs read HIGH until setPinLevel() changes them, as the
+// pulled up buttons at rest
+const uint8_t NATIVE_PINS = 64;
+
+/** Pin struct
+ *
+ * @param level Level of the pin
+ * @param mode Mode of the attached interrupt, 0 if there is none
+ * @param handler Attached interrupt
+ * @param argument Argument of the attached interrupt, if it was attached with one
+ * @param hasArgument True if the interrupt was attached with an argument
+ *
+ */
+struct nativePin {
+    uint8_t level;
+    int mode;
+    void (*handler)(void*);
+    void* argument;
+    bool hasArgument;
+};
+
+static nativePin pins[NATIVE_PINS];
+static mutex pinsMutex;
+static bool pinsReady = false;
+
+static nativePin& getPin(uint8_t pin)
+{
+    if (!pinsReady)
+    {
+        for (uint8_t i = 0; i < NATIVE_PINS; i++) pins[i] = { HIGH, 0, NULL, NULL, false };
+        pinsReady = true;
+    }
+    return pins[pin % NATIVE_PINS];
+}
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+
+int digitalRead(uint8_t pin)
+{
+    lock_guard<mutex> lock(pinsMutex);
+    return getPin(pin).level;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    lock_guard<mutex> lock(pinsMutex);
+    getPin(pin).level = value ? HIGH : LOW;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode)
+{
+    lock_guard<mutex> lock(pinsMutex);
+    nativePin& state = getPin(pin);
+    state.handler = (void (*)(void*))handler;
+    state.argument = NULL;
+    state.hasArgument = false;
+    state.mode = mode;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* argument, int mode) 
+{
+    lock_guard<mutex> lock(pinsMutex);
+    nativePin& state = getPin(pin);
+    state.handler = handler;
+    state.argument = argument;
+    state.hasArgument = true;
+    state.mode = mode;
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    lock_guard<mutex> lock(pinsMutex);
+    getPin(pin).mode = 0;
+}
+
+void setPinLevel(uint8_t pin, uint8_t level)
+{
+    unique_lock<mutex> lock(pinsMutex);
+    nativePin& state = getPin(pin);
+    level = level ? HIGH : LOW;
+    bool rising = state.level == LOW && level == HIGH;
+    bool falling = state.level == HIGH && level == LOW;
+    state.level = level;
+
+    bool matches = (rising && (state.mode == RISING || state.mode == CHANGE)) ||
+                   (falling && (state.mode == FALLING || state.mode == CHANGE));
+    if (!matches || state.handler == NULL) return;
+    nativePin interrupt = state;
+    lock.unlock();
+    if (interrupt.hasArgument) interrupt.handler(interrupt.argument);
+    else ((void (*)(void))interrupt.handler)();
+}
+
+// The ESP32 timers count the 80 MHz APB clock divided by the prescaler
+const uint32_t TIMER_BASE_CLOCK = 80000000;
+
+struct hw_timer_s {
+    uint16_t divider;
+    uint64_t alarmValue;
+    bool autoReload;
+    void (*handler)(void);
+    atomic<bool> enabled;
+    atomic<uint32_t> generation;
+};
+
+hw_timer_t* timerBegin(uint8_t number, uint16_t divider, bool countUp)
+{
+    (void)number; (void)countUp;
+    hw_timer_t* timer = new hw_timer_t();
+    timer->divider = divider ? divider : 1;
+    timer->alarmValue = 0;
+    timer->autoReload = false;
+    timer->handler = NULL;
+    timer->enabled = false;
+    timer->generation = 0;
+    return timer;
+}
+
+void timerEnd(hw_timer_t* timer)
+{
+    // the thread of the timer may still be sleeping, so the timer is never freed
+    timerAlarmDisable(timer);
+}
+
+void timerAttachInterrupt(hw_timer_t* timer, void (*handler)(void), bool edge)
+{
+    (void)edge;
+    timer->handler = handler;
+}
+
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarmValue, bool autoReload)
+{
+    timer->alarmValue = alarmValue;
+    timer->autoReload = autoReload;
+}
+
+void timerAlarmEnable(hw_timer_t* timer)
+{
+    if (timer->enabled.exchange(true)) return;
+    uint32_t generation = ++timer->generation;
+    uint64_t periodUs = timer->alarmValue * timer->divider / (TIMER_BASE_CLOCK / 1000000);
+    thread([timer, generation, periodUs]() {
+        chrono::steady_clock::time_point next = chrono::steady_clock::now();
+        do
+        {
+            next += chrono::microseconds(periodUs ? periodUs : 1);
+            this_thread::sleep_until(next);
+            if (!timer->enabled || timer->generation != generation) return;
+            if (timer->handler) timer->handler();
+        } while (timer->autoReload);
+        timer->enabled = false;
+    }).detach();
+}
+
+void timerAlarmDisable(hw_timer_t* timer)
+{
+    timer->enabled = false;
+}
@@ -0,0 +1,206 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+/* Native shim of the Arduino core. It only has what the firmware uses, so the
+ * processing can be built and measured on the host. */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define IRAM_ATTR
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define DEC 10
+#define HEX 16
+
+#define digitalPinToInterrupt(pin) (pin)
+
+using std::min;
+using std::max;
+
+/** String class
+ *
+ * @brief Arduino String backed by a std::string.
+ *
+ */
+class String {
+    std::string text;
+
+    public:
+        String() {}
+        String(const char* value) : text(value ? value : "") {}
+        String(const std::string& value) : text(value) {}
+        String(char value) : text(1, value) {}
+        String(int value, unsigned char base = DEC);
+        String(unsigned int value, unsigned char base = DEC);
+        String(long value, unsigned char base = DEC);
+        String(unsigned long value, unsigned char base = DEC);
+        String(double value, unsigned char decimals = 2);
+
+        const char* c_str() const { return text.c_str(); }
+        unsigned int length() const { return text.size(); }
+        bool reserve(unsigned int size) { text.reserve(size); return true; }
+        bool concat(const String& value) { text += value.text; return true; }
+        bool concat(const char* value, unsigned int length) { text.append(value, length); return true; }
+        String& operator+=(const String& value) { text += value.text; return *this; }
+        String& operator+=(const char* value) { text += value; return *this; }
+        String& operator+=(char value) { text += value; return *this; }
+        bool operator==(const String& value) const { return text == value.text; }
+        bool operator==(const char* value) const { return text == value; }
+        bool operator!=(const String& value) const { return text != value.text; }
+        bool operator!=(const char* value) const { return text != value; }
+        char operator[](unsigned int index) const { return index < text.size() ? text[index] : 0; }
+        int indexOf(const String& value, unsigned int from = 0) const;
+        bool startsWith(const String& value) const { return text.compare(0, value.text.size(), value.text) == 0; }
+        String substring(unsigned int from) const { return from < text.size() ? String(text.substr(from)) : String(); }
+        String substring(unsigned int from, unsigned int to) const;
+        long toInt() const { return atol(text.c_str()); }
+        float toFloat() const { return atof(text.c_str()); }
+
+        friend String operator+(const String& left, const String& right);
+};
+
+String operator+(const String& left, const String& right);
+
+class Print;
+
+/** Printable class
+ *
+ * @brief Object that knows how to print itself.
+ *
+ */
+class Printable {
+    public:
+        virtual ~Printable() {}
+        virtual size_t printTo(Print& printer) const = 0;
+};
+
+/** Print class
+ *
+ * @brief Arduino formatted output over a write function.
+ *
+ */
+class Print {
+    public:
+        virtual ~Print() {}
+        virtual size_t write(uint8_t value) = 0;
+        virtual size_t write(const uint8_t* buffer, size_t size);
+        size_t write(const char* text) { return text ? write((const uint8_t*)text, strlen(text)) : 0; }
+
+        size_t print(const char* value) { return write(value); }
+        size_t print(const String& value) { return write(value.c_str()); }
+        size_t print(char value) { return write((uint8_t)value); }
+        size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+        size_t print(int value, int base = DEC) { return print((long)value, base); }
+        size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+        size_t print(long value, int base = DEC);
+        size_t print(unsigned long value, int base = DEC);
+        size_t print(long long value, int base = DEC) { return print((long)value, base); }
+        size_t print(unsigned long long value, int base = DEC) { return print((unsigned long)value, base); }
+        size_t print(double value, int decimals = 2);
+        size_t print(const Printable& value) { return value.printTo(*this); }
+
+        template <typename T>
+        size_t println(const T& value) { size_t size = print(value); return size + println(); }
+        template <typename T>
+        size_t println(const T& value, int format) { size_t size = print(value, format); return size + println(); }
+        size_t println() { return write("\r\n"); }
+
+        size_t printf(const char* format, ...) __attribute__ ((format (printf, 2, 3)));
+};
+
+/** Hardware serial class
+ *
+ * @brief Serial port written to the standard output.
+ *
+ * @details setOutput() only exists in the native build, to silence or redirect the
+ *          messages of the firmware.
+ *
+ */
+class HardwareSerial : public Print {
+    FILE* output;
+
+    public:
+        HardwareSerial() : output(stdout) {}
+        void begin(unsigned long baudRate) { (void)baudRate; }
+        void end() {}
+        void flush() { if (output) fflush(output); }
+        int available() { return 0; }
+        int read() { return -1; }
+        void setOutput(FILE* stream) { output = stream; }
+        operator bool() const { return true; }
+
+        using Print::write;
+        size_t write(uint8_t value);
+        size_t write(const uint8_t* buffer, size_t size);
+};
+
+extern HardwareSerial Serial;
+
+/** ESP class
+ *
+ * @brief Functions of the chip. The cycle counter counts at the CPU frequency of the
+ *        ESP32 from the host clock, so the cycles measured are host time.
+ *
+ */
+class EspClass {
+    public:
+        uint32_t getCycleCount();
+        uint32_t getCpuFreqMHz() { return 240; }
+};
+
+extern EspClass ESP;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* argument, int mode);
+void detachInterrupt(uint8_t pin);
+
+// Native only: changes the level of an input pin, as a device or a button would, and
+// calls the interrupt attached to the pin if the edge matches its mode
+void setPinLevel(uint8_t pin, uint8_t level);
+
+/** Hardware timer struct
+ *
+ * @brief Timer of the ESP32, run by a thread that calls the interrupt at each alarm.
+ *
+ */
+typedef struct hw_timer_s hw_timer_t;
+
+hw_timer_t* timerBegin(uint8_t number, uint16_t divider, bool countUp);
+void timerEnd(hw_timer_t* timer);
+void timerAttachInterrupt(hw_timer_t* timer, void (*handler)(void), bool edge);
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarmValue, bool autoReload);
+void timerAlarmEnable(hw_timer_t* timer);
+void timerAlarmDisable(hw_timer_t* timer);
+
+#endif /* ARDUINO_H */
@@ -0,0 +1,784 @@
+#include "ESPAsyncWebServer.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+// Mutex of the clients, their queues and the connections, taken by the server thread
+// while it calls the handlers
+static recursive_mutex webMutex;
+
+static const char* WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+static const size_t MAX_REQUEST_SIZE = 8192;
+static const int POLL_PERIOD_MS = 5;
+
+/** SHA-1 function
+ *
+ * @brief Computes the SHA-1 digest of a message, used by the WebSocket handshake.
+ *
+ */
+static void sha1(const string& message, uint8_t digest[20])
+{
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    string data = message;
+    uint64_t bits = (uint64_t)message.size() * 8;
+    data += (char)0x80;
+    while (data.size() % 64 != 56) data += (char)0;
+    for (int i = 7; i >= 0; i--) data += (char)(bits >> (i * 8));
+
+    for (size_t chunk = 0; chunk < data.size(); chunk += 64)
+    {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++)
+        {
+            const uint8_t* p = (const uint8_t*)data.data() + chunk + i * 4;
+            w[i] = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+        }
+        for (int i = 16; i < 80; i++)
+        {
+            uint32_t v = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+            w[i] = v << 1 | v >> 31;
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++)
+        {
+            uint32_t f, k;
+            if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+            uint32_t temp = (a << 5 | a >> 27) + f + e + k + w[i];
+            e = d; d = c; c = b << 30 | b >> 2; b = a; a = temp;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    for (int i = 0; i < 20; i++) digest[i] = h[i / 4] >> (24 - (i % 4) * 8);
+}
+
+static string base64(const uint8_t* data, size_t length)
+{
+    static const char* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    string encoded;
+    for (size_t i = 0; i < length; i += 3)
+    {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < length) v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < length) v |= data[i + 2];
+        encoded += table[(v >> 18) & 0x3F];
+        encoded += table[(v >> 12) & 0x3F];
+        encoded += i + 1 < length ? table[(v >> 6) & 0x3F] : '=';
+        encoded += i + 2 < length ? table[v & 0x3F] : '=';
+    }
+    return encoded;
+}
+
+static string toLower(string text)
+{
+    for (size_t i = 0; i < text.size(); i++) text[i] = tolower((unsigned char)text[i]);
+    return text;
+}
+
+static string trim(const string& text)
+{
+    size_t begin = text.find_first_not_of(" \t");
+    size_t end = text.find_last_not_of(" \t\r");
+    return begin == string::npos ? string() : text.substr(begin, end - begin + 1);
+}
+
+static string urlDecode(const string& text)
+{
+    string decoded;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        if (text[i] == '+') decoded += ' ';
+        else if (text[i] == '%' && i + 2 < text.size())
+        {
+            decoded += (char)strtol(text.substr(i + 1, 2).c_str(), NULL, 16);
+            i += 2;
+        }
+        else decoded += text[i];
+    }
+    return decoded;
+}
+
+static const char* statusText(int code)
+{
+    switch (code)
+    {
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        default: return "Internal Server Error";
+    }
+}
+
+/** WebSocket frame function
+ *
+ * @brief Builds an unmasked frame sent by the server.
+ *
+ */
+static string wsFrame(uint8_t opcode, const uint8_t* payload, size_t length)
+{
+    string frame;
+    frame += (char)(0x80 | opcode);
+    if (length < 126) frame += (char)length;
+    else if (length < 65536)
+    {
+        frame += (char)126;
+        frame += (char)(length >> 8);
+        frame += (char)length;
+    }
+    else
+    {
+        frame += (char)127;
+        for (int i = 7; i >= 0; i--) frame += (char)((uint64_t)length >> (i * 8));
+    }
+    frame.append((const char*)payload, length);
+    return frame;
+}
+
+/** HTTP connection struct
+ *
+ * @param fd Socket of the connection
+ * @param input Bytes received and not parsed yet
+ * @param output Bytes waiting to be written
+ * @param closeAfterWrite True if the connection is closed once the output is written
+ * @param socket WebSocket of the connection, NULL while it is an HTTP connection
+ * @param client WebSocket client of the connection
+ *
+ */
+struct httpConnection {
+    int fd;
+    string input;
+    string output;
+    bool closeAfterWrite;
+    AsyncWebSocket* socket;
+    AsyncWebSocketClient* client;
+};
+
+/** Native HTTP server class
+ *
+ * @brief Thread that accepts the connections of an AsyncWebServer and serves them.
+ *
+ */
+class nativeHttpServer {
+    AsyncWebServer* owner;
+    int listenFd;
+    list<httpConnection> connections;
+
+    void run();
+    bool readConnection(httpConnection& connection);
+    bool writeConnection(httpConnection& connection);
+    void handleRequest(httpConnection& connection, size_t headerEnd);
+    void handleFrames(httpConnection& connection);
+    void fillOutput(httpConnection& connection);
+    void closeConnection(httpConnection& connection);
+
+    public:
+        nativeHttpServer(AsyncWebServer* pOwner, int fd) : owner(pOwner), listenFd(fd) {}
+
+        void start() { thread(&nativeHttpServer::run, this).detach(); }
+};
+
+void nativeHttpServer::run()
+{
+    vector<pollfd> fds;
+    while (true)
+    {
+        fds.clear();
+        pollfd listener = { listenFd, POLLIN, 0 };
+        fds.push_back(listener);
+        {
+            lock_guard<recursive_mutex> lock(webMutex);
+            for (list<httpConnection>::iterator it = connections.begin(); it != connections.end(); ++it)
+            {
+                fillOutput(*it);
+                pollfd entry = { it->fd, (short)(POLLIN | (it->output.empty() ? 0 : POLLOUT)), 0 };
+                fds.push_back(entry);
+            }
+        }
+
+        // the timeout bounds the latency of the messages queued by the other threads
+        if (poll(fds.data(), fds.size(), POLL_PERIOD_MS) < 0 && errno != EINTR) return;
+
+        lock_guard<recursive_mutex> lock(webMutex);
+        if (fds[0].revents & POLLIN)
+        {
+            int fd = accept(listenFd, NULL, NULL);
+            if (fd >= 0)
+            {
+                httpConnection connection = { fd, string(), string(), false, NULL, NULL };
+                connections.push_back(connection);
+            }
+        }
+
+        size_t index = 1;
+        for (list<httpConnection>::iterator it = connections.begin(); it != connections.end(); )
+        {
+            bool open = true;
+            if (index < fds.size() && fds[index].fd == it->fd)
+            {
+                short events = fds[index].revents;
+                index++;
+                if (events & (POLLIN | POLLHUP | POLLERR)) open = readConnection(*it);
+                if (open && (events & POLLOUT)) open = writeConnection(*it);
+            }
+            if (!open)
+            {
+                closeConnection(*it);
+                it = connections.erase(it);
+            }
+            else ++it;
+        }
+    }
+}
+
+bool nativeHttpServer::readConnection(httpConnection& connection)
+{
+    char buffer[4096];
+    ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+    if (received <= 0) return false;
+    connection.input.append(buffer, received);
+
+    if (connection.socket != NULL)
+    {
+        handleFrames(connection);
+        return true;
+    }
+
+    size_t headerEnd = connection.input.find("\r\n\r\n");
+    if (headerEnd != string::npos) handleRequest(connection, headerEnd);
+    else if (connection.input.size() > MAX_REQUEST_SIZE) return false;
+    return true;
+}
+
+bool nativeHttpServer::writeConnection(httpConnection& connection)
+{
+    ssize_t sent = send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+    if (sent < 0) return errno == EAGAIN || errno == EINTR;
+    connection.output.erase(0, sent);
+    return !(connection.output.empty() && connection.closeAfterWrite);
+}
+
+void nativeHttpServer::closeConnection(httpConnection& connection)
+{
+    close(connection.fd);
+    if (connection.client == NULL) return;
+
+    connection.client->clientStatus = WS_DISCONNECTED;
+    AsyncWebSocket* socket = connection.socket;
+    if (socket->eventHandler) socket->eventHandler(socket, connection.client, WS_EVT_DISCONNECT, NULL, NULL, 0);
+}
+
+/** Handle request function
+ *
+ * @brief Parses an HTTP request, answers it with its route or upgrades it to a WebSocket.
+ *
+ */
+void nativeHttpServer::handleRequest(httpConnection& connection, size_t headerEnd)
+{
+    string head = connection.input.substr(0, headerEnd);
+    connection.input.clear();
+
+    AsyncWebServerRequest request;
+    size_t lineEnd = head.find("\r\n");
+    string requestLine = head.substr(0, lineEnd);
+    size_t methodEnd = requestLine.find(' ');
+    size_t targetEnd = requestLine.find(' ', methodEnd + 1);
+    if (methodEnd == string::npos || targetEnd == string::npos)
+    {
+        request.send(400);
+        connection.output = request.response;
+        connection.closeAfterWrite = true;
+        return;
+    }
+    string method = requestLine.substr(0, methodEnd);
+    string target = requestLine.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+    request.requestMethod = method == "POST" ? HTTP_POST : HTTP_GET;
+
+    size_t queryStart = target.find('?');
+    request.requestUrl = String(urlDecode(target.substr(0, queryStart)));
+    if (queryStart != string::npos)
+    {
+        string query = target.substr(queryStart + 1);
+        size_t start = 0;
+        while (start <= query.size())
+        {
+            size_t end = query.find('&', start);
+            if (end == string::npos) end = query.size();
+            string pair = query.substr(start, end - start);
+            size_t equal = pair.find('=');
+            if (!pair.empty())
+            {
+                request.parameters.push_back(AsyncWebParameter(String(urlDecode(pair.substr(0, equal))),
+                    String(equal == string::npos ? string() : urlDecode(pair.substr(equal + 1)))));
+            }
+            start = end + 1;
+        }
+    }
+
+    while (lineEnd != string::npos)
+    {
+        size_t start = lineEnd + 2;
+        lineEnd = head.find("\r\n", start);
+        string line = head.substr(start, lineEnd == string::npos ? string::npos : lineEnd - start);
+        size_t colon = line.find(':');
+        if (colon == string::npos) continue;
+        request.headers.push_back(AsyncWebHeader(String(trim(line.substr(0, colon))), String(trim(line.substr(colon + 1)))));
+    }
+
+    AsyncWebSocket* socket = NULL;
+    for (size_t i = 0; i < owner->sockets.size(); i++)
+    {
+        if (request.requestUrl == owner->sockets[i]->url) socket = owner->sockets[i];
+    }
+    AsyncWebHeader* key = request.getHeader("Sec-WebSocket-Key");
+    if (socket != NULL && key != NULL)
+    {
+        uint8_t digest[20];
+        sha1(string(key->value().c_str()) + WS_GUID, digest);
+        string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                          "Sec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\n";
+        AsyncWebHeader* protocols = request.getHeader("Sec-WebSocket-Protocol");
+        if (protocols != NULL)
+        {
+            string requested = protocols->value().c_str();
+            response += "Sec-WebSocket-Protocol: " + trim(requested.substr(0, requested.find(','))) + "\r\n";
+        }
+        connection.output = response + "\r\n";
+        connection.socket = socket;
+        connection.client = new AsyncWebSocketClient(socket, socket->nextId++);
+        socket->clients.push_back(connection.client);
+        if (socket->eventHandler) socket->eventHandler(socket, connection.client, WS_EVT_CONNECT, &request, NULL, 0);
+        return;
+    }
+
+    bool found = false;
+    for (size_t i = 0; i < owner->routes.size() && !found; i++)
+    {
+        const AsyncWebServer::route& route = owner->routes[i];
+        if (route.uri != request.requestUrl || !(route.method & request.requestMethod)) continue;
+        found = true;
+        route.handler(&request);
+    }
+    if (!found) request.send(404, "text/plain", "Not found");
+    else if (request.response.empty()) request.send(500);
+
+    connection.output = request.response;
+    connection.closeAfterWrite = true;
+}
+
+/** Handle frames function
+ *
+ * @brief Parses the frames received from a WebSocket client.
+ *
+ * @details The fragmented messages are handed frame by frame, as the library does.
+ *
+ */
+void nativeHttpServer::handleFrames(httpConnection& connection)
+{
+    AsyncWebSocketClient* client = connection.client;
+    AsyncWebSocket* socket = connection.socket;
+    while (connection.input.size() >= 2)
+    {
+        const uint8_t* data = (const uint8_t*)connection.input.data();
+        uint8_t opcode = data[0] & 0x0F;
+        bool final = data[0] & 0x80;
+        bool masked = data[1] & 0x80;
+        uint64_t length = data[1] & 0x7F;
+        size_t offset = 2;
+        if (length == 126)
+        {
+            if (connection.input.size() < 4) return;
+            length = (uint64_t)data[2] << 8 | data[3];
+            offset = 4;
+        }
+        else if (length == 127)
+        {
+            if (connection.input.size() < 10) return;
+            length = 0;
+            for (int i = 0; i < 8; i++) length = length << 8 | data[2 + i];
+            offset = 10;
+        }
+        uint8_t mask[4] = { 0, 0, 0, 0 };
+        if (masked)
+        {
+            if (connection.input.size() < offset + 4) return;
+            memcpy(mask, data + offset, 4);
+            offset += 4;
+        }
+        if (connection.input.size() < offset + length) return;
+
+        string payload = connection.input.substr(offset, length);
+        for (size_t i = 0; i < payload.size(); i++) payload[i] ^= mask[i % 4];
+        connection.input.erase(0, offset + length);
+
+        if (opcode == WS_DISCONNECT)
+        {
+            if (client->clientStatus == WS_CONNECTED) connection.output += wsFrame(WS_DISCONNECT, NULL, 0);
+            client->clientStatus = WS_DISCONNECTING;
+            connection.closeAfterWrite = true;
+            return;
+        }
+        if (opcode == WS_PING)
+        {
+            connection.output += wsFrame(WS_PONG, (const uint8_t*)payload.data(), payload.size());
+            continue;
+        }
+        if (opcode == WS_PONG)
+        {
+            if (socket->eventHandler) socket->eventHandler(socket, client, WS_EVT_PONG, NULL, (uint8_t*)&payload[0], payload.size());
+            continue;
+        }
+
+        AwsFrameInfo info;
+        info.message_opcode = opcode;
+        info.num = 0;
+        info.final = final;
+        info.masked = masked;
+        info.opcode = opcode;
+        info.len = length;
+        memcpy(info.mask, mask, 4);
+        info.index = 0;
+        if (socket->eventHandler) socket->eventHandler(socket, client, WS_EVT_DATA, &info, (uint8_t*)&payload[0], payload.size());
+    }
+}
+
+/** Fill output function
+ *
+ * @brief Frames the next queued message of a WebSocket client once the previous one is written.
+ *
+ */
+void nativeHttpServer::fillOutput(httpConnection& connection)
+{
+    AsyncWebSocketClient* client = connection.client;
+    if (client == NULL || !connection.output.empty() || connection.closeAfterWrite) return;
+
+    if (!client->queue.empty())
+    {
+        AsyncWebSocketClient::queuedMessage message = client->queue.front();
+        client->queue.pop_front();
+        connection.output = wsFrame(message.opcode, message.buffer->get(), message.buffer->length());
+        message.buffer->unlock();
+        if (message.owned) delete message.buffer;
+    }
+    else if (client->clientStatus == WS_DISCONNECTING)
+    {
+        connection.output = wsFrame(WS_DISCONNECT, NULL, 0);
+        connection.closeAfterWrite = true;
+    }
+}
+
+AsyncWebSocketClient::AsyncWebSocketClient(AsyncWebSocket* pServer, uint32_t pClientId)
+{
+    this->server = pServer;
+    this->clientId = pClientId;
+    this->clientStatus = WS_CONNECTED;
+}
+
+AsyncWebSocketClient::~AsyncWebSocketClient()
+{
+    while (!queue.empty())
+    {
+        queue.front().buffer->unlock();
+        if (queue.front().owned) delete queue.front().buffer;
+        queue.pop_front();
+    }
+}
+
+AwsClientStatus AsyncWebSocketClient::status() const
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    return clientStatus;
+}
+
+bool AsyncWebSocketClient::canSend() const
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    return queue.size() < WS_MAX_QUEUED_MESSAGES;
+}
+
+bool AsyncWebSocketClient::queueIsFull() const
+{
+    return !canSend();
+}
+
+size_t AsyncWebSocketClient::queueLen() const
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    return queue.size();
+}
+
+void AsyncWebSocketClient::queueMessage(AsyncWebSocketMessageBuffer* buffer, bool owned, uint8_t opcode)
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    if (clientStatus != WS_CONNECTED || queue.size() >= WS_MAX_QUEUED_MESSAGES)
+    {
+        if (owned) delete buffer;
+        return;
+    }
+    buffer->lock();
+    queuedMessage message = { buffer, owned, opcode };
+    queue.push_back(message);
+}
+
+void AsyncWebSocketClient::close(uint16_t code, const char* message)
+{
+    (void)code;
+    (void)message;
+    lock_guard<recursive_mutex> lock(webMutex);
+    if (clientStatus == WS_CONNECTED) clientStatus = WS_DISCONNECTING;
+}
+
+void AsyncWebSocketClient::ping(const uint8_t* data, size_t length)
+{
+    queueMessage(new AsyncWebSocketMessageBuffer((uint8_t*)data, data ? length : 0), true, WS_PING);
+}
+
+void AsyncWebSocketClient::text(const char* message, size_t length)
+{
+    queueMessage(new AsyncWebSocketMessageBuffer((uint8_t*)message, length), true, WS_TEXT);
+}
+
+void AsyncWebSocketClient::text(const char* message)
+{
+    text(message, strlen(message));
+}
+
+void AsyncWebSocketClient::text(const String& message)
+{
+    text(message.c_str(), message.length());
+}
+
+void AsyncWebSocketClient::text(AsyncWebSocketMessageBuffer* buffer)
+{
+    queueMessage(buffer, false, WS_TEXT);
+}
+
+void AsyncWebSocketClient::binary(const uint8_t* message, size_t length)
+{
+    queueMessage(new AsyncWebSocketMessageBuffer((uint8_t*)message, length), true, WS_BINARY);
+}
+
+void AsyncWebSocketClient::binary(AsyncWebSocketMessageBuffer* buffer)
+{
+    queueMessage(buffer, false, WS_BINARY);
+}
+
+AsyncWebSocket::~AsyncWebSocket()
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    for (list<AsyncWebSocketClient*>::iterator it = clients.begin(); it != clients.end(); ++it) delete *it;
+}
+
+AsyncWebSocketClient* AsyncWebSocket::client(uint32_t id)
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    for (list<AsyncWebSocketClient*>::iterator it = clients.begin(); it != clients.end(); ++it)
+    {
+        if ((*it)->id() == id && (*it)->clientStatus == WS_CONNECTED) return *it;
+    }
+    return NULL;
+}
+
+size_t AsyncWebSocket::count() const
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    size_t connected = 0;
+    for (list<AsyncWebSocketClient*>::const_iterator it = clients.begin(); it != clients.end(); ++it)
+    {
+        if ((*it)->clientStatus == WS_CONNECTED) connected++;
+    }
+    return connected;
+}
+
+void AsyncWebSocket::closeAll(uint16_t code, const char* message)
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    for (list<AsyncWebSocketClient*>::iterator it = clients.begin(); it != clients.end(); ++it) (*it)->close(code, message);
+}
+
+/** Cleanup clients function
+ *
+ * @brief Deletes the disconnected clients and closes the oldest ones over the limit.
+ *
+ * @details The clients are only deleted here, so the pointers handed to the events stay
+ *          valid until the task that sends the messages asks for the cleanup.
+ *
+ */
+void AsyncWebSocket::cleanupClients(uint16_t maxClients)
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    for (list<AsyncWebSocketClient*>::iterator it = clients.begin(); it != clients.end(); )
+    {
+        if ((*it)->clientStatus == WS_DISCONNECTED)
+        {
+            delete *it;
+            it = clients.erase(it);
+        }
+        else ++it;
+    }
+    if (count() > maxClients) clients.front()->close();
+}
+
+void AsyncWebSocket::textAll(const char* message, size_t length)
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    for (list<AsyncWebSocketClient*>::iterator it = clients.begin(); it != clients.end(); ++it) (*it)->text(message, length);
+}
+
+void AsyncWebSocket::textAll(const String& message)
+{
+    textAll(message.c_str(), message.length());
+}
+
+void AsyncWebSocket::textAll(AsyncWebSocketMessageBuffer* buffer)
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    for (list<AsyncWebSocketClient*>::iterator it = clients.begin(); it != clients.end(); ++it) (*it)->text(buffer);
+}
+
+void AsyncWebSocket::binaryAll(const uint8_t* message, size_t length)
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    for (list<AsyncWebSocketClient*>::iterator it = clients.begin(); it != clients.end(); ++it) (*it)->binary(message, length);
+}
+
+void AsyncWebSocket::binaryAll(AsyncWebSocketMessageBuffer* buffer)
+{
+    lock_guard<recursive_mutex> lock(webMutex);
+    for (list<AsyncWebSocketClient*>::iterator it = clients.begin(); it != clients.end(); ++it) (*it)->binary(buffer);
+}
+
+void AsyncWebServerRequest::send(int code, const String& contentType, const String& content)
+{
+    char status[64];
+    snprintf(status, sizeof(status), "HTTP/1.1 %d %s\r\n", code, statusText(code));
+    response = status;
+    if (contentType.length() > 0) response += string("Content-Type: ") + contentType.c_str() + "\r\n";
+    response += "Content-Length: " + to_string(content.length()) + "\r\nConnection: close\r\n\r\n";
+    response.append(content.c_str(), content.length());
+}
+
+void AsyncWebServerRequest::send(SPIFFSFS& fs, const String& path, const String& contentType)
+{
+    File file = fs.open(path, FILE_READ);
+    if (!file)
+    {
+        send(404, "text/plain", "Not found");
+        return;
+    }
+    String content;
+    uint8_t buffer[4096];
+    size_t size;
+    while ((size = file.read(buffer, sizeof(buffer))) > 0) content.concat((const char*)buffer, size);
+    send(200, contentType, content);
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* pResponse)
+{
+    send(pResponse->code, pResponse->contentType, pResponse->getContent());
+    if (pResponse->headers.length() > 0)
+    {
+        size_t headerEnd = response.find("\r\n") + 2;
+        response.insert(headerEnd, pResponse->headers.c_str());
+    }
+    delete pResponse;
+}
+
+bool AsyncWebServerRequest::hasParam(const String& name) const
+{
+    for (size_t i = 0; i < parameters.size(); i++)
+    {
+        if (parameters[i].name() == name) return true;
+    }
+    return false;
+}
+
+AsyncWebParameter* AsyncWebServerRequest::getParam(const String& name)
+{
+    for (size_t i = 0; i < parameters.size(); i++)
+    {
+        if (parameters[i].name() == name) return &parameters[i];
+    }
+    return NULL;
+}
+
+bool AsyncWebServerRequest::hasHeader(const String& name) const
+{
+    return const_cast<AsyncWebServerRequest*>(this)->getHeader(name) != NULL;
+}
+
+AsyncWebHeader* AsyncWebServerRequest::getHeader(const String& name)
+{
+    string wanted = toLower(name.c_str());
+    for (size_t i = 0; i < headers.size(); i++)
+    {
+        if (toLower(headers[i].name().c_str()) == wanted) return &headers[i];
+    }
+    return NULL;
+}
+
+AsyncWebHandler& AsyncWebServer::addHandler(AsyncWebHandler* handler)
+{
+    AsyncWebSocket* socket = dynamic_cast<AsyncWebSocket*>(handler);
+    if (socket != NULL) sockets.push_back(socket);
+    return *handler;
+}
+
+void AsyncWebServer::on(const char* uri, WebRequestMethod method, ArRequestHandlerFunction handler)
+{
+    route entry = { String(uri), method, handler };
+    routes.push_back(entry);
+}
+
+/** Begin function
+ *
+ * @brief Starts listening and serving the connections in a thread.
+ *
+ * @details The port of the constructor is replaced by NATIVE_HTTP_PORT, as the ports under
+ *          1024 are reserved on the host. If the port can not be used, the error is printed and the server does not start,
+ *          so the rest of the firmware keeps running.
+ *
+ */
+void AsyncWebServer::begin()
+{
+    if (server != NULL) return;
+
+    const char* portValue = getenv("NATIVE_HTTP_PORT");
+    const char* address = getenv("NATIVE_HTTP_ADDRESS");
+    if (portValue == NULL) return;
+    uint16_t listenPort = atoi(portValue);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in endpoint;
+    memset(&endpoint, 0, sizeof(endpoint));
+    endpoint.sin_family = AF_INET;
+    endpoint.sin_port = htons(listenPort);
+    inet_pton(AF_INET, address ? address : "127.0.0.1", &endpoint.sin_addr);
+    if (fd < 0 || bind(fd, (sockaddr*)&endpoint, sizeof(endpoint)) < 0 || listen(fd, 8) < 0)
+    {
+        fprintf(stderr, "AsyncWebServer: can not listen on port %u: %s\n", listenPort, strerror(errno));
+        if (fd >= 0) close(fd);
+        return;
+    }
+    fprintf(stderr, "AsyncWebServer: listening on http://%s:%u/\n", address ? address : "127.0.0.1", listenPort);
+
+    server = new nativeHttpServer(this, fd);
+    server->start();
+}
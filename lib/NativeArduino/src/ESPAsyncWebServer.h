@@ -0,0 +1,245 @@
+#ifndef ESPASYNCWEBSERVER_H
+#define ESPASYNCWEBSERVER_H
+
+/* Native shim of the ESPAsyncWebServer library: an HTTP/1.1 and WebSocket server on a
+ * TCP port of the host, run by one thread as the async TCP task of the ESP32. The 
+ * handlers and the WebSocket events are called from that thread. Each response closes
+ * its connection. The server only listens when the NATIVE_HTTP_PORT environment variable
+ * sets the port, so the benchmarks do not open one, and it listens on 127.0.0.1 or on
+ * the address set in NATIVE_HTTP_ADDRESS. */
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#ifndef WS_MAX_QUEUED_MESSAGES
+#define WS_MAX_QUEUED_MESSAGES 32
+#endif
+
+typedef enum { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA } AwsEventType;
+typedef enum { WS_DISCONNECTED, WS_CONNECTED, WS_DISCONNECTING } AwsClientStatus;
+typedef enum { WS_CONTINUATION, WS_TEXT, WS_BINARY, WS_DISCONNECT = 0x08, WS_PING, WS_PONG } AwsFrameType;
+enum WebRequestMethod { HTTP_GET = 1, HTTP_POST = 2, HTTP_ANY = 0xff };
+
+typedef struct {
+    uint8_t message_opcode;
+    uint32_t num;
+    uint8_t final;
+    uint8_t masked;
+    uint8_t opcode;
+    uint64_t len;
+    uint8_t mask[4];
+    uint64_t index;
+} AwsFrameInfo;
+
+class AsyncWebSocketMessageBuffer {
+    std::vector<uint8_t> data;
+    std::atomic<int> locks;
+
+    public:
+        AsyncWebSocketMessageBuffer(size_t size) : data(size), locks(0) {}
+        AsyncWebSocketMessageBuffer(uint8_t* source, size_t size) : data(source, source + size), locks(0) {}
+
+        uint8_t* get() { return data.data(); }
+        size_t length() const { return data.size(); }
+        void lock() { locks++; }
+        void unlock() { if (locks > 0) locks--; }
+        bool canDelete() const { return locks == 0; }
+};
+
+class AsyncWebSocket;
+class nativeHttpServer;
+
+/** WebSocket client class
+ *
+ * @brief Client of a WebSocket. The messages are queued and sent by the server thread.
+ *
+ */
+class AsyncWebSocketClient {
+    friend class AsyncWebSocket;
+    friend class nativeHttpServer;
+
+    /** Queued message struct
+     *
+     * @param buffer Buffer of the message, locked while it is queued
+     * @param owned True if the buffer was made by the client and is deleted when sent
+     * @param opcode Opcode of the frame
+     *
+     */
+    struct queuedMessage {
+        AsyncWebSocketMessageBuffer* buffer;
+        bool owned;
+        uint8_t opcode;
+    };
+
+    AsyncWebSocket* server;
+    uint32_t clientId;
+    AwsClientStatus clientStatus;
+    std::deque<queuedMessage> queue;
+
+    void queueMessage(AsyncWebSocketMessageBuffer* buffer, bool owned, uint8_t opcode);
+
+    public:
+        AsyncWebSocketClient(AsyncWebSocket* pServer, uint32_t pClientId);
+        ~AsyncWebSocketClient();
+
+        uint32_t id() const { return clientId; }
+        AwsClientStatus status() const;
+        AsyncWebSocket* getServer() const { return server; }
+        bool canSend() const;
+        bool queueIsFull() const;
+        size_t queueLen() const;
+        void close(uint16_t code = 0, const char* message = NULL);
+        void ping(const uint8_t* data = NULL, size_t length = 0);
+        void text(const char* message, size_t length);
+        void text(const char* message);
+        void text(const String& message);
+        void text(AsyncWebSocketMessageBuffer* buffer);
+        void binary(const uint8_t* message, size_t length);
+        void binary(AsyncWebSocketMessageBuffer* buffer);
+};
+
+typedef std::function<void(AsyncWebSocket*, AsyncWebSocketClient*, AwsEventType, void*, uint8_t*, size_t)> AwsEventHandler;
+
+class AsyncWebHandler {
+    public:
+        virtual ~AsyncWebHandler() {}
+};
+
+class AsyncWebSocket : public AsyncWebHandler {
+    friend class AsyncWebSocketClient;
+    friend class nativeHttpServer;
+
+    String url;
+    AwsEventHandler eventHandler;
+    std::list<AsyncWebSocketClient*> clients;
+    uint32_t nextId;
+
+    public:
+        AsyncWebSocket(const String& pUrl) : url(pUrl), nextId(1) {}
+        ~AsyncWebSocket();
+
+        const char* getUrl() const { return url.c_str(); }
+        void onEvent(AwsEventHandler handler) { eventHandler = handler; }
+        AsyncWebSocketClient* client(uint32_t id);
+        size_t count() const;
+        void closeAll(uint16_t code = 0, const char* message = NULL);
+        void cleanupClients(uint16_t maxClients = 8);
+        void textAll(const char* message, size_t length);
+        void textAll(const String& message);
+        void textAll(AsyncWebSocketMessageBuffer* buffer);
+        void binaryAll(const uint8_t* message, size_t length);
+        void binaryAll(AsyncWebSocketMessageBuffer* buffer);
+        AsyncWebSocketMessageBuffer* makeBuffer(size_t size) { return new AsyncWebSocketMessageBuffer(size); }
+        AsyncWebSocketMessageBuffer* makeBuffer(uint8_t* data, size_t size) { return new AsyncWebSocketMessageBuffer(data, size); }
+};
+
+class AsyncWebHeader {
+    String headerName;
+    String headerValue;
+
+    public:
+        AsyncWebHeader(const String& name, const String& value) : headerName(name), headerValue(value) {}
+        const String& name() const { return headerName; }
+        const String& value() const { return headerValue; }
+};
+
+class AsyncWebParameter {
+    String parameterName;
+    String parameterValue;
+
+    public:
+        AsyncWebParameter(const String& name, const String& value) : parameterName(name), parameterValue(value) {}
+        const String& name() const { return parameterName; }
+        const String& value() const { return parameterValue; }
+};
+
+class AsyncWebServerResponse {
+    friend class AsyncWebServerRequest;
+
+    protected:
+        int code;
+        String contentType;
+        String headers;
+
+    public:
+        AsyncWebServerResponse(int pCode = 200, const String& pContentType = String()) : code(pCode), contentType(pContentType) {}
+        virtual ~AsyncWebServerResponse() {}
+        void addHeader(const String& name, const String& value) { headers += name + ": " + value + "\r\n"; }
+        virtual String getContent() const { return String(); }
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+    String content;
+
+    public:
+        AsyncResponseStream(const String& pContentType) : AsyncWebServerResponse(200, pContentType) {}
+        String getContent() const { return content; }
+
+        using Print::write;
+        size_t write(uint8_t value) { content += (char)value; return 1; }
+        size_t write(const uint8_t* buffer, size_t size) { content.concat((const char*)buffer, size); return size; }
+};
+
+class AsyncWebServerRequest {
+    friend class nativeHttpServer;
+
+    WebRequestMethod requestMethod;
+    String requestUrl;
+    std::vector<AsyncWebParameter> parameters;
+    std::vector<AsyncWebHeader> headers;
+    std::string response;
+
+    public:
+        AsyncWebServerRequest() : requestMethod(HTTP_GET) {}
+
+        WebRequestMethod method() const { return requestMethod; }
+        const String& url() const { return requestUrl; }
+        void send(int code, const String& contentType = String(), const String& content = String());
+        void send(SPIFFSFS& fs, const String& path, const String& contentType = String());
+        void send(AsyncWebServerResponse* response);
+        AsyncResponseStream* beginResponseStream(const String& contentType) { return new AsyncResponseStream(contentType); }
+        bool hasParam(const String& name) const;
+        AsyncWebParameter* getParam(const String& name);
+        bool hasHeader(const String& name) const;
+        AsyncWebHeader* getHeader(const String& name);
+};
+
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+
+class AsyncWebServer {
+    friend class nativeHttpServer;
+
+    /** Route struct
+     *
+     * @param uri Path of the route
+     * @param method Methods of the route
+     * @param handler Handler of the requests
+     *
+     */
+    struct route {
+        String uri;
+        WebRequestMethod method;
+        ArRequestHandlerFunction handler;
+    };
+
+    uint16_t port;
+    std::vector<route> routes;
+    std::vector<AsyncWebSocket*> sockets;
+    nativeHttpServer* server;
+
+    public:
+        AsyncWebServer(uint16_t pPort) : port(pPort), server(NULL) {}
+
+        void begin();
+        void end() {}
+        AsyncWebHandler& addHandler(AsyncWebHandler* handler);
+        void on(const char* uri, WebRequestMethod method, ArRequestHandlerFunction handler);
+};
+
+#endif /* ESPASYNCWEBSERVER_H */
@@ -0,0 +1,123 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+/** Event group struct
+ *
+ * @param bits Bits set
+ * @param mutex Mutex of the bits
+ * @param changed Condition signaled when bits are set
+ *
+ */
+struct eventGroup {
+    EventBits_t bits = 0;
+    mutex bitsMutex;
+    condition_variable changed;
+};
+
+void vPortEnterCritical(portMUX_TYPE* mux)
+{
+    while (__atomic_exchange_n(&mux->locked, 1, __ATOMIC_ACQUIRE))
+    {
+        this_thread::yield();
+    }
+}
+
+void vPortExitCritical(portMUX_TYPE* mux)
+{
+    __atomic_store_n(&mux->locked, 0, __ATOMIC_RELEASE);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth, 
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core)
+{
+    (void)name; (void)stackDepth; (void)priority; (void)core;
+    thread task(function, parameter);
+    if (handle) *handle = NULL;
+    task.detach();
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    this_thread::sleep_for(chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount()
+{
+    static const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+}
+
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t period)
+{
+    *previousWakeTime += period;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previousWakeTime - now) > 0) vTaskDelay(*previousWakeTime - now);
+}
+
+EventGroupHandle_t xEventGroupCreate()
+{
+    return new eventGroup();
+}
+
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+    delete (eventGroup*)group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    eventGroup* events = (eventGroup*)group;
+    lock_guard<mutex> lock(events->bitsMutex);
+    events->bits |= bits;
+    events->changed.notify_all();
+    return events->bits;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t group, EventBits_t bits, BaseType_t* higherPriorityTaskWoken)
+{
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdFALSE;
+    xEventGroupSetBits(group, bits);
+    return pdPASS;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    eventGroup* events = (eventGroup*)group;
+    lock_guard<mutex> lock(events->bitsMutex);
+    EventBits_t previous = events->bits;
+    events->bits &= ~bits;
+    return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    eventGroup* events = (eventGroup*)group;
+    lock_guard<mutex> lock(events->bitsMutex);
+    return events->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit, 
+                                BaseType_t waitForAll, TickType_t ticks)
+{
+    eventGroup* events = (eventGroup*)group;
+    unique_lock<mutex> lock(events->bitsMutex);
+    auto ready = [&]() {
+        EventBits_t set = events->bits & bits;
+        return waitForAll ? set == bits : set != 0;
+    };
+    if (ticks == portMAX_DELAY) events->changed.wait(lock, ready);
+    else events->changed.wait_for(lock, chrono::milliseconds(ticks), ready);
+
+    EventBits_t result = events->bits;
+    if (ready() && clearOnExit) events->bits &= ~bits;
+    return result;
+}
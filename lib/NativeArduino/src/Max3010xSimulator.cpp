@@ -0,0 +1,282 @@
+#include "Max3010xSimulator.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace std;
+
+// Registers of the MAX30102
+#define REGISTER_INT_STATUS_1 0x00
+#define REGISTER_INT_STATUS_2 0x01
+#define REGISTER_INT_ENABLE_1 0x02
+#define REGISTER_FIFO_WRITE_POINTER 0x04
+#define REGISTER_FIFO_OVERFLOW 0x05
+#define REGISTER_FIFO_READ_POINTER 0x06
+#define REGISTER_FIFO_DATA 0x07
+#define REGISTER_FIFO_CONFIG 0x08
+#define REGISTER_MODE_CONFIG 0x09
+#define REGISTER_SPO2_CONFIG 0x0A
+#define REGISTER_SLOTS_1 0x11
+#define REGISTER_SLOTS_2 0x12
+#define REGISTER_TEMPERATURE_INTEGER 0x1F
+#define REGISTER_TEMPERATURE_CONFIG 0x21
+#define REGISTER_REVISION_ID 0xFE
+#define REGISTER_PART_ID 0xFF
+
+// Bits of the interrupt registers
+#define INTERRUPT_ALMOST_FULL 0x80
+#define INTERRUPT_NEW_SAMPLE 0x40
+#define INTERRUPT_POWER_READY 0x01
+#define INTERRUPT_TEMPERATURE_READY 0x02
+
+const uint8_t FIFO_DEPTH = 32;
+const uint32_t SAMPLE_RATES[8] = { 50, 100, 200, 400, 800, 1000, 1600, 3200 };
+const uint32_t SAMPLE_AVERAGES[8] = { 1, 2, 4, 8, 16, 32, 32, 32 };
+
+static uint64_t nowMicros()
+{
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+syntheticPpg::syntheticPpg(float pHeartRate, float pSpo2, float pNoiseLevel, uint32_t seed) :
+    heartRate(pHeartRate), spo2(pSpo2), noiseLevel(pNoiseLevel), sample(0), phase(0), noise(seed ? seed : 1)
+{
+}
+
+float syntheticPpg::nextNoise()
+{
+    // sum of two uniform values, so the noise is triangular between -1 and 1
+    noise = noise * 1664525 + 1013904223;
+    float first = float(noise >> 8) / (1 << 24);
+    noise = noise * 1664525 + 1013904223;
+    float second = float(noise >> 8) / (1 << 24);
+    return first + second - 1;
+}
+
+bool syntheticPpg::nextSample(uint32_t sampleRate, uint32_t& ir, uint32_t& red)
+{
+    const float dcIR = 110000, acIR = 1400, dcRed = 90000;
+    double time = double(sample++) / sampleRate;
+
+    // slow variability of the heart rate and breathing at 15 breaths per minute
+    double breathing = sin(2 * M_PI * 0.25 * time);
+    phase += heartRate / 60.0 * (1 + 0.03 * breathing) / sampleRate;
+    double beat = phase - floor(phase);
+
+    // systolic peak and dicrotic wave, the light absorbed grows with the blood volume
+    double systolic = exp(-pow((beat - 0.15) / 0.07, 2));
+    double dicrotic = 0.35 * exp(-pow((beat - 0.45) / 0.09, 2));
+    double pulse = systolic + dicrotic;
+
+    float ratio = (110 - spo2) / 25;
+    float acRed = ratio * acIR / dcIR * dcRed;
+    ir = uint32_t(dcIR - acIR * pulse + 300 * breathing + noiseLevel * nextNoise());
+    red = uint32_t(dcRed - acRed * pulse + 250 * breathing + noiseLevel * nextNoise());
+    return true;
+}
+
+max3010xSimulator::max3010xSimulator(simulatedSignal& pSignal, uint8_t pInterruptPin) : 
+    signal(pSignal), interruptPin(pInterruptPin), interruptLevel(HIGH)
+{
+    reset();
+    registers[REGISTER_INT_STATUS_1] = INTERRUPT_POWER_READY;
+}
+
+void max3010xSimulator::reset()
+{
+    for (uint16_t i = 0; i < 256; i++) registers[i] = 0;
+    registers[REGISTER_PART_ID] = 0x15;
+    registers[REGISTER_REVISION_ID] = 0x03;
+    registers[REGISTER_TEMPERATURE_INTEGER] = 30;
+    storedSamples = 0;
+    registerPointer = 0;
+    byteInSample = 0;
+    configTime = nowMicros();
+    madeSamples = 0;
+}
+
+void max3010xSimulator::begin(TwoWire& wire, uint8_t address)
+{
+    wire.attachDevice(address, this);
+    thread([this]() {
+        for (;;)
+        {
+            {
+                lock_guard<mutex> lock(deviceMutex);
+                update();
+            }
+            updateInterruptPin();
+            this_thread::sleep_for(chrono::milliseconds(2));
+        }
+    }).detach();
+}
+
+uint32_t max3010xSimulator::getSampleRate()
+{
+    uint8_t mode = registers[REGISTER_MODE_CONFIG];
+    if ((mode & 0x80) || getActiveSlots() == 0) return 0;
+    return SAMPLE_RATES[(registers[REGISTER_SPO2_CONFIG] >> 2) & 0x07];
+}
+
+uint8_t max3010xSimulator::getActiveSlots()
+{
+    uint8_t mode = registers[REGISTER_MODE_CONFIG] & 0x07;
+    if (mode == 2) return 1;
+    if (mode == 3) return 2;
+    if (mode != 7) return 0;
+    uint8_t slots = 0;
+    if (registers[REGISTER_SLOTS_1] & 0x07) slots++;
+    if (registers[REGISTER_SLOTS_1] & 0x70) slots++;
+    if (registers[REGISTER_SLOTS_2] & 0x07) slots++;
+    if (registers[REGISTER_SLOTS_2] & 0x70) slots++;
+    return slots;
+}
+
+// Makes the samples due since the configuration, at the sample rate divided by the average
+void max3010xSimulator::update()
+{
+    uint32_t sampleRate = getSampleRate();
+    if (sampleRate == 0) return;
+    uint32_t average = SAMPLE_AVERAGES[registers[REGISTER_FIFO_CONFIG] >> 5];
+    uint64_t dueSamples = (nowMicros() - configTime) * sampleRate / average / 1000000;
+    while (madeSamples < dueSamples)
+    {
+        uint32_t ir, red;
+        madeSamples++;
+        if (!signal.nextSample(sampleRate / average, ir, red)) return;
+        pushSample(ir & 0x3FFFF, red & 0x3FFFF);
+    }
+}
+
+void max3010xSimulator::pushSample(uint32_t ir, uint32_t red)
+{
+    uint8_t& writePointer = registers[REGISTER_FIFO_WRITE_POINTER];
+    uint8_t& readPointer = registers[REGISTER_FIFO_READ_POINTER];
+    uint8_t& overflow = registers[REGISTER_FIFO_OVERFLOW];
+    if (storedSamples == FIFO_DEPTH)
+    {
+        if (overflow < 0x1F) overflow++;
+        // without rollover the new sample is lost
+        if (!(registers[REGISTER_FIFO_CONFIG] & 0x10)) return;
+        readPointer = (readPointer + 1) % FIFO_DEPTH;
+        storedSamples--;
+        byteInSample = 0;
+    }
+    fifoIR[writePointer] = ir;
+    fifoRed[writePointer] = red;
+    writePointer = (writePointer + 1) % FIFO_DEPTH;
+    storedSamples++;
+
+    registers[REGISTER_INT_STATUS_1] |= INTERRUPT_NEW_SAMPLE;
+    uint8_t almostFull = FIFO_DEPTH - (registers[REGISTER_FIFO_CONFIG] & 0x0F);
+    if (storedSamples == almostFull) registers[REGISTER_INT_STATUS_1] |= INTERRUPT_ALMOST_FULL;
+}
+
+void max3010xSimulator::updateInterruptPin()
+{
+    uint8_t level;
+    {
+        lock_guard<mutex> lock(deviceMutex);
+        uint8_t status = registers[REGISTER_INT_STATUS_1];
+        bool asserted = (status & registers[REGISTER_INT_ENABLE_1] & 0xE0) || (status & INTERRUPT_POWER_READY);
+        level = asserted ? LOW : HIGH;
+        if (level == interruptLevel) return;
+        interruptLevel = level;
+    }
+    setPinLevel(interruptPin, level);
+}
+
+uint8_t max3010xSimulator::readRegister()
+{
+    if (registerPointer != REGISTER_FIFO_DATA)
+    {
+        uint8_t value = registers[registerPointer];
+        if (registerPointer == REGISTER_INT_STATUS_1 || registerPointer == REGISTER_INT_STATUS_2)
+        {
+            registers[registerPointer] = 0;
+        }
+        if (registerPointer < 0xFF) registerPointer++;
+        return value;
+    }
+
+    // the FIFO data register does not increment the pointer nor clear the interrupts
+    if (storedSamples == 0) return 0;
+    uint8_t& readPointer = registers[REGISTER_FIFO_READ_POINTER];
+    uint8_t slot = byteInSample / 3;
+    uint32_t value = fifoRed[readPointer];
+    uint8_t mode = registers[REGISTER_MODE_CONFIG] & 0x07;
+    if (mode == 3 && slot == 1) value = fifoIR[readPointer];
+    if (mode == 7)
+    {
+        uint8_t slotsConfig[4] = { uint8_t(registers[REGISTER_SLOTS_1] & 0x07), uint8_t(registers[REGISTER_SLOTS_1] >> 4), 
+                                   uint8_t(registers[REGISTER_SLOTS_2] & 0x07), uint8_t(registers[REGISTER_SLOTS_2] >> 4) };
+        if ((slotsConfig[slot & 3] & 0x03) != 1) value = fifoIR[readPointer];
+    }
+    uint8_t part = uint8_t(value >> (8 * (2 - byteInSample % 3)));
+
+    byteInSample++;
+    if (byteInSample == 3 * getActiveSlots())
+    {
+        byteInSample = 0;
+        readPointer = (readPointer + 1) % FIFO_DEPTH;
+        storedSamples--;
+        // the overflow counter is cleared when a complete sample is popped
+        registers[REGISTER_FIFO_OVERFLOW] = 0;
+    }
+    return part;
+}
+
+void max3010xSimulator::writeRegister(uint8_t value)
+{
+    uint8_t address = registerPointer;
+    if (address < 0xFF) registerPointer++;
+    if (address == REGISTER_INT_STATUS_1 || address == REGISTER_FIFO_DATA || address >= REGISTER_REVISION_ID) return;
+
+    if (address == REGISTER_MODE_CONFIG && (value & 0x40))
+    {
+        // the reset bit clears itself
+        reset();
+        return;
+    }
+    registers[address] = value;
+
+    if (address == REGISTER_FIFO_WRITE_POINTER || address == REGISTER_FIFO_READ_POINTER)
+    {
+        registers[address] &= FIFO_DEPTH - 1;
+        storedSamples = (registers[REGISTER_FIFO_WRITE_POINTER] - registers[REGISTER_FIFO_READ_POINTER]) & (FIFO_DEPTH - 1);
+        byteInSample = 0;
+    }
+    if (address == REGISTER_FIFO_CONFIG || address == REGISTER_MODE_CONFIG || address == REGISTER_SPO2_CONFIG)
+    {
+        configTime = nowMicros();
+        madeSamples = 0;
+    }
+    if (address == REGISTER_TEMPERATURE_CONFIG && (value & 0x01))
+    {
+        registers[REGISTER_TEMPERATURE_CONFIG] = 0;
+        registers[REGISTER_INT_STATUS_2] |= INTERRUPT_TEMPERATURE_READY;
+    }
+}
+
+void max3010xSimulator::write(const uint8_t* data, size_t length)
+{
+    {
+        lock_guard<mutex> lock(deviceMutex);
+        update();
+        if (length == 0) return;
+        registerPointer = data[0];
+        for (size_t i = 1; i < length; i++) writeRegister(data[i]);
+    }
+    updateInterruptPin();
+}
+
+size_t max3010xSimulator::read(uint8_t* data, size_t length)
+{
+    {
+        lock_guard<mutex> lock(deviceMutex);
+        update();
+        for (size_t i = 0; i < length; i++) data[i] = readRegister();
+    }
+    updateInterruptPin();
+    return length;
+}
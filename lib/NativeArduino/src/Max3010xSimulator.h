@@ -0,0 +1,117 @@
+#ifndef MAX3010XSIMULATOR_H
+#define MAX3010XSIMULATOR_H
+
+/* Native only: MAX30102 simulated at register level on the I2C bus, so the firmware and
+ * the SparkFun library run unchanged. The samples come from a simulated signal. */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <atomic>
+#include <mutex>
+
+/** Simulated signal class
+ *
+ * @brief Source of the samples of the simulated sensor.
+ *
+ */
+class simulatedSignal {
+    public:
+        virtual ~simulatedSignal() {}
+
+        // Gives the next IR and red samples, false if the signal has finished
+        virtual bool nextSample(uint32_t sampleRate, uint32_t& ir, uint32_t& red) = 0;
+};
+
+/** Synthetic PPG class
+ *
+ * @brief Finger PPG with a pulse wave, its dicrotic notch, a slow variability of the
+ *        heart rate, the breathing baseline and noise. The red to IR ratio follows the
+ *        SpO2 (R = (110 - SpO2) / 25). The noise is deterministic.
+ *
+ * @param heartRate Heart rate in bpm
+ * @param spo2 SpO2 in %
+ * @param noiseLevel Amplitude of the noise in ADC counts
+ * @param sample Number of samples generated
+ * @param phase Phase of the heart beat in beats
+ * @param noise State of the noise generator
+ *
+ */
+class syntheticPpg : public simulatedSignal {
+    std::atomic<float> heartRate;
+    std::atomic<float> spo2;
+    std::atomic<float> noiseLevel;
+    uint32_t sample;
+    double phase;
+    uint32_t noise;
+
+    float nextNoise();
+
+    public:
+        syntheticPpg(float pHeartRate = 72, float pSpo2 = 97, float pNoiseLevel = 20, uint32_t seed = 1);
+
+        void setHeartRate(float value) { heartRate = value; }
+        void setSpo2(float value) { spo2 = value; }
+        void setNoiseLevel(float value) { noiseLevel = value; }
+
+        bool nextSample(uint32_t sampleRate, uint32_t& ir, uint32_t& red);
+};
+
+/** MAX3010x simulator class
+ *
+ * @brief MAX30102 with its registers, its 32 samples FIFO and its INT pin.
+ *
+ * @details The samples are made at the rate set in the registers (sample rate divided
+ *          by the sample average) since the sensor was configured. The FIFO has the
+ *          write and read pointers, the overflow counter and the rollover of the real
+ *          one, and the almost full and new sample interrupts pull the INT pin low until
+ *          Interrupt Status 1 is read, as reading the FIFO does not clear them. A thread
+ *          keeps the samples flowing when the firmware does not access the sensor.
+ *
+ * @param signal Source of the samples
+ * @param interruptPin Pin connected to the INT pin
+ * @param registers Registers of the sensor
+ * @param fifoIR IR samples of the FIFO
+ * @param fifoRed Red samples of the FIFO
+ * @param storedSamples Number of samples in the FIFO
+ * @param registerPointer Register of the next access
+ * @param byteInSample Next byte of the sample being read from the FIFO
+ * @param configTime Time when the sample rate was set in us
+ * @param madeSamples Samples made since configTime
+ * @param interruptLevel Level of the INT pin
+ * @param deviceMutex Mutex of the state of the sensor
+ *
+ */
+class max3010xSimulator : public i2cDevice {
+    simulatedSignal& signal;
+    uint8_t interruptPin;
+    uint8_t registers[256];
+    uint32_t fifoIR[32];
+    uint32_t fifoRed[32];
+    uint8_t storedSamples;
+    uint8_t registerPointer;
+    uint8_t byteInSample;
+    uint64_t configTime;
+    uint64_t madeSamples;
+    uint8_t interruptLevel;
+    std::mutex deviceMutex;
+
+    void reset();
+    uint32_t getSampleRate();
+    uint8_t getActiveSlots();
+    void update();
+    void pushSample(uint32_t ir, uint32_t red);
+    uint8_t readRegister();
+    void writeRegister(uint8_t value);
+    void updateInterruptPin();
+
+    public:
+        max3010xSimulator(simulatedSignal& pSignal, uint8_t pInterruptPin);
+
+        // Attaches the sensor to the bus at address and starts the thread of the samples
+        void begin(TwoWire& wire = Wire, uint8_t address = 0x57);
+
+        void write(const uint8_t* data, size_t length);
+        size_t read(uint8_t* data, size_t length);
+};
+
+#endif /* MAX3010XSIMULATOR_H */
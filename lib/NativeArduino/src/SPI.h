@@ -0,0 +1,8 @@
+#ifndef SPI_H
+#define SPI_H
+
+/* Native shim of the SPI bus: the display driver of the shim does not use it. */
+
+#include <Arduino.h>
+
+#endif /* SPI_H */
@@ -0,0 +1,84 @@
+#include "SPIFFS.h"
+
+using namespace std;
+
+SPIFFSFS SPIFFS;
+
+File::File(FILE* file)
+{
+    if (file) handle = shared_ptr<FILE>(file, fclose);
+}
+
+size_t File::size()
+{
+    if (!handle) return 0;
+    long current = ftell(handle.get());
+    fseek(handle.get(), 0, SEEK_END);
+    long end = ftell(handle.get());
+    fseek(handle.get(), current, SEEK_SET);
+    return end < 0 ? 0 : end;
+}
+
+size_t File::position()
+{
+    return handle ? ftell(handle.get()) : 0;
+}
+
+bool File::seek(uint32_t position)
+{
+    return handle && fseek(handle.get(), position, SEEK_SET) == 0;
+}
+
+int File::available()
+{
+    return handle ? size() - position() : 0;
+}
+
+int File::read()
+{
+    return handle ? fgetc(handle.get()) : -1;
+}
+
+size_t File::read(uint8_t* buffer, size_t size)
+{
+    return handle ? fread(buffer, 1, size, handle.get()) : 0;
+}
+
+void File::flush()
+{
+    if (handle) fflush(handle.get());
+}
+
+void File::close()
+{
+    handle.reset();
+}
+
+size_t File::write(uint8_t value)
+{
+    return write(&value, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size)
+{
+    return handle ? fwrite(buffer, 1, size, handle.get()) : 0;
+}
+
+String SPIFFSFS::getHostPath(const String& path)
+{
+    const char* root = getenv("SPIFFS_ROOT");
+    return String(root ? root : "data") + path;
+}
+
+File SPIFFSFS::open(const String& path, const char* mode)
+{
+    string hostMode = string(mode) + "b";
+    return File(fopen(getHostPath(path).c_str(), hostMode.c_str()));
+}
+
+bool SPIFFSFS::exists(const String& path)
+{
+    FILE* file = fopen(getHostPath(path).c_str(), "rb");
+    if (file) fclose(file);
+    return file != NULL;
+}
@@ -0,0 +1,61 @@
+#ifndef SPIFFS_H
+#define SPIFFS_H
+
+/* Native shim of the SPIFFS file system: the files are read from a host directory,
+ * "data" by default or the one set in the SPIFFS_ROOT environment variable. */
+
+#include <Arduino.h>
+#include <memory>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+/** File class
+ *
+ * @brief File of the host file system.
+ *
+ * @param handle Shared handle of the file, closed when the last copy is destroyed
+ *
+ */
+class File : public Print {
+    std::shared_ptr<FILE> handle;
+
+    public:
+        File() {}
+        File(FILE* file);
+
+        operator bool() const { return handle != NULL; }
+        size_t size();
+        size_t position();
+        bool seek(uint32_t position);
+        int available();
+        int read();
+        size_t read(uint8_t* buffer, size_t size);
+        void flush();
+        void close();
+
+        using Print::write;
+        size_t write(uint8_t value);
+        size_t write(const uint8_t* buffer, size_t size);
+};
+
+/** SPIFFS file system class
+ *
+ * @brief File system mapped to a host directory.
+ *
+ */
+class SPIFFSFS {
+    public:
+        bool begin(bool formatOnFail = false) { (void)formatOnFail; return true; }
+        void end() {}
+        File open(const String& path, const char* mode = FILE_READ);
+        bool exists(const String& path);
+        String getHostPath(const String& path);
+};
+
+extern SPIFFSFS SPIFFS;
+
+namespace fs { typedef ::SPIFFSFS FS; }
+
+#endif /* SPIFFS_H */
@@ -0,0 +1,202 @@
+#include "U8g2lib.h"
+
+#include <atomic>
+
+using namespace std;
+
+const u8g2_cb_t u8g2_cb_r0 = { 0 };
+const u8g2_cb_t u8g2_cb_r2 = { 2 };
+
+const uint8_t u8g2_font_luBS10_tf[] = { 0 };
+const uint8_t u8g2_font_6x10_tf[] = { 0 };
+const uint8_t u8g2_font_tinyunicode_tf[] = { 0 };
+
+// 5x7 font of the printable ASCII characters, one byte per column with the top row in
+// the lowest bit and the descenders in the highest bit
+static const uint8_t FONT_5X7[95][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x56,0x20,0x50}, {0x00,0x08,0x07,0x03,0x00},
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x2A,0x1C,0x7F,0x1C,0x2A}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x80,0x70,0x30,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x00,0x60,0x60,0x00}, {0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x72,0x49,0x49,0x49,0x46}, {0x21,0x41,0x49,0x4D,0x33},
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x31}, {0x41,0x21,0x11,0x09,0x07},
+    {0x36,0x49,0x49,0x49,0x36}, {0x46,0x49,0x49,0x29,0x1E}, {0x00,0x00,0x14,0x00,0x00}, {0x00,0x40,0x34,0x00,0x00},
+    {0x00,0x08,0x14,0x22,0x41}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x59,0x09,0x06},
+    {0x3E,0x41,0x5D,0x59,0x4E}, {0x7C,0x12,0x11,0x12,0x7C}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x41,0x3E}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x41,0x51,0x73},
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x1C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x26,0x49,0x49,0x49,0x32},
+    {0x03,0x01,0x7F,0x01,0x03}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+    {0x63,0x14,0x08,0x14,0x63}, {0x03,0x04,0x78,0x04,0x03}, {0x61,0x59,0x49,0x4D,0x43}, {0x00,0x7F,0x41,0x41,0x41},
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x41,0x7F}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x03,0x07,0x08,0x00}, {0x20,0x54,0x54,0x78,0x40}, {0x7F,0x28,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x28},
+    {0x38,0x44,0x44,0x28,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x00,0x08,0x7E,0x09,0x02}, {0x18,0xA4,0xA4,0x9C,0x78},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x40,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x78,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+    {0xFC,0x18,0x24,0x24,0x18}, {0x18,0x24,0x24,0x18,0xFC}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x24},
+    {0x04,0x04,0x3F,0x44,0x24}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44}, {0x4C,0x90,0x90,0x90,0x7C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x77,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x02,0x01,0x02,0x04,0x02}
+};
+
+static atomic<U8G2*> lastDisplay(NULL);
+
+U8G2::U8G2() : currentPage(0), cursorX(0), cursorY(0), frames(0)
+{
+    memset(pageBuffer, 0, sizeof(pageBuffer));
+    memset(displayMemory, 0, sizeof(displayMemory));
+    lastDisplay = this;
+}
+
+U8G2::~U8G2()
+{
+    U8G2* self = this;
+    lastDisplay.compare_exchange_strong(self, NULL);
+}
+
+U8G2* U8G2::getDisplay()
+{
+    return lastDisplay;
+}
+
+// Only the pixels of the current page are drawn, as the real page buffer
+void U8G2::drawPixel(int x, int y)
+{
+    int row = y - currentPage * U8G2_PAGE_HEIGHT;
+    if (x < 0 || x >= U8G2_DISPLAY_WIDTH || row < 0 || row >= U8G2_PAGE_HEIGHT) return;
+    pageBuffer[x] |= 1 << row;
+}
+
+void U8G2::drawLine(int x0, int y0, int x1, int y1)
+{
+    int dx = abs(x1 - x0), dy = -abs(y1 - y0);
+    int stepX = x0 < x1 ? 1 : -1, stepY = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+    for (;;)
+    {
+        drawPixel(x0, y0);
+        if (x0 == x1 && y0 == y1) return;
+        int doubled = 2 * error;
+        if (doubled >= dy) { error += dy; x0 += stepX; }
+        if (doubled <= dx) { error += dx; y0 += stepY; }
+    }
+}
+
+void U8G2::drawHLine(int x, int y, int width)
+{
+    for (int i = 0; i < width; i++) drawPixel(x + i, y);
+}
+
+void U8G2::drawVLine(int x, int y, int height)
+{
+    for (int i = 0; i < height; i++) drawPixel(x, y + i);
+}
+
+void U8G2::drawBox(int x, int y, int width, int height)
+{
+    for (int i = 0; i < height; i++) drawHLine(x, y + i, width);
+}
+
+void U8G2::drawFrame(int x, int y, int width, int height)
+{
+    drawHLine(x, y, width);
+    drawHLine(x, y + height - 1, width);
+    drawVLine(x, y, height);
+    drawVLine(x + width - 1, y, height);
+}
+
+// The cursor is on the baseline, and the characters advance 6 pixels. Each UTF-8 
+// character out of ASCII is drawn as '?'.
+size_t U8G2::write(uint8_t value)
+{
+    if (value >= 0x80 && value < 0xC0) return 1;
+    if (value < 0x20 || value >= 0x7F) value = '?';
+    const uint8_t* glyph = FONT_5X7[value - 0x20];
+    for (int column = 0; column < 5; column++)
+    {
+        for (int row = 0; row < 8; row++)
+        {
+            if (glyph[column] & (1 << row)) drawPixel(cursorX + column, cursorY - 7 + row);
+        }
+    }
+    cursorX += 6;
+    return 1;
+}
+
+void U8G2::sendPage()
+{
+    lock_guard<mutex> lock(memoryMutex);
+    memcpy(displayMemory[currentPage], pageBuffer, U8G2_DISPLAY_WIDTH);
+}
+
+void U8G2::firstPage()
+{
+    currentPage = 0;
+    memset(pageBuffer, 0, sizeof(pageBuffer));
+}
+
+// Sends the current page and goes to the next one, 0 when all the pages have been sent
+uint8_t U8G2::nextPage()
+{
+    sendPage();
+    memset(pageBuffer, 0, sizeof(pageBuffer));
+    if (currentPage + 1 >= U8G2_PAGES)
+    {
+        currentPage = 0;
+        lock_guard<mutex> lock(memoryMutex);
+        frames++;
+        return 0;
+    }
+    currentPage++;
+    return 1;
+}
+
+void U8G2::clearBuffer()
+{
+    firstPage();
+}
+
+// The page mode driver only has the page buffer, so this only sends the current page
+void U8G2::sendBuffer()
+{
+    sendPage();
+}
+
+bool U8G2::getPixel(int x, int y) const
+{
+    if (x < 0 || x >= U8G2_DISPLAY_WIDTH || y < 0 || y >= U8G2_DISPLAY_HEIGHT) return false;
+    lock_guard<mutex> lock(memoryMutex);
+    return displayMemory[y / U8G2_PAGE_HEIGHT][x] & (1 << (y % U8G2_PAGE_HEIGHT));
+}
+
+uint32_t U8G2::getFrames() const
+{
+    lock_guard<mutex> lock(memoryMutex);
+    return frames;
+}
+
+bool U8G2::savePBM(const char* fileName) const
+{
+    uint8_t image[U8G2_DISPLAY_HEIGHT][U8G2_DISPLAY_WIDTH / 8];
+    memset(image, 0, sizeof(image));
+    {
+        lock_guard<mutex> lock(memoryMutex);
+        for (int y = 0; y < U8G2_DISPLAY_HEIGHT; y++)
+        {
+            for (int x = 0; x < U8G2_DISPLAY_WIDTH; x++)
+            {
+                if (displayMemory[y / U8G2_PAGE_HEIGHT][x] & (1 << (y % U8G2_PAGE_HEIGHT))) image[y][x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+    }
+
+    // written to a temporary file and renamed, so a viewer never reads half an image
+    string temporary = string(fileName) + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (file == NULL) return false;
+    fprintf(file, "P4\n%d %d\n", U8G2_DISPLAY_WIDTH, U8G2_DISPLAY_HEIGHT);
+    bool written = fwrite(image, 1, sizeof(image), file) == sizeof(image);
+    written = fclose(file) == 0 && written;
+    return written && rename(temporary.c_str(), fileName) == 0;
+}
@@ -0,0 +1,86 @@
+#ifndef U8G2LIB_H
+#define U8G2LIB_H
+
+/* Native shim of the U8g2 library for a 128x64 display in page mode. The drawing goes
+ * to the 8 rows page buffer, and nextPage() copies it to the memory of the display, as 
+ * the real driver sends it to the ST7565. The text is drawn with a 5x7 font whatever
+ * font is set. The memory of the display can be saved as a PBM image. */
+
+#include <Arduino.h>
+#include <mutex>
+
+typedef struct u8g2_cb_struct { uint8_t rotation; } u8g2_cb_t;
+
+extern const u8g2_cb_t u8g2_cb_r0;
+extern const u8g2_cb_t u8g2_cb_r2;
+#define U8G2_R0 (&u8g2_cb_r0)
+#define U8G2_R2 (&u8g2_cb_r2)
+
+extern const uint8_t u8g2_font_luBS10_tf[];
+extern const uint8_t u8g2_font_6x10_tf[];
+extern const uint8_t u8g2_font_tinyunicode_tf[];
+
+const uint8_t U8G2_DISPLAY_WIDTH = 128;
+const uint8_t U8G2_DISPLAY_HEIGHT = 64;
+const uint8_t U8G2_PAGE_HEIGHT = 8;
+const uint8_t U8G2_PAGES = U8G2_DISPLAY_HEIGHT / U8G2_PAGE_HEIGHT;
+
+class U8G2 : public Print {
+    uint8_t pageBuffer[U8G2_DISPLAY_WIDTH];
+    uint8_t displayMemory[U8G2_PAGES][U8G2_DISPLAY_WIDTH];
+    uint8_t currentPage;
+    int cursorX;
+    int cursorY;
+    uint32_t frames;
+    mutable std::mutex memoryMutex;
+
+    void sendPage();
+
+    public:
+        U8G2();
+        virtual ~U8G2();
+
+        bool begin() { return true; }
+        void setContrast(uint8_t value) { (void)value; }
+        void enableUTF8Print() {}
+        void setFont(const uint8_t* font) { (void)font; }
+        uint8_t getDisplayHeight() { return U8G2_DISPLAY_HEIGHT; }
+        uint8_t getDisplayWidth() { return U8G2_DISPLAY_WIDTH; }
+
+        void drawPixel(int x, int y);
+        void drawLine(int x0, int y0, int x1, int y1);
+        void drawHLine(int x, int y, int width);
+        void drawVLine(int x, int y, int height);
+        void drawBox(int x, int y, int width, int height);
+        void drawFrame(int x, int y, int width, int height);
+        void setCursor(int x, int y) { cursorX = x; cursorY = y; }
+
+        void firstPage();
+        uint8_t nextPage();
+        void clearBuffer();
+        void sendBuffer();
+
+        using Print::write;
+        size_t write(uint8_t value);
+
+        // Native only: state of a pixel of the display memory and number of frames sent
+        bool getPixel(int x, int y) const;
+        uint32_t getFrames() const;
+
+        // Native only: saves the display memory as a PBM image
+        bool savePBM(const char* fileName) const;
+
+        // Native only: display created last, NULL if there is none
+        static U8G2* getDisplay();
+};
+
+class U8G2_ST7565_ERC12864_1_4W_SW_SPI : public U8G2 {
+    public:
+        U8G2_ST7565_ERC12864_1_4W_SW_SPI ( const u8g2_cb_t* rotation, uint8_t clock, uint8_t data, 
+                                           uint8_t cs, uint8_t dc, uint8_t reset = 255 )
+        {
+            (void)rotation; (void)clock; (void)data; (void)cs; (void)dc; (void)reset;
+        }
+};
+
+#endif /* U8G2LIB_H */
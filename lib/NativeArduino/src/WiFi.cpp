@@ -0,0 +1,18 @@
+#include "WiFi.h"
+
+WiFiClass WiFi;
+
+IPAddress::IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth)
+{
+    bytes[0] = first;
+    bytes[1] = second;
+    bytes[2] = third;
+    bytes[3] = fourth;
+}
+
+String IPAddress::toString() const
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return String(text);
+}
@@ -0,0 +1,29 @@
+#ifndef WIFI_H
+#define WIFI_H
+
+/* Native shim of the WiFi: the host is always connected, at the loopback address. */
+
+#include <Arduino.h>
+
+#define WL_CONNECTED 3
+
+class IPAddress : public Printable {
+    uint8_t bytes[4];
+
+    public:
+        IPAddress(uint8_t first = 0, uint8_t second = 0, uint8_t third = 0, uint8_t fourth = 0);
+        String toString() const;
+        uint8_t operator[](int index) const { return bytes[index]; }
+        size_t printTo(Print& printer) const { return printer.print(toString()); }
+};
+
+class WiFiClass {
+    public:
+        int begin(const char* ssid, const char* password) { (void)ssid; (void)password; return WL_CONNECTED; }
+        int status() { return WL_CONNECTED; }
+        IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+};
+
+extern WiFiClass WiFi;
+
+#endif /* WIFI_H */
@@ -0,0 +1,64 @@
+#include "Wire.h"
+
+using namespace std;
+
+TwoWire Wire;
+
+TwoWire::TwoWire() : transmitAddress(0), transmitLength(0), receiveLength(0), receivePosition(0)
+{
+    for (uint8_t i = 0; i < 128; i++) devices[i] = NULL;
+}
+
+void TwoWire::attachDevice(uint8_t address, i2cDevice* device)
+{
+    lock_guard<mutex> lock(busMutex);
+    devices[address & 0x7F] = device;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    transmitAddress = address & 0x7F;
+    transmitLength = 0;
+}
+
+size_t TwoWire::write(uint8_t value)
+{
+    if (transmitLength >= BUFFER_LENGTH) return 0;
+    transmitBuffer[transmitLength++] = value;
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool stop)
+{
+    (void)stop;
+    lock_guard<mutex> lock(busMutex);
+    i2cDevice* device = devices[transmitAddress];
+    if (device != NULL) device->write(transmitBuffer, transmitLength);
+    return device != NULL ? 0 : 2;
+}
+
+uint8_t TwoWire::requestFrom(int address, int quantity, int stop)
+{
+    (void)stop;
+    lock_guard<mutex> lock(busMutex);
+    i2cDevice* device = devices[address & 0x7F];
+    size_t length = quantity < BUFFER_LENGTH ? quantity : BUFFER_LENGTH;
+    receiveLength = device != NULL ? device->read(receiveBuffer, length) : 0;
+    receivePosition = 0;
+    return receiveLength;
+}
+
+int TwoWire::available()
+{
+    return receiveLength - receivePosition;
+}
+
+int TwoWire::read()
+{
+    return receivePosition < receiveLength ? receiveBuffer[receivePosition++] : -1;
+}
+
+int TwoWire::peek()
+{
+    return receivePosition < receiveLength ? receiveBuffer[receivePosition] : -1;
+}
@@ -0,0 +1,58 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+/* Native shim of the I2C bus. The simulated devices are attached to the bus with their
+ * address; a transmission to an address without a device fails, as a NACK would. */
+
+#include <Arduino.h>
+#include <mutex>
+
+#define BUFFER_LENGTH 32
+
+/** I2C device class
+ *
+ * @brief Device simulated on the native I2C bus.
+ *
+ * @details write() gets the bytes of a transmission, whose first byte is usually the
+ *          register, and read() gives the bytes of a request.
+ *
+ */
+class i2cDevice {
+    public:
+        virtual ~i2cDevice() {}
+        virtual void write(const uint8_t* data, size_t length) = 0;
+        virtual size_t read(uint8_t* data, size_t length) = 0;
+};
+
+class TwoWire : public Print {
+    i2cDevice* devices[128];
+    uint8_t transmitAddress;
+    uint8_t transmitBuffer[BUFFER_LENGTH];
+    size_t transmitLength;
+    uint8_t receiveBuffer[BUFFER_LENGTH];
+    size_t receiveLength;
+    size_t receivePosition;
+    std::mutex busMutex;
+
+    public:
+        TwoWire();
+
+        bool begin() { return true; }
+        void setClock(uint32_t frequency) { (void)frequency; }
+        void beginTransmission(uint8_t address);
+        uint8_t endTransmission(bool stop = true);
+        uint8_t requestFrom(int address, int quantity, int stop = true);
+        int available();
+        int read();
+        int peek();
+
+        using Print::write;
+        size_t write(uint8_t value);
+
+        // Native only: attaches a simulated device to the bus
+        void attachDevice(uint8_t address, i2cDevice* device);
+};
+
+extern TwoWire Wire;
+
+#endif /* WIRE_H */
@@ -0,0 +1,16 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include "FreeRTOS.h"
+
+#define tskIDLE_PRIORITY ((UBaseType_t)0)
+
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth, 
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t period);
+TickType_t xTaskGetTickCount();
+
+#endif /* TASK_H */
@@ -0,0 +1,114 @@
+"""Generate the filter coefficient sets from data/coefficients.txt and data/sections.txt.
+
+This script is run by PlatformIO before every build (extra_scripts) and can also be
+run by hand. It writes:
+  - data/coefficients.bin: binary blob of the FIR loaded from SPIFFS in one read.
+  - src/FilterCoefficients.h: constexpr array compiled into flash, used as fallback.
+  - data/sections.bin: binary blob of the IIR (FILTER_IIR) loaded from SPIFFS.
+  - src/FilterSections.h: constexpr array of the IIR compiled into flash.
+
+Binary layout (little endian):
+  uint32 magic "FIRC" (FIR) or "SOSC" (IIR), uint16 version, uint16 number of
+  coefficients, uint32 sample rate (Hz), uint32 CRC-32 of the coefficients,
+  float32 coefficients[number].
+
+Each line of data/sections.txt is a second order section "b0 b1 b2 a0 a1 a2", as
+given by scipy.signal (output="sos"). The sections are normalized by a0 and stored
+as b0, b1, b2, a1, a2.
+"""
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b"FIRC"
+SECTIONS_MAGIC = b"SOSC"
+VERSION = 1
+SAMPLE_RATE = 25
+
+
+def read_coefficients(path):
+    with open(path) as f:
+        return [float(line) for line in f if line.strip()]
+
+
+def read_sections(path):
+    coefs = []
+    with open(path) as f:
+        for line in f:
+            if not line.strip():
+                continue
+            b0, b1, b2, a0, a1, a2 = [float(value) for value in line.split()]
+            coefs += [b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0]
+    return coefs
+
+
+def write_binary(path, coefs, sample_rate, magic=MAGIC):
+    payload = struct.pack("<%df" % len(coefs), *coefs)
+    header = magic + struct.pack("<HHII", VERSION, len(coefs), sample_rate, zlib.crc32(payload) & 0xFFFFFFFF)
+    write_if_changed(path, header + payload)
+
+
+def write_header(path, coefs, sample_rate):
+    values = ",\n".join("    %sf" % float_literal(c) for c in coefs)
+    text = (
+        "// Generated by scripts/generate_coefficients.py from data/coefficients.txt. Do not edit.\n"
+        "#ifndef FILTERCOEFFICIENTS_H\n"
+        "#define FILTERCOEFFICIENTS_H\n\n"
+        "#include <stdint.h>\n\n"
+        "constexpr uint16_t FILTER_TAPS = %d;\n"
+        "constexpr uint32_t FILTER_SAMPLE_RATE = %d;\n\n"
+        "constexpr float FILTER_COEFFICIENTS[FILTER_TAPS] = {\n%s\n};\n\n"
+        "#endif /* FILTERCOEFFICIENTS_H */\n" % (len(coefs), sample_rate, values)
+    )
+    write_if_changed(path, text.encode())
+
+
+def write_sections_header(path, coefs, sample_rate):
+    values = ",\n".join("    " + ", ".join("%sf" % float_literal(c) for c in coefs[i:i + 5])
+                        for i in range(0, len(coefs), 5))
+    text = (
+        "// Generated by scripts/generate_coefficients.py from data/sections.txt. Do not edit.\n"
+        "#ifndef FILTERSECTIONS_H\n"
+        "#define FILTERSECTIONS_H\n\n"
+        "#include <stdint.h>\n\n"
+        "constexpr uint16_t FILTER_SECTIONS = %d;\n"
+        "constexpr uint32_t FILTER_SECTIONS_SAMPLE_RATE = %d;\n\n"
+        "// b0, b1, b2, a1, a2 of each section, with a0 = 1\n"
+        "constexpr float FILTER_SECTION_COEFFICIENTS[5 * FILTER_SECTIONS] = {\n%s\n};\n\n"
+        "#endif /* FILTERSECTIONS_H */\n" % (len(coefs) // 5, sample_rate, values)
+    )
+    write_if_changed(path, text.encode())
+
+
+def float_literal(value):
+    literal = "%.9g" % value
+    if "." not in literal and "e" not in literal:
+        literal += ".0"
+    return literal
+
+
+def write_if_changed(path, content):
+    if os.path.exists(path):
+        with open(path, "rb") as f:
+            if f.read() == content:
+                return
+    with open(path, "wb") as f:
+        f.write(content)
+
+
+def generate(project_dir):
+    coefs = read_coefficients(os.path.join(project_dir, "data", "coefficients.txt"))
+    write_binary(os.path.join(project_dir, "data", "coefficients.bin"), coefs, SAMPLE_RATE)
+    write_header(os.path.join(project_dir, "src", "FilterCoefficients.h"), coefs, SAMPLE_RATE)
+    sections = read_sections(os.path.join(project_dir, "data", "sections.txt"))
+    write_binary(os.path.join(project_dir, "data", "sections.bin"), sections, SAMPLE_RATE, SECTIONS_MAGIC)
+    write_sections_header(os.path.join(project_dir, "src", "FilterSections.h"), sections, SAMPLE_RATE)
+
+
+try:
+    Import("env")  # noqa: F821 (defined by PlatformIO)
+    generate(env.subst("$PROJECT_DIR"))  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        generate(sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__), ".."))
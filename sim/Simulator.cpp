@@ -0,0 +1,190 @@
+#include <Arduino.h>
+#include <Max3010xSimulator.h>
+#include <U8g2lib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "TraceReplay.h"
+
+using namespace std;
+
+// Firmware of main.cpp
+void setup();
+void loop();
+
+// Pins of the firmware (see main.cpp)
+const uint8_t SENSOR_INT_PIN = 19;
+const uint8_t BUTTON_PINS[] = { 26, 25, 27 };
+// Time a button is held down by the press command in ms
+const uint32_t PRESS_TIME = 250;
+
+/** Trace signal class
+ *
+ * @brief Signal of the simulated sensor that gives the samples of a trace, from the start
+ *        again when it finishes.
+ *
+ * @details The samples are taken in order from the bursts of the trace, and the sensor
+ *          makes them at its own rate, so the rate of the trace should be the configured one.
+ *
+ * @param replay Replay of the trace
+ *
+ */
+class traceSignal : public simulatedSignal {
+    traceReplay& replay;
+
+    public:
+        traceSignal(traceReplay& pReplay) : replay(pReplay) {}
+
+        bool nextSample(uint32_t sampleRate, uint32_t& ir, uint32_t& red)
+        {
+            (void)sampleRate;
+            for (uint8_t attempts = 0; replay.available() == 0; attempts++)
+            {
+                if (replay.isFinished() && !replay.rewind()) return false;
+                replay.check();
+                if (attempts > 8) return false;
+            }
+            ir = replay.getFIFOIR();
+            red = replay.getFIFORed();
+            replay.nextSample();
+            return true;
+        }
+};
+
+/** Press button function
+ *
+ * @brief Holds a button down as a finger would, in its own thread.
+ *
+ */
+static void pressButton(uint8_t pin)
+{
+    thread([pin]() {
+        setPinLevel(pin, LOW);
+        this_thread::sleep_for(chrono::milliseconds(PRESS_TIME));
+        setPinLevel(pin, HIGH);
+    }).detach();
+}
+
+static void dumpDisplay(const char* fileName)
+{
+    U8G2* display = U8G2::getDisplay();
+    if (display == NULL || !display->savePBM(fileName)) fprintf(stderr, "Failed to save the display in %s\n", fileName);
+}
+
+/** Read commands function
+ *
+ * @brief Reads the commands of the standard input, as the user of the device would act.
+ *
+ * @details The commands are:
+ *          press <1|2|3>       press the heart rate, SpO2 or frequencies button
+ *          dump <file>         save the display in a PBM image
+ *          hr <bpm>            set the heart rate of the synthetic signal
+ *          spo2 <percentage>   set the SpO2 of the synthetic signal
+ *          noise <counts>      set the noise of the synthetic signal
+ *          quit                end the simulation
+ *
+ */
+static void readCommands(syntheticPpg* synthetic)
+{
+    char line[256];
+    while (fgets(line, sizeof(line), stdin) != NULL)
+    {
+        char command[32] = "";
+        char argument[224] = "";
+        if (sscanf(line, "%31s %223s", command, argument) < 1) continue;
+        string name = command;
+        if (name == "press" && atoi(argument) >= 1 && atoi(argument) <= 3) pressButton(BUTTON_PINS[atoi(argument) - 1]);
+        else if (name == "dump" && argument[0] != 0) dumpDisplay(argument);
+        else if (name == "hr" && synthetic != NULL) synthetic->setHeartRate(atof(argument));
+        else if (name == "spo2" && synthetic != NULL) synthetic->setSpo2(atof(argument));
+        else if (name == "noise" && synthetic != NULL) synthetic->setNoiseLevel(atof(argument));
+        else if (name == "quit") break;
+        else fprintf(stderr, "Unknown command: %s", line);
+    }
+    fflush(stdout);
+    _exit(0);
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr, "Usage: %s [--port port] [--pbm file] [--pbm-period ms] [--heart-rate bpm] [--spo2 percentage]\n"
+                    "          [--noise counts] [--trace file] [--quiet]\n", program);
+}
+
+/** Simulator main function
+ *
+ * @brief Runs the firmware of main.cpp on the host with a simulated sensor, display, buttons
+ *        and web server.
+ *
+ * @details The sensor is a MAX30102 simulated at register level on the I2C bus, so the SparkFun
+ *          library, the INT pin and the FIFO of the sensor work as on the device. Its samples
+ *          come from a synthetic PPG or from a recorded trace. The web page is served on the
+ *          port given (8080 by default) from the data directory, and the display can be saved
+ *          as a PBM image, periodically or with the dump command.
+ *
+ */
+int main ( int argc, char** argv )
+{
+    const char* port = "8080";
+    const char* pbmName = NULL;
+    uint32_t pbmPeriod = 1000;
+    float heartRate = 72;
+    float spo2 = 97;
+    float noise = 20;
+    const char* traceName = NULL;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--port" && hasValue) port = argv[++i];
+        else if (option == "--pbm" && hasValue) pbmName = argv[++i];
+        else if (option == "--pbm-period" && hasValue) pbmPeriod = atoi(argv[++i]);
+        else if (option == "--heart-rate" && hasValue) heartRate = atof(argv[++i]);
+        else if (option == "--spo2" && hasValue) spo2 = atof(argv[++i]);
+        else if (option == "--noise" && hasValue) noise = atof(argv[++i]);
+        else if (option == "--trace" && hasValue) traceName = argv[++i];
+        else if (option == "--quiet") quiet = true;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    static syntheticPpg synthetic(heartRate, spo2, noise);
+    static traceReplay replay(File(traceName ? fopen(traceName, "rb") : NULL));
+    static traceSignal trace(replay);
+    if (traceName != NULL && !replay.begin())
+    {
+        fprintf(stderr, "Failed to read the trace %s\n", traceName);
+        return 1;
+    }
+    static max3010xSimulator sensor(traceName ? (simulatedSignal&)trace : (simulatedSignal&)synthetic, SENSOR_INT_PIN);
+    sensor.begin();
+
+    setenv("NATIVE_HTTP_PORT", port, 1);
+    if (quiet) Serial.setOutput(NULL);
+    fprintf(stderr, "Simulator started at %lu ms, %s\n", millis(), traceName ? traceName : "synthetic signal");
+
+    setup();
+
+    thread(readCommands, traceName ? (syntheticPpg*)NULL : &synthetic).detach();
+    if (pbmName != NULL)
+    {
+        thread([pbmName, pbmPeriod]() {
+            for (;;)
+            {
+                this_thread::sleep_for(chrono::milliseconds(pbmPeriod));
+                dumpDisplay(pbmName);
+            }
+        }).detach();
+    }
+
+    for (;;) loop();
+}
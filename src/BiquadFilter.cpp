@@ -0,0 +1,155 @@
+#include "BiquadFilter.h"
+
+using namespace std;
+
+/** Biquad filter constructor
+ *
+ * @brief This is the constructor of the biquad filter class.
+ *
+ * @param pSections Number of second order sections.
+ *
+ * @details The coefficients and the states are allocated here, so filtering a sample
+ *          never allocates memory. Until the coefficients are set, every section is
+ *          a unit gain.
+ *
+ */
+biquadFilter::biquadFilter ( int pSections ) : sections(pSections), coefs(BIQUAD_COEFFICIENTS * pSections, 0.0f),
+                                               states(4 * pSections, 0.0f)
+{
+    for (int i = 0; i < sections; i++) coefs[BIQUAD_COEFFICIENTS * i] = 1.0f;
+}
+
+/** Set coefficients function
+ *
+ * @brief This function sets the coefficients of the sections.
+ *
+ * @param pCoefs Coefficients b0, b1, b2, a1, a2 of each section, normalized by a0.
+ * @param size Number of coefficients, BIQUAD_COEFFICIENTS per section.
+ *
+ */
+void biquadFilter::setCoefficients ( const float* pCoefs, int size )
+{
+    for (int i = 0; i < size && i < int(coefs.size()); i++)
+    {
+        coefs[i] = pCoefs[i];
+    }
+}
+
+/** Get sections function
+ *
+ * @brief This function returns the number of sections of the filter.
+ *
+ * @return Number of second order sections.
+ *
+ */
+int biquadFilter::getSections ()
+{
+    return sections;
+}
+
+/** Is ready function
+ *
+ * @brief This function returns if a sample has been pushed.
+ *
+ * @return True if there is a sample to filter, false if not.
+ *
+ */
+bool biquadFilter::isReady ()
+{
+    return primed;
+}
+
+/** Push sample function
+ *
+ * @brief This function sets the next sample of each channel to filter.
+ *
+ * @param valueIR IR sample.
+ * @param valueRed Red sample.
+ *
+ * @note filter() has to be called once after each sample, as it is the one that
+ *       advances the states.
+ *
+ */
+void biquadFilter::pushSample ( float valueIR, float valueRed )
+{
+    inputIR = valueIR;
+    inputRed = valueRed;
+    if ( !primed ) prime();
+}
+
+/** Prime function
+ *
+ * @brief This function sets the states of the sections to the steady state of the
+ *        first sample.
+ *
+ * @details With a constant input x, a section gives y = G * x, being G its DC gain, and
+ *          its states are s2 = b2 * x - a2 * y and s1 = b1 * x - a1 * y + s2. The output
+ *          of each section is the input of the next one.
+ *
+ */
+void biquadFilter::prime ()
+{
+    float inputs[2] = { inputIR, inputRed };
+    for (int i = 0; i < sections; i++)
+    {
+        const float* coef = &coefs[BIQUAD_COEFFICIENTS * i];
+        float* state = &states[4 * i];
+        float denominator = 1.0f + coef[3] + coef[4];
+        float gain = denominator == 0.0f ? 0.0f : (coef[0] + coef[1] + coef[2]) / denominator;
+        for (uint8_t channel = 0; channel < 2; channel++)
+        {
+            float output = gain * inputs[channel];
+            state[2 + channel] = coef[2] * inputs[channel] - coef[4] * output;
+            state[channel] = coef[1] * inputs[channel] - coef[3] * output + state[2 + channel];
+            inputs[channel] = output;
+        }
+    }
+    primed = true;
+}
+
+/** Filter function
+ *
+ * @brief This function filters the last sample of both channels through all the sections.
+ *
+ * @param resultOfIR Filtered IR sample.
+ * @param resultOfRed Filtered red sample.
+ *
+ * @details Each section computes y = b0 * x + s1, s1 = b1 * x - a1 * y + s2 and
+ *          s2 = b2 * x - a2 * y, with the states of both channels next to each other.
+ *
+ */
+void biquadFilter::filter ( float& resultOfIR, float& resultOfRed )
+{
+    float valueIR = inputIR;
+    float valueRed = inputRed;
+    const float* coef = coefs.data();
+    float* state = states.data();
+    for (int i = 0; i < sections; i++)
+    {
+        float outputIR = coef[0] * valueIR + state[0];
+        float outputRed = coef[0] * valueRed + state[1];
+        state[0] = coef[1] * valueIR - coef[3] * outputIR + state[2];
+        state[1] = coef[1] * valueRed - coef[3] * outputRed + state[3];
+        state[2] = coef[2] * valueIR - coef[4] * outputIR;
+        state[3] = coef[2] * valueRed - coef[4] * outputRed;
+        valueIR = outputIR;
+        valueRed = outputRed;
+        coef += BIQUAD_COEFFICIENTS;
+        state += 4;
+    }
+    resultOfIR = valueIR;
+    resultOfRed = valueRed;
+}
+
+/** Reset function
+ *
+ * @brief This function clears the states, so the next sample primes them again.
+ *
+ */
+void biquadFilter::reset ()
+{
+    fill(states.begin(), states.end(), 0.0f);
+    inputIR = 0.0f;
+    inputRed = 0.0f;
+    primed = false;
+}
@@ -0,0 +1,61 @@
+#ifndef BIQUADFILTER_H
+#define BIQUADFILTER_H
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+namespace std
+{
+    // Coefficients of each section: b0, b1, b2, a1, a2, with a0 = 1
+    const uint8_t BIQUAD_COEFFICIENTS = 5;
+
+    /** Biquad filter class
+     *
+     * @brief This class is the streaming IIR filter of the IR and red channels, a cascade
+     *        of second order sections.
+     *
+     * @details Each section is in transposed direct form II, which keeps two state
+     *          variables per channel and needs 5 multiplications per sample. The states of
+     *          the IR and red channels are interleaved, so both channels go through all the
+     *          sections in one pass with a single read of each coefficient. The first
+     *          sample sets the states to the steady state of a constant input, so the DC of
+     *          the sensor does not start a transient of several seconds. Memory is
+     *          allocated once in the constructor.
+     *
+     * @param sections Number of second order sections
+     * @param coefs Coefficients of the sections, BIQUAD_COEFFICIENTS per section
+     * @param states Interleaved IR/red states, 2 per section and channel
+     * @param inputIR Last IR sample pushed
+     * @param inputRed Last red sample pushed
+     * @param primed True if the states have been set by the first sample
+     *
+     */
+    class biquadFilter {
+        int sections;
+        vector<float> coefs;
+        vector<float> states;
+        float inputIR = 0.0f;
+        float inputRed = 0.0f;
+        bool primed = false;
+
+        void prime ();
+
+        public:
+            biquadFilter ( int pSections );
+
+            void setCoefficients ( const float* pCoefs, int size );
+
+            int getSections ();
+
+            bool isReady ();
+
+            void pushSample ( float valueIR, float valueRed );
+
+            void filter ( float& resultOfIR, float& resultOfRed );
+
+            void reset ();
+    };
+}
+
+#endif /* BIQUADFILTER_H */
@@ -0,0 +1,109 @@
+#ifndef BLOCKPOOL_H
+#define BLOCKPOOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "SpscQueue.h"
+
+namespace std
+{
+    /** Block pool class
+     *
+     * @brief This class hands preallocated blocks from a producer task to a consumer task
+     *        without copying them.
+     *
+     * @details The blocks are allocated once with the pool, and only their pointers move
+     *          between the two queues. The producer acquires a free block, fills it and
+     *          submits it, and the consumer takes it, processes it and releases it. Each
+     *          queue has one producer and one consumer, as the free blocks go the other way.
+     *          When the consumer falls behind, all the blocks are in use and acquire()
+     *          fails, so the producer has to skip data instead of waiting.
+     *
+     * @param blocks Storage of the blocks
+     * @param freeBlocks Blocks that can be filled, from the consumer to the producer
+     * @param readyBlocks Blocks filled, from the producer to the consumer
+     *
+     */
+    template <typename T, size_t COUNT>
+    class blockPool {
+        T blocks[COUNT];
+        spscQueue<T*, COUNT> freeBlocks;
+        spscQueue<T*, COUNT> readyBlocks;
+
+        public:
+            blockPool ()
+            {
+                for (size_t i = 0; i < COUNT; i++) freeBlocks.push(&blocks[i]);
+            }
+
+            /** Acquire function
+             *
+             * @brief This function gets a free block. Only called by the producer.
+             *
+             * @return Free block, NULL if all the blocks are in use.
+             *
+             */
+            T* acquire ()
+            {
+                T* block = NULL;
+                if ( freeBlocks.front(block) ) freeBlocks.pop();
+                return block;
+            }
+
+            /** Submit function
+             *
+             * @brief This function hands a filled block to the consumer. Only called by
+             *        the producer.
+             *
+             * @param block Block acquired and filled.
+             *
+             */
+            void submit ( T* block )
+            {
+                readyBlocks.push(block);
+            }
+
+            /** Take function
+             *
+             * @brief This function gets the oldest filled block. Only called by the consumer.
+             *
+             * @return Filled block, NULL if there are none.
+             *
+             */
+            T* take ()
+            {
+                T* block = NULL;
+                if ( readyBlocks.front(block) ) readyBlocks.pop();
+                return block;
+            }
+
+            /** Release function
+             *
+             * @brief This function gives a processed block back to the producer. Only
+             *        called by the consumer.
+             *
+             * @param block Block taken and processed.
+             *
+             */
+            void release ( T* block )
+            {
+                freeBlocks.push(block);
+            }
+
+            /** Get ready blocks function
+             *
+             * @brief This function returns the number of filled blocks waiting for the
+             *        consumer.
+             *
+             * @return Number of filled blocks.
+             *
+             */
+            size_t getReadyBlocks () const
+            {
+                return readyBlocks.size();
+            }
+    };
+}
+
+#endif /* BLOCKPOOL_H */
@@ -117,14 +117,14 @@ void buttonsArray::begin(vector<int> buttonPins, bool defaultOrder)
  * 
  * @brief This function reads the buttons.
  *  
- * @return void.
+ * @return True if the order of the buttons has changed, false if not.
  *  
  * @details This function reads the buttons' values and changes the order of the buttons.
  *  
  * @note This function is called when the timer is activated. 
  * 
  */
-void buttonsArray::readButtons()
+bool buttonsArray::readButtons()
 { 
     for(uint8_t i = 0; i < buttons.size(); i++)
     {
@@ -139,8 +139,9 @@ void buttonsArray::readButtons()
             }
             buttons[i].previousValue = buttons[i].actualValue;                       // Last value equal to actual value
             buttons[i].previousChange = 0;                                           // Last status change equal to 0
-            return;
+            return true;
         }
         buttons[i].previousChange = buttons[i].actualChange;                         // Last status change is equal to acutal change
     }
+    return false;
 }
@@ -57,7 +57,7 @@ namespace std
 
             void begin(vector<int> buttonPins, bool defaultOrder = true);
 
-            void readButtons();
+            bool readButtons();
     };
 }
 
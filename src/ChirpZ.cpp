@@ -0,0 +1,161 @@
+#include "ChirpZ.h"
+
+using namespace std;
+
+/** Begin function
+ *
+ * @brief This function chooses the size of the FFT and allocates the buffers.
+ *
+ * @param pSamples Number of samples of a block.
+ * @param pMaxBins Maximum number of bins of a call.
+ * @param pWindow Window of the samples.
+ *
+ * @return True if the FFT of the samples plus the bins fits in FFT_MAX_SIZE points, false
+ *         if not, in which case nothing is computed.
+ *
+ */
+bool chirpZ::begin ( uint16_t pSamples, uint16_t pMaxBins, fftWindow pWindow )
+{
+    samples = 0;
+    bins = 0;
+    if ( pSamples == 0 || pMaxBins < 2 || uint32_t(pSamples) + pMaxBins - 1 > FFT_MAX_SIZE ) return false;
+
+    uint16_t points = 2;
+    while ( points < pSamples + pMaxBins - 1 ) points <<= 1;
+    if ( !fft.begin(points) ) return false;
+
+    window.resize(pSamples);
+    for (uint16_t n = 0; n < pSamples; n++) window[n] = fftWindowValue(pWindow, n, pSamples);
+    sampleChirp.assign(2 * pSamples, 0.0f);
+    filterSpectrum.assign(2 * points, 0.0f);
+    work.assign(2 * points, 0.0f);
+    output.assign(pMaxBins, 0.0f);
+    this -> maxBins = pMaxBins;
+    this -> samples = pSamples;
+    return true;
+}
+
+/** Magnitudes function
+ *
+ * @brief This function computes the magnitude of the spectrum of a block of samples in
+ *        a band.
+ *
+ * @param input Samples of the block, as signed 32 bits integers.
+ * @param pLowFrequency Frequency of the first bin in Hz.
+ * @param highFrequency Frequency of the last bin in Hz.
+ * @param pBins Number of bins, from 2 to the maximum of begin().
+ * @param sampleRate Rate of the samples in Hz.
+ *
+ * @return Magnitudes of the bins, (highFrequency - pLowFrequency) / (pBins - 1) Hz apart
+ *         and valid until the next call, or NULL if the band is not valid or the transform
+ *         has not begun.
+ *
+ * @details A call costs two FFTs, and one more and the chirps when the band changes.
+ *
+ * @see setBand().
+ *
+ */
+const float* chirpZ::magnitudes ( const int32_t* input, float pLowFrequency, float highFrequency,
+                                  uint16_t pBins, float sampleRate )
+{
+    if ( samples == 0 || pBins < 2 || pBins > maxBins || sampleRate <= 0 || highFrequency <= pLowFrequency )
+        return NULL;
+
+    float relativeLow = pLowFrequency / sampleRate;
+    float relativeStep = (highFrequency - pLowFrequency) / (pBins - 1) / sampleRate;
+    if ( relativeLow != lowFrequency || relativeStep != step || pBins != bins ) setBand(relativeLow, relativeStep, pBins);
+
+    int64_t sum = 0;
+    for (uint16_t n = 0; n < samples; n++) sum += input[n];
+    float mean = float(sum) / samples;
+
+    uint16_t points = fft.getPoints();
+    for (uint16_t n = 0; n < samples; n++)
+    {
+        float value = input[n] - mean;
+        work[2 * n] = value * sampleChirp[2 * n];
+        work[2 * n + 1] = value * sampleChirp[2 * n + 1];
+    }
+    for (uint16_t n = 2 * samples; n < 2 * points; n++) work[n] = 0.0f;
+
+    fft.transform(work.data());
+    for (uint16_t k = 0; k < points; k++)
+    {
+        float* y = &work[2 * k];
+        const float* v = &filterSpectrum[2 * k];
+        float real = y[0] * v[0] - y[1] * v[1];
+        float imag = y[0] * v[1] + y[1] * v[0];
+        y[0] = real;
+        y[1] = imag;
+    }
+    fft.transform(work.data(), true);
+
+    // the chirp of the output only changes the phase
+    for (uint16_t k = 0; k < bins; k++)
+    {
+        const float* x = &work[2 * k];
+        output[k] = sqrtf(x[0] * x[0] + x[1] * x[1]);
+    }
+    return output.data();
+}
+
+/** Set band function
+ *
+ * @brief This function computes the chirps of a band.
+ *
+ * @param pLowFrequency Frequency of the first bin, relative to the sample rate.
+ * @param pStep Frequency between bins, relative to the sample rate.
+ * @param pBins Number of bins.
+ *
+ * @details The chirp of the samples is window[n] * exp(-j * 2 * pi * (f1 * n + df * n^2 / 2))
+ *          and the one of the convolution is exp(j * pi * df * m^2), from m = -(samples - 1)
+ *          to pBins - 1 wrapped around the FFT. The phases are reduced in double, as n^2
+ *          grows too much for the precision of a float.
+ *
+ */
+void chirpZ::setBand ( float pLowFrequency, float pStep, uint16_t pBins )
+{
+    for (uint16_t n = 0; n < samples; n++)
+    {
+        double turns = double(pLowFrequency) * n + 0.5 * double(pStep) * n * n;
+        float phase = 2 * M_PI * (turns - floor(turns));
+        sampleChirp[2 * n] = window[n] * cosf(phase);
+        sampleChirp[2 * n + 1] = -window[n] * sinf(phase);
+    }
+
+    uint16_t points = fft.getPoints();
+    for (uint16_t n = 0; n < 2 * points; n++) filterSpectrum[n] = 0.0f;
+    for (uint16_t m = 0; m < samples || m < pBins; m++)
+    {
+        double turns = 0.5 * double(pStep) * m * m;
+        float phase = 2 * M_PI * (turns - floor(turns));
+        if ( m < pBins )
+        {
+            filterSpectrum[2 * m] = cosf(phase);
+            filterSpectrum[2 * m + 1] = sinf(phase);
+        }
+        if ( m > 0 && m < samples )
+        {
+            filterSpectrum[2 * (points - m)] = cosf(phase);
+            filterSpectrum[2 * (points - m) + 1] = sinf(phase);
+        }
+    }
+    fft.transform(filterSpectrum.data());
+    for (uint16_t n = 0; n < 2 * points; n++) filterSpectrum[n] /= points;
+
+    this -> lowFrequency = pLowFrequency;
+    this -> step = pStep;
+    this -> bins = pBins;
+}
+
+/** Get points function
+ *
+ * @brief This function returns the number of points of the FFTs of the convolution.
+ *
+ * @return Number of points, 0 if the transform has not begun.
+ *
+ */
+uint16_t chirpZ::getPoints ( )
+{
+    return samples > 0 ? fft.getPoints() : 0;
+}
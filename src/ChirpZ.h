@@ -0,0 +1,68 @@
+#ifndef CHIRPZ_H
+#define CHIRPZ_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ComplexFft.h"
+#include "FftWindow.h"
+
+namespace std
+{
+    /** Chirp Z class
+     *
+     * @brief This class is the spectrum of a block of real samples at any number of
+     *        frequencies evenly spaced in a band (zoom FFT), with the chirp Z transform.
+     *
+     * @details X[k] = sum(x[n] * exp(-j * 2 * pi * (f1 + k * df) * n / fs)) is written with
+     *          n * k = (n^2 + k^2 - (k - n)^2) / 2 as a convolution of the samples times a
+     *          chirp with another chirp (Bluestein), which is done with two complexFft of
+     *          the first power of 2 not smaller than the samples plus the bins minus 1. The
+     *          mean of the samples is removed and the window is included in the chirp of
+     *          the samples. The chirps and the spectrum of the second one only depend on
+     *          the band, so they are kept until a call asks for another one. The buffers
+     *          are allocated by begin() for up to the maximum number of bins, so a call
+     *          never allocates memory. The magnitudes are scaled as the DFT of the block,
+     *          the same as fftPlan.
+     *
+     * @param samples Number of samples of a block, 0 until begin() is called
+     * @param maxBins Maximum number of bins of a call
+     * @param window Window of the samples
+     * @param fft Complex FFT of the convolution
+     * @param lowFrequency Frequency of the first bin of the band of the chirps, relative
+     *                     to the sample rate
+     * @param step Frequency between bins of the band of the chirps, relative to the
+     *             sample rate
+     * @param bins Number of bins of the band of the chirps, 0 if there is none
+     * @param sampleChirp Window times the chirp of each sample, interleaved complex values
+     * @param filterSpectrum Spectrum of the chirp of the convolution, divided by the points
+     * @param work Samples and convolution, interleaved complex values
+     * @param output Magnitudes of the bins
+     *
+     */
+    class chirpZ {
+        uint16_t samples = 0;
+        uint16_t maxBins = 0;
+        vector<float> window;
+        complexFft fft;
+        float lowFrequency = 0;
+        float step = 0;
+        uint16_t bins = 0;
+        vector<float> sampleChirp;
+        vector<float> filterSpectrum;
+        vector<float> work;
+        vector<float> output;
+
+        void setBand ( float pLowFrequency, float pStep, uint16_t pBins );
+
+        public:
+            bool begin ( uint16_t pSamples, uint16_t pMaxBins, fftWindow pWindow );
+
+            const float* magnitudes ( const int32_t* input, float pLowFrequency, float highFrequency,
+                                      uint16_t pBins, float sampleRate );
+
+            uint16_t getPoints ();
+    };
+}
+
+#endif /* CHIRPZ_H */
@@ -0,0 +1,103 @@
+#include "CicDecimator.h"
+
+#include <string.h>
+
+using namespace std;
+
+/** CIC decimator constructor
+ *
+ * @brief This is the constructor of the CIC decimator class, which does not decimate
+ *        until begin() is called.
+ *
+ */
+cicDecimator::cicDecimator ( )
+{
+    reset();
+}
+
+/** Begin function
+ *
+ * @brief This function sets the decimation factor.
+ *
+ * @param pFactor Decimation factor, from 1 to CIC_MAX_FACTOR.
+ *
+ */
+void cicDecimator::begin ( uint8_t pFactor )
+{
+    if ( pFactor == 0 ) pFactor = 1;
+    if ( pFactor > CIC_MAX_FACTOR ) pFactor = CIC_MAX_FACTOR;
+    this -> factor = pFactor;
+
+    float dcGain = 1;
+    for (uint8_t i = 0; i < CIC_STAGES; i++) dcGain *= pFactor;
+    this -> gain = 1 / dcGain;
+    reset();
+}
+
+/** Push function
+ *
+ * @brief This function integrates a sample of each channel and computes the output when
+ *        it is kept.
+ *
+ * @param valueIR IR sample, replaced by the IR output if there is one.
+ * @param valueRed Red sample, replaced by the red output if there is one.
+ *
+ * @return True if the values are an output, false if the sample has only been integrated
+ *         or the combs are settling.
+ *
+ */
+bool cicDecimator::push ( float& valueIR, float& valueRed )
+{
+    float* values[2] = { &valueIR, &valueRed };
+    for (uint8_t channel = 0; channel < 2; channel++)
+    {
+        uint32_t value = uint32_t(int32_t(*values[channel]));
+        for (uint8_t i = 0; i < CIC_STAGES; i++)
+        {
+            integrators[channel][i] += value;
+            value = integrators[channel][i];
+        }
+    }
+    if ( ++phase < factor ) return false;
+    phase = 0;
+
+    for (uint8_t channel = 0; channel < 2; channel++)
+    {
+        uint32_t value = integrators[channel][CIC_STAGES - 1];
+        for (uint8_t i = 0; i < CIC_STAGES; i++)
+        {
+            uint32_t previous = combs[channel][i];
+            combs[channel][i] = value;
+            value -= previous;
+        }
+        *values[channel] = int32_t(value) * gain;
+    }
+    if ( settling == 0 ) return true;
+    settling--;
+    return false;
+}
+
+/** Get factor function
+ *
+ * @brief This function returns the decimation factor.
+ *
+ * @return Number of inputs of each output.
+ *
+ */
+uint8_t cicDecimator::getFactor ()
+{
+    return factor;
+}
+
+/** Reset function
+ *
+ * @brief This function clears the integrators and the combs.
+ *
+ */
+void cicDecimator::reset ()
+{
+    memset(integrators, 0, sizeof(integrators));
+    memset(combs, 0, sizeof(combs));
+    phase = 0;
+    settling = CIC_STAGES;
+}
@@ -0,0 +1,54 @@
+#ifndef CICDECIMATOR_H
+#define CICDECIMATOR_H
+
+#include <stdint.h>
+
+namespace std
+{
+    // Number of integrator and comb stages of the CIC decimator
+    const uint8_t CIC_STAGES = 3;
+    // Maximum decimation factor, so the gain of the 18 bits samples fits in 32 bits
+    const uint8_t CIC_MAX_FACTOR = 16;
+
+    /** CIC decimator class
+     *
+     * @brief This class is a cascaded integrator comb decimator of the IR and red channels.
+     *
+     * @details The integrators run at the input rate and the combs at the output rate, so
+     *          it only adds and subtracts: CIC_STAGES additions per input and CIC_STAGES
+     *          subtractions per output for each channel. The arithmetic is modular, so
+     *          the integrators can wrap as long as the output fits in 32 bits, which is
+     *          why the factor is limited to CIC_MAX_FACTOR. Its response falls in the
+     *          passband (sinc^CIC_STAGES), so it is followed by a compensation filter. The
+     *          first CIC_STAGES outputs are the ramp of the combs and are not given.
+     *
+     * @param factor Decimation factor
+     * @param phase Number of inputs since the last output
+     * @param settling Number of outputs left until the combs are full
+     * @param gain Inverse of the DC gain, factor^CIC_STAGES
+     * @param integrators State of the integrators of each channel
+     * @param combs Previous inputs of the combs of each channel
+     *
+     */
+    class cicDecimator {
+        uint8_t factor = 1;
+        uint8_t phase = 0;
+        uint8_t settling = CIC_STAGES;
+        float gain = 1;
+        uint32_t integrators[2][CIC_STAGES];
+        uint32_t combs[2][CIC_STAGES];
+
+        public:
+            cicDecimator ();
+
+            void begin ( uint8_t pFactor );
+
+            bool push ( float& valueIR, float& valueRed );
+
+            uint8_t getFactor ();
+
+            void reset ();
+    };
+}
+
+#endif /* CICDECIMATOR_H */
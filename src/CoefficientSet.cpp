@@ -0,0 +1,144 @@
+#include "CoefficientSet.h"
+#include "FilterCoefficients.h"
+#include "FilterSections.h"
+
+#include <string.h>
+
+using namespace std;
+
+#define COEFFICIENTS_VERSION 1
+
+/** Read little endian function
+ * 
+ * @brief This function reads a little endian unsigned integer.
+ * 
+ * @param data Pointer to the first byte.
+ * @param bytes Number of bytes of the integer.
+ * 
+ * @return Value read.
+ * 
+ */
+static uint32_t readLittleEndian ( const uint8_t* data, uint8_t bytes )
+{
+    uint32_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--)
+    {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+/** Load binary function
+ * 
+ * @brief This function loads the coefficients from a binary blob.
+ * 
+ * @param blob Content of the binary coefficients file.
+ * @param size Size of the blob in bytes.
+ * @param magic Magic of the file, COEFFICIENTS_MAGIC or SECTIONS_MAGIC.
+ * 
+ * @return True if the blob is valid, false if not. If it is not valid, the 
+ *         coefficients are not modified.
+ * 
+ */
+bool coefficientSet::loadBinary ( const uint8_t* blob, size_t size, const char* magic )
+{
+    if ( size < COEFFICIENTS_HEADER_SIZE || memcmp(blob, magic, 4) != 0 ) return false;
+    if ( readLittleEndian(blob + 4, 2) != COEFFICIENTS_VERSION ) return false;
+
+    uint16_t taps = readLittleEndian(blob + 6, 2);
+    const uint8_t* payload = blob + COEFFICIENTS_HEADER_SIZE;
+    size_t payloadSize = taps * sizeof(float);
+    if ( size != COEFFICIENTS_HEADER_SIZE + payloadSize ) return false;
+    if ( readLittleEndian(blob + 12, 4) != crc32(payload, payloadSize) ) return false;
+
+    this -> sampleRate = readLittleEndian(blob + 8, 4);
+    this -> coefs.resize(taps);
+    for (uint16_t i = 0; i < taps; i++)
+    {
+        uint32_t bits = readLittleEndian(payload + i * sizeof(float), 4);
+        memcpy(&coefs[i], &bits, sizeof(float));
+    }
+    return true;
+}
+
+/** Load compiled in function
+ * 
+ * @brief This function loads the coefficients compiled into flash.
+ * 
+ */
+void coefficientSet::loadCompiledIn ( )
+{
+    this -> sampleRate = FILTER_SAMPLE_RATE;
+    this -> coefs.assign(FILTER_COEFFICIENTS, FILTER_COEFFICIENTS + FILTER_TAPS);
+}
+
+/** Load compiled in sections function
+ * 
+ * @brief This function loads the second order sections compiled into flash.
+ * 
+ */
+void coefficientSet::loadCompiledInSections ( )
+{
+    this -> sampleRate = FILTER_SECTIONS_SAMPLE_RATE;
+    this -> coefs.assign(FILTER_SECTION_COEFFICIENTS, FILTER_SECTION_COEFFICIENTS + 5 * FILTER_SECTIONS);
+}
+
+/** Get coefficients function
+ * 
+ * @brief This function returns the coefficients.
+ * 
+ * @return Pointer to the first coefficient.
+ * 
+ */
+const float* coefficientSet::getCoefficients ( )
+{
+    return coefs.data();
+}
+
+/** Get taps function
+ * 
+ * @brief This function returns the number of coefficients.
+ * 
+ * @return Number of taps.
+ * 
+ */
+int coefficientSet::getTaps ( )
+{
+    return coefs.size();
+}
+
+/** Get sample rate function
+ * 
+ * @brief This function returns the sample rate the filter was designed for.
+ * 
+ * @return Sample rate in Hz.
+ * 
+ */
+uint32_t coefficientSet::getSampleRate ( )
+{
+    return sampleRate;
+}
+
+/** CRC-32 function
+ * 
+ * @brief This function computes the CRC-32 (IEEE 802.3) of the data.
+ * 
+ * @param data Data.
+ * @param size Size of the data in bytes.
+ * 
+ * @return CRC-32 of the data.
+ * 
+ */
+uint32_t coefficientSet::crc32 ( const uint8_t* data, size_t size )
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
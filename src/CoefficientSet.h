@@ -0,0 +1,54 @@
+#ifndef COEFFICIENTSET_H
+#define COEFFICIENTSET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace std
+{
+    // Size of the header of the binary coefficients file
+    const size_t COEFFICIENTS_HEADER_SIZE = 16;
+    // Magic of the binary file of the FIR filter
+    const char COEFFICIENTS_MAGIC[] = "FIRC";
+    // Magic of the binary file of the second order sections of the IIR filter
+    const char SECTIONS_MAGIC[] = "SOSC";
+
+    /** Coefficient set class
+     *
+     * @brief This class is the set of coefficients of the filter.
+     *
+     * @details The coefficients can be loaded from a binary blob or from the array compiled
+     *          into flash (FilterCoefficients.h, or FilterSections.h for the sections of the
+     *          IIR filter). Both are generated at build time from data/coefficients.txt and
+     *          data/sections.txt by scripts/generate_coefficients.py. The binary blob has a
+     *          header with the magic "FIRC" or "SOSC", the version, the number of
+     *          coefficients, the sample rate and the CRC-32 of the coefficients, all in
+     *          little endian.
+     *
+     * @param coefs Coefficients of the filter
+     * @param sampleRate Sample rate the filter was designed for
+     *
+     */
+    class coefficientSet {
+        vector<float> coefs;
+        uint32_t sampleRate = 0;
+
+        public:
+            bool loadBinary ( const uint8_t* blob, size_t size, const char* magic = COEFFICIENTS_MAGIC );
+
+            void loadCompiledIn ();
+
+            void loadCompiledInSections ();
+
+            const float* getCoefficients ();
+
+            int getTaps ();
+
+            uint32_t getSampleRate ();
+
+            static uint32_t crc32 ( const uint8_t* data, size_t size );
+    };
+}
+
+#endif /* COEFFICIENTSET_H */
@@ -0,0 +1,127 @@
+#include "ComplexFft.h"
+
+using namespace std;
+
+/** Begin function
+ *
+ * @brief This function computes the bit reversal and the twiddle factors.
+ *
+ * @param pPoints Number of points, a power of 2 from 2 to FFT_MAX_SIZE.
+ *
+ * @return True if the number of points is valid, false if not.
+ *
+ */
+bool complexFft::begin ( uint16_t pPoints )
+{
+    points = 0;
+    if ( pPoints < 2 || pPoints > FFT_MAX_SIZE || (pPoints & (pPoints - 1)) != 0 ) return false;
+
+    uint8_t bits = 0;
+    while ( (1 << bits) < pPoints ) bits++;
+    bitReverse.resize(pPoints);
+    for (uint16_t i = 0; i < pPoints; i++)
+    {
+        uint16_t reversedIndex = 0;
+        for (uint8_t b = 0; b < bits; b++) reversedIndex |= ((i >> b) & 1) << (bits - 1 - b);
+        bitReverse[i] = reversedIndex;
+    }
+
+    twiddles.resize(pPoints);
+    for (uint16_t k = 0; k < pPoints / 2; k++)
+    {
+        twiddles[2 * k] = cos(2 * M_PI * k / pPoints);
+        twiddles[2 * k + 1] = sin(2 * M_PI * k / pPoints);
+    }
+    this -> points = pPoints;
+    return true;
+}
+
+/** Reversed function
+ *
+ * @brief This function returns the position of a sample in bit reversed order.
+ *
+ * @param index Index of the sample.
+ *
+ * @return Position of the sample before butterflies().
+ *
+ */
+uint16_t complexFft::reversed ( uint16_t index )
+{
+    return bitReverse[index];
+}
+
+/** Butterflies function
+ *
+ * @brief This function transforms samples already in bit reversed order.
+ *
+ * @param data Interleaved complex samples in bit reversed order, replaced by the spectrum
+ *             in natural order.
+ * @param inverse True for the inverse transform, without the division by the points.
+ *
+ * @details The samples can be written directly in bit reversed order with reversed(),
+ *          which saves the permutation of transform().
+ *
+ */
+void complexFft::butterflies ( float* data, bool inverse )
+{
+    float sign = inverse ? 1.0f : -1.0f;
+    for (uint16_t half = 1; half < points; half <<= 1)
+    {
+        uint16_t stride = points / (2 * half);
+        for (uint16_t k = 0; k < half; k++)
+        {
+            // exp(-+j * 2 * pi * k / (2 * half))
+            float wr = twiddles[2 * k * stride];
+            float wi = sign * twiddles[2 * k * stride + 1];
+            for (uint16_t i = k; i < points; i += 2 * half)
+            {
+                float* upper = &data[2 * i];
+                float* lower = &data[2 * (i + half)];
+                float tr = lower[0] * wr - lower[1] * wi;
+                float ti = lower[0] * wi + lower[1] * wr;
+                lower[0] = upper[0] - tr;
+                lower[1] = upper[1] - ti;
+                upper[0] += tr;
+                upper[1] += ti;
+            }
+        }
+    }
+}
+
+/** Transform function
+ *
+ * @brief This function transforms samples in natural order.
+ *
+ * @param data Interleaved complex samples, replaced by the spectrum.
+ * @param inverse True for the inverse transform, without the division by the points.
+ *
+ * @see butterflies().
+ *
+ */
+void complexFft::transform ( float* data, bool inverse )
+{
+    for (uint16_t i = 0; i < points; i++)
+    {
+        uint16_t j = bitReverse[i];
+        if ( j <= i ) continue;
+        float real = data[2 * i];
+        float imag = data[2 * i + 1];
+        data[2 * i] = data[2 * j];
+        data[2 * i + 1] = data[2 * j + 1];
+        data[2 * j] = real;
+        data[2 * j + 1] = imag;
+    }
+    butterflies(data, inverse);
+}
+
+/** Get points function
+ *
+ * @brief This function returns the number of points of the FFT.
+ *
+ * @return Number of points, 0 if the FFT has not begun.
+ *
+ */
+uint16_t complexFft::getPoints ( )
+{
+    return points;
+}
@@ -0,0 +1,45 @@
+#ifndef COMPLEXFFT_H
+#define COMPLEXFFT_H
+
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+namespace std
+{
+    // Maximum size of the FFT, a power of 2
+    const uint16_t FFT_MAX_SIZE = 4096;
+
+    /** Complex FFT class
+     *
+     * @brief This class is the radix 2 FFT of complex samples in float, with the bit
+     *        reversal and the twiddle factors computed once by begin().
+     *
+     * @details The samples are interleaved, the real part followed by the imaginary part,
+     *          and transformed in place. The inverse transform is not divided by the number
+     *          of points. It is the transform shared by fftPlan and chirpZ.
+     *
+     * @param points Number of points, 0 until begin() is called
+     * @param bitReverse Position of each sample in bit reversed order
+     * @param twiddles Cosine and sine of the twiddle factors
+     *
+     */
+    class complexFft {
+        uint16_t points = 0;
+        vector<uint16_t> bitReverse;
+        vector<float> twiddles;
+
+        public:
+            bool begin ( uint16_t pPoints );
+
+            uint16_t reversed ( uint16_t index );
+
+            void butterflies ( float* data, bool inverse = false );
+
+            void transform ( float* data, bool inverse = false );
+
+            uint16_t getPoints ();
+    };
+}
+
+#endif /* COMPLEXFFT_H */
@@ -1,4 +1,5 @@
 #include "DataReader.h"
+#include "FilterSections.h"
 
 using namespace std;
 
@@ -6,176 +7,422 @@ using namespace std;
  * 
  * @brief This is the constructor of the global data reader class.
  * 
- * @param pEnoughSamples Number of samples to apply the filter.
+ * @param pSensor FIFO of the pulse sensor.
+ * @param pEnoughSamples Number of samples to apply the filter, at most MAX_BLOCK_SAMPLES.
  * 
  */
-globalDataReader::globalDataReader ( int pEnoughSamples )
+globalDataReader::globalDataReader ( sensorFifo& pSensor, int pEnoughSamples ) : sensor(pSensor),
+                                     filter(FILTER_USE_IIR ? int(FILTER_SECTIONS) : pEnoughSamples + 1)
 {
-    this -> enoughSamples = pEnoughSamples;
-   
-    uint32_t pIrBuffer[enoughSamples];
-    this -> irBuffer = pIrBuffer;
-   
-    uint32_t pRedBuffer[enoughSamples];
-    this -> redBuffer = pRedBuffer;
-   
-    float pVCoefs[enoughSamples + 1];
-    this -> vCoefs = pVCoefs;
+    this -> enoughSamples = min(pEnoughSamples, int(MAX_BLOCK_SAMPLES));
+}
+
+/** Global data reader destructor
+ * 
+ * @brief This is the destructor of the global data reader class, which deletes the 
+ *        event group of the blocks.
+ * 
+ */
+globalDataReader::~globalDataReader ( )
+{
+    if ( blockEvents != NULL ) vEventGroupDelete(blockEvents);
 }
 
 /** Setup function
  * 
  * @brief This function sets up the data reader.
  * 
+ * @param SAMPLING_FREQUENCY Rate of the analysis in Hz.
+ * @param FFT_SIZE Number of points of the FFT of each block, a power of 2.
+ * 
+ * @details The decimation is designed from the rate of the sensor FIFO to the rate of the
+ *          analysis, and the sample clock starts at the rate of the sensor. The plan of 
+ *          the FFT takes the whole block, zero padded to FFT_SIZE points. With SLIDING_DFT,
+ *          the sliding DFT covers the band from SPECTRUM_LOW_FREQUENCY to 
+ *          SPECTRUM_HIGH_FREQUENCY instead, with ZOOM_SPECTRUM the chirp Z transform 
+ *          takes the whole block for up to MAX_FREQS bins, and with WELCH_PSD the segments
+ *          of the Welch PSD have FFT_SIZE samples.
+ * 
+ * @see decimationChain::begin(), sampleClock::begin(), fftPlan::begin(), slidingDft::begin(),
+ *      chirpZ::begin(), welchPsd::begin().
+ * 
  */
-void globalDataReader::setup ( )
+void globalDataReader::setup ( uint8_t SAMPLING_FREQUENCY, uint16_t FFT_SIZE )
 {
-    readFile();
-    initMAX30102();
+    blockEvents = xEventGroupCreate();
+    if ( blockEvents == NULL )
+    {
+        LOG_ERROR("Error creating the analysis events");
+        logger.flush();
+        for (;;);
+    }
+    loadCoefficients();
+    if ( SPECTRUM_USE_SLIDING_DFT )
+    {
+        if ( !spectrum.begin(SAMPLING_FREQUENCY, SLIDING_DFT_LENGTH, SPECTRUM_LOW_FREQUENCY, SPECTRUM_HIGH_FREQUENCY,
+                             FFT_ANALYSIS_WINDOW) )
+        {
+            LOG_ERROR("The sliding DFT has no bins between %.1f and %.1f Hz", SPECTRUM_LOW_FREQUENCY, 
+                      SPECTRUM_HIGH_FREQUENCY);
+        }
+    }
+    else if ( SPECTRUM_USE_ZOOM )
+    {
+        if ( !zoom.begin(enoughSamples, MAX_FREQS, FFT_ANALYSIS_WINDOW) )
+        {
+            LOG_ERROR("The zoom spectrum cannot have %u samples", enoughSamples);
+        }
+    }
+    else if ( SPECTRUM_USE_WELCH )
+    {
+        if ( !welch.begin(FFT_SIZE, WELCH_OVERLAP, WELCH_DEPTH, WELCH_AVERAGE, FFT_ANALYSIS_WINDOW) )
+        {
+            LOG_ERROR("The Welch PSD cannot have segments of %u samples", FFT_SIZE);
+        }
+    }
+    else if ( !transform.begin(FFT_SIZE, enoughSamples, FFT_ANALYSIS_WINDOW) )
+    {
+        LOG_ERROR("The FFT cannot have %u points", FFT_SIZE);
+    }
+    sensor.begin();
+
+    uint16_t sensorRate = sensor.getSampleRate();
+    if ( sensorRate == 0 ) sensorRate = SAMPLING_FREQUENCY;
+    decimator.begin(sensorRate, SAMPLING_FREQUENCY);
+    clock.begin(sensorRate);
+    LOG_INFO("Sensor at %u Hz, decimated by %u", sensorRate, decimator.getFactor());
 }
 
-/** Init MAX30102 function
+/** Load coefficients function
  * 
- * @brief This function initializes the MAX30102 sensor.
+ * @brief This function loads the coefficients of the filter.
  * 
- * @param ledBrightness LED brightness.
- * @param sampleAverage Sample average.
- * @param ledMode LED mode.
- * @param sampleRate Sample rate.
- * @param pulseWidth Pulse width.
- * @param adcRange ADC range.
+ * @details The coefficients are read from the binary file in the ESP32 file system. If 
+ *          it is missing or not valid, the coefficients compiled into flash are used. 
+ *          The number of taps of the FIR has to be enoughSamples + 1, and with FILTER_IIR
+ *          the file has the FILTER_SECTIONS second order sections of data/sections.txt.
  * 
- * @note The parameters are set to the default values. The different options are:
- *      - ledBrightness: 0 = Off to 255 = 50mA
- *      - sampleAverage: 1, 2, 4, 8, 16, 32
- *      - ledMode: 1 = Red only, 2 = Red + IR, 3 = Red + IR + Green
- *      - sampleRate: 50, 100, 200, 400, 800, 1000, 1600, 3200
- *      - pulseWidth: 69, 118, 215, 411
- *      - adcRange: 2048, 4096, 8192, 16384
- * 
- * @see setup();
+ * @see readFile(), coefficientSet::loadCompiledIn(), coefficientSet::loadCompiledInSections().
  * 
  */
-void globalDataReader::initMAX30102 ( byte ledBrightness, byte sampleAverage, byte ledMode, 
-                                      int sampleRate, int pulseWidth, int adcRange )
+void globalDataReader::loadCoefficients ( )
 {
-    // Initialize sensor
-    if (!particleSensor.begin(Wire, I2C_SPEED_FAST)) //Use default I2C port, 400kHz speed
+    uint32_t startTime = millis();
+#ifdef FILTER_IIR
+    int filterCoefficients = BIQUAD_COEFFICIENTS * filter.getSections();
+#else
+    int filterCoefficients = enoughSamples + 1;
+#endif
+    if ( !readFile() || coefficients.getTaps() != filterCoefficients )
+    {
+        LOG_WARN("Using the filter coefficients compiled into flash");
+        if ( FILTER_USE_IIR ) coefficients.loadCompiledInSections();
+        else coefficients.loadCompiledIn();
+    }
+    if ( coefficients.getTaps() != filterCoefficients )
     {
-        Serial.println("MAX30105 was not found. Please check wiring/power. ");
+        LOG_ERROR("Filter taps do not match the number of samples. Please regenerate the coefficients.");
+        logger.flush();
         while (1);
     }
-    particleSensor.setup(ledBrightness, sampleAverage, ledMode, sampleRate, pulseWidth, adcRange); 
+    filter.setCoefficients(coefficients.getCoefficients(), coefficients.getTaps());
+
+    LOG_INFO("Filter coefficients loaded in %u ms", millis() - startTime);
 }
 
 /** Read file function
  * 
- * @brief This function reads the coeficients for the filter from a file in the ESP32 
- *        file system and assign its coefficients to the vCoefs array.
+ * @brief This function reads the binary coefficients file from the ESP32 file system
+ *        in one read.
+ * 
+ * @param fileName Name of the file to read. By default is FILTER_FILE, "/coefficients.bin"
+ *                 or "/sections.bin" with FILTER_IIR.
  * 
- * @param fileName Name of the file to read. By default is "/coeficients2.txt".
+ * @return True if the file has been read and is valid, false if not.
  * 
- * @see setup();
+ * @see loadCoefficients(), coefficientSet::loadBinary().
  * 
  */
-void globalDataReader::readFile ( String fileName)
+bool globalDataReader::readFile ( String fileName )
 {
     File file = SPIFFS.open(fileName);
     if(!file)
     {
-        Serial.println("Failed to open file for reading");
-        return;
+        LOG_WARN("Failed to open file for reading");
+        return false;
     }
 
-    for (int i = 0; i <= enoughSamples; i++)
+    vector<uint8_t> blob(file.size());
+    size_t bytesRead = file.read(blob.data(), blob.size());
+    file.close(); 
+
+    const char* magic = FILTER_USE_IIR ? SECTIONS_MAGIC : COEFFICIENTS_MAGIC;
+    if ( bytesRead != blob.size() || !coefficients.loadBinary(blob.data(), blob.size(), magic) )
     {
-        string stringCoef = file.readStringUntil('\n').c_str();
-        vCoefs[i] = stof(stringCoef);
-        delay(50);
+        LOG_WARN("Coefficients file is not valid");
+        return false;
     }
-  
-    file.close(); 
+    return true;
 }
 
 /** Read data function
  * 
- * @brief This function reads the data from the sensor.
+ * @brief This function reads the data from the sensor. It is called by the sampler task.
  *
  * @param globalValuesVar Global values variable.
- * @param SAMPLES Number of samples.
- * @param SAMPLING_FREQUENCY Sampling frequency.
- * 
- * @details This functions reads the data from the sensor and, when it has enough samples,
- *          it applies the filter and sends the data to the heart rate algorithm. Finally,
- *          the output data is stored in the global values variable and printed.
- * 
- * @see readValuesFromSensor(), doFiltering(), setGlobalValues(), printData().
+ * @param events Events of the visualizer.
+ * 
+ * @details This functions reads a batch of samples from the sensor FIFO, tags them with
+ *          the sample clock and pushes them through the decimation and the filter. Every
+ *          filtered sample is stored in the block being filled, which is handed to the
+ *          analysis task when it is full, and pushed to the waveform stream with the time
+ *          it was taken. With SLIDING_DFT, it also updates the spectrum. The 
+ *          visualizer is signaled when a batch of samples is pushed and when a spectrum is
+ *          published. If the FIFO has no new
+ *          samples, it waits 1 ms. The sequence numbers of the filtered samples count 
+ *          the samples at the rate of the analysis.
+ * 
+ * @see readValuesFromSensor(), doDecimation(), doFiltering(), storeSample(), updateSpectrum(),
+ *      analyzeData(), globalValues::pushWaveformSample(), sampleClock.
  *  
  */
-void globalDataReader::readData ( globalValues& globalValuesVar, uint8_t SAMPLES, uint8_t SAMPLING_FREQUENCY )
+void globalDataReader::readData ( globalValues& globalValuesVar, visualizerEvents& events )
 {
-    float resultOfIR = 0.0;
-    float resultOfRed = 0.0;
+    uint8_t batchSize = readValuesFromSensor();
+    if ( batchSize == 0 )
+    {
+        delay(1);
+        return;
+    }
+    if ( firstSampleTime == 0 )
+    {
+        firstSampleTime = millis();
+        LOG_INFO("Boot to first sample: %u ms", firstSampleTime);
+    }
+    clock.update(batchTime, batchSize, batchOverflows);
 
-    readValuesFromSensor();
-    // we have enough samples to apply the filter
-    if ( inputIRData.size() > enoughSamples )
+    bool newSpectrum = false;
+    for (uint8_t i = 0; i < batchSize; i++)
     {
-        doFiltering(resultOfIR, resultOfRed);
+        float valueIR = irBatch[i];
+        float valueRed = redBatch[i];
+        if ( !doDecimation(valueIR, valueRed) ) continue;
 
-        //we have enough samples to send to the heart rate algorithm
-        if ( filteringIterations >= enoughSamples )
-        {
-            filteringIterations = 0;
-            setGlobalValues(globalValuesVar);
-            printData();
-            fft(globalValuesVar, SAMPLES, SAMPLING_FREQUENCY);
-            dataReady = true;
-        }
-        irBuffer[filteringIterations] = resultOfIR;
-        redBuffer[filteringIterations] = resultOfRed;    
-        filteringIterations++;
+        filterSample resultOfIR = 0;
+        filterSample resultOfRed = 0;
+
+#ifdef FIXED_POINT
+        filter.pushSample(lroundf(valueIR), lroundf(valueRed));
+#else
+        filter.pushSample(valueIR, valueRed);
+#endif
+        // we have enough samples to apply the filter
+        if ( !filter.isReady() ) continue;
+
+        doFiltering(resultOfIR, resultOfRed);
+        uint32_t sampleTime = clock.getTimestamp(i);
+        globalValuesVar.pushWaveformSample(int32_t(resultOfIR), sampleTime);
+        storeSample(resultOfIR, resultOfRed, clock.getSequence(i) / decimator.getFactor(), sampleTime);
+        if ( SPECTRUM_USE_SLIDING_DFT && updateSpectrum(globalValuesVar, resultOfIR) ) newSpectrum = true;
     }
+    if ( filter.isReady() ) events.signal(newSpectrum ? EVENT_NEW_SAMPLES | EVENT_NEW_SPECTRUM : EVENT_NEW_SAMPLES);
 }
 
 /** Read values from sensor function
  * 
- * @brief This function reads the values from the sensor and stores the values in its
- *        respective arrays.
+ * @brief This function reads the new samples of the sensor FIFO and stores them in the
+ *        batch arrays.
  * 
- * @see readData().
+ * @return Number of samples read.
+ * 
+ * @details The FIFO is only read when the sensor has signaled that it is almost full, so
+ *          all the samples are read in one I2C burst instead of one read per sample.
+ * 
+ * @see readData(), sensorFifo::check().
  * 
  */
-void globalDataReader::readValuesFromSensor ( )
+uint8_t globalDataReader::readValuesFromSensor ( )
 {
-    // read the value from the sensor
-    float valueIR = particleSensor.getIR();
-    float valueRed = particleSensor.getRed();
+    if ( !sensor.dataPending() ) return 0;
 
-    // add the new sample to the input data vector
-    inputIRData.push_back(valueIR); 
-    inputRedData.push_back(valueRed);
+    STAGE_TIMER(STAGE_SENSOR_READ);
+    sensor.check();
+    batchTime = sensor.getCheckTime();
+    batchOverflows = sensor.getOverflows();
+    uint8_t batchSize = 0;
+    while ( sensor.available() && batchSize < SENSOR_FIFO_DEPTH )
+    {
+        irBatch[batchSize] = sensor.getFIFOIR();
+        redBatch[batchSize] = sensor.getFIFORed();
+        sensor.nextSample();
+        batchSize++;
+    }
+    return batchSize;
+}
+
+/** Do decimation function
+ * 
+ * @brief This function pushes a sample of the sensor through the decimation.
+ * 
+ * @param valueIR IR sample, replaced by the decimated one if there is one.
+ * @param valueRed Red sample, replaced by the decimated one if there is one.
+ * 
+ * @return True if there is a sample at the rate of the analysis.
+ * 
+ * @see decimationChain::push().
+ * 
+ */
+bool globalDataReader::doDecimation ( float& valueIR, float& valueRed )
+{
+    STAGE_TIMER(STAGE_DECIMATION);
+    return decimator.push(valueIR, valueRed);
 }
 
 /** Do filtering function
  * 
- * @brief This function does the filtering of the input data and stores it.
+ * @brief This function does the filtering of the input data.
  * 
  * @param resultOfIR Result of the convolution of the filter and the IR array.
  * @param resultOfRed Result of the convolution of the filter and the Red array. 
  * 
+ * @see firFilter::filter(), biquadFilter::filter(), fixedFirFilter::filter().
+ * 
+ */
+void globalDataReader::doFiltering ( filterSample& resultOfIR, filterSample& resultOfRed )
+{
+    STAGE_TIMER(STAGE_FILTER);
+    filter.filter(resultOfIR, resultOfRed);
+}
+
+/** Store sample function
+ * 
+ * @brief This function stores a filtered sample in the block being filled.
+ * 
+ * @param resultOfIR Filtered IR sample.
+ * @param resultOfRed Filtered red sample.
+ * @param sequence Sequence number of the sample.
+ * @param sampleTime Time since boot when the sample was taken in ms.
+ * 
+ * @details When the block is full, it gets the statistics of the clock and the samples
+ *          lost inside it, and it is submitted to the analysis task, which is woken up. 
+ *          The next block is acquired with the next sample. If all the blocks are in use,
+ *          the analysis has fallen behind: the samples are skipped until a block is free,
+ *          and the overrun is counted and logged, so the sampler never waits. The 
+ *          samples are band-passed, so about half of them are negative: they are stored
+ *          as signed 32 bits integers.
+ * 
+ * @see readData(), analyzeData(), blockPool.
+ * 
+ */
+void globalDataReader::storeSample ( filterSample resultOfIR, filterSample resultOfRed, uint32_t sequence, uint32_t sampleTime )
+{
+    if ( currentBlock == NULL )
+    {
+        currentBlock = blocks.acquire();
+        if ( currentBlock == NULL )
+        {
+            if ( overrunSamples++ == 0 ) analysisOverruns++;
+            return;
+        }
+        if ( overrunSamples > 0 )
+        {
+            LOG_WARN("Analysis overrun: %u samples skipped", overrunSamples);
+            skippedSamples += overrunSamples;
+            overrunSamples = 0;
+        }
+        filteringIterations = 0;
+        currentBlock -> firstSample = sequence;
+    }
+
+    currentBlock -> irSamples[filteringIterations] = int32_t(resultOfIR);
+    currentBlock -> redSamples[filteringIterations] = int32_t(resultOfRed);
+    filteringIterations++;
+
+    //we have enough samples to send to the heart rate algorithm
+    if ( filteringIterations >= enoughSamples )
+    {
+        currentBlock -> sequence = blockSequence++;
+        currentBlock -> time = sampleTime;
+        currentBlock -> lostSamples = sequence - currentBlock -> firstSample + 1 - enoughSamples;
+        currentBlock -> clock = clock.getStats();
+        currentBlock -> sampleRate = currentBlock -> clock.rate / decimator.getFactor();
+        blocks.submit(currentBlock);
+        currentBlock = NULL;
+        xEventGroupSetBits(blockEvents, EVENT_BLOCK_READY);
+    }
+}
+
+/** Update spectrum function
+ * 
+ * @brief This function pushes a filtered sample to the sliding DFT and publishes the 
+ *        peaks of the spectrum every SPECTRUM_UPDATE_SAMPLES samples.
+ * 
+ * @param globalValuesVar Global values variable.
+ * @param resultOfIR Filtered IR sample.
+ * 
+ * @return True if a spectrum has been published.
+ * 
+ * @details The frequencies of the bins come from the measured sample rate, like the ones
+ *          of the FFT of the blocks. Nothing is published until the window is full.
+ * 
+ * @see readData(), slidingDft, peakExtractor, globalValues::publishSpectrum().
+ * 
  */
-void globalDataReader::doFiltering ( float& resultOfIR, float& resultOfRed )
+bool globalDataReader::updateSpectrum ( globalValues& globalValuesVar, filterSample resultOfIR )
 {
-    for (int n = enoughSamples; n >= 0; n--) 
+    STAGE_TIMER(STAGE_SPECTRUM);
+    spectrum.push(resultOfIR);
+    if ( ++spectrumSamples < SPECTRUM_UPDATE_SAMPLES ) return false;
+    spectrumSamples = 0;
+
+    const float* magnitudes = spectrum.magnitudes();
+    if ( magnitudes == NULL ) return false;
+    float step = clock.getRate() / decimator.getFactor() / spectrum.getLength();
+    spectrumPeaks.extract(magnitudes, spectrum.getBins(), spectrum.getFirstBin() * step, step);
+    globalValuesVar.publishSpectrum(spectrumPeaks.getPeaks(), spectrumPeaks.getPeaksCount());
+    return true;
+}
+
+/** Analyze data function
+ * 
+ * @brief This function analyzes the oldest block of filtered samples. It is called by the
+ *        analysis task.
+ *
+ * @param globalValuesVar Global values variable.
+ * @param events Events of the visualizer.
+ * @param timeout Maximum time to wait for a block in ms, portMAX_DELAY to wait forever.
+ * 
+ * @return True if a block has been analyzed, false if the timeout expired.
+ * 
+ * @details The block is sent to the heart rate algorithm and to the FFT, with the sample
+ *          rate measured while it was filled. With SLIDING_DFT, the spectrum comes from 
+ *          the sampler and the FFT is not computed. Then, the output
+ *          data is stored and published in the global values variable and printed, the 
+ *          visualizer is signaled and the block is given back to the sampler.
+ * 
+ * @see storeSample(), setGlobalValues(), printData(), fft(), globalValues::publish().
+ * 
+ */
+bool globalDataReader::analyzeData ( globalValues& globalValuesVar, visualizerEvents& events, uint32_t timeout )
+{
+    analysisBlock* block = blocks.take();
+    if ( block == NULL && timeout > 0 )
     {
-        resultOfIR += vCoefs[n] * inputIRData[inputIRData.size() - n - 1];
-        resultOfRed += vCoefs[n] * inputRedData[inputRedData.size() - n - 1];
-        
+        TickType_t ticks = timeout == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(timeout);
+        xEventGroupWaitBits(blockEvents, EVENT_BLOCK_READY, pdTRUE, pdFALSE, ticks);
+        block = blocks.take();
     }
-    // delete the oldest sample from the list
-    inputIRData.erase(inputIRData.begin()); 
-    inputRedData.erase(inputRedData.begin());
+    if ( block == NULL ) return false;
+
+    setGlobalValues(globalValuesVar, *block);
+    printData(*block);
+    if ( !SPECTRUM_USE_SLIDING_DFT ) fft(globalValuesVar, block -> irSamples, block -> sampleRate);
+    blocks.release(block);
+
+    globalValuesVar.publish();
+    events.signal(EVENT_NEW_BLOCK);
+    dataReady = true;
+    return true;
 }
 
 /** Set the global values
@@ -183,42 +430,85 @@ void globalDataReader::doFiltering ( float& resultOfIR, float& resultOfRed )
  * @brief This functions sets the global values with the calculated parameters.
  * 
  * @param globalValuesVar global values variable
+ * @param block Block of filtered samples.
  * 
  * @details This function sends the samples to the heart rate algorithm and, if the
  *         heart rate and the SPO2 are valid, it stores them in the global values 
- *        variable. If not, it stores a default value.
+ *        variable. If not, it stores a default value. The algorithm counts the samples
+ *        between beats at its fixed rate of FreqS Hz, so the heart rate is scaled by the
+ *        measured rate.
  * 
- * @see readData().
+ * @see analyzeData(), getHeartRateWindow().
  * 
  */
-void globalDataReader::setGlobalValues ( globalValues& globalValuesVar )
+void globalDataReader::setGlobalValues ( globalValues& globalValuesVar, analysisBlock& block )
 {
+    STAGE_TIMER(STAGE_HEART_RATE);
     // send samples to the heart rate algorithm
-    maxim_heart_rate_and_oxygen_saturation( irBuffer, enoughSamples /*200*/, redBuffer, 
+    uint16_t windowSize = getHeartRateWindow( block.irSamples, enoughSamples, irWindow );
+    getHeartRateWindow( block.redSamples, enoughSamples, redWindow );
+    maxim_heart_rate_and_oxygen_saturation( irWindow, windowSize, redWindow, 
                                             &spo2Percentage, &validSPO2, &heartRate, &validHeartRate);
     if ( validHeartRate && validSPO2 ){
+        heartRate = lroundf(heartRate * block.sampleRate / FreqS);
         globalValuesVar.setBeatsPerMinute(heartRate);
         globalValuesVar.setSpo2Percentage(spo2Percentage);
     } else {
         globalValuesVar.setSpo2Percentage(96);
     }
-    globalValuesVar.pushBackHeartRateDataArray( irBuffer, enoughSamples /*200*/ );
+    globalValuesVar.pushBackHeartRateDataArray( block.irSamples, enoughSamples /*200*/ );
+}
+
+/** Get heart rate window function
+ * 
+ * @brief This function prepares the samples of a block for the heart rate algorithm.
+ * 
+ * @param samples Filtered samples of a block.
+ * @param count Number of samples of the block.
+ * @param window Samples for the algorithm, BUFFER_SIZE at most.
+ * 
+ * @return Number of samples of the window.
+ * 
+ * @details The algorithm only has room for BUFFER_SIZE samples, so the window is the last
+ *          ones of the block. It takes unsigned samples and removes their mean with an 
+ *          unsigned sum, so the filtered samples, which are signed, are shifted by their
+ *          minimum to make them all positive.
+ * 
+ * @see setGlobalValues().
+ * 
+ */
+uint16_t globalDataReader::getHeartRateWindow ( const int32_t* samples, uint16_t count, uint32_t* window )
+{
+    uint16_t size = count < BUFFER_SIZE ? count : BUFFER_SIZE;
+    const int32_t* first = samples + count - size;
+    int32_t minimum = 0;
+    for (uint16_t i = 0; i < size; i++)
+    {
+        if ( i == 0 || first[i] < minimum ) minimum = first[i];
+    }
+    for (uint16_t i = 0; i < size; i++)
+    {
+        window[i] = uint32_t(int64_t(first[i]) - minimum);
+    }
+    return size;
 }
 
 /** Print data function
  * 
- * @brief This function prints the results calculated.
+ * @brief This function prints the results calculated and the sample clock of the block.
+ * 
+ * @param block Block analyzed.
  * 
- * @see setGlobalValues(), readData().
+ * @see setGlobalValues(), analyzeData().
  * 
 */
-void globalDataReader::printData ( )
+void globalDataReader::printData ( const analysisBlock& block )
 {
-    Serial.print("Heart rate: ");
-    Serial.print(heartRate);
-    Serial.print(" bpm / SpO2: ");
-    Serial.print(spo2Percentage);
-    Serial.println(" %"); 
+    STAGE_TIMER(STAGE_LOG);
+    LOG_INFO("Heart rate: %d bpm / SpO2: %d %%", heartRate, spo2Percentage);
+    LOG_INFO("Sample rate: %.2f Hz, jitter: %.2f ms, %u samples overflowed, %u dropped", 
+             block.clock.rate, block.clock.jitter, block.clock.overflows, block.clock.drops);
+    if ( block.lostSamples > 0 ) LOG_WARN("Block %u lost %u samples", block.sequence, block.lostSamples);
 }
 
 /** FFT function
@@ -226,67 +516,148 @@ void globalDataReader::printData ( )
  * @brief This function applies the FFT to the data.
  * 
  * @param globalValuesVar Global values variable.
- * @param SAMPLING_FREQUENCY Sampling frequency.
- * @param SAMPLES Number of samples.
+ * @param irSamples Filtered IR samples of a block.
+ * @param SAMPLING_FREQUENCY Measured sampling frequency in Hz.
  * 
- * @details This function applies the FFT to the data and stores the results in the
- *         global values variable.
+ * @details This function applies the FFT to the whole block, zero padded to the size of
+ *         the plan, and stores the results in the global values variable. With 
+ *         FIXED_POINT, the FFT is done in Q15. With ZOOM_SPECTRUM, the spectrum is the 
+ *         ZOOM_BINS bins from ZOOM_LOW_FREQUENCY to ZOOM_HIGH_FREQUENCY instead. With
+ *         WELCH_PSD, the block is added to the Welch PSD, and the peaks are only stored
+ *         again when it has changed enough. Only the MAX_PEAKS main peaks of the
+ *         spectrum are stored.
+ * 
+ * @see fftPlan::magnitudes(), fixedFft::magnitudes(), getZoomResults(), getWelchResults().
  * 
  */
-void globalDataReader::fft ( globalValues& globalValuesVar, uint8_t SAMPLES, uint8_t SAMPLING_FREQUENCY )
+void globalDataReader::fft ( globalValues& globalValuesVar, const int32_t* irSamples, float SAMPLING_FREQUENCY )
 {
-    Serial.println("Computing FFT...");
-    
-    /***TODO: GET 4 MAX AND SHOW ITS HZ IN DISPLAY*/
-
-    arduinoFFT FFT = arduinoFFT();
-    double vReal[SAMPLES];
-    double vImag[SAMPLES];
-    for (int i = 0; i < SAMPLES; i++)
+    LOG_DEBUG("Computing FFT...");
+
+    if ( SPECTRUM_USE_ZOOM )
     {
-        vReal[i] = irBuffer[i];
-        vImag[i] = 0;
+        uint8_t count = getZoomResults( irSamples, ZOOM_LOW_FREQUENCY, ZOOM_HIGH_FREQUENCY, ZOOM_BINS, SAMPLING_FREQUENCY );
+        globalValuesVar.setFreqs( blockPeaks.getPeaks(), count );
+        return;
+    }
+    if ( SPECTRUM_USE_WELCH )
+    {
+        if ( getWelchResults( irSamples, SAMPLING_FREQUENCY ) ) 
+            globalValuesVar.setFreqs( blockPeaks.getPeaks(), blockPeaks.getPeaksCount() );
+        return;
     }
 
-    FFT.Compute(vReal, vImag, SAMPLES, FFT_FORWARD);
-    FFT.ComplexToMagnitude(vReal, vImag, SAMPLES);
-    vReal[0] = 0; // Remove the DC component
+    const float* magnitudes = NULL;
+    {
+        STAGE_TIMER(STAGE_FFT);
+        magnitudes = transform.magnitudes(irSamples);
+    }
+    if ( magnitudes == NULL ) return;
 
-    vector<fundamentalsFreqs> fftResults = getFFTResults( vReal, SAMPLES, SAMPLING_FREQUENCY );
-    globalValuesVar.setFreqs( fftResults );
+    STAGE_TIMER(STAGE_PEAKS);
+    uint8_t count = getFFTResults( magnitudes, transform.getSize(), SAMPLING_FREQUENCY );
+    globalValuesVar.setFreqs( blockPeaks.getPeaks(), count );
 }
 
 /** Get FFT results function
  * 
- * @brief This function gets the FFT results.
+ * @brief This function gets the main peaks of the FFT.
  * 
- * @param vReal Real part of the FFT.
- * @param SAMPLES Number of samples.
+ * @param magnitudes Magnitudes of the first FFT_SIZE / 2 bins of the FFT.
+ * @param FFT_SIZE Number of points of the FFT.
  * @param SAMPLING_FREQUENCY Sampling frequency.
  * 
- * @return Vector of fundamentals frequencies.
+ * @return Number of fundamentals frequencies, at most MAX_PEAKS, without the DC component.
+ *         They are the peaks of blockPeaks, from the highest one, so nothing is allocated.
+ * 
+ * @see peakExtractor::extract().
  * 
  */
-vector<fundamentalsFreqs> globalDataReader::getFFTResults ( double* vReal, uint8_t SAMPLES, uint8_t SAMPLING_FREQUENCY )
+uint8_t globalDataReader::getFFTResults ( const float* magnitudes, uint16_t FFT_SIZE, float SAMPLING_FREQUENCY )
 {
-    Serial.println("FFT results:");
+    LOG_DEBUG("FFT results:");
 
-    vector<fundamentalsFreqs> freqs;
-    for (int i = 0; i < SAMPLES / 2; i++)
+    uint8_t count = blockPeaks.extract(magnitudes, FFT_SIZE / 2, 0, SAMPLING_FREQUENCY / FFT_SIZE);
+    for (uint8_t i = 0; i < count; i++)
     {
-        float frequency = float(i) * SAMPLING_FREQUENCY / SAMPLES;
-        float magnitude = vReal[i];
-        fundamentalsFreqs x;
-        x.amplitude=magnitude;
-        x.freqsHz=frequency;
-        freqs.push_back(x);
-        
-        Serial.print("Frequency: ");
-        Serial.print(frequency);
-        Serial.print(" Hz, Magnitude: ");
-        Serial.println(magnitude);
+        LOG_DEBUG("Frequency: %.2f Hz, Magnitude: %.2f", blockPeaks.getPeaks()[i].freqsHz, blockPeaks.getPeaks()[i].amplitude);
     }
-    return freqs;
+    return count;
+}
+
+/** Get zoom results function
+ * 
+ * @brief This function gets the spectrum of a block in a band.
+ * 
+ * @param irSamples Filtered IR samples of a block.
+ * @param lowFrequency Frequency of the first bin in Hz.
+ * @param highFrequency Frequency of the last bin in Hz.
+ * @param bins Number of bins, from 2 to MAX_FREQS.
+ * @param SAMPLING_FREQUENCY Sampling frequency.
+ * 
+ * @return Number of fundamentals frequencies, at most MAX_PEAKS, 0 if the band is not
+ *         valid. They are the peaks of blockPeaks, the main ones of the band.
+ * 
+ * @details The samples are taken without their mean and with the window of the FFT, so
+ *          the magnitudes are comparable with the ones of the FFT. The band can change in
+ *          every call, at the cost of one more FFT.
+ * 
+ * @see chirpZ::magnitudes(), peakExtractor::extract().
+ * 
+ */
+uint8_t globalDataReader::getZoomResults ( const int32_t* irSamples, float lowFrequency, float highFrequency, 
+                                           uint16_t bins, float SAMPLING_FREQUENCY )
+{
+    const float* magnitudes = NULL;
+    {
+        STAGE_TIMER(STAGE_FFT);
+        magnitudes = zoom.magnitudes(irSamples, lowFrequency, highFrequency, bins, SAMPLING_FREQUENCY);
+    }
+    if ( magnitudes == NULL ) return 0;
+
+    STAGE_TIMER(STAGE_PEAKS);
+    float step = (highFrequency - lowFrequency) / (bins - 1);
+    return blockPeaks.extract(magnitudes, bins, lowFrequency, step);
+}
+
+/** Get Welch results function
+ * 
+ * @brief This function adds a block to the Welch PSD and gets its main peaks if it has
+ *        changed enough since they were last taken.
+ * 
+ * @param irSamples Filtered IR samples of a block, following the ones of the last block.
+ * @param SAMPLING_FREQUENCY Measured sampling frequency in Hz.
+ * 
+ * @return True if the PSD has changed by WELCH_CHANGE_THRESHOLD or more, or if its peaks
+ *         had not been taken yet, in which case they are the peaks of blockPeaks, false 
+ *         if the block completed no segment or if the last peaks are still valid.
+ * 
+ * @details The peaks are interpolated on the density, so their amplitudes are powers per
+ *          Hz. The change of the density, the stability metric of the spectrum, is
+ *          measured against the one of the last peaks taken, so a spectrum that drifts
+ *          slowly is also published again.
+ * 
+ * @see welchPsd, peakExtractor::extract().
+ * 
+ */
+bool globalDataReader::getWelchResults ( const int32_t* irSamples, float SAMPLING_FREQUENCY )
+{
+    uint8_t segments = 0;
+    {
+        STAGE_TIMER(STAGE_FFT);
+        segments = welch.push(irSamples, enoughSamples, SAMPLING_FREQUENCY);
+    }
+    const float* density = welch.getDensity();
+    if ( segments == 0 || density == NULL ) return false;
+
+    STAGE_TIMER(STAGE_PEAKS);
+    float change = welch.getChange();
+    LOG_DEBUG("Welch PSD: %u new segments, change %.3f", segments, change);
+    if ( change < WELCH_CHANGE_THRESHOLD ) return false;
+
+    blockPeaks.extract(density, welch.getBins(), 0, SAMPLING_FREQUENCY / welch.getLength());
+    welch.setReference();
+    return true;
 }
 
 /** Is data ready function
@@ -299,4 +670,45 @@ vector<fundamentalsFreqs> globalDataReader::getFFTResults ( double* vReal, uint8
 bool globalDataReader::isDataReady()
 {
     return dataReady;
+}
+
+/** Get analysis overruns function
+ * 
+ * @brief This function returns the number of times the analysis fell behind and the 
+ *        sampler found no free block.
+ * 
+ * @return Number of analysis overruns.
+ * 
+ */
+uint32_t globalDataReader::getAnalysisOverruns ( )
+{
+    return analysisOverruns;
+}
+
+/** Get skipped samples function
+ * 
+ * @brief This function returns the number of filtered samples skipped by the finished 
+ *        analysis overruns.
+ * 
+ * @return Number of skipped samples.
+ * 
+ */
+uint32_t globalDataReader::getSkippedSamples ( )
+{
+    return skippedSamples;
+}
+
+/** Get clock stats function
+ * 
+ * @brief This function returns the statistics of the sample clock.
+ * 
+ * @return Measured sample rate, jitter, overflows and drops.
+ * 
+ * @note The clock is updated by the sampler task, so the statistics of the blocks are
+ *       preferred from the other tasks, as they are taken at once.
+ * 
+ */
+sampleClockStats globalDataReader::getClockStats ( )
+{
+    return clock.getStats();
 }
\ No newline at end of file
@@ -2,86 +2,300 @@
 #define DATAREADER_H
 
 #include <Arduino.h>
-#include <Wire.h>
 #include <vector>
 #include <SPIFFS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
 
-#include "MAX30105.h"
 #include "heartRate.h"
-#include "arduinoFFT.h"
 #include "spo2_algorithm.h"
 
+#include "BlockPool.h"
 #include "GlobalValues.h"
+#include "Logger.h"
+#include "BiquadFilter.h"
+#include "ChirpZ.h"
+#include "FirFilter.h"
+#include "FixedFft.h"
+#include "FixedFirFilter.h"
+#include "CoefficientSet.h"
+#include "DecimationChain.h"
+#include "FftPlan.h"
+#include "PeakExtractor.h"
+#include "SampleClock.h"
+#include "SensorFifo.h"
+#include "SlidingDft.h"
+#include "StageMetrics.h"
+#include "VisualizerEvents.h"
+#include "WelchPsd.h"
+
+// FILTER IIR : define FILTER_IIR (e.g. in build_flags) to filter with the cascade of second
+// order sections of data/sections.txt instead of the FIR of data/coefficients.txt.
+// #define FILTER_IIR
+
+// FIXED POINT : define FIXED_POINT (e.g. in build_flags) to filter the samples as 32 bits
+// integers with Q31 coefficients and to compute the FFT in Q15, instead of float and double.
+// #define FIXED_POINT
+
+// SLIDING DFT : define SLIDING_DFT (e.g. in build_flags) to update the spectrum of the 
+// cardiac band with every filtered sample, instead of the FFT of each block.
+// #define SLIDING_DFT
+
+// ZOOM SPECTRUM : define ZOOM_SPECTRUM (e.g. in build_flags) to compute the spectrum of each
+// block only in the heart rate band, with ZOOM_BINS bins, instead of the FFT of all the band.
+// #define ZOOM_SPECTRUM
+
+// WELCH PSD : define WELCH_PSD (e.g. in build_flags) to average the power spectral density
+// of overlapping segments over the blocks, instead of the FFT of each block alone.
+// #define WELCH_PSD
+
+#if defined(FIXED_POINT) && defined(FILTER_IIR)
+#error "FIXED_POINT only has the FIR filter, FILTER_IIR cannot be used with it"
+#endif
+
+#if defined(ZOOM_SPECTRUM) && defined(SLIDING_DFT)
+#error "ZOOM_SPECTRUM zooms the spectrum of the blocks, which is not computed with SLIDING_DFT"
+#endif
+
+#if defined(WELCH_PSD) && (defined(SLIDING_DFT) || defined(ZOOM_SPECTRUM))
+#error "WELCH_PSD replaces the FFT of the blocks, it cannot be used with SLIDING_DFT or ZOOM_SPECTRUM"
+#endif
 
 namespace std
 {
+#ifdef FIXED_POINT
+    // Type of the samples of the filter
+    typedef int32_t filterSample;
+#else
+    // Type of the samples of the filter
+    typedef float filterSample;
+#endif
+#ifdef FILTER_IIR
+    const bool FILTER_USE_IIR = true;
+    // Binary file of the filter in the file system
+    const char FILTER_FILE[] = "/sections.bin";
+#else
+    const bool FILTER_USE_IIR = false;
+    // Binary file of the filter in the file system
+    const char FILTER_FILE[] = "/coefficients.bin";
+#endif
+#ifdef SLIDING_DFT
+    const bool SPECTRUM_USE_SLIDING_DFT = true;
+#else
+    const bool SPECTRUM_USE_SLIDING_DFT = false;
+#endif
+#ifdef ZOOM_SPECTRUM
+    const bool SPECTRUM_USE_ZOOM = true;
+#else
+    const bool SPECTRUM_USE_ZOOM = false;
+#endif
+#ifdef WELCH_PSD
+    const bool SPECTRUM_USE_WELCH = true;
+#else
+    const bool SPECTRUM_USE_WELCH = false;
+#endif
+    // Window of the samples of the FFT
+    const fftWindow FFT_ANALYSIS_WINDOW = FFT_WINDOW_HANN;
+    // Samples of the window of the sliding DFT, about 10 s at 25 Hz
+    const uint16_t SLIDING_DFT_LENGTH = 256;
+    // Lowest frequency of the sliding DFT in Hz (30 bpm)
+    const float SPECTRUM_LOW_FREQUENCY = 0.5;
+    // Highest frequency of the sliding DFT in Hz (240 bpm)
+    const float SPECTRUM_HIGH_FREQUENCY = 4.0;
+    // Filtered samples between the spectra published by the sliding DFT
+    const uint8_t SPECTRUM_UPDATE_SAMPLES = 5;
+    // Frequency of the first bin of the zoom spectrum in Hz (42 bpm)
+    const float ZOOM_LOW_FREQUENCY = 0.7;
+    // Frequency of the last bin of the zoom spectrum in Hz (210 bpm)
+    const float ZOOM_HIGH_FREQUENCY = 3.5;
+    // Bins of the zoom spectrum, about 2.7 bpm apart
+    const uint16_t ZOOM_BINS = 64;
+    // Part of a segment of the Welch PSD shared with the next one
+    const float WELCH_OVERLAP = 0.5;
+    // Segments of the average of the Welch PSD, about 50 s at 25 Hz with 256 samples
+    const uint8_t WELCH_DEPTH = 8;
+    // Average of the segments of the Welch PSD
+    const welchAverage WELCH_AVERAGE = WELCH_AVERAGE_EXPONENTIAL;
+    // Change of the Welch PSD, relative to the last one published, to publish its peaks again
+    const float WELCH_CHANGE_THRESHOLD = 0.1;
+    // Number of blocks of the pool: one being filled, one waiting and one being analyzed
+    const size_t ANALYSIS_BLOCKS = 3;
+    // A block of filtered samples is waiting for the analysis
+    const EventBits_t EVENT_BLOCK_READY = 0x01;
+
+    /** Analysis block struct
+     * 
+     * @brief This struct is a block of filtered samples handed to the analysis.
+     * 
+     * @param irSamples Filtered IR samples
+     * @param redSamples Filtered red samples
+     * @param sequence Number of blocks filled before this one since the start
+     * @param time Time since boot of the last sample in ms
+     * @param firstSample Sequence number of the first sample
+     * @param lostSamples Samples lost between the first and the last sample
+     * @param sampleRate Measured rate of the samples of the block in Hz
+     * @param clock Statistics of the sample clock of the sensor when the block was filled
+     *
+     */
+    struct analysisBlock{
+        int32_t irSamples[MAX_BLOCK_SAMPLES];
+        int32_t redSamples[MAX_BLOCK_SAMPLES];
+        uint32_t sequence;
+        uint32_t time;
+        uint32_t firstSample;
+        uint32_t lostSamples;
+        float sampleRate;
+        sampleClockStats clock;
+    };
+
     /** Global data reader class
      *
      * @brief This class is the global data reader of the device.
      *
-     * @details This class is used to manage the global data reader of the device.
+     * @details This class is used to manage the global data reader of the device. The
+     *          acquisition and the filtering run in the sampler task with readData(), which
+     *          fills the blocks of the pool, and the heart rate, the SpO2 and the FFT run in
+     *          the analysis task with analyzeData(). If the analysis falls behind, the
+     *          sampler skips the samples until a block is free and counts the overrun.
+     *          With SLIDING_DFT, the spectrum is updated by the sampler with every sample
+     *          instead of by the analysis with each block, with ZOOM_SPECTRUM the
+     *          spectrum of each block only covers the heart rate band, and with WELCH_PSD
+     *          it is averaged over the blocks.
      *
-     * @param particleSensor MAX30105 object
-     * @param enoughSamples Number of samples to be taken
-     * @param irBuffer IR buffer
-     * @param redBuffer Red buffer
-     * @param vCoefs Coefficients of the filter
+     * @param sensor FIFO of the pulse sensor
+     * @param enoughSamples Number of samples of a block, at most MAX_BLOCK_SAMPLES
+     * @param blocks Pool of the blocks from the sampler to the analysis
+     * @param currentBlock Block being filled by the sampler, NULL if none was free
+     * @param blockSequence Sequence number of the next block
+     * @param blockEvents Event group that wakes the analysis task
+     * @param analysisOverruns Number of times the sampler found no free block
+     * @param skippedSamples Number of filtered samples skipped by the overruns
+     * @param overrunSamples Samples skipped by the current overrun
+     * @param irBatch IR samples read from the sensor FIFO
+     * @param redBatch Red samples read from the sensor FIFO
+     * @param batchOverflows Samples lost by the sensor FIFO before the batch
+     * @param clock Clock of the samples of the sensor, with the measured sample rate
+     * @param decimator Decimation from the rate of the sensor to the rate of the analysis
+     * @param coefficients Coefficients of the filter
+     * @param filter Band pass filter of the IR and red channels, FIR or IIR with FILTER_IIR,
+     *               in fixed point with FIXED_POINT
+     * @param transform Plan of the FFT of the blocks, in Q15 with FIXED_POINT
+     * @param zoom Chirp Z transform of the heart rate band of the blocks, with ZOOM_SPECTRUM
+     * @param spectrum Sliding DFT of the cardiac band, with SLIDING_DFT
+     * @param spectrumSamples Filtered samples since the last spectrum of the sliding DFT
+     * @param welch Welch PSD of the blocks, with WELCH_PSD
+     * @param blockPeaks Peaks of the spectrum of the blocks, used by the analysis task
+     * @param spectrumPeaks Peaks of the spectrum of the sliding DFT, used by the sampler task
      * @param bufferLenght Buffer length
      * @param spo2Percentage SPO2 percentage
      * @param heartRate Heart rate
      * @param validSPO2 Valid SPO2
      * @param validHeartRate Valid heart rate
-     * @param inputIRData Input IR data
-     * @param inputRedData Input red data
-     * @param filteringIterations Filtering iterations
+     * @param filteringIterations Samples of the current block
      * @param dataReady Data ready
+     * @param firstSampleTime Time since boot of the first sample in ms
+     * @param batchTime Time of the last batch read from the sensor FIFO in ms
      *
      */
     class globalDataReader {
         // sensor
-        MAX30105 particleSensor;
+        sensorFifo& sensor;
 
         // variables for data reading
         int enoughSamples;
-        uint32_t* irBuffer;
-        uint32_t* redBuffer;
-        float* vCoefs;
         int32_t bufferLenght, spo2Percentage, heartRate;
         int8_t validSPO2, validHeartRate;
+        uint32_t irBatch[SENSOR_FIFO_DEPTH];
+        uint32_t redBatch[SENSOR_FIFO_DEPTH];
+        uint32_t irWindow[BUFFER_SIZE];
+        uint32_t redWindow[BUFFER_SIZE];
+        uint8_t batchOverflows = 0;
+        sampleClock clock;
+        decimationChain decimator;
+
+        // analysis blocks
+        blockPool<analysisBlock, ANALYSIS_BLOCKS> blocks;
+        analysisBlock* currentBlock = NULL;
+        uint32_t blockSequence = 0;
+        EventGroupHandle_t blockEvents = NULL;
+        uint32_t analysisOverruns = 0;
+        uint32_t skippedSamples = 0;
+        uint32_t overrunSamples = 0;
 
         // filter variables
-        vector<float> inputIRData;
-        vector<float> inputRedData;
+        coefficientSet coefficients;
+#if defined(FILTER_IIR)
+        biquadFilter filter;
+#elif defined(FIXED_POINT)
+        fixedFirFilter filter;
+#else
+        firFilter filter;
+#endif
+#ifdef FIXED_POINT
+        fixedFft transform;
+#else
+        fftPlan transform;
+#endif
+        chirpZ zoom;
+        slidingDft spectrum;
+        uint8_t spectrumSamples = 0;
+        welchPsd welch;
+        peakExtractor blockPeaks;
+        peakExtractor spectrumPeaks;
         int filteringIterations = 0; 
 
         // Confrimation variables
         bool dataReady = false;
+        uint32_t firstSampleTime = 0;
+        uint32_t batchTime = 0;
 
         public:
-            globalDataReader ( int pEnoughSamples = 200 );
+            globalDataReader ( sensorFifo& pSensor, int pEnoughSamples = 200 );
+
+            ~globalDataReader ();
+
+            void setup ( uint8_t SAMPLING_FREQUENCY = 25, uint16_t FFT_SIZE = 256 );
+
+            void loadCoefficients ();
+
+            bool readFile ( String fileName = FILTER_FILE );
+
+            void readData ( globalValues& globalValuesVar, visualizerEvents& events );
 
-            void setup ();
+            uint8_t readValuesFromSensor ();
 
-            void initMAX30102 ( byte ledBrightness = 0x1F, byte sampleAverage = 4, byte ledMode = 3, 
-                                int sampleRate = 3200, int pulseWidth = 411, int adcRange = 4096 );
+            bool doDecimation ( float& valueIR, float& valueRed );
 
-            void readFile ( String fileName = "/coefficients.txt" );
+            void doFiltering ( filterSample& resultOfIR, filterSample& resultOfRed );
 
-            void readData ( globalValues& globalValuesVar, uint8_t SAMPLES, uint8_t SAMPLING_FREQUENCY );
+            void storeSample ( filterSample resultOfIR, filterSample resultOfRed, uint32_t sequence, uint32_t sampleTime );
 
-            void readValuesFromSensor ();
+            bool updateSpectrum ( globalValues& globalValuesVar, filterSample resultOfIR );
 
-            void doFiltering ( float& resultOfIR, float& resultOfRed );
+            bool analyzeData ( globalValues& globalValuesVar, visualizerEvents& events, uint32_t timeout = portMAX_DELAY );
 
-            void setGlobalValues ( globalValues& globalValuesVar );
+            void setGlobalValues ( globalValues& globalValuesVar, analysisBlock& block );
+
+            static uint16_t getHeartRateWindow ( const int32_t* samples, uint16_t count, uint32_t* window );
             
-            void printData ();
+            void printData ( const analysisBlock& block );
+
+            void fft ( globalValues& globalValuesVar, const int32_t* irSamples, float SAMPLING_FREQUENCY );
+
+            uint8_t getFFTResults ( const float* magnitudes, uint16_t FFT_SIZE, float SAMPLING_FREQUENCY );
 
-            void fft ( globalValues& globalValuesVar, uint8_t SAMPLES, uint8_t SAMPLING_FREQUENCY );
+            uint8_t getZoomResults ( const int32_t* irSamples, float lowFrequency, float highFrequency, 
+                                     uint16_t bins, float SAMPLING_FREQUENCY );
 
-            vector<fundamentalsFreqs> getFFTResults ( double* vReal, uint8_t SAMPLES, uint8_t SAMPLING_FREQUENCY );
+            bool getWelchResults ( const int32_t* irSamples, float SAMPLING_FREQUENCY );
 
             bool isDataReady ();
+
+            uint32_t getAnalysisOverruns ();
+
+            uint32_t getSkippedSamples ();
+
+            sampleClockStats getClockStats ();
     };
 }
 
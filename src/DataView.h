@@ -0,0 +1,77 @@
+#ifndef DATAVIEW_H
+#define DATAVIEW_H
+
+#include <stddef.h>
+
+namespace std
+{
+    /** Data view class
+     *
+     * @brief This class is a read only view of values stored somewhere else.
+     *
+     * @details The values can be split in two contiguous segments, so a view can cover 
+     *          a ring buffer that wraps around without copying it. Creating and reading
+     *          a view never allocates memory. A view is only valid until the values it
+     *          points to are modified.
+     *
+     * @param first First segment
+     * @param firstSize Number of values of the first segment
+     * @param second Second segment
+     * @param secondSize Number of values of the second segment
+     *
+     */
+    template <typename T>
+    class dataView {
+        const T* first;
+        size_t firstSize;
+        const T* second;
+        size_t secondSize;
+
+        public:
+            dataView () : first(NULL), firstSize(0), second(NULL), secondSize(0) {}
+
+            dataView ( const T* pFirst, size_t pFirstSize, const T* pSecond = NULL, size_t pSecondSize = 0 ) :
+                       first(pFirst), firstSize(pFirstSize), second(pSecond), secondSize(pSecondSize) {}
+
+            /** [] operator
+             *
+             * @brief This function returns a value of the view.
+             *
+             * @param i Index of the value.
+             *
+             * @return Value.
+             *
+             */
+            const T& operator [] ( size_t i ) const
+            {
+                if ( i < firstSize ) return first[i];
+                return second[i - firstSize];
+            }
+
+            /** Size function
+             *
+             * @brief This function returns the number of values of the view.
+             *
+             * @return Number of values.
+             *
+             */
+            size_t size () const
+            {
+                return firstSize + secondSize;
+            }
+
+            /** Empty function
+             *
+             * @brief This function returns if the view has no values.
+             *
+             * @return True if the view is empty, false if not.
+             *
+             */
+            bool empty () const
+            {
+                return size() == 0;
+            }
+    };
+}
+
+#endif /* DATAVIEW_H */
@@ -20,7 +20,8 @@ using namespace std;
  */
 globalDataVisualizer::globalDataVisualizer ( const u8g2_cb_t *rotation, uint8_t clock, 
                                              uint8_t data, uint8_t cs, uint8_t dc, uint8_t reset, int port ):
-                                             display(rotation, clock, data, cs, dc, reset ), page(port), buttons(){}
+                                             display(rotation, clock, data, cs, dc, reset ), page(port), 
+                                             normalizedAmplitudes(MAX_PEAKS), buttons(){}
 
 /** Setup function
  * 
@@ -37,44 +38,202 @@ void globalDataVisualizer::setup ( vector<int> buttonPins, const char* ssid, con
 {
     buttons.begin(buttonPins);
     display.init();
+    discretizedData.resize(display.getDataWindowSize());
     page.begin(ssid, password);
 }
 
+/** Set waveform streaming function
+ * 
+ * @brief This function sets how the filtered samples are streamed to the web page.
+ *
+ * @param batchSize Number of filtered samples sent in each message.
+ * @param period Time between checks of the waveform stream in ms.
+ * 
+ * @details A bigger batch means less messages but more latency. At 25 Hz, the default 
+ *          batch of 5 samples is sent every 200 ms.
+ * 
+ * @see streamWaveform().
+ * 
+ */
+void globalDataVisualizer::setWaveformStreaming ( uint16_t batchSize, uint16_t period )
+{
+    if ( batchSize == 0 ) batchSize = 1;
+    if ( batchSize > MAX_WAVEFORM_BATCH ) batchSize = MAX_WAVEFORM_BATCH;
+    this -> waveformBatchSize = batchSize;
+    this -> waveformPeriod = period;
+}
+
+/** Set refresh periods function
+ * 
+ * @brief This function sets how often the display and the web page can be refreshed.
+ *
+ * @param pDisplayPeriod Minimum time between display refreshes in ms.
+ * @param pWebPeriod Minimum time between values sent to the web page in ms.
+ * 
+ * @details They are only refreshed when there is new data, so these periods limit how often
+ *          it happens when the data changes quickly.
+ * 
+ * @see generateVisualization(), setWaveformStreaming().
+ * 
+ */
+void globalDataVisualizer::setRefreshPeriods ( uint16_t pDisplayPeriod, uint16_t pWebPeriod )
+{
+    this -> displayPeriod = pDisplayPeriod;
+    this -> webPeriod = pWebPeriod;
+}
+
 /** Work in progress message function
  * 
  * @brief This function displays a message in the display.
  * 
- * @see generateVisualization().
+ * @see generateDisplayVisualization().
  * 
  */
 void globalDataVisualizer::workInProgressMessage()
 {
     display.firstPage();
-    while(display.nextPage()){
+    do {
         display.setFont(u8g2_font_luBS10_tf);
         display.setCursor(uint8_t(display.getDisplayWidth()/5), uint8_t(2*display.getDisplayHeight()/3));
         display.print("Calculating...");
-    }
+    } while(display.nextPage());
 }
 
 /** Generate visualization function
  * 
- * @brief This function generates the visualization.
+ * @brief This function waits for new data and generates the visualization.
  *
  * @param globalValuesVar Global values.
+ * @param events Events of the visualizer.
+ * 
+ * @details This function sleeps until the reader or the buttons signal an event, or until the next refresh is due. When
+ *          a new block is published, the newest values are taken and both the display and the web page are refreshed, but the
+ *          frequencies are only drawn again if they have changed since the last block. The spectrum is sent with every
+ *          values frame, so a frame replaced in the queue of a slow client never takes it away. A new
+ *          spectrum of the sliding DFT refreshes the web page, and the display if it shows the frequencies. A mode 
+ *          change only refreshes the display, and the new filtered samples are streamed to the web page. Each refresh runs 
+ *          at most once per its period. While there are more samples than fit in the display, the heart rate data is shifted
+ *          every HEART_RATE_SCROLL_PERIOD ms.
  * 
- * @details This function generates the visualization. It generates the display visualization and the web page visualization.
+ * @see globalValues::update(), globalValues::updateSpectrum(), generateDisplayVisualization(), sendValues(), 
+ *      streamWaveform().
  * 
  */
-void globalDataVisualizer::generateVisualization( globalValues& globalValuesVar )
+void globalDataVisualizer::generateVisualization( globalValues& globalValuesVar, visualizerEvents& events )
 {
-    generateDisplayVisualization(globalValuesVar);
+    EventBits_t newEvents = events.wait(EVENT_ALL, getTimeToNextRefresh(globalValuesVar, millis()));
+    uint32_t now = millis();
+
+    if ( (newEvents & EVENT_NEW_BLOCK) && globalValuesVar.update() )
+    {
+        bool newFreqs = !hasValues || globalValuesVar.getFreqsSequence() != freqsSequence;
+        freqsSequence = globalValuesVar.getFreqsSequence();
+        hasValues = true;
+        if ( newFreqs || !buttons[2].order ) displayPending = true;
+        valuesPending = true;
+    }
+    if ( (newEvents & EVENT_NEW_SPECTRUM) && globalValuesVar.updateSpectrum() && hasValues )
+    {
+        if ( buttons[2].order ) displayPending = true;
+        valuesPending = true;
+    }
+    if ( newEvents & EVENT_MODE_CHANGE ) displayPending = true;
+    if ( page.takeNewClient() && hasValues ) valuesPending = true;
+
+    if ( hasValues && getRemainingTime(lastScrollTime, HEART_RATE_SCROLL_PERIOD, now) == 0 &&
+         globalValuesVar.getHeartRateDataArray().size() > display.getDataWindowSize() )
+    {
+        globalValuesVar.shiftHeartRate();
+        lastScrollTime = now;
+        displayPending = true;
+    }
 
-    String jsonMessage = getJSON(globalValuesVar);
-    page.sendWsMessage(jsonMessage);  
-   
-    globalValuesVar.shiftHeartRate();
-    delay(700);
+    if ( displayPending && getRemainingTime(lastDisplayTime, displayPeriod, now) == 0 )
+    {
+        generateDisplayVisualization(globalValuesVar);
+        displayPending = false;
+        lastDisplayTime = now;
+    }
+    if ( valuesPending && getRemainingTime(lastWebTime, webPeriod, now) == 0 )
+    {
+        sendValues(globalValuesVar);
+        valuesPending = false;
+        lastWebTime = now;
+    }
+    if ( getRemainingTime(lastStreamTime, waveformPeriod, now) == 0 )
+    {
+        streamWaveform(globalValuesVar);
+        lastStreamTime = now;
+    }
+}
+
+/** Get time to next refresh function
+ * 
+ * @brief This function gets how long the visualizer can sleep.
+ *
+ * @param globalValuesVar Global values.
+ * @param now Time since boot in ms.
+ * 
+ * @return Time until the next pending refresh is due in ms, portMAX_DELAY if nothing is pending.
+ * 
+ * @see generateVisualization().
+ * 
+ */
+uint32_t globalDataVisualizer::getTimeToNextRefresh ( globalValues& globalValuesVar, uint32_t now )
+{
+    uint32_t timeout = portMAX_DELAY;
+    if ( displayPending ) 
+        timeout = min(timeout, getRemainingTime(lastDisplayTime, displayPeriod, now));
+    if ( valuesPending ) 
+        timeout = min(timeout, getRemainingTime(lastWebTime, webPeriod, now));
+    if ( hasValues && globalValuesVar.getHeartRateDataArray().size() > display.getDataWindowSize() )
+        timeout = min(timeout, getRemainingTime(lastScrollTime, HEART_RATE_SCROLL_PERIOD, now));
+    if ( globalValuesVar.getPendingWaveformSamples() >= waveformBatchSize || page.hasQueuedMessages() )
+        timeout = min(timeout, getRemainingTime(lastStreamTime, waveformPeriod, now));
+    return timeout;
+}
+
+/** Get remaining time function
+ * 
+ * @brief This function gets the time until a period is over.
+ *
+ * @param lastTime Time when the period started in ms.
+ * @param period Period in ms.
+ * @param now Time since boot in ms.
+ * 
+ * @return Remaining time in ms, 0 if the period is over.
+ * 
+ */
+uint32_t globalDataVisualizer::getRemainingTime ( uint32_t lastTime, uint32_t period, uint32_t now )
+{
+    uint32_t elapsed = now - lastTime;
+    return elapsed >= period ? 0 : period - elapsed;
+}
+
+/** Send values function
+ * 
+ * @brief This function sends the values of the last block to the web page.
+ *
+ * @param globalValuesVar Global values.
+ * 
+ * @details The values are sent in JSON or binary depending on the protocol of each client.
+ * 
+ * @see getJSON(), getBinaryFrame().
+ * 
+ */
+void globalDataVisualizer::sendValues ( globalValues& globalValuesVar )
+{
+    STAGE_TIMER(STAGE_WEB_SEND);
+    if (page.hasClient(WS_PROTOCOL_JSON))
+    {
+        const textBuffer<JSON_BUFFER_SIZE>& jsonMessage = getJSON(globalValuesVar);
+        page.sendWsMessage(jsonMessage.c_str(), jsonMessage.size());  
+    }
+    if (page.hasClient(WS_PROTOCOL_BINARY))
+    {
+        frameEncoder& frame = getBinaryFrame(globalValuesVar);
+        page.sendWsBinary(frame.getData(), frame.size());
+    }
 }
 
 /** Generate display visualization function
@@ -83,29 +242,35 @@ void globalDataVisualizer::generateVisualization( globalValues& globalValuesVar
  *
  * @param globalValuesVar Global values.
  * 
+ * @details Until the first block of values is received, the work in progress message is shown.
+ * 
  * @see defaultDataVisualitzation(), frequenciesDataVisualitzation().
  */
 void globalDataVisualizer::generateDisplayVisualization ( globalValues& globalValuesVar )
 {
+    STAGE_TIMER(STAGE_DISPLAY);
+    if ( !hasValues )
+    {
+        workInProgressMessage();
+        return;
+    }
+    LOG_DEBUG("Display visualizing: %s", buttons[0].order ? "Heart Rate" : 
+              buttons[1].order ? "SPO2" : buttons[2].order ? "Frequencies" : "none");
     display.firstPage();
-    while (display.nextPage()) 
+    do
     {
-        Serial.println("Display visuializing: ");
         if (buttons[0].order){
-            Serial.println("Heart Rate");
             defaultDataVisualitzation( globalValuesVar, display.getDataWindowSize(), true );
         } else {
             if(buttons[1].order){
-                Serial.println("SPO2");
                 defaultDataVisualitzation( globalValuesVar, display.getDataWindowSize(), false );
             } else {
                 if(buttons[2].order){
-                    Serial.println("Frequencies");
                     frequenciesDataVisualitzation(globalValuesVar);
                 }
             }
         }
-    }   
+    } while (display.nextPage());
 }
 
 /** Default data visualitzation function
@@ -123,12 +288,12 @@ void globalDataVisualizer::generateDisplayVisualization ( globalValues& globalVa
 void globalDataVisualizer::defaultDataVisualitzation ( globalValues& globalValuesVar, uint32_t windowSize, bool heartRateType )
 {
     display.drawAxis();
-    vector<uint32_t> data = globalValuesVar.getHeartRateDataArray(windowSize);
+    dataView<int32_t> data = globalValuesVar.getHeartRateDataArray(windowSize);
     uint32_t value;
     if ( heartRateType ) value = globalValuesVar.getBeatsPerMinute();
     else value = globalValuesVar.getSpo2Percentage();
 
-    vector<uint32_t> discretizedDataVector = defaultDiscretization( data );
+    dataView<uint32_t> discretizedDataVector = defaultDiscretization( data );
     display.drawData( discretizedDataVector );
     display.printMeasurements(value, heartRateType);
 }
@@ -139,25 +304,26 @@ void globalDataVisualizer::defaultDataVisualitzation ( globalValues& globalValue
  *
  * @param data Data to discretize.
  * 
- * @details This function discretizes the data by normalizing it in realation to the maximum value divided by the Y axis bias.
- *          From that we will obtain the height of each value in pixels, being the maximum value the highest permitted value.
+ * @details This function discretizes the data by normalizing it in realation to the range between the minimum and 
+ *          the maximum values, which are signed, divided by the Y axis bias. From that we will obtain the height of each 
+ *          value in pixels, being the minimum value the lowest and the maximum value the highest permitted value.
  * 
- * @return Discretized data.
+ * @return View of the discretized data, stored in the discretized data buffer.
  */
-vector<uint32_t> globalDataVisualizer::defaultDiscretization ( vector<uint32_t> data )
+dataView<uint32_t> globalDataVisualizer::defaultDiscretization ( const dataView<int32_t>& data )
 {
-    vector<uint32_t> discretizedDataVector;
-    uint32_t max = getMaxValue(data);
+    int64_t min = getMinValue(data);
+    int64_t range = int64_t(getMaxValue(data)) - min;
     uint32_t yBias = display.getYAxisBias();
-    uint32_t yAxisScale = uint32_t(max/yBias);
 
-    if (yAxisScale == 0) yAxisScale = 1;
+    if (range == 0) range = 1;
 
-    for (uint32_t i = 0; i < data.size(); i++)
+    uint32_t size = data.size() < discretizedData.size() ? data.size() : discretizedData.size();
+    for (uint32_t i = 0; i < size; i++)
     {
-        discretizedDataVector.push_back(uint32_t(data[i]/yAxisScale));
+        discretizedData[i] = uint32_t((data[i] - min) * yBias / range);
     }
-    return discretizedDataVector;
+    return dataView<uint32_t>(discretizedData.data(), size);
 }
 
 /** Get max value function
@@ -166,25 +332,48 @@ vector<uint32_t> globalDataVisualizer::defaultDiscretization ( vector<uint32_t>
  *
  * @param data Data to get the max value.
  * 
- * @return Max value.
+ * @return Max value, zero if there is no data.
  * 
- * @see defaultDiscretization().
+ * @see defaultDiscretization(), getMinValue().
  * 
  */
-uint32_t globalDataVisualizer::getMaxValue( vector<uint32_t> data )
+int32_t globalDataVisualizer::getMaxValue( const dataView<int32_t>& data )
 {
-    uint32_t max = 0;
-    for (uint8_t i = 0; i < data.size(); i++)
+    int32_t max = data.size() > 0 ? data[0] : 0;
+    for (size_t i = 0; i < data.size(); i++)
     {
-        uint32_t absValue = uint32_t(abs(float(data[i])));
-        if (absValue > max)
+        if (data[i] > max)
         {
-            max = absValue;
+            max = data[i];
         }
     }
     return max;
 }
 
+/** Get min value function
+ * 
+ * @brief This function gets the min value.
+ *
+ * @param data Data to get the min value.
+ * 
+ * @return Min value, zero if there is no data.
+ * 
+ * @see defaultDiscretization(), getMaxValue().
+ * 
+ */
+int32_t globalDataVisualizer::getMinValue( const dataView<int32_t>& data )
+{
+    int32_t min = data.size() > 0 ? data[0] : 0;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        if (data[i] < min)
+        {
+            min = data[i];
+        }
+    }
+    return min;
+}
+
 /** Frequencies data visualitzation function
  * 
  * @brief This function visualizes the frequencies data.
@@ -196,68 +385,68 @@ uint32_t globalDataVisualizer::getMaxValue( vector<uint32_t> data )
  */
 void globalDataVisualizer::frequenciesDataVisualitzation ( globalValues& globalValuesVar )
 {
-    vector<String> labels;
-    vector<float> amplitudes;
-    getDisplayStyleFundamentalsFrequencies(globalValuesVar.getFreqs(), labels, amplitudes);
-    display.drawBars(labels, amplitudes);
+    uint32_t size = getDisplayStyleFundamentalsFrequencies(globalValuesVar.getFreqs());
+    uint32_t labelsCount = size < MAXIMUM_LABELS_TO_PLOT ? size : MAXIMUM_LABELS_TO_PLOT;
+    display.drawBars(frequencyLabels, labelsCount, normalizedAmplitudes.data(), size);
     bool longAxis = true;
     display.drawAxis(longAxis);
 }
 
 /** Get display style fundamentals frequencies function
  * 
- * @brief This function returns the normalized frequencies'amplitude vector and the labels'vector.
+ * @brief This function fills the normalized frequencies'amplitude buffer and the labels'buffer.
  *
  * @param data Data to get the scaled fundamentals frequencies.
- * @param labels Vector of labels.
- * @param amplitudes Vector of amplitudes.
  * 
- * @details This function normalizes the amplitudes and adds them to the amplitudes vector. The normalized amplitude should be
- *          a float number between 0 and 1. The labels vector is filled with the frequencies in Hz, kHz or MHz depending on the
- *         magnitude of the frequency.
+ * @return Number of normalized amplitudes.
+ * 
+ * @details This function normalizes the amplitudes and stores them in the amplitudes buffer. The normalized amplitude should be
+ *          a float number between 0 and 1. The labels buffer is filled with the first frequencies in Hz, kHz or MHz depending 
+ *          on the magnitude of the frequency.
  * 
  * @see getLabeledFrequency(), frequenciesDataVisualitzation().
  * 
  */
-void globalDataVisualizer::getDisplayStyleFundamentalsFrequencies ( vector<fundamentalsFreqs> data, vector<String>& labels, vector<float>& amplitudes )
+uint32_t globalDataVisualizer::getDisplayStyleFundamentalsFrequencies ( const dataView<fundamentalsFreqs>& data )
 {
     float max = getMaxAmplitude(data);
-    for (uint8_t i = 0; i < data.size() ; i++)
+    if (max == 0) max = 1;
+
+    uint32_t size = data.size() < normalizedAmplitudes.size() ? data.size() : normalizedAmplitudes.size();
+    for (uint32_t i = 0; i < size ; i++)
     {
-        // normalize and add amplitudes
-        float normalizeFrequencyAmplitude = data[i].amplitude/max;
-        amplitudes.push_back(normalizeFrequencyAmplitude);
+        // normalize amplitudes
+        normalizedAmplitudes[i] = data[i].amplitude/max;
 
-        // casting to string and add labels
-        String label = getLabeledFrequency(data[i].freqsHz);
-        labels.push_back(label);
+        // casting to string the labels
+        if (i < MAXIMUM_LABELS_TO_PLOT) getLabeledFrequency(data[i].freqsHz, frequencyLabels[i]);
     }
+    return size;
 }
 
 /** Get labeled frequency
  * 
- * @brief This function returns a string with an appropiate style realted to its magnitude
+ * @brief This function writes a string with an appropiate style realted to its magnitude
  * 
  * @param data Data to convert into string
+ * @param label Text where the string is written
  * 
- * @return String of the input data
- * 
- * @see getDisplayStyleFudamentalsFrequencies(), getJSON().
+ * @see getDisplayStyleFudamentalsFrequencies().
  * 
 */
-String globalDataVisualizer::getLabeledFrequency ( float data )
+void globalDataVisualizer::getLabeledFrequency ( float data, textBuffer<FREQUENCY_LABEL_SIZE>& label )
 {
-    String labelHz = String(data) + " ";
-    if (data/1000 >= 1)
-    {
-        labelHz = String(data/1000) + " K";
-    }
+    label.clear();
     if (data/1000000 >= 1)
     {
-        labelHz = String(data/1000000) + " M";
+        label.appendFloat(data/1000000).append(" M");
+    } else if (data/1000 >= 1)
+    {
+        label.appendFloat(data/1000).append(" K");
+    } else {
+        label.appendFloat(data).append(" ");
     }
-    labelHz += "Hz";
-    return labelHz;
+    label.append("Hz");
 }
 
 /** Get max amplitude function
@@ -269,10 +458,10 @@ String globalDataVisualizer::getLabeledFrequency ( float data )
  * @return Max amplitude.
  * 
  */
-float globalDataVisualizer::getMaxAmplitude ( const vector<fundamentalsFreqs>& freqs )
+float globalDataVisualizer::getMaxAmplitude ( const dataView<fundamentalsFreqs>& freqs )
 {
     float max = 0;
-    for (uint8_t i = 0; i < freqs.size(); i++)
+    for (size_t i = 0; i < freqs.size(); i++)
     {
         if (freqs[i].amplitude > max)
         {
@@ -288,51 +477,165 @@ float globalDataVisualizer::getMaxAmplitude ( const vector<fundamentalsFreqs>& f
  * 
  * @param globalValuesVar Global values variable.
  * 
- * @return JSON of the global values.
+ * @return JSON of the global values, stored in the JSON buffer.
  * 
  * @details This function returns the JSON of the global values. The JSON is structured as follows:
  *         {
  *              "heartRateData": firstHeartRateData,
- *              "spo2Data": firstSpo2Data,
  *              "beatsPerMinute": beatsPerMinute,
  *              "spo2Percentage": spo2Percentage,
  *              "freqsAmplitude": [freqsAmplitude],
- *              "freqsHz": [labeledFreqsHz]
+ *              "freqsHz": [freqsHz]
  *          }
  * 
- * @see getLabeledFrequency().
- * 
  */
-String globalDataVisualizer::getJSON ( globalValues& globalValuesVar )
+const textBuffer<JSON_BUFFER_SIZE>& globalDataVisualizer::getJSON ( globalValues& globalValuesVar )
 {
-    String json = "{";
-    json += "\"heartRateData\":" + String(globalValuesVar.getFirstValueHeartRate()) + ",";
-    json += "\"beatsPerMinute\": " + String(globalValuesVar.getBeatsPerMinute()) + ", ";
-    json += "\"spo2Percentage\": " + String(globalValuesVar.getSpo2Percentage()) + ", ";
-    json += "\"freqsAmplitude\": [";
-
-    vector<fundamentalsFreqs> freqs = globalValuesVar.getFreqs();
-    for(int i = 0; i < freqs.size(); i++)
+    json.clear();
+    json.append("{");
+    json.append("\"heartRateData\":").appendInteger(globalValuesVar.getFirstValueHeartRate()).append(",");
+    json.append("\"beatsPerMinute\": ").appendInteger(globalValuesVar.getBeatsPerMinute()).append(", ");
+    json.append("\"spo2Percentage\": ").appendInteger(globalValuesVar.getSpo2Percentage()).append(", ");
+    json.append("\"freqsAmplitude\": [");
+
+    dataView<fundamentalsFreqs> freqs = globalValuesVar.getFreqs();
+    for(size_t i = 0; i < freqs.size(); i++)
     {
-        json += String(freqs[i].amplitude);
+        json.appendFloat(freqs[i].amplitude);
         if(i != freqs.size() - 1)
         {
-            json += ", ";
+            json.append(", ");
         }
     }
-    json += "], ";
+    json.append("], ");
 
-    json += "\"freqsHz\": [";
-    for(int i = 0; i < freqs.size(); i++)
+    json.append("\"freqsHz\": [");
+    for(size_t i = 0; i < freqs.size(); i++)
     {
-        json += String(freqs[i].freqsHz);
+        json.appendFloat(freqs[i].freqsHz);
         if(i != freqs.size() - 1)
         {
-            json += ", ";
+            json.append(", ");
         }
     }
-    json += "]";
-    json += "}";
+    json.append("]");
+    json.append("}");
     
     return json;
-}
\ No newline at end of file
+}
+
+/** Get binary frame function
+ * 
+ * @brief This function gets the binary frame of the global values.
+ * 
+ * @param globalValuesVar Global values variable.
+ * 
+ * @return Binary frame of the global values, with the same values as the JSON.
+ * 
+ * @see getJSON(), frameEncoder.
+ * 
+ */
+frameEncoder& globalDataVisualizer::getBinaryFrame ( globalValues& globalValuesVar )
+{
+    binaryFrame.begin();
+    binaryFrame.addVitals(globalValuesVar.getBeatsPerMinute(), globalValuesVar.getSpo2Percentage());
+    binaryFrame.addWaveform(globalValuesVar.getHeartRateDataArray(1));
+    binaryFrame.addSpectrum(globalValuesVar.getFreqs());
+    return binaryFrame;
+}
+
+/** Stream waveform function
+ * 
+ * @brief This function sends the pending filtered samples to the web page.
+ * 
+ * @param globalValuesVar Global values variable.
+ * 
+ * @details The samples are sent in messages of the batch size, and the remaining ones 
+ *          wait for the next call. The samples are taken even if there is no client, so 
+ *          the stream never fills up. The messages are stream messages, so they are not 
+ *          replaced by newer ones while they wait for a slow client.
+ * 
+ * @see setWaveformStreaming(), globalValues::popWaveformSamples(), webPage::flushClients().
+ * 
+ */
+void globalDataVisualizer::streamWaveform ( globalValues& globalValuesVar )
+{
+    while ( globalValuesVar.getPendingWaveformSamples() >= waveformBatchSize )
+    {
+        STAGE_TIMER(STAGE_WEB_STREAM);
+        size_t count = globalValuesVar.popWaveformSamples(waveformBatch, waveformBatchSize);
+        if (page.hasClient(WS_PROTOCOL_JSON))
+        {
+            const textBuffer<JSON_BUFFER_SIZE>& jsonMessage = getWaveformJSON(waveformBatch, count);
+            page.sendWsMessage(jsonMessage.c_str(), jsonMessage.size(), WS_MESSAGE_STREAM);
+        }
+        if (page.hasClient(WS_PROTOCOL_BINARY))
+        {
+            frameEncoder& frame = getWaveformFrame(waveformBatch, count);
+            page.sendWsBinary(frame.getData(), frame.size(), WS_MESSAGE_STREAM);
+        }
+    }
+    // hand the messages that were waiting for a slow client
+    page.flushClients();
+}
+
+/** Get waveform JSON function
+ * 
+ * @brief This function gets the JSON of a batch of filtered samples.
+ * 
+ * @param samples Consecutive filtered samples.
+ * @param count Number of samples.
+ * 
+ * @return JSON of the samples, stored in the JSON buffer.
+ * 
+ * @details The JSON is structured as follows:
+ *         {
+ *              "sequence": sequenceOfFirstSample,
+ *              "timestamps": [timestampsInMs],
+ *              "samples": [samples]
+ *          }
+ * 
+ */
+const textBuffer<JSON_BUFFER_SIZE>& globalDataVisualizer::getWaveformJSON ( const waveformSample* samples, size_t count )
+{
+    json.clear();
+    json.append("{");
+    json.append("\"sequence\": ").appendInteger(count > 0 ? samples[0].sequence : 0).append(", ");
+    json.append("\"timestamps\": [");
+    for(size_t i = 0; i < count; i++)
+    {
+        json.appendInteger(samples[i].timestamp);
+        if(i != count - 1) json.append(", ");
+    }
+    json.append("], ");
+
+    json.append("\"samples\": [");
+    for(size_t i = 0; i < count; i++)
+    {
+        json.appendInteger(samples[i].value);
+        if(i != count - 1) json.append(", ");
+    }
+    json.append("]");
+    json.append("}");
+
+    return json;
+}
+
+/** Get waveform frame function
+ * 
+ * @brief This function gets the binary frame of a batch of filtered samples.
+ * 
+ * @param samples Consecutive filtered samples.
+ * @param count Number of samples.
+ * 
+ * @return Binary frame with only the stream section.
+ * 
+ * @see getWaveformJSON(), frameEncoder::addStream().
+ * 
+ */
+frameEncoder& globalDataVisualizer::getWaveformFrame ( const waveformSample* samples, size_t count )
+{
+    binaryFrame.begin();
+    binaryFrame.addStream(samples, count);
+    return binaryFrame;
+}
@@ -5,9 +5,21 @@
 #include "Display.h"
 #include "WebPage.h"
 #include "Button.h"
+#include "DataView.h"
+#include "TextBuffer.h"
+#include "FrameEncoder.h"
+#include "VisualizerEvents.h"
+#include "StageMetrics.h"
 
 namespace std 
 {
+    // Size of the JSON message sent to the web page
+    const size_t JSON_BUFFER_SIZE = 4096;
+    // Maximum number of filtered samples sent in a waveform stream message
+    const uint16_t MAX_WAVEFORM_BATCH = 64;
+    // Time between shifts of the heart rate data in the display in ms
+    const uint32_t HEART_RATE_SCROLL_PERIOD = 700;
+
     /** Data visualizer class
      *
      * @brief This class is the global data visualizer of the device.
@@ -17,11 +29,54 @@ namespace std
      * @param display Display object
      * @param page WebPage object
      * @param buttons ButtonsArray object
+     * @param discretizedData Discretized heart rate data of the display
+     * @param normalizedAmplitudes Normalized amplitudes of the frequency bars
+     * @param frequencyLabels Labels of the frequency bars
+     * @param json JSON message of the web page
+     * @param binaryFrame Binary message of the web page
+     * @param waveformBatch Filtered samples of the waveform stream message
+     * @param waveformBatchSize Number of filtered samples sent in each waveform stream message
+     * @param waveformPeriod Time between checks of the waveform stream in ms
+     * @param displayPeriod Minimum time between display refreshes in ms
+     * @param webPeriod Minimum time between values sent to the web page in ms
+     * @param displayPending True if the display has to be refreshed
+     * @param valuesPending True if the values have to be sent to the web page
+     * @param freqsSequence Sequence of the fundamentals frequencies of the last block
+     * @param hasValues True if a block of values has been received
+     * @param lastDisplayTime Time of the last display refresh in ms
+     * @param lastWebTime Time of the last values sent to the web page in ms
+     * @param lastStreamTime Time of the last check of the waveform stream in ms
+     * @param lastScrollTime Time of the last shift of the heart rate data in ms
+     *
+     * @details The buffers are allocated once, so a frame is generated without allocating
+     *          memory.
      *
      */
     class globalDataVisualizer {
         Display display;
         webPage page;
+        vector<uint32_t> discretizedData;
+        vector<float> normalizedAmplitudes;
+        textBuffer<FREQUENCY_LABEL_SIZE> frequencyLabels[MAXIMUM_LABELS_TO_PLOT];
+        textBuffer<JSON_BUFFER_SIZE> json;
+        frameEncoder binaryFrame;
+        waveformSample waveformBatch[MAX_WAVEFORM_BATCH];
+        uint16_t waveformBatchSize = 5;
+        uint16_t waveformPeriod = 200;
+        uint16_t displayPeriod = 100;
+        uint16_t webPeriod = 250;
+        bool displayPending = true;
+        bool valuesPending = false;
+        uint32_t freqsSequence = 0;
+        bool hasValues = false;
+        uint32_t lastDisplayTime = 0;
+        uint32_t lastWebTime = 0;
+        uint32_t lastStreamTime = 0;
+        uint32_t lastScrollTime = 0;
+
+        uint32_t getTimeToNextRefresh ( globalValues& globalValuesVar, uint32_t now );
+
+        static uint32_t getRemainingTime ( uint32_t lastTime, uint32_t period, uint32_t now );
         
         public:
             buttonsArray buttons;
@@ -31,9 +86,15 @@ namespace std
 
             void setup ( vector<int> buttonPins, const char* ssid, const char* password );
 
+            void setWaveformStreaming ( uint16_t batchSize, uint16_t period );
+
+            void setRefreshPeriods ( uint16_t pDisplayPeriod, uint16_t pWebPeriod );
+
             void workInProgressMessage ();
 
-            void generateVisualization( globalValues& globalValuesVar );
+            void generateVisualization( globalValues& globalValuesVar, visualizerEvents& events );
+
+            void sendValues ( globalValues& globalValuesVar );
 
             void generateDisplayVisualization ( globalValues& globalValuesVar );
 
@@ -41,19 +102,29 @@ namespace std
 
             void defaultDataVisualitzation ( globalValues& globalValuesVar, uint32_t windowSize, bool heartRateType );
 
-            vector<uint32_t> defaultDiscretization ( vector<uint32_t> data );
+            dataView<uint32_t> defaultDiscretization ( const dataView<int32_t>& data );
 
-            uint32_t getMaxValue( vector<uint32_t> data );
+            int32_t getMaxValue( const dataView<int32_t>& data );
+
+            int32_t getMinValue( const dataView<int32_t>& data );
 
             void frequenciesDataVisualitzation ( globalValues& globalValuesVar );
 
-            void getDisplayStyleFundamentalsFrequencies ( vector<fundamentalsFreqs> data, vector<String>& labels, vector<float>& amplitudes );
+            uint32_t getDisplayStyleFundamentalsFrequencies ( const dataView<fundamentalsFreqs>& data );
+
+            void getLabeledFrequency ( float data, textBuffer<FREQUENCY_LABEL_SIZE>& label );
+
+            float getMaxAmplitude ( const dataView<fundamentalsFreqs>& freqs );
+
+            const textBuffer<JSON_BUFFER_SIZE>& getJSON ( globalValues& globalValuesVar );
+
+            frameEncoder& getBinaryFrame ( globalValues& globalValuesVar );
 
-            String getLabeledFrequency ( float data );
+            void streamWaveform ( globalValues& globalValuesVar );
 
-            float getMaxAmplitude ( const vector<fundamentalsFreqs>& freqs );
+            const textBuffer<JSON_BUFFER_SIZE>& getWaveformJSON ( const waveformSample* samples, size_t count );
 
-            String getJSON ( globalValues& globalValuesVar );
+            frameEncoder& getWaveformFrame ( const waveformSample* samples, size_t count );
     };
 }
 
@@ -0,0 +1,243 @@
+#include "DecimationChain.h"
+
+using namespace std;
+
+/** Begin function
+ *
+ * @brief This function designs the stages that decimate from the input rate to the
+ *        output rate.
+ *
+ * @param inputRate Rate of the sensor in Hz.
+ * @param outputRate Rate of the analysis in Hz.
+ * @param useCic True to use a CIC and a compensation filter if the factor allows it.
+ *
+ * @return True if the input rate is a multiple of the output rate, false if not, in
+ *         which case the samples are passed without decimation.
+ *
+ * @note It allocates the filters, so it has to be called before the samples are pushed.
+ *
+ */
+bool decimationChain::begin ( uint16_t inputRate, uint16_t outputRate, bool useCic )
+{
+    stages.clear();
+    cicEnabled = false;
+    factor = 1;
+    macsPerOutput = 0;
+    if ( outputRate == 0 || inputRate % outputRate != 0 || outputRate <= 2 * DECIMATION_PASSBAND )
+    {
+        LOG_ERROR("Cannot decimate from %u Hz to %u Hz", inputRate, outputRate);
+        return false;
+    }
+    factor = inputRate / outputRate;
+
+    float rate = inputRate;
+    uint16_t remaining = factor;
+    if ( useCic && factor >= 4 && factor % 2 == 0 && factor / 2 <= CIC_MAX_FACTOR )
+    {
+        uint8_t cicFactor = factor / 2;
+        cic.begin(cicFactor);
+        cicEnabled = true;
+        rate /= cicFactor;
+
+        float stopband = rate / 2 - DECIMATION_PASSBAND;
+        int taps = estimateTaps(rate, stopband - DECIMATION_PASSBAND);
+        addStage(designCompensator(rate, (DECIMATION_PASSBAND + stopband) / 2, taps, cicFactor), 2);
+        remaining = 1;
+    }
+
+    // prime factors, the biggest first
+    while ( remaining > 1 )
+    {
+        uint16_t stageFactor = remaining;
+        for (uint16_t divisor = 2; divisor * divisor <= stageFactor; divisor++)
+        {
+            while ( stageFactor % divisor == 0 && stageFactor > divisor ) stageFactor /= divisor;
+        }
+
+        float stopband = rate / stageFactor - DECIMATION_PASSBAND;
+        int taps = estimateTaps(rate, stopband - DECIMATION_PASSBAND);
+        addStage(designLowPass(rate, (DECIMATION_PASSBAND + stopband) / 2, taps), stageFactor);
+        rate /= stageFactor;
+        remaining /= stageFactor;
+    }
+
+    // each stage makes the outputs of all the stages after it
+    uint16_t outputs = 1;
+    for (size_t i = stages.size(); i > 0; i--)
+    {
+        macsPerOutput += float(stages[i - 1].getTaps()) * outputs;
+        outputs *= stages[i - 1].getFactor();
+    }
+    return true;
+}
+
+/** Estimate taps function
+ *
+ * @brief This function estimates the taps of a Hamming window low pass filter.
+ *
+ * @param inputRate Rate of the filter in Hz.
+ * @param transition Width of the transition band in Hz.
+ *
+ * @return Odd number of taps, at least 3.
+ *
+ */
+int decimationChain::estimateTaps ( float inputRate, float transition )
+{
+    int taps = ceil(DECIMATION_TAPS_PER_TRANSITION * inputRate / transition);
+    if ( taps < 3 ) taps = 3;
+    return taps | 1;
+}
+
+/** Design low pass function
+ *
+ * @brief This function designs a low pass filter with a windowed sinc.
+ *
+ * @param inputRate Rate of the filter in Hz.
+ * @param cutoff Cutoff frequency in Hz, in the middle of the transition band.
+ * @param taps Number of taps, odd.
+ *
+ * @return Coefficients of the filter, with unit gain at DC.
+ *
+ */
+vector<float> decimationChain::designLowPass ( float inputRate, float cutoff, int taps )
+{
+    vector<float> coefs(taps);
+    float center = (taps - 1) / 2.0;
+    float normalizedCutoff = 2 * cutoff / inputRate;
+    float sum = 0;
+    for (int n = 0; n < taps; n++)
+    {
+        float x = n - center;
+        float sinc = x == 0 ? normalizedCutoff : sin(M_PI * normalizedCutoff * x) / (M_PI * x);
+        float window = 0.54 - 0.46 * cos(2 * M_PI * n / (taps - 1));
+        coefs[n] = sinc * window;
+        sum += coefs[n];
+    }
+    for (int n = 0; n < taps; n++) coefs[n] /= sum;
+    return coefs;
+}
+
+/** Design compensator function
+ *
+ * @brief This function designs a low pass filter whose passband is the inverse of the
+ *        response of a CIC decimator.
+ *
+ * @param inputRate Rate of the filter in Hz, the output rate of the CIC.
+ * @param cutoff Cutoff frequency in Hz, in the middle of the transition band.
+ * @param taps Number of taps, odd.
+ * @param cicFactor Decimation factor of the CIC.
+ *
+ * @return Coefficients of the filter, with unit gain at DC.
+ *
+ * @details The coefficients are the inverse transform of the desired response, 1 / CIC
+ *          up to the cutoff and 0 after it, integrated with DECIMATION_DESIGN_POINTS
+ *          points, and then windowed.
+ *
+ */
+vector<float> decimationChain::designCompensator ( float inputRate, float cutoff, int taps, uint8_t cicFactor )
+{
+    vector<float> coefs(taps, 0.0f);
+    float center = (taps - 1) / 2.0;
+    float step = cutoff / DECIMATION_DESIGN_POINTS;
+    for (uint16_t k = 0; k < DECIMATION_DESIGN_POINTS; k++)
+    {
+        float frequency = (k + 0.5) * step;
+        float cicResponse = fabs(sin(M_PI * frequency / inputRate) / (cicFactor * sin(M_PI * frequency / (cicFactor * inputRate))));
+        float response = 1;
+        for (uint8_t i = 0; i < CIC_STAGES; i++) response /= cicResponse;
+        for (int n = 0; n < taps; n++)
+        {
+            coefs[n] += 2 * step / inputRate * response * cos(2 * M_PI * frequency * (n - center) / inputRate);
+        }
+    }
+    float sum = 0;
+    for (int n = 0; n < taps; n++)
+    {
+        coefs[n] *= 0.54 - 0.46 * cos(2 * M_PI * n / (taps - 1));
+        sum += coefs[n];
+    }
+    for (int n = 0; n < taps; n++) coefs[n] /= sum;
+    return coefs;
+}
+
+/** Add stage function
+ *
+ * @brief This function adds a FIR decimator at the end of the chain.
+ *
+ * @param coefs Coefficients of the low pass filter.
+ * @param stageFactor Decimation factor of the stage.
+ *
+ */
+void decimationChain::addStage ( const vector<float>& coefs, uint8_t stageFactor )
+{
+    stages.push_back(polyphaseDecimator(coefs.data(), coefs.size(), stageFactor));
+}
+
+/** Push function
+ *
+ * @brief This function pushes a sample of each channel through the stages.
+ *
+ * @param valueIR IR sample, replaced by the IR output if there is one.
+ * @param valueRed Red sample, replaced by the red output if there is one.
+ *
+ * @return True if the values are an output at the output rate, false if not.
+ *
+ */
+bool decimationChain::push ( float& valueIR, float& valueRed )
+{
+    if ( cicEnabled && !cic.push(valueIR, valueRed) ) return false;
+    for (size_t i = 0; i < stages.size(); i++)
+    {
+        if ( !stages[i].push(valueIR, valueRed) ) return false;
+    }
+    return true;
+}
+
+/** Get factor function
+ *
+ * @brief This function returns the total decimation factor.
+ *
+ * @return Number of inputs of each output.
+ *
+ */
+uint16_t decimationChain::getFactor ( )
+{
+    return factor;
+}
+
+/** Get MACs per output function
+ *
+ * @brief This function returns the cost of the FIR stages.
+ *
+ * @return Multiply accumulates per output of the chain and per channel.
+ *
+ */
+float decimationChain::getMacsPerOutput ( )
+{
+    return macsPerOutput;
+}
+
+/** Get CIC operations per output function
+ *
+ * @brief This function returns the cost of the CIC stage.
+ *
+ * @return Additions and subtractions per output of the chain and per channel, 0 without CIC.
+ *
+ */
+uint16_t decimationChain::getCicOperationsPerOutput ( )
+{
+    if ( !cicEnabled ) return 0;
+    uint16_t combOutputs = factor / cic.getFactor();
+    return CIC_STAGES * (factor + combOutputs);
+}
+
+/** Reset function
+ *
+ * @brief This function empties the stages.
+ *
+ */
+void decimationChain::reset ( )
+{
+    cic.reset();
+    for (size_t i = 0; i < stages.size(); i++) stages[i].reset();
+}
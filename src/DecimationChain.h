@@ -0,0 +1,82 @@
+#ifndef DECIMATIONCHAIN_H
+#define DECIMATIONCHAIN_H
+
+#include <Arduino.h>
+#include <vector>
+
+#include "CicDecimator.h"
+#include "Logger.h"
+#include "PolyphaseDecimator.h"
+
+// DECIMATION CIC : define DECIMATION_CIC (e.g. in build_flags) to decimate with a CIC and a
+// compensation FIR instead of a cascade of FIR decimators.
+// #define DECIMATION_CIC
+
+namespace std
+{
+#ifdef DECIMATION_CIC
+    const bool DECIMATION_USE_CIC = true;
+#else
+    const bool DECIMATION_USE_CIC = false;
+#endif
+    // Highest frequency kept by the decimation in Hz, the stopband edge of the band pass filter
+    const float DECIMATION_PASSBAND = 3.5;
+    // Taps of a Hamming window per normalized transition width, for about 50 dB of stopband
+    const float DECIMATION_TAPS_PER_TRANSITION = 3.3;
+    // Points of the integral of the response of the compensation filter
+    const uint16_t DECIMATION_DESIGN_POINTS = 256;
+
+    /** Decimation chain class
+     *
+     * @brief This class takes the samples of the sensor from its rate down to the rate of
+     *        the analysis.
+     *
+     * @details The decimation is split in stages, one for each prime factor of the total
+     *          factor, the biggest first, each one a polyphase FIR decimator. Each stage only
+     *          has to keep the frequencies that would alias into the passband of the
+     *          analysis, so its transition goes from DECIMATION_PASSBAND to its output rate
+     *          minus DECIMATION_PASSBAND, and the early stages, which run faster, have few
+     *          taps. With DECIMATION_CIC, an even factor of 4 or more is done by a CIC
+     *          decimator, which does not multiply, and a FIR that decimates by 2 and
+     *          compensates the droop of the CIC in the passband. The filters are designed
+     *          by begin(), as windowed sinc or inverse CIC responses with a Hamming window,
+     *          so the chain matches any sensor rate. A factor of 1 passes the samples.
+     *
+     * @param factor Total decimation factor
+     * @param cicEnabled True if the first stage is the CIC
+     * @param cic CIC decimator
+     * @param stages FIR decimators, in order
+     * @param macsPerOutput Multiply accumulates of the FIR stages per output and channel
+     *
+     */
+    class decimationChain {
+        uint16_t factor = 1;
+        bool cicEnabled = false;
+        cicDecimator cic;
+        vector<polyphaseDecimator> stages;
+        float macsPerOutput = 0;
+
+        static int estimateTaps ( float inputRate, float transition );
+
+        static vector<float> designLowPass ( float inputRate, float cutoff, int taps );
+
+        static vector<float> designCompensator ( float inputRate, float cutoff, int taps, uint8_t cicFactor );
+
+        void addStage ( const vector<float>& coefs, uint8_t stageFactor );
+
+        public:
+            bool begin ( uint16_t inputRate, uint16_t outputRate, bool useCic = DECIMATION_USE_CIC );
+
+            bool push ( float& valueIR, float& valueRed );
+
+            uint16_t getFactor ();
+
+            float getMacsPerOutput ();
+
+            uint16_t getCicOperationsPerOutput ();
+
+            void reset ();
+    };
+}
+
+#endif /* DECIMATIONCHAIN_H */
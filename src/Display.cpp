@@ -50,11 +50,12 @@ void Display::drawAxis ( bool longAxis )
  * @see getDataWindowSize(), getYAxisBias().
  * 
  */
-void Display::drawData ( vector<uint32_t> dataVector ) 
+void Display::drawData ( const dataView<uint32_t>& dataVector ) 
 {
     uint32_t actualHeight = 0;
     uint32_t lastHeight = 0;
     uint32_t windowSize = this -> getDataWindowSize();
+    if ( dataVector.size() < windowSize ) windowSize = dataVector.size();
     uint32_t yBias = getYAxisBias();
     for (uint32_t i = 0; i < windowSize; i++)
     {
@@ -77,23 +78,24 @@ void Display::drawData ( vector<uint32_t> dataVector )
 void Display::printMeasurements ( int32_t value, bool heartRateType )
 {
     this -> setFont(u8g2_font_luBS10_tf);
-    String valueString = String(value);
+    textBuffer<16> valueString;
+    valueString.appendInteger(value);
 
     if (heartRateType){
         this -> setCursor(this -> xAxisEnd + 20, this -> halfHeight + 2*margin);
         this -> print("BPM");
     }else {
-        valueString += " %";
+        valueString.append(" %");
         this -> setCursor(this -> xAxisEnd + 20, this -> halfHeight + 2*margin);
         this -> print("SPO2");
     }
 
-    if (valueString.length() >= 3){
+    if (valueString.size() >= 3){
         this -> setCursor(this -> xAxisEnd + 20, this -> halfHeight );
     }else {
         this -> setCursor(this -> xAxisEnd + 20 + margin, this -> halfHeight);
     }
-    this -> print(valueString);
+    this -> print(valueString.c_str());
 }
 
 /** Draw bars function
@@ -101,26 +103,28 @@ void Display::printMeasurements ( int32_t value, bool heartRateType )
  * @brief This function draws the bars in the display.
  *
  * @param labels Labels to print.
+ * @param labelsCount Number of labels, at most MAXIMUM_LABELS_TO_PLOT.
  * @param normalizedAmplitudes Normalized amplitudes to print.
+ * @param size Number of amplitudes.
  * 
  * @note This function expects the labels and the normalized amplitudes,which should
  *       be between 0 and 1, in the same order. 
  *
  */
-void Display::drawBars ( const vector<String>& labels, const vector<float>& normalizedAmplitudes )
+void Display::drawBars ( const textBuffer<FREQUENCY_LABEL_SIZE>* labels, uint32_t labelsCount, 
+                         const float* normalizedAmplitudes, uint32_t size )
 {
     this -> setFont(u8g2_font_tinyunicode_tf);
 
-    if(labels.size() != normalizedAmplitudes.size())
+    if(size == 0 || labelsCount > size)
     {
-        Serial.println("Error: labels and normalizedAmplitudes must have the same size");
+        LOG_ERROR("There must be one amplitude for each label");
         return;
     }
-    uint32_t maximumLabelsToPlot = 7;
     uint32_t labelsPlotted = 0;
-    uint32_t xAxisScale = (xAxisEnd + margin/2)/labels.size();
-    uint32_t yAxisStep = yAxisEnd/maximumLabelsToPlot;
-    for (uint8_t i = 0; i < xAxisEnd - margin ; i++)
+    uint32_t xAxisScale = (xAxisEnd + margin/2)/size;
+    uint32_t yAxisStep = yAxisEnd/MAXIMUM_LABELS_TO_PLOT;
+    for (uint8_t i = 0; i < xAxisEnd - margin && i < size; i++)
     {
         // Plot bar
         uint32_t xAxisPlotBegin = xAxisScale*i + xAxisScale/2;
@@ -133,10 +137,10 @@ void Display::drawBars ( const vector<String>& labels, const vector<float>& norm
             this -> drawLine(xAxisPlotBegin, yAxisEnd -j, xWidth ,yAxisEnd -j);
         }
         // Plot label
-        if ( labelsPlotted < maximumLabelsToPlot )
+        if ( labelsPlotted < labelsCount )
         {
             this -> setCursor(xAxisEnd + 2*margin, yAxisStep * i + 4/3*margin);
-            this -> print(labels[i]);
+            this -> print(labels[i].c_str());
             labelsPlotted++;
         }
     }
@@ -5,8 +5,17 @@
 #include <U8g2lib.h>
 #include <SPI.h>
 
+#include "DataView.h"
+#include "TextBuffer.h"
+#include "Logger.h"
+
 namespace std
 {
+    // Maximum number of labels plotted next to the frequency bars
+    const uint8_t MAXIMUM_LABELS_TO_PLOT = 7;
+    // Size of a frequency label
+    const uint8_t FREQUENCY_LABEL_SIZE = 16;
+
     /** Display class
      *
      * @brief This class is the display of the device.
@@ -31,11 +40,12 @@ namespace std
 
             void drawAxis ( bool longAxis = false );
 
-            void drawData ( vector<uint32_t> dataVector );
+            void drawData ( const dataView<uint32_t>& dataVector );
 
             void printMeasurements (int32_t value, bool heartRateType );
 
-            void drawBars ( const vector<String>& labels, const vector<float>& amplitudes );
+            void drawBars ( const textBuffer<FREQUENCY_LABEL_SIZE>* labels, uint32_t labelsCount, 
+                            const float* normalizedAmplitudes, uint32_t size );
             
             uint32_t getYAxisBias ( );
 
@@ -0,0 +1,114 @@
+#include "FftPlan.h"
+
+using namespace std;
+
+/** Begin function
+ *
+ * @brief This function computes the tables and allocates the buffers of the FFT.
+ *
+ * @param pSize Number of points of the FFT, a power of 2 from 4 to FFT_MAX_SIZE.
+ * @param pSamples Number of samples of a block, at most pSize.
+ * @param pWindow Window of the samples.
+ *
+ * @return True if the size is valid, false if not, in which case the plan is not usable.
+ *
+ */
+bool fftPlan::begin ( uint16_t pSize, uint16_t pSamples, fftWindow pWindow )
+{
+    size = 0;
+    if ( pSize < 4 || pSize > FFT_MAX_SIZE || (pSize & (pSize - 1)) != 0 ) return false;
+
+    uint16_t points = pSize / 2;
+    if ( !fft.begin(points) ) return false;
+    this -> samples = pSamples < pSize ? pSamples : pSize;
+    window.resize(samples);
+    for (uint16_t n = 0; n < samples; n++) window[n] = fftWindowValue(pWindow, n, samples);
+
+    splitTwiddles.resize(pSize);
+    for (uint16_t k = 0; k < points; k++)
+    {
+        splitTwiddles[2 * k] = cos(2 * M_PI * k / pSize);
+        splitTwiddles[2 * k + 1] = sin(2 * M_PI * k / pSize);
+    }
+
+    work.assign(pSize, 0.0f);
+    output.assign(points, 0.0f);
+    this -> size = pSize;
+    return true;
+}
+
+/** Magnitudes function
+ *
+ * @brief This function computes the magnitude of the spectrum of a block of samples.
+ *
+ * @param input Samples of the block, as signed 32 bits integers.
+ *
+ * @return Magnitudes of the bins 0 to size / 2 - 1, valid until the next call, or NULL
+ *         if the plan has not begun.
+ *
+ * @details X[k] = E[k] + W^k * O[k], being E and O the spectra of the even and odd
+ *          samples, with E[k] = (Z[k] + Z*[N - k]) / 2 and O[k] = -j * (Z[k] - Z*[N - k]) / 2
+ *          from the spectrum Z of the N = size / 2 packed samples.
+ *
+ */
+const float* fftPlan::magnitudes ( const int32_t* input )
+{
+    if ( size == 0 ) return NULL;
+    uint16_t points = size / 2;
+
+    int64_t sum = 0;
+    for (uint16_t n = 0; n < samples; n++) sum += input[n];
+    float mean = float(sum) / samples;
+
+    // windowed and zero padded samples, packed in bit reversed order
+    for (uint16_t m = 0; m < points; m++)
+    {
+        float* packed = &work[2 * fft.reversed(m)];
+        uint16_t n = 2 * m;
+        packed[0] = n < samples ? (input[n] - mean) * window[n] : 0.0f;
+        packed[1] = n + 1 < samples ? (input[n + 1] - mean) * window[n + 1] : 0.0f;
+    }
+
+    fft.butterflies(work.data());
+
+    for (uint16_t k = 0; k < points; k++)
+    {
+        const float* z = &work[2 * k];
+        const float* mirror = &work[2 * ((points - k) % points)];
+        float evenReal = 0.5f * (z[0] + mirror[0]);
+        float evenImag = 0.5f * (z[1] - mirror[1]);
+        float oddReal = 0.5f * (z[1] + mirror[1]);
+        float oddImag = -0.5f * (z[0] - mirror[0]);
+        // exp(-j * 2 * pi * k / size)
+        float wr = splitTwiddles[2 * k];
+        float wi = -splitTwiddles[2 * k + 1];
+        float real = evenReal + oddReal * wr - oddImag * wi;
+        float imag = evenImag + oddReal * wi + oddImag * wr;
+        output[k] = sqrtf(real * real + imag * imag);
+    }
+    return output.data();
+}
+
+/** Get size function
+ *
+ * @brief This function returns the number of points of the FFT.
+ *
+ * @return Number of points, 0 if the plan has not begun.
+ *
+ */
+uint16_t fftPlan::getSize ( )
+{
+    return size;
+}
+
+/** Get samples function
+ *
+ * @brief This function returns the number of samples of a block.
+ *
+ * @return Number of samples.
+ *
+ */
+uint16_t fftPlan::getSamples ( )
+{
+    return samples;
+}
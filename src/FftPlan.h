@@ -0,0 +1,57 @@
+#ifndef FFTPLAN_H
+#define FFTPLAN_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ComplexFft.h"
+#include "FftWindow.h"
+
+namespace std
+{
+    /** FFT plan class
+     *
+     * @brief This class is the spectrum of a block of real samples, with everything that
+     *        does not depend on the samples computed once by begin().
+     *
+     * @details The samples, without their mean and multiplied by the window, are zero
+     *          padded up to the size of the FFT, a power of 2, which interpolates the
+     *          spectrum between the bins of the block. The size real samples are packed
+     *          as size / 2 complex samples (even samples in the real part and odd ones in
+     *          the imaginary part), written in bit reversed order, and transformed by the
+     *          complexFft of size / 2 points in float. A last pass splits
+     *          the spectrum of the even and odd samples and gives the magnitude of the
+     *          bins 0 to size / 2 - 1, as an unnormalized DFT. The window, the bit reversal
+     *          and both sets of twiddle factors are tables, and the working and output
+     *          buffers are allocated by begin(), so a transform never allocates memory.
+     *
+     * @param size Number of points of the FFT
+     * @param samples Number of samples of a block, the rest are zeros
+     * @param window Window of the samples
+     * @param fft Complex FFT of size / 2 points
+     * @param splitTwiddles Cosine and sine of the twiddle factors of the split pass
+     * @param work Packed complex samples, real and imaginary parts interleaved
+     * @param output Magnitudes of the bins
+     *
+     */
+    class fftPlan {
+        uint16_t size = 0;
+        uint16_t samples = 0;
+        vector<float> window;
+        complexFft fft;
+        vector<float> splitTwiddles;
+        vector<float> work;
+        vector<float> output;
+
+        public:
+            bool begin ( uint16_t pSize, uint16_t pSamples, fftWindow pWindow );
+
+            const float* magnitudes ( const int32_t* input );
+
+            uint16_t getSize ();
+
+            uint16_t getSamples ();
+    };
+}
+
+#endif /* FFTPLAN_H */
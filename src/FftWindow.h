@@ -0,0 +1,49 @@
+#ifndef FFTWINDOW_H
+#define FFTWINDOW_H
+
+#include <stdint.h>
+#include <math.h>
+
+namespace std
+{
+    /** FFT window enum
+     *
+     * @brief This enum is the window applied to the samples before the FFT.
+     *
+     */
+    enum fftWindow {
+        FFT_WINDOW_RECTANGULAR,
+        FFT_WINDOW_HANN,
+        FFT_WINDOW_BLACKMAN
+    };
+
+    /** FFT window value function
+     *
+     * @brief This function computes a point of a window.
+     *
+     * @param window Window.
+     * @param n Index of the sample.
+     * @param count Number of samples of the window.
+     *
+     * @return Value of the window, between 0 and 1.
+     *
+     * @note The window is periodic (divided by count and not by count - 1), the one of
+     *       spectral analysis.
+     *
+     */
+    inline float fftWindowValue ( fftWindow window, uint16_t n, uint16_t count )
+    {
+        float phase = 2 * M_PI * n / count;
+        switch ( window )
+        {
+            case FFT_WINDOW_HANN:
+                return 0.5f - 0.5f * cosf(phase);
+            case FFT_WINDOW_BLACKMAN:
+                return 0.42f - 0.5f * cosf(phase) + 0.08f * cosf(2 * phase);
+            default:
+                return 1.0f;
+        }
+    }
+}
+
+#endif /* FFTWINDOW_H */
@@ -0,0 +1,214 @@
+// Generated by scripts/generate_coefficients.py from data/coefficients.txt. Do not edit.
+#ifndef FILTERCOEFFICIENTS_H
+#define FILTERCOEFFICIENTS_H
+
+#include <stdint.h>
+
+constexpr uint16_t FILTER_TAPS = 201;
+constexpr uint32_t FILTER_SAMPLE_RATE = 25;
+
+constexpr float FILTER_COEFFICIENTS[FILTER_TAPS] = {
+    -0.0f,
+    -0.000144f,
+    -0.000197f,
+    -0.000108f,
+    9.9e-05f,
+    0.000338f,
+    0.000498f,
+    0.000504f,
+    0.000358f,
+    0.000146f,
+    -0.0f,
+    3e-05f,
+    0.000256f,
+    0.00059f,
+    0.000866f,
+    0.000928f,
+    0.00072f,
+    0.000329f,
+    -4.3e-05f,
+    -0.000187f,
+    0.0f,
+    0.000432f,
+    0.000863f,
+    0.001006f,
+    0.000695f,
+    -0.0f,
+    -0.000785f,
+    -0.001283f,
+    -0.001244f,
+    -0.000703f,
+    0.0f,
+    0.000387f,
+    0.000102f,
+    -0.000867f,
+    -0.002132f,
+    -0.003089f,
+    -0.003234f,
+    -0.002469f,
+    -0.0012f,
+    -0.000155f,
+    -0.0f,
+    -0.000941f,
+    -0.002556f,
+    -0.00397f,
+    -0.004305f,
+    -0.003188f,
+    -0.001015f,
+    0.001202f,
+    0.002347f,
+    0.001837f,
+    -0.0f,
+    -0.002017f,
+    -0.00283f,
+    -0.001592f,
+    0.001476f,
+    0.005095f,
+    0.007561f,
+    0.007664f,
+    0.005428f,
+    0.002198f,
+    -0.0f,
+    0.00044f,
+    0.003748f,
+    0.008505f,
+    0.012294f,
+    0.01297f,
+    0.009899f,
+    0.004453f,
+    -0.000578f,
+    -0.002444f,
+    0.0f,
+    0.005484f,
+    0.010799f,
+    0.012424f,
+    0.008487f,
+    -0.0f,
+    -0.009414f,
+    -0.01529f,
+    -0.014754f,
+    -0.008324f,
+    0.0f,
+    0.004597f,
+    0.001213f,
+    -0.010452f,
+    -0.026049f,
+    -0.038389f,
+    -0.04108f,
+    -0.032226f,
+    -0.016189f,
+    -0.002183f,
+    0.0f,
+    -0.014709f,
+    -0.042916f,
+    -0.07271f,
+    -0.087819f,
+    -0.07451f,
+    -0.028296f,
+    0.042662f,
+    0.119304f,
+    0.178189f,
+    0.200254f,
+    0.178189f,
+    0.119304f,
+    0.042662f,
+    -0.028296f,
+    -0.07451f,
+    -0.087819f,
+    -0.07271f,
+    -0.042916f,
+    -0.014709f,
+    0.0f,
+    -0.002183f,
+    -0.016189f,
+    -0.032226f,
+    -0.04108f,
+    -0.038389f,
+    -0.026049f,
+    -0.010452f,
+    0.001213f,
+    0.004597f,
+    0.0f,
+    -0.008324f,
+    -0.014754f,
+    -0.01529f,
+    -0.009414f,
+    -0.0f,
+    0.008487f,
+    0.012424f,
+    0.010799f,
+    0.005484f,
+    0.0f,
+    -0.002444f,
+    -0.000578f,
+    0.004453f,
+    0.009899f,
+    0.01297f,
+    0.012294f,
+    0.008505f,
+    0.003748f,
+    0.00044f,
+    -0.0f,
+    0.002198f,
+    0.005428f,
+    0.007664f,
+    0.007561f,
+    0.005095f,
+    0.001476f,
+    -0.001592f,
+    -0.00283f,
+    -0.002017f,
+    -0.0f,
+    0.001837f,
+    0.002347f,
+    0.001202f,
+    -0.001015f,
+    -0.003188f,
+    -0.004305f,
+    -0.00397f,
+    -0.002556f,
+    -0.000941f,
+    -0.0f,
+    -0.000155f,
+    -0.0012f,
+    -0.002469f,
+    -0.003234f,
+    -0.003089f,
+    -0.002132f,
+    -0.000867f,
+    0.000102f,
+    0.000387f,
+    0.0f,
+    -0.000703f,
+    -0.001244f,
+    -0.001283f,
+    -0.000785f,
+    -0.0f,
+    0.000695f,
+    0.001006f,
+    0.000863f,
+    0.000432f,
+    0.0f,
+    -0.000187f,
+    -4.3e-05f,
+    0.000329f,
+    0.00072f,
+    0.000928f,
+    0.000866f,
+    0.00059f,
+    0.000256f,
+    3e-05f,
+    -0.0f,
+    0.000146f,
+    0.000358f,
+    0.000504f,
+    0.000498f,
+    0.000338f,
+    9.9e-05f,
+    -0.000108f,
+    -0.000197f,
+    -0.000144f,
+    -0.0f
+};
+
+#endif /* FILTERCOEFFICIENTS_H */
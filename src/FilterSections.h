@@ -0,0 +1,17 @@
+// Generated by scripts/generate_coefficients.py from data/sections.txt. Do not edit.
+#ifndef FILTERSECTIONS_H
+#define FILTERSECTIONS_H
+
+#include <stdint.h>
+
+constexpr uint16_t FILTER_SECTIONS = 3;
+constexpr uint32_t FILTER_SECTIONS_SAMPLE_RATE = 25;
+
+// b0, b1, b2, a1, a2 of each section, with a0 = 1
+constexpr float FILTER_SECTION_COEFFICIENTS[5 * FILTER_SECTIONS] = {
+    0.558273833f, 0.0f, -0.558273833f, -1.20320336f, 0.602437209f,
+    0.245237275f, 0.0f, -0.245237275f, -1.43614963f, 0.509525449f,
+    0.132196275f, 0.0f, -0.132196275f, -1.88931023f, 0.905859245f
+};
+
+#endif /* FILTERSECTIONS_H */
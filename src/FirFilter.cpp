@@ -0,0 +1,132 @@
+#include "FirFilter.h"
+
+using namespace std;
+
+/** FIR filter constructor
+ * 
+ * @brief This is the constructor of the FIR filter class.
+ * 
+ * @param pTaps Number of taps of the filter.
+ * 
+ * @details The coefficients and the delay line are allocated here, so filtering
+ *          a sample never allocates memory.
+ * 
+ */
+firFilter::firFilter ( int pTaps ) : taps(pTaps), coefs(pTaps, 0.0f), delayLine(4 * pTaps, 0.0f) {}
+
+/** Set coefficient function
+ * 
+ * @brief This function sets one coefficient of the filter.
+ * 
+ * @param index Index of the coefficient, being 0 the one applied to the newest sample.
+ * @param value Value of the coefficient.
+ * 
+ * @note The coefficients are stored in reverse order so the convolution runs over
+ *       the delay line from the oldest to the newest sample.
+ * 
+ */
+void firFilter::setCoefficient ( int index, float value )
+{
+    if ( index < 0 || index >= taps ) return;
+    coefs[taps - 1 - index] = value;
+}
+
+/** Set coefficients function
+ * 
+ * @brief This function sets all the coefficients of the filter.
+ * 
+ * @param pCoefs Coefficients of the filter.
+ * @param size Number of coefficients.
+ * 
+ * @see setCoefficient().
+ * 
+ */
+void firFilter::setCoefficients ( const float* pCoefs, int size )
+{
+    for (int i = 0; i < size && i < taps; i++)
+    {
+        setCoefficient(i, pCoefs[i]);
+    }
+}
+
+/** Get taps function
+ * 
+ * @brief This function returns the number of taps of the filter.
+ * 
+ * @return Number of taps.
+ * 
+ */
+int firFilter::getTaps ()
+{
+    return taps;
+}
+
+/** Is ready function
+ * 
+ * @brief This function returns if the delay line is full.
+ * 
+ * @return True if there are enough samples to filter, false if not.
+ * 
+ */
+bool firFilter::isReady ()
+{
+    return storedSamples >= taps;
+}
+
+/** Push sample function
+ * 
+ * @brief This function adds a new sample of each channel to the delay line.
+ * 
+ * @param valueIR IR sample.
+ * @param valueRed Red sample.
+ * 
+ * @details The sample overwrites the oldest one and is mirrored taps positions ahead,
+ *          so the window of the last taps samples starts at head and is contiguous.
+ * 
+ */
+void firFilter::pushSample ( float valueIR, float valueRed )
+{
+    float* first = &delayLine[2 * head];
+    float* mirror = &delayLine[2 * (head + taps)];
+    first[0] = mirror[0] = valueIR;
+    first[1] = mirror[1] = valueRed;
+
+    head++;
+    if ( head == taps ) head = 0;
+    if ( storedSamples < taps ) storedSamples++;
+}
+
+/** Filter function
+ * 
+ * @brief This function applies the filter to the last taps samples of both channels.
+ * 
+ * @param resultOfIR Result of the convolution of the filter and the IR samples.
+ * @param resultOfRed Result of the convolution of the filter and the red samples.
+ * 
+ */
+void firFilter::filter ( float& resultOfIR, float& resultOfRed )
+{
+    const float* window = &delayLine[2 * head];
+    const float* coef = coefs.data();
+    float accIR = 0.0f;
+    float accRed = 0.0f;
+    for (int n = 0; n < taps; n++)
+    {
+        accIR += coef[n] * window[2 * n];
+        accRed += coef[n] * window[2 * n + 1];
+    }
+    resultOfIR = accIR;
+    resultOfRed = accRed;
+}
+
+/** Reset function
+ * 
+ * @brief This function empties the delay line.
+ * 
+ */
+void firFilter::reset ()
+{
+    fill(delayLine.begin(), delayLine.end(), 0.0f);
+    head = 0;
+    storedSamples = 0;
+}
@@ -0,0 +1,54 @@
+#ifndef FIRFILTER_H
+#define FIRFILTER_H
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+namespace std
+{
+    /** FIR filter class
+     *
+     * @brief This class is the streaming FIR filter of the IR and red channels.
+     *
+     * @details The delay line is a mirrored circular buffer: every sample is written at
+     *          position head and head + taps, so the last taps samples are always
+     *          contiguous in memory and the convolution never wraps. The IR and red
+     *          samples are interleaved, so both channels are filtered in one pass with
+     *          a single read of each coefficient. Memory is allocated once in the
+     *          constructor.
+     *
+     * @param taps Number of taps of the filter
+     * @param coefs Coefficients of the filter, stored in reverse order
+     * @param delayLine Interleaved IR/red delay line of 2 * taps samples per channel
+     * @param head Position of the oldest sample in the delay line
+     * @param storedSamples Number of samples stored until the delay line is full
+     *
+     */
+    class firFilter {
+        int taps;
+        vector<float> coefs;
+        vector<float> delayLine;
+        int head = 0;
+        int storedSamples = 0;
+
+        public:
+            firFilter ( int pTaps );
+
+            void setCoefficient ( int index, float value );
+
+            void setCoefficients ( const float* pCoefs, int size );
+
+            int getTaps ();
+
+            bool isReady ();
+
+            void pushSample ( float valueIR, float valueRed );
+
+            void filter ( float& resultOfIR, float& resultOfRed );
+
+            void reset ();
+    };
+}
+
+#endif /* FIRFILTER_H */
@@ -0,0 +1,166 @@
+#include "FixedFft.h"
+
+using namespace std;
+
+/** Fixed FFT constructor
+ *
+ * @brief This is the constructor of the fixed FFT class, which fills the tables of the
+ *        twiddle factors.
+ *
+ */
+fixedFft::fixedFft ( )
+{
+    for (uint16_t k = 0; k < FIXED_FFT_MAX_SIZE / 2; k++)
+    {
+        float angle = 2 * M_PI * k / FIXED_FFT_MAX_SIZE;
+        cosTable[k] = toQ15(cos(angle));
+        sinTable[k] = toQ15(sin(angle));
+    }
+}
+
+/** Begin function
+ *
+ * @brief This function sets the size of the FFT and computes the window.
+ *
+ * @param pSize Number of points of the FFT, a power of 2 from 2 to FIXED_FFT_MAX_SIZE.
+ * @param pSamples Number of samples of a block, at most pSize.
+ * @param pWindow Window of the samples.
+ *
+ * @return True if the size is valid, false if not.
+ *
+ */
+bool fixedFft::begin ( uint16_t pSize, uint16_t pSamples, fftWindow pWindow )
+{
+    size = 0;
+    if ( pSize < 2 || pSize > FIXED_FFT_MAX_SIZE || (pSize & (pSize - 1)) != 0 ) return false;
+
+    this -> samples = pSamples < pSize ? pSamples : pSize;
+    window.resize(samples);
+    for (uint16_t n = 0; n < samples; n++) window[n] = toQ15(fftWindowValue(pWindow, n, samples));
+    output.assign(pSize / 2, 0.0f);
+    this -> size = pSize;
+    return true;
+}
+
+/** Magnitudes function
+ *
+ * @brief This function computes the magnitude of the spectrum of a block of samples.
+ *
+ * @param input Samples of the block, as signed 32 bits integers.
+ *
+ * @return Magnitudes of the bins 0 to size / 2 - 1, scaled as the DFT and valid until
+ *         the next call, or NULL if the FFT has not begun.
+ *
+ * @details The magnitudes are scaled back by the size and by the block scaling when
+ *          they are converted to float.
+ *
+ */
+const float* fixedFft::magnitudes ( const int32_t* input )
+{
+    if ( size == 0 ) return NULL;
+
+    int64_t sum = 0;
+    for (uint16_t i = 0; i < samples; i++) sum += input[i];
+    int32_t mean = sum / samples;
+
+    // block scaling
+    uint32_t peak = 0;
+    for (uint16_t i = 0; i < samples; i++)
+    {
+        int64_t value = int64_t(input[i]) - mean;
+        uint32_t magnitude = value < 0 ? -value : value;
+        if ( magnitude > peak ) peak = magnitude;
+    }
+    uint8_t shift = 0;
+    while ( (peak >> shift) >= (uint32_t(1) << FIXED_FFT_INPUT_BITS) ) shift++;
+
+    // bit reversed order
+    uint8_t bits = 0;
+    while ( (1 << bits) < size ) bits++;
+    for (uint16_t i = 0; i < size; i++)
+    {
+        uint16_t reversed = 0;
+        for (uint8_t b = 0; b < bits; b++) reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        int32_t value = 0;
+        if ( i < samples )
+        {
+            value = int32_t((int64_t(input[i]) - mean) >> shift);
+            value = (value * window[i] + (1 << (Q15_SHIFT - 1))) >> Q15_SHIFT;
+        }
+        real[reversed] = value;
+        imag[reversed] = 0;
+    }
+
+    for (uint16_t half = 1; half < size; half <<= 1)
+    {
+        uint16_t stride = FIXED_FFT_MAX_SIZE / (2 * half);
+        for (uint16_t k = 0; k < half; k++)
+        {
+            // exp(-j * 2 * pi * k / (2 * half))
+            int32_t wr = cosTable[k * stride];
+            int32_t wi = -sinTable[k * stride];
+            for (uint16_t i = k; i < size; i += 2 * half)
+            {
+                uint16_t j = i + half;
+                int32_t tr = (real[j] * wr - imag[j] * wi + (1 << (Q15_SHIFT - 1))) >> Q15_SHIFT;
+                int32_t ti = (real[j] * wi + imag[j] * wr + (1 << (Q15_SHIFT - 1))) >> Q15_SHIFT;
+                int32_t ur = real[i];
+                int32_t ui = imag[i];
+                real[i] = (ur + tr) >> 1;
+                imag[i] = (ui + ti) >> 1;
+                real[j] = (ur - tr) >> 1;
+                imag[j] = (ui - ti) >> 1;
+            }
+        }
+    }
+
+    float scale = float(size) * float(uint32_t(1) << shift);
+    for (uint16_t i = 0; i < size / 2; i++)
+    {
+        uint32_t power = int32_t(real[i]) * real[i] + int32_t(imag[i]) * imag[i];
+        output[i] = squareRoot(power) * scale;
+    }
+    return output.data();
+}
+
+/** Get size function
+ *
+ * @brief This function returns the number of points of the FFT.
+ *
+ * @return Number of points, 0 if the FFT has not begun.
+ *
+ */
+uint16_t fixedFft::getSize ( )
+{
+    return size;
+}
+
+/** Square root function
+ *
+ * @brief This function computes the integer square root, bit by bit.
+ *
+ * @param value Value.
+ *
+ * @return Square root of the value, rounded down.
+ *
+ */
+uint16_t fixedFft::squareRoot ( uint32_t value )
+{
+    uint32_t root = 0;
+    uint32_t bit = uint32_t(1) << 30;
+    while ( bit > value ) bit >>= 2;
+    while ( bit != 0 )
+    {
+        if ( value >= root + bit )
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
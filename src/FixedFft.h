@@ -0,0 +1,64 @@
+#ifndef FIXEDFFT_H
+#define FIXEDFFT_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "FftWindow.h"
+#include "FixedPoint.h"
+
+namespace std
+{
+    // Maximum size of the fixed point FFT, a power of 2
+    const uint16_t FIXED_FFT_MAX_SIZE = 256;
+    // Bits of the samples after the block scaling, one below Q15 for the rounding
+    const uint8_t FIXED_FFT_INPUT_BITS = 14;
+
+    /** Fixed FFT class
+     *
+     * @brief This class is the radix 2 FFT in Q15 of the filtered samples, for FIXED_POINT.
+     *
+     * @details It is the fixed point version of fftPlan. The mean of the block is removed
+     *          and the samples are shifted to FIXED_FFT_INPUT_BITS bits (block floating
+     *          point), so the AC part keeps all the precision whatever the level of the
+     *          sensor, multiplied by the window in Q15 and zero padded up to the size.
+     *          Every butterfly divides its outputs by 2, so the values never grow and the
+     *          transform is the DFT divided by the size. The twiddle factors are a Q15
+     *          table of FIXED_FFT_MAX_SIZE / 2 points computed in the constructor, and
+     *          smaller sizes step over it. The working buffers are 16 bits, half of the
+     *          float ones of fftPlan.
+     *
+     * @param size Number of points of the FFT, 0 until begin() is called
+     * @param samples Number of samples of a block, the rest are zeros
+     * @param window Window of the samples in Q15
+     * @param cosTable Cosine of the twiddle factors in Q15
+     * @param sinTable Sine of the twiddle factors in Q15
+     * @param real Real part of the working buffer
+     * @param imag Imaginary part of the working buffer
+     * @param output Magnitudes of the bins
+     *
+     */
+    class fixedFft {
+        uint16_t size = 0;
+        uint16_t samples = 0;
+        vector<int16_t> window;
+        int16_t cosTable[FIXED_FFT_MAX_SIZE / 2];
+        int16_t sinTable[FIXED_FFT_MAX_SIZE / 2];
+        int16_t real[FIXED_FFT_MAX_SIZE];
+        int16_t imag[FIXED_FFT_MAX_SIZE];
+        vector<float> output;
+
+        static uint16_t squareRoot ( uint32_t value );
+
+        public:
+            fixedFft ();
+
+            bool begin ( uint16_t pSize, uint16_t pSamples, fftWindow pWindow );
+
+            const float* magnitudes ( const int32_t* input );
+
+            uint16_t getSize ();
+    };
+}
+
+#endif /* FIXEDFFT_H */
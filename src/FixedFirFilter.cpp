@@ -0,0 +1,135 @@
+#include "FixedFirFilter.h"
+
+using namespace std;
+
+/** Fixed FIR filter constructor
+ *
+ * @brief This is the constructor of the fixed FIR filter class.
+ *
+ * @param pTaps Number of taps of the filter.
+ *
+ * @details The coefficients and the delay line are allocated here, so filtering
+ *          a sample never allocates memory.
+ *
+ */
+fixedFirFilter::fixedFirFilter ( int pTaps ) : taps(pTaps), coefs(pTaps, 0), delayLine(4 * pTaps, 0) {}
+
+/** Set coefficient function
+ *
+ * @brief This function sets one coefficient of the filter.
+ *
+ * @param index Index of the coefficient, being 0 the one applied to the newest sample.
+ * @param value Value of the coefficient, in [-1, 1].
+ *
+ * @note The coefficient is converted to Q31 and stored in reverse order, as in firFilter.
+ *
+ */
+void fixedFirFilter::setCoefficient ( int index, float value )
+{
+    if ( index < 0 || index >= taps ) return;
+    coefs[taps - 1 - index] = toQ31(value);
+}
+
+/** Set coefficients function
+ *
+ * @brief This function sets all the coefficients of the filter.
+ *
+ * @param pCoefs Coefficients of the filter.
+ * @param size Number of coefficients.
+ *
+ * @see setCoefficient().
+ *
+ */
+void fixedFirFilter::setCoefficients ( const float* pCoefs, int size )
+{
+    for (int i = 0; i < size && i < taps; i++)
+    {
+        setCoefficient(i, pCoefs[i]);
+    }
+}
+
+/** Get taps function
+ *
+ * @brief This function returns the number of taps of the filter.
+ *
+ * @return Number of taps.
+ *
+ */
+int fixedFirFilter::getTaps ()
+{
+    return taps;
+}
+
+/** Is ready function
+ *
+ * @brief This function returns if the delay line is full.
+ *
+ * @return True if there are enough samples to filter, false if not.
+ *
+ */
+bool fixedFirFilter::isReady ()
+{
+    return storedSamples >= taps;
+}
+
+/** Push sample function
+ *
+ * @brief This function adds a new sample of each channel to the delay line.
+ *
+ * @param valueIR IR sample.
+ * @param valueRed Red sample.
+ *
+ * @see firFilter::pushSample().
+ *
+ */
+void fixedFirFilter::pushSample ( int32_t valueIR, int32_t valueRed )
+{
+    int32_t* first = &delayLine[2 * head];
+    int32_t* mirror = &delayLine[2 * (head + taps)];
+    first[0] = mirror[0] = valueIR;
+    first[1] = mirror[1] = valueRed;
+
+    head++;
+    if ( head == taps ) head = 0;
+    if ( storedSamples < taps ) storedSamples++;
+}
+
+/** Filter function
+ *
+ * @brief This function applies the filter to the last taps samples of both channels.
+ *
+ * @param resultOfIR Result of the convolution of the filter and the IR samples.
+ * @param resultOfRed Result of the convolution of the filter and the red samples.
+ *
+ * @details The products are accumulated in 64 bits and the result is taken back from
+ *          Q31 once at the end, truncated toward zero as the float results are when they
+ *          are stored, so both paths give the same samples to the analysis.
+ *
+ */
+void fixedFirFilter::filter ( int32_t& resultOfIR, int32_t& resultOfRed )
+{
+    const int32_t* window = &delayLine[2 * head];
+    const int32_t* coef = coefs.data();
+    int64_t accIR = 0;
+    int64_t accRed = 0;
+    for (int n = 0; n < taps; n++)
+    {
+        accIR += int64_t(coef[n]) * window[2 * n];
+        accRed += int64_t(coef[n]) * window[2 * n + 1];
+    }
+    const int64_t bias = (int64_t(1) << Q31_SHIFT) - 1;
+    resultOfIR = int32_t((accIR < 0 ? accIR + bias : accIR) >> Q31_SHIFT);
+    resultOfRed = int32_t((accRed < 0 ? accRed + bias : accRed) >> Q31_SHIFT);
+}
+
+/** Reset function
+ *
+ * @brief This function empties the delay line.
+ *
+ */
+void fixedFirFilter::reset ()
+{
+    fill(delayLine.begin(), delayLine.end(), 0);
+    head = 0;
+    storedSamples = 0;
+}
@@ -0,0 +1,56 @@
+#ifndef FIXEDFIRFILTER_H
+#define FIXEDFIRFILTER_H
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+#include "FixedPoint.h"
+
+namespace std
+{
+    /** Fixed FIR filter class
+     *
+     * @brief This class is the streaming FIR filter of the IR and red channels in fixed
+     *        point, for FIXED_POINT.
+     *
+     * @details It is the same filter as firFilter, with the samples as 32 bits integers, the
+     *          coefficients in Q31 and 64 bits accumulators, so it does not use the FPU. The
+     *          18 bits samples of the sensor times the Q31 coefficients fit in 49 bits, which
+     *          leaves room for the sum of thousands of taps. The delay line is the same
+     *          mirrored circular buffer, with the IR and red samples interleaved.
+     *
+     * @param taps Number of taps of the filter
+     * @param coefs Coefficients of the filter in Q31, stored in reverse order
+     * @param delayLine Interleaved IR/red delay line of 2 * taps samples per channel
+     * @param head Position of the oldest sample in the delay line
+     * @param storedSamples Number of samples stored until the delay line is full
+     *
+     */
+    class fixedFirFilter {
+        int taps;
+        vector<int32_t> coefs;
+        vector<int32_t> delayLine;
+        int head = 0;
+        int storedSamples = 0;
+
+        public:
+            fixedFirFilter ( int pTaps );
+
+            void setCoefficient ( int index, float value );
+
+            void setCoefficients ( const float* pCoefs, int size );
+
+            int getTaps ();
+
+            bool isReady ();
+
+            void pushSample ( int32_t valueIR, int32_t valueRed );
+
+            void filter ( int32_t& resultOfIR, int32_t& resultOfRed );
+
+            void reset ();
+    };
+}
+
+#endif /* FIXEDFIRFILTER_H */
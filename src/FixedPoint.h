@@ -0,0 +1,50 @@
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <stdint.h>
+#include <math.h>
+
+namespace std
+{
+    // Fractional bits of a Q15 value
+    const uint8_t Q15_SHIFT = 15;
+    // Fractional bits of a Q31 value
+    const uint8_t Q31_SHIFT = 31;
+
+    /** To Q15 function
+     *
+     * @brief This function converts a value in [-1, 1] to Q15, saturating at the limits.
+     *
+     * @param value Value to convert.
+     *
+     * @return Value in Q15.
+     *
+     */
+    inline int16_t toQ15 ( float value )
+    {
+        float scaled = roundf(value * 32768.0f);
+        if ( scaled >= 32767.0f ) return INT16_MAX;
+        if ( scaled <= -32768.0f ) return INT16_MIN;
+        return int16_t(scaled);
+    }
+
+    /** To Q31 function
+     *
+     * @brief This function converts a value in [-1, 1] to Q31, saturating at the limits.
+     *
+     * @param value Value to convert.
+     *
+     * @return Value in Q31.
+     *
+     */
+    inline int32_t toQ31 ( float value )
+    {
+        // a float has 24 bits of mantissa, so the scaled value is exact
+        float scaled = roundf(value * 2147483648.0f);
+        if ( scaled >= 2147483648.0f ) return INT32_MAX;
+        if ( scaled <= -2147483648.0f ) return INT32_MIN;
+        return int32_t(scaled);
+    }
+}
+
+#endif /* FIXEDPOINT_H */
@@ -0,0 +1,304 @@
+#include "FrameEncoder.h"
+
+#include <string.h>
+#include <math.h>
+
+using namespace std;
+
+#define FRAME_MAGIC 'P'
+#define FRAME_HEADER_SIZE 6
+#define FRAME_SECTIONS_OFFSET 2
+
+/** Begin function
+ * 
+ * @brief This function starts a new frame with its header.
+ * 
+ * @see addVitals(), addWaveform(), addSpectrum().
+ * 
+ */
+void frameEncoder::begin ( )
+{
+    length = 0;
+    overflow = false;
+    putUint8(FRAME_MAGIC);
+    putUint8(BINARY_PROTOCOL_VERSION);
+    putUint8(0);
+    putUint8(0);
+    putUint16(sequence++);
+}
+
+/** Add vitals function
+ * 
+ * @brief This function adds the vitals section to the frame.
+ * 
+ * @param beatsPerMinute Beats per minute.
+ * @param spo2Percentage SPO2 percentage.
+ * 
+ */
+void frameEncoder::addVitals ( int32_t beatsPerMinute, int32_t spo2Percentage )
+{
+    if ( !reserve(4) ) return;
+    buffer[FRAME_SECTIONS_OFFSET] |= FRAME_HAS_VITALS;
+    putUint16(beatsPerMinute < 0 ? 0 : beatsPerMinute * 10);
+    putUint16(spo2Percentage < 0 ? 0 : spo2Percentage * 10);
+}
+
+/** Add waveform function
+ * 
+ * @brief This function adds the waveform section to the frame.
+ * 
+ * @param samples Heart rate samples.
+ * 
+ * @details The first sample is stored as is and the rest as the zigzag encoded difference
+ *          with the previous one, so small changes take one or two bytes. The samples are
+ *          signed and the differences wrap around 32 bits, like the decoder does.
+ * 
+ */
+void frameEncoder::addWaveform ( const dataView<int32_t>& samples )
+{
+    // worst case: 5 bytes per difference
+    size_t count = samples.size();
+    if ( count > 0xFFFF || !reserve(6 + 5 * count) ) return;
+    buffer[FRAME_SECTIONS_OFFSET] |= FRAME_HAS_WAVEFORM;
+    putUint16(count);
+    if ( count == 0 ) return;
+
+    putInt32(samples[0]);
+    for (size_t i = 1; i < count; i++)
+    {
+        putZigzag(int32_t(uint32_t(samples[i]) - uint32_t(samples[i-1])));
+    }
+}
+
+/** Add spectrum function
+ * 
+ * @brief This function adds the spectrum section to the frame.
+ * 
+ * @param freqs Fundamentals frequencies.
+ * 
+ * @details If the frequencies are equally spaced, only the first one and the step are
+ *          stored. The amplitudes are stored relative to the maximum amplitude.
+ * 
+ */
+void frameEncoder::addSpectrum ( const dataView<fundamentalsFreqs>& freqs )
+{
+    size_t count = freqs.size();
+    bool uniform = true;
+    float step = count > 1 ? freqs[1].freqsHz - freqs[0].freqsHz : 0;
+    float maxAmplitude = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if ( i > 0 && fabsf(freqs[i].freqsHz - freqs[i-1].freqsHz - step) > 0.001f ) uniform = false;
+        if ( freqs[i].amplitude > maxAmplitude ) maxAmplitude = freqs[i].amplitude;
+    }
+
+    size_t axisSize = uniform ? 8 : 2 * count;
+    if ( count > 0xFFFF || !reserve(3 + axisSize + 4 + 2 * count) ) return;
+    buffer[FRAME_SECTIONS_OFFSET] |= FRAME_HAS_SPECTRUM;
+    putUint16(count);
+    if ( uniform )
+    {
+        putUint8(SPECTRUM_AXIS_UNIFORM);
+        putFloat(count > 0 ? freqs[0].freqsHz : 0);
+        putFloat(step);
+    } else {
+        putUint8(SPECTRUM_AXIS_EXPLICIT);
+        for (size_t i = 0; i < count; i++)
+        {
+            putUint16(uint16_t(freqs[i].freqsHz * 100 + 0.5f));
+        }
+    }
+
+    putFloat(maxAmplitude);
+    for (size_t i = 0; i < count; i++)
+    {
+        float relative = maxAmplitude > 0 ? freqs[i].amplitude / maxAmplitude : 0;
+        if ( relative < 0 ) relative = 0;
+        putUint16(uint16_t(relative * 65535 + 0.5f));
+    }
+}
+
+/** Add stream function
+ * 
+ * @brief This function adds the stream section to the frame.
+ * 
+ * @param samples Consecutive filtered samples.
+ * @param count Number of samples.
+ * 
+ * @details The sequence number is only stored for the first sample, as the samples are
+ *          consecutive. The timestamps and the samples are stored as the difference with 
+ *          the previous one, like the waveform section.
+ * 
+ * @see globalValues::popWaveformSamples().
+ * 
+ */
+void frameEncoder::addStream ( const waveformSample* samples, size_t count )
+{
+    // worst case: 10 bytes per difference
+    if ( count > 0xFFFF || !reserve(14 + 10 * count) ) return;
+    buffer[FRAME_SECTIONS_OFFSET] |= FRAME_HAS_STREAM;
+    putUint32(count > 0 ? samples[0].sequence : 0);
+    putUint16(count);
+    if ( count == 0 ) return;
+
+    putUint32(samples[0].timestamp);
+    putInt32(samples[0].value);
+    for (size_t i = 1; i < count; i++)
+    {
+        putZigzag(int32_t(samples[i].timestamp - samples[i-1].timestamp));
+        putZigzag(int32_t(uint32_t(samples[i].value) - uint32_t(samples[i-1].value)));
+    }
+}
+
+/** Get data function
+ * 
+ * @brief This function returns the bytes of the frame.
+ * 
+ * @return Pointer to the first byte of the frame.
+ * 
+ */
+const uint8_t* frameEncoder::getData ( )
+{
+    return buffer;
+}
+
+/** Size function
+ * 
+ * @brief This function returns the size of the frame.
+ * 
+ * @return Number of bytes of the frame.
+ * 
+ */
+size_t frameEncoder::size ( )
+{
+    return length;
+}
+
+/** Overflowed function
+ * 
+ * @brief This function returns if some section did not fit in the frame.
+ * 
+ * @return True if a section was left out, false if not.
+ * 
+ */
+bool frameEncoder::overflowed ( )
+{
+    return overflow;
+}
+
+/** Reserve function
+ * 
+ * @brief This function checks if there is room for a section.
+ * 
+ * @param bytes Maximum size of the section.
+ * 
+ * @return True if the section fits, false if not.
+ * 
+ */
+bool frameEncoder::reserve ( size_t bytes )
+{
+    if ( length + bytes > BINARY_FRAME_SIZE )
+    {
+        overflow = true;
+        return false;
+    }
+    return true;
+}
+
+/** Put uint8 function
+ * 
+ * @brief This function appends a byte to the frame.
+ * 
+ * @param value Byte.
+ * 
+ */
+void frameEncoder::putUint8 ( uint8_t value )
+{
+    buffer[length++] = value;
+}
+
+/** Put uint16 function
+ * 
+ * @brief This function appends a 16 bits integer in little endian to the frame.
+ * 
+ * @param value Integer.
+ * 
+ */
+void frameEncoder::putUint16 ( uint16_t value )
+{
+    putUint8(value & 0xFF);
+    putUint8(value >> 8);
+}
+
+/** Put uint32 function
+ * 
+ * @brief This function appends a 32 bits integer in little endian to the frame.
+ * 
+ * @param value Integer.
+ * 
+ */
+void frameEncoder::putUint32 ( uint32_t value )
+{
+    putUint16(value & 0xFFFF);
+    putUint16(value >> 16);
+}
+
+/** Put int32 function
+ * 
+ * @brief This function appends a signed 32 bits integer in little endian and two's 
+ *        complement to the frame.
+ * 
+ * @param value Integer.
+ * 
+ */
+void frameEncoder::putInt32 ( int32_t value )
+{
+    putUint32(uint32_t(value));
+}
+
+/** Put float function
+ * 
+ * @brief This function appends a 32 bits float in little endian to the frame.
+ * 
+ * @param value Float.
+ * 
+ */
+void frameEncoder::putFloat ( float value )
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    putUint32(bits);
+}
+
+/** Put varint function
+ * 
+ * @brief This function appends an unsigned integer with 7 bits per byte, the highest
+ *        bit set meaning that more bytes follow.
+ * 
+ * @param value Integer.
+ * 
+ */
+void frameEncoder::putVarint ( uint32_t value )
+{
+    while ( value >= 0x80 )
+    {
+        putUint8((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    putUint8(value);
+}
+
+/** Put zigzag function
+ * 
+ * @brief This function appends a signed integer as a varint, mapping the small negative 
+ *        and positive values to small unsigned values (0, -1, 1, -2... to 0, 1, 2, 3...).
+ * 
+ * @param value Integer.
+ * 
+ * @see putVarint().
+ * 
+ */
+void frameEncoder::putZigzag ( int32_t value )
+{
+    putVarint((uint32_t(value) << 1) ^ uint32_t(value >> 31));
+}
@@ -0,0 +1,97 @@
+#ifndef FRAMEENCODER_H
+#define FRAMEENCODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "DataView.h"
+#include "GlobalValues.h"
+
+namespace std
+{
+    // Size of the binary frame sent to the web page
+    const size_t BINARY_FRAME_SIZE = 2048;
+    // Version of the binary protocol
+    const uint8_t BINARY_PROTOCOL_VERSION = 1;
+    // Name of the binary protocol, used as WebSocket subprotocol
+    const char BINARY_PROTOCOL_NAME[] = "pulsiox.bin.v1";
+
+    // Sections of a binary frame, in order of appearance
+    const uint8_t FRAME_HAS_VITALS = 0x01;
+    const uint8_t FRAME_HAS_WAVEFORM = 0x02;
+    const uint8_t FRAME_HAS_SPECTRUM = 0x04;
+    const uint8_t FRAME_HAS_STREAM = 0x08;
+
+    // Frequency axis of the spectrum section
+    const uint8_t SPECTRUM_AXIS_UNIFORM = 0;
+    const uint8_t SPECTRUM_AXIS_EXPLICIT = 1;
+
+    /** Frame encoder class
+     *
+     * @brief This class encodes the values sent to the web page as a compact binary frame.
+     *
+     * @details All the fields are little endian. A frame is structured as follows:
+     *          - header: magic 'P' (u8), version (u8), sections (u8), reserved (u8),
+     *            sequence (u16).
+     *          - vitals: beats per minute and SPO2 percentage in tenths (u16 each).
+     *          - waveform: number of samples (u16), first sample (i32) and the differences
+     *            between consecutive samples as zigzag varints, wrapping around 32 bits.
+     *            The samples are the filtered signal, so they are signed.
+     *          - spectrum: number of bins (u16), axis type (u8), the axis (start and step 
+     *            in Hz as f32 if it is uniform, or each frequency in hundredths of Hz as 
+     *            u16 if not), the maximum amplitude (f32) and each amplitude relative to
+     *            it (u16, 65535 = maximum).
+     *          - stream: sequence number of the first sample (u32), number of samples (u16),
+     *            timestamp of the first sample in ms (u32), first sample (i32) and, for each
+     *            next sample, the timestamp difference in ms and the sample difference as
+     *            zigzag varints. The samples are signed, like in the waveform section.
+     *          The sections are only present if their bit is set in the sections field.
+     *
+     * @param buffer Bytes of the frame
+     * @param length Number of bytes of the frame
+     * @param overflow True if some section did not fit
+     * @param sequence Sequence number of the next frame
+     *
+     */
+    class frameEncoder {
+        uint8_t buffer[BINARY_FRAME_SIZE];
+        size_t length = 0;
+        bool overflow = false;
+        uint16_t sequence = 0;
+
+        bool reserve ( size_t bytes );
+
+        void putUint8 ( uint8_t value );
+
+        void putUint16 ( uint16_t value );
+
+        void putUint32 ( uint32_t value );
+
+        void putInt32 ( int32_t value );
+
+        void putFloat ( float value );
+
+        void putVarint ( uint32_t value );
+
+        void putZigzag ( int32_t value );
+
+        public:
+            void begin ();
+
+            void addVitals ( int32_t beatsPerMinute, int32_t spo2Percentage );
+
+            void addWaveform ( const dataView<int32_t>& samples );
+
+            void addSpectrum ( const dataView<fundamentalsFreqs>& freqs );
+
+            void addStream ( const waveformSample* samples, size_t count );
+
+            const uint8_t* getData ();
+
+            size_t size ();
+
+            bool overflowed ();
+    };
+}
+
+#endif /* FRAMEENCODER_H */
@@ -7,13 +7,7 @@ using namespace std;
  * @brief This function is the constructor of the global values.
  *
  */
-globalValues::globalValues()
-{
-    this -> heartRateDataArray = {};
-    this -> beatsPerMinute = 0;
-    this -> spo2Percentage = 0;
-    this -> freqs = {};
-}
+globalValues::globalValues() : nextFrame() {}
 
 /** Global values constructor
  * 
@@ -24,14 +18,17 @@ globalValues::globalValues()
  * @param spo2Percentage SPO2 percentage.
  * @param freqs Fundamentals frequencies.
  * 
+ * @details The values are published as the first frame.
+ * 
  */
-globalValues::globalValues( vector<uint32_t> heartRateDataArray, int32_t beatsPerMinute,
-                            int32_t spo2Percentage, vector<fundamentalsFreqs> freqs )
+globalValues::globalValues( vector<int32_t> heartRateDataArray, int32_t beatsPerMinute,
+                            int32_t spo2Percentage, vector<fundamentalsFreqs> freqs ) : nextFrame()
 {
-    this -> heartRateDataArray = heartRateDataArray;
-    this -> beatsPerMinute = beatsPerMinute;
-    this -> spo2Percentage = spo2Percentage;
-    this -> freqs = freqs;
+    this -> heartRateDataArray.pushBack( heartRateDataArray.data(), heartRateDataArray.size() );
+    setBeatsPerMinute(beatsPerMinute);
+    setSpo2Percentage(spo2Percentage);
+    setFreqs(freqs.data(), freqs.size());
+    publish();
 }
 
 /** Push back heart rate data array function
@@ -41,30 +38,44 @@ globalValues::globalValues( vector<uint32_t> heartRateDataArray, int32_t beatsPe
  * @param pHeartRateDataArray Heart rate data array.
  * @param size Size of the heart rate data array.
  * 
+ * @details The samples are stored in the next frame and added to the heart rate data
+ *          array when the visualizer takes the frame.
+ * 
+ * @see publish(), update().
+ * 
  */
-void globalValues::pushBackHeartRateDataArray ( uint32_t* pHeartRateDataArray, uint32_t size )
+void globalValues::pushBackHeartRateDataArray ( const int32_t* pHeartRateDataArray, uint32_t size )
 {  
+    if ( size > MAX_BLOCK_SAMPLES ) size = MAX_BLOCK_SAMPLES;
     for (uint32_t i = 0; i < size; i++)
     {
-        this -> heartRateDataArray.push_back ( pHeartRateDataArray[i] );
+        this -> nextFrame.heartRateData[i] = pHeartRateDataArray[i];
     }
+    this -> nextFrame.heartRateDataCount = size;
+    this -> nextFrame.blockSequence++;
 }
 
+/** Shift heart rate function
+ * 
+ * @brief This function removes the oldest value of the heart rate data array.
+ * 
+ */
 void globalValues::shiftHeartRate()
 {
-    heartRateDataArray.erase( heartRateDataArray.begin() );
+    heartRateDataArray.advance();
 }
 
-/** Set heart rate data array function
+/** Get dropped heart rate samples function
  * 
- * @brief This function sets the heart rate data array.
+ * @brief This function returns the number of heart rate samples overwritten before
+ *        being shifted out of the heart rate data array.
  * 
- * @param heartRateDataArray Heart rate data array.
+ * @return Number of dropped samples.
  * 
  */
-void globalValues::setHeartRateDataArray ( vector<uint32_t> heartRateDataArray )
+uint32_t globalValues::getDroppedHeartRateSamples()
 {
-    this -> heartRateDataArray = heartRateDataArray;
+    return heartRateDataArray.getDropped();
 }
 
 /** Set beats per minute function
@@ -76,7 +87,7 @@ void globalValues::setHeartRateDataArray ( vector<uint32_t> heartRateDataArray )
  */
 void globalValues::setBeatsPerMinute ( int32_t beatsPerMinute )
 {
-    this -> beatsPerMinute = beatsPerMinute;
+    this -> nextFrame.beatsPerMinute = beatsPerMinute;
 }
 
 /** Set SPO2 percentage function
@@ -88,7 +99,7 @@ void globalValues::setBeatsPerMinute ( int32_t beatsPerMinute )
  */
 void globalValues::setSpo2Percentage ( int32_t spo2Percentage )
 {
-    this -> spo2Percentage = spo2Percentage;
+    this -> nextFrame.spo2Percentage = spo2Percentage;
 }
 
 /** Set fundamentals frequencies function
@@ -96,23 +107,177 @@ void globalValues::setSpo2Percentage ( int32_t spo2Percentage )
  * @brief This function sets the fundamentals frequencies.
  * 
  * @param freqs Fundamentals frequencies.
+ * @param count Number of fundamentals frequencies, at most MAX_PEAKS are stored.
+ * 
+ * @details The frames published until the next call keep these frequencies, and the 
+ *          sequence of the frequencies tells the visualizer that they have changed.
+ * 
+ * @see getFreqsSequence().
+ * 
+ */
+void globalValues::setFreqs ( const fundamentalsFreqs* freqs, uint16_t count )
+{
+    if ( count > MAX_PEAKS ) count = MAX_PEAKS;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        this -> nextFrame.freqs[i] = freqs[i];
+    }
+    this -> nextFrame.freqsCount = count;
+    this -> nextFrame.freqsSequence++;
+}
+
+/** Publish function
+ * 
+ * @brief This function publishes the values set since the last publish.
+ * 
+ * @details The next frame is copied into the triple buffer, so the visualizer
+ *          can take it with update(). It is called by the reader task.
+ * 
+ */
+void globalValues::publish ( )
+{
+    frames.getWriteBuffer() = nextFrame;
+    frames.publish();
+}
+
+/** Push waveform sample function
+ * 
+ * @brief This function pushes a filtered sample to the waveform stream.
+ * 
+ * @param value Filtered sample.
+ * @param timestamp Time since boot when the sample was taken in ms.
+ * 
+ * @details The sample gets the next sequence number even if the stream is full and the
+ *          sample is dropped, so the gap can be detected by the web page. It is called 
+ *          by the reader task.
+ * 
+ * @see popWaveformSamples().
+ * 
+ */
+void globalValues::pushWaveformSample ( int32_t value, uint32_t timestamp )
+{
+    waveformSample sample = { waveformSequence++, timestamp, value };
+    waveformStream.push(sample);
+}
+
+/** Publish spectrum function
+ * 
+ * @brief This function publishes the peaks of a spectrum of the sliding DFT.
+ * 
+ * @param freqs Fundamentals frequencies.
+ * @param count Number of fundamentals frequencies, at most MAX_PEAKS are published.
+ * 
+ * @details It is called by the sampler task, so it has its own triple buffer instead of
+ *          the frame of the blocks, which is written by the analysis task.
+ * 
+ * @see updateSpectrum(), slidingDft.
+ * 
+ */
+void globalValues::publishSpectrum ( const fundamentalsFreqs* freqs, uint16_t count )
+{
+    spectrumFrame& frame = spectrumFrames.getWriteBuffer();
+    if ( count > MAX_PEAKS ) count = MAX_PEAKS;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        frame.freqs[i] = freqs[i];
+    }
+    frame.freqsCount = count;
+    spectrumFrames.publish();
+}
+
+/** Update function
+ * 
+ * @brief This function takes the newest frame published by the reader.
+ * 
+ * @return True if there is a new frame, false if not.
+ * 
+ * @details If the frame has a new block of heart rate data, it is added to the heart
+ *          rate data array and its spikes are corrected. It is called by the visualizer 
+ *          task before the getters.
+ * 
+ * @see correctHeartRateSpikes().
+ * 
+ */
+bool globalValues::update ( )
+{
+    if ( !frames.update() ) return false;
+
+    const globalValuesFrame& frame = frames.getReadBuffer();
+    if ( frame.blockSequence != lastBlockSequence )
+    {
+        heartRateDataArray.pushBack( frame.heartRateData, frame.heartRateDataCount );
+        correctHeartRateSpikes( frame.heartRateDataCount );
+        lastBlockSequence = frame.blockSequence;
+    }
+    return true;
+}
+
+/** Update spectrum function
+ * 
+ * @brief This function takes the newest spectrum published by the sampler.
+ * 
+ * @return True if there is a new spectrum, false if not.
+ * 
+ * @details From then on, getFreqs() returns the spectra of the sliding DFT. It is called 
+ *          by the visualizer task.
+ * 
+ * @see publishSpectrum(), getFreqs().
  * 
  */
-void globalValues::setFreqs ( vector<fundamentalsFreqs> freqs )
+bool globalValues::updateSpectrum ( )
 {
-    this -> freqs = freqs;
+    if ( !spectrumFrames.update() ) return false;
+    hasSpectrum = true;
+    return true;
+}
+
+/** Correct heart rate spikes function
+ * 
+ * @brief This function smooths the spikes of the newest samples of the heart rate data array.
+ * 
+ * @param newSamples Number of samples just added.
+ * 
+ * @details The samples are filtered, so they are signed and a spike can not be told by its
+ *          value alone. A sample that steps away from both neighbours more than 
+ *          HEART_RATE_SPIKE_FACTOR times the mean step between the new samples is replaced
+ *          by the mean of its neighbours. The last sample of the previous block is also 
+ *          checked, as it had no next sample until now.
+ * 
+ * @see update().
+ * 
+ */
+void globalValues::correctHeartRateSpikes ( size_t newSamples )
+{
+    size_t size = heartRateDataArray.size();
+    size_t first = newSamples + 1 < size ? size - newSamples - 1 : 1;
+    if ( first + 1 >= size ) return;
+
+    int64_t steps = 0;
+    for (size_t i = first; i < size; i++)
+    {
+        int64_t step = int64_t(heartRateDataArray[i]) - heartRateDataArray[i-1];
+        steps += step < 0 ? -step : step;
+    }
+    int64_t threshold = HEART_RATE_SPIKE_FACTOR * (steps / int64_t(size - first));
+    for (size_t i = first; i + 1 < size; i++)
+    {
+        int64_t previous = int64_t(heartRateDataArray[i]) - heartRateDataArray[i-1];
+        int64_t next = int64_t(heartRateDataArray[i]) - heartRateDataArray[i+1];
+        bool spike = (previous > threshold && next > threshold) || (previous < -threshold && next < -threshold);
+        if ( spike ) heartRateDataArray[i] = int32_t((int64_t(heartRateDataArray[i-1]) + heartRateDataArray[i+1]) / 2);
+    }
 }
 
 /** Get heart rate data array function
  * 
  * @brief This function gets the heart rate data array.
  * 
- * @return Heart rate data array.
+ * @return View of the heart rate data array.
  * 
  */
-vector<uint32_t> globalValues::getHeartRateDataArray()
+dataView<int32_t> globalValues::getHeartRateDataArray()
 {
-    return heartRateDataArray;
+    return heartRateDataArray.view( 0, heartRateDataArray.size() );
 }
 
 /** Get heart rate data array function
@@ -121,31 +286,24 @@ vector<uint32_t> globalValues::getHeartRateDataArray()
  * 
  * @param N Size of the returned heart rate data array.
  * 
- * @return Heart rate data array.
+ * @return View of the N first values of the heart rate data array.
  * 
  */
-vector<uint32_t> globalValues::getHeartRateDataArray ( uint32_t N )
+dataView<int32_t> globalValues::getHeartRateDataArray ( uint32_t N )
 {
-    if ( N > heartRateDataArray.size() )return heartRateDataArray;
-    vector<uint32_t> result;
-    for (uint32_t i = 0; i < N; i++)
-    {
-        if ( heartRateDataArray[i] > 10*heartRateDataArray[i-1] && i+1 < heartRateDataArray.size()) 
-            heartRateDataArray[i] = (heartRateDataArray[i-1] + heartRateDataArray[i+1])/2;
-        result.push_back ( heartRateDataArray[i] );
-    }
-    return result;
+    return heartRateDataArray.view( 0, N );
 }
 
 /** Get first value of heart rate function
  * 
  * @brief This function gets the first value of the heartRate array.
  * 
- * @return First value of the heartRate array.
+ * @return First value of the heartRate array, 0 if it is empty.
  * 
  */
-uint32_t globalValues::getFirstValueHeartRate()
+int32_t globalValues::getFirstValueHeartRate()
 {
+    if ( heartRateDataArray.empty() ) return 0;
     return heartRateDataArray[0];
 }
 
@@ -158,7 +316,7 @@ uint32_t globalValues::getFirstValueHeartRate()
  */
 int32_t globalValues::getBeatsPerMinute()
 {
-    return beatsPerMinute;
+    return frames.getReadBuffer().beatsPerMinute;
 }
 
 /** Get SPO2 percentage function
@@ -170,17 +328,92 @@ int32_t globalValues::getBeatsPerMinute()
  */
 int32_t globalValues::getSpo2Percentage()
 {
-    return spo2Percentage;
+    return frames.getReadBuffer().spo2Percentage;
 }
 
 /** Get fundamentals frequencies function
  * 
  * @brief This function gets the fundamentals frequencies.
  * 
- * @return Fundamentals frequencies.
+ * @return View of the fundamentals frequencies of the last spectrum of the sliding DFT if
+ *         there is one, or of the last frame if not.
+ * 
+ */
+dataView<fundamentalsFreqs> globalValues::getFreqs()
+{
+    if ( hasSpectrum )
+    {
+        const spectrumFrame& spectrum = spectrumFrames.getReadBuffer();
+        return dataView<fundamentalsFreqs>(spectrum.freqs, spectrum.freqsCount);
+    }
+    const globalValuesFrame& frame = frames.getReadBuffer();
+    return dataView<fundamentalsFreqs>(frame.freqs, frame.freqsCount);
+}
+
+/** Get fundamentals frequencies sequence function
+ * 
+ * @brief This function gets the sequence of the fundamentals frequencies of the last frame.
+ * 
+ * @return Number of times the fundamentals frequencies had been set when the frame was
+ *         published, so the spectrum only has to be sent again when it changes.
+ * 
+ * @see setFreqs().
+ * 
+ */
+uint32_t globalValues::getFreqsSequence()
+{
+    return frames.getReadBuffer().freqsSequence;
+}
+
+/** Get pending waveform samples function
+ * 
+ * @brief This function gets the number of filtered samples waiting in the waveform stream.
+ * 
+ * @return Number of pending samples.
+ * 
+ */
+size_t globalValues::getPendingWaveformSamples()
+{
+    return waveformStream.size();
+}
+
+/** Pop waveform samples function
+ * 
+ * @brief This function takes the oldest samples of the waveform stream.
+ * 
+ * @param samples Array where the samples are copied.
+ * @param maxSamples Maximum number of samples to take.
+ * 
+ * @return Number of samples taken.
+ * 
+ * @details It stops before a gap in the sequence numbers, so the samples taken are 
+ *          always consecutive. It is called by the visualizer task.
+ * 
+ * @see pushWaveformSample().
+ * 
+ */
+size_t globalValues::popWaveformSamples ( waveformSample* samples, size_t maxSamples )
+{
+    size_t count = 0;
+    waveformSample sample;
+    while ( count < maxSamples && waveformStream.front(sample) )
+    {
+        if ( count > 0 && sample.sequence != samples[count-1].sequence + 1 ) break;
+        samples[count++] = sample;
+        waveformStream.pop();
+    }
+    return count;
+}
+
+/** Get dropped waveform samples function
+ * 
+ * @brief This function returns the number of filtered samples dropped because the waveform
+ *        stream was full.
+ * 
+ * @return Number of dropped samples.
  * 
  */
-vector<fundamentalsFreqs> globalValues::getFreqs()
+uint32_t globalValues::getDroppedWaveformSamples()
 {
-    return freqs;
+    return waveformStream.getDropped();
 }
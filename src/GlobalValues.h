@@ -1,11 +1,31 @@
 #ifndef GLOBALVALUES_H
 #define GLOBALVALUES_H
 
-#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <vector>
 
+#include "TripleBuffer.h"
+#include "RingBuffer.h"
+#include "DataView.h"
+#include "SpscQueue.h"
+
 namespace std
 {
+    // Maximum number of bins of a spectrum
+    const uint16_t MAX_FREQS = 128;
+    // Maximum number of fundamentals frequencies in a frame, the main peaks of the spectrum
+    const uint8_t MAX_PEAKS = 4;
+    // Maximum number of heart rate samples in a frame
+    const uint16_t MAX_BLOCK_SAMPLES = 200;
+    // Number of heart rate samples kept for the visualizer
+    const size_t HEART_RATE_HISTORY_SIZE = 4 * MAX_BLOCK_SAMPLES;
+    // A heart rate sample that steps away from both neighbours more than this many times the
+    // mean step of its block is a spike
+    const uint8_t HEART_RATE_SPIKE_FACTOR = 10;
+    // Number of filtered samples waiting to be streamed to the web page
+    const size_t WAVEFORM_STREAM_SIZE = 256;
+
     /** Fundamentals frequencies struct
      * 
      * @brief This struct is the fundamentals frequencies of the device.
@@ -21,52 +41,152 @@ namespace std
         float amplitude;
     };
 
-    /** Global values class
+    /** Waveform sample struct
      * 
-     * @brief This class is the global values of the device.
+     * @brief This struct is a filtered sample streamed to the web page.
+     * 
+     * @param sequence Number of samples filtered before this one since the start
+     * @param timestamp Time since boot when the sample was taken in ms
+     * @param value Filtered IR value, signed as the band-pass removes the DC level
+     *
+     */
+    struct waveformSample{
+        uint32_t sequence;
+        uint32_t timestamp;
+        int32_t value;
+    };
+
+    /** Global values frame struct
      * 
-     * @details This class is used to store the global values of the device.
+     * @brief This struct is a complete set of the values calculated in one block.
+     * 
+     * @details This struct is what the reader task publishes to the visualizer task.
      * 
-     * @param heartRateDataArray Array of heart rate data
      * @param beatsPerMinute Beats per minute
      * @param spo2Percentage Spo2 percentage
      * @param freqs Fundamentals frequencies
+     * @param freqsCount Number of fundamentals frequencies
+     * @param freqsSequence Number of times the fundamentals frequencies have been set
+     * @param heartRateData Heart rate data of the last block
+     * @param heartRateDataCount Number of heart rate samples of the last block
+     * @param blockSequence Number of heart rate blocks pushed since the start
+     *
+     */
+    struct globalValuesFrame{
+        int32_t beatsPerMinute;
+        int32_t spo2Percentage;
+        fundamentalsFreqs freqs[MAX_PEAKS];
+        uint16_t freqsCount;
+        uint32_t freqsSequence;
+        int32_t heartRateData[MAX_BLOCK_SAMPLES];
+        uint16_t heartRateDataCount;
+        uint32_t blockSequence;
+    };
+
+    /** Spectrum frame struct
+     * 
+     * @brief This struct is the peaks of a spectrum of the sliding DFT, published between
+     *        the blocks.
+     * 
+     * @param freqs Fundamentals frequencies
+     * @param freqsCount Number of fundamentals frequencies
+     *
+     */
+    struct spectrumFrame{
+        fundamentalsFreqs freqs[MAX_PEAKS];
+        uint16_t freqsCount;
+    };
+
+    /** Global values class
+     * 
+     * @brief This class is the global values of the device.
+     * 
+     * @details This class is used to share the global values between the reader task and
+     *          the visualizer task, which run in different cores. The reader writes with
+     *          the setters and publish(), and the visualizer takes the newest frame with 
+     *          update() and reads it with the getters, so it never sees a frame half
+     *          written. The heart rate data array is only accessed by the visualizer. It
+     *          has a fixed capacity: when it is full, the oldest samples are overwritten.
+     *          The getters return read only views, so reading the values never allocates
+     *          memory. Every filtered sample is also pushed to the waveform stream as soon
+     *          as it is calculated, so the visualizer can send them to the web page in 
+     *          small batches instead of waiting for a whole block. The spectrum of the
+     *          sliding DFT is published by the sampler task as often as it is updated, in
+     *          its own triple buffer, and it replaces the spectrum of the blocks once the
+     *          visualizer takes it with updateSpectrum().
+     * 
+     * @param frames Triple buffer of frames
+     * @param nextFrame Frame being written by the reader
+     * @param heartRateDataArray Array of heart rate data
+     * @param lastBlockSequence Block sequence of the last block added to the array
+     * @param waveformStream Queue of filtered samples from the reader to the visualizer
+     * @param waveformSequence Sequence number of the next filtered sample
+     * @param spectrumFrames Triple buffer of the spectra of the sliding DFT
+     * @param hasSpectrum True if a spectrum of the sliding DFT has been taken
      *
      */
     class globalValues {
-        vector<uint32_t> heartRateDataArray;
-        vector<fundamentalsFreqs> freqs;
-        int32_t beatsPerMinute, spo2Percentage;
+        tripleBuffer<globalValuesFrame> frames;
+        globalValuesFrame nextFrame;
+        ringBuffer<int32_t, HEART_RATE_HISTORY_SIZE> heartRateDataArray;
+        uint32_t lastBlockSequence = 0;
+        spscQueue<waveformSample, WAVEFORM_STREAM_SIZE> waveformStream;
+        uint32_t waveformSequence = 0;
+        tripleBuffer<spectrumFrame> spectrumFrames;
+        bool hasSpectrum = false;
+
+        void correctHeartRateSpikes ( size_t newSamples );
 
         public:
             globalValues ();
             
-            globalValues ( vector<uint32_t> heartRateDataArray, int32_t beatsPerMinute, 
+            globalValues ( vector<int32_t> heartRateDataArray, int32_t beatsPerMinute, 
                         int32_t spo2Percentage, vector<fundamentalsFreqs> freqs );
 
-            void pushBackHeartRateDataArray ( uint32_t* pHeartRateDataArray, uint32_t size);
-
-            void setHeartRateDataArray ( vector <uint32_t>heartRateDataArray );
+            // Reader task
+            void pushBackHeartRateDataArray ( const int32_t* pHeartRateDataArray, uint32_t size);
             
             void setBeatsPerMinute ( int32_t beatsPerMinute );
 
             void setSpo2Percentage ( int32_t spo2Percentage );
 
-            void setFreqs ( vector<fundamentalsFreqs> freqs);
+            void setFreqs ( const fundamentalsFreqs* freqs, uint16_t count );
+
+            void publish ();
+
+            void pushWaveformSample ( int32_t value, uint32_t timestamp );
+
+            // Sampler task
+            void publishSpectrum ( const fundamentalsFreqs* freqs, uint16_t count );
+
+            // Visualizer task
+            bool update ();
+
+            bool updateSpectrum ();
             
-            vector<uint32_t> getHeartRateDataArray();
+            dataView<int32_t> getHeartRateDataArray();
 
-            vector<uint32_t> getHeartRateDataArray( uint32_t N );
+            dataView<int32_t> getHeartRateDataArray( uint32_t N );
                         
-            uint32_t getFirstValueHeartRate();
+            int32_t getFirstValueHeartRate();
             
             void shiftHeartRate();
 
+            uint32_t getDroppedHeartRateSamples();
+
             int32_t getBeatsPerMinute();
 
             int32_t getSpo2Percentage();
         
-            vector<fundamentalsFreqs> getFreqs();
+            dataView<fundamentalsFreqs> getFreqs();
+
+            uint32_t getFreqsSequence();
+
+            size_t getPendingWaveformSamples();
+
+            size_t popWaveformSamples ( waveformSample* samples, size_t maxSamples );
+
+            uint32_t getDroppedWaveformSamples();
     };
 }
-#endif /* GLOBALVALUES_H */
\ No newline at end of file
+#endif /* GLOBALVALUES_H */
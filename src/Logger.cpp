@@ -0,0 +1,199 @@
+#include "Logger.h"
+#include "TextBuffer.h"
+
+using namespace std;
+
+asyncLogger std::logger(Serial);
+
+static const char LEVEL_LETTERS[] = { ' ', 'E', 'W', 'I', 'D' };
+
+/** asyncLogger constructor
+ *
+ * @brief This function is the constructor of the logger.
+ *
+ * @param pOutput Output of the messages.
+ *
+ */
+asyncLogger::asyncLogger ( Print& pOutput ) : output(pOutput) {}
+
+/** Begin function
+ *
+ * @brief This function starts the drain task.
+ *
+ * @details The messages logged before are kept in the queue and written when the task
+ *          starts. It has to be called after the output is initialized. The task runs at
+ *          the priority of the Arduino loop task, which shares its core, so a loop that
+ *          does not block can not starve it.
+ *
+ */
+void asyncLogger::begin ( )
+{
+    xTaskCreatePinnedToCore(
+        drainTask,          /* Task function. */
+        "logDrain",         /* name of task. */
+        4096,               /* Stack size of task */
+        this,               /* parameter of the task */
+        LOG_DRAIN_PRIORITY, /* priority of the task */
+        NULL,               /* Task handle to keep track of created task */
+        LOG_DRAIN_CORE);    /* pin task to the core of the visualizer */
+}
+
+/** Drain task function
+ *
+ * @brief This function writes the queued messages, and sleeps LOG_DRAIN_PERIOD ms when
+ *        there are none.
+ *
+ * @param parameter Logger.
+ *
+ */
+void asyncLogger::drainTask ( void* parameter )
+{
+    asyncLogger* logger = static_cast<asyncLogger*>(parameter);
+    for (;;)
+    {
+        if ( !logger->drain() ) vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_PERIOD));
+    }
+}
+
+/** Push function
+ *
+ * @brief This function queues a message, or drops it if the queue is full.
+ *
+ * @param level Level of the message.
+ * @param format Format of the message.
+ * @param arguments Arguments of the message.
+ * @param count Number of arguments.
+ *
+ */
+void asyncLogger::push ( uint8_t level, const char* format, const logArgument* arguments, uint8_t count )
+{
+    logMessage message;
+    message.time = millis();
+    message.format = format;
+    message.level = level;
+    message.count = count;
+    for (uint8_t i = 0; i < count; i++) message.arguments[i] = arguments[i];
+    queue.push(message);
+}
+
+/** Drain function
+ *
+ * @brief This function writes all the queued messages.
+ *
+ * @return True if some message has been written.
+ *
+ * @details It is called by the drain task. Before a message, the messages dropped since
+ *          the last one are reported.
+ *
+ */
+bool asyncLogger::drain ( )
+{
+    bool written = false;
+    logMessage message;
+    while ( queue.pop(message) )
+    {
+        uint32_t dropped = queue.getDropped();
+        if ( dropped != reportedDrops )
+        {
+            output.printf("[%u] W %u log messages dropped\r\n", message.time, dropped - reportedDrops);
+            reportedDrops = dropped;
+        }
+        writeMessage(message);
+        written = true;
+    }
+    return written;
+}
+
+/** Flush function
+ *
+ * @brief This function writes the queued messages from the calling task.
+ *
+ * @details It is used before halting after a fatal error, when the drain task may not
+ *          run anymore.
+ *
+ */
+void asyncLogger::flush ( )
+{
+    drain();
+}
+
+/** Get dropped function
+ *
+ * @brief This function returns the number of messages dropped because the queue was full.
+ *
+ * @return Number of dropped messages.
+ *
+ */
+uint32_t asyncLogger::getDropped ( )
+{
+    return queue.getDropped();
+}
+
+/** Write message function
+ *
+ * @brief This function formats a message and writes it to the output.
+ *
+ * @param message Message.
+ *
+ * @details Each conversion of the format is done with snprintf and its argument, read as
+ *          an integer, a float or a string by its conversion character. The length
+ *          modifiers are ignored, as the arguments have 32 bits. The line is truncated to
+ *          LOG_LINE_SIZE characters.
+ *
+ */
+void asyncLogger::writeMessage ( const logMessage& message )
+{
+    textBuffer<LOG_LINE_SIZE> line;
+    char field[LOG_LINE_SIZE];
+    snprintf(field, sizeof(field), "[%u] %c ", message.time, LEVEL_LETTERS[message.level]);
+    line.append(field);
+
+    uint8_t argument = 0;
+    const char* character = message.format;
+    while ( *character != '\0' )
+    {
+        if ( *character != '%' )
+        {
+            char text[2] = { *character++, '\0' };
+            line.append(text);
+            continue;
+        }
+        if ( character[1] == '%' )
+        {
+            line.append("%");
+            character += 2;
+            continue;
+        }
+
+        // copy the flags, the width and the precision, skipping the length modifiers
+        char specification[16];
+        uint8_t length = 0;
+        specification[length++] = *character++;
+        while ( *character != '\0' && strchr("diouxXcsfFeEgG", *character) == NULL )
+        {
+            if ( strchr("hlLzjt", *character) == NULL && length < sizeof(specification) - 2 )
+            {
+                specification[length++] = *character;
+            }
+            character++;
+        }
+        if ( *character == '\0' ) break;
+        char conversion = *character++;
+        specification[length++] = conversion;
+        specification[length] = '\0';
+
+        if ( argument >= message.count )
+        {
+            line.append(specification);
+            continue;
+        }
+        const logArgument& value = message.arguments[argument++];
+        if ( strchr("fFeEgG", conversion) != NULL ) snprintf(field, sizeof(field), specification, double(value.f));
+        else if ( conversion == 's' ) snprintf(field, sizeof(field), specification, value.s ? value.s : "(null)");
+        else if ( conversion == 'd' || conversion == 'i' || conversion == 'c' ) snprintf(field, sizeof(field), specification, int(value.i));
+        else snprintf(field, sizeof(field), specification, (unsigned int)value.u);
+        line.append(field);
+    }
+    output.write((const uint8_t*)line.c_str(), line.size());
+    output.write((const uint8_t*)"\r\n", 2);
+}
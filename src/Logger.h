@@ -0,0 +1,157 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+
+#include "MpmcQueue.h"
+
+// LOG LEVELS : the messages above LOG_LEVEL are not compiled (e.g. -DLOG_LEVEL=LOG_LEVEL_DEBUG
+// in build_flags to print the FFT results and the display pages)
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+namespace std
+{
+    // Maximum number of arguments of a message
+    const uint8_t LOG_MAX_ARGUMENTS = 6;
+    // Number of messages waiting to be written, a power of two
+    const size_t LOG_QUEUE_SIZE = 64;
+    // Maximum length of a written line
+    const size_t LOG_LINE_SIZE = 160;
+    // Time the drain task sleeps when there are no messages in ms
+    const uint32_t LOG_DRAIN_PERIOD = 10;
+    // Core of the drain task, the one of the visualizer, so the reader is not delayed
+    const BaseType_t LOG_DRAIN_CORE = 1;
+    // Priority of the drain task, the one of the loop task of its core, so it is not starved
+    const UBaseType_t LOG_DRAIN_PRIORITY = 1;
+
+    /** Log argument union
+     *
+     * @brief Argument of a message, interpreted by its conversion in the format.
+     *
+     */
+    union logArgument {
+        int32_t i;
+        uint32_t u;
+        float f;
+        const char* s;
+    };
+
+    /** Log message struct
+     *
+     * @brief Message waiting to be formatted and written.
+     *
+     * @param time Time of the message since boot in ms
+     * @param format Format of the message, which has to be a literal or a string that lives
+     *               until it is written, as the %s arguments
+     * @param level Level of the message
+     * @param count Number of arguments
+     * @param arguments Arguments of the message
+     *
+     */
+    struct logMessage {
+        uint32_t time;
+        const char* format;
+        uint8_t level;
+        uint8_t count;
+        logArgument arguments[LOG_MAX_ARGUMENTS];
+    };
+
+    inline logArgument toLogArgument ( int value ) { logArgument argument; argument.i = value; return argument; }
+    inline logArgument toLogArgument ( long value ) { logArgument argument; argument.i = value; return argument; }
+    inline logArgument toLogArgument ( unsigned int value ) { logArgument argument; argument.u = value; return argument; }
+    inline logArgument toLogArgument ( unsigned long value ) { logArgument argument; argument.u = value; return argument; }
+    inline logArgument toLogArgument ( double value ) { logArgument argument; argument.f = value; return argument; }
+    inline logArgument toLogArgument ( const char* value ) { logArgument argument; argument.s = value; return argument; }
+
+    /** Asynchronous logger class
+     *
+     * @brief This class writes the log messages of the tasks in a low priority task, so
+     *        the tasks do not wait for the serial port.
+     *
+     * @details A message is queued with its format and its arguments without formatting
+     *          it, which only copies a few words. The drain task formats the messages and
+     *          writes them to the output. If the queue is full the message is dropped, and
+     *          the number of dropped messages is written with the next message. The
+     *          arguments are 32 bits values: integers, floats and strings.
+     *
+     * @param queue Messages waiting to be written
+     * @param output Output of the messages
+     * @param reportedDrops Dropped messages already reported
+     *
+     */
+    class asyncLogger {
+        mpmcQueue<logMessage, LOG_QUEUE_SIZE> queue;
+        Print& output;
+        uint32_t reportedDrops = 0;
+
+        static void drainTask ( void* parameter );
+
+        void push ( uint8_t level, const char* format, const logArgument* arguments, uint8_t count );
+
+        void writeMessage ( const logMessage& message );
+
+        public:
+            asyncLogger ( Print& pOutput );
+
+            void begin ();
+
+            /** Log function
+             *
+             * @brief This function queues a message. It can be called by any task.
+             *
+             * @param level Level of the message.
+             * @param format Format of the message, as printf.
+             * @param values Arguments of the format.
+             *
+             */
+            template <typename... T>
+            void log ( uint8_t level, const char* format, T... values )
+            {
+                static_assert(sizeof...(T) <= LOG_MAX_ARGUMENTS, "Too many arguments in a log message");
+                logArgument arguments[sizeof...(T) + 1] = { toLogArgument(values)... };
+                push(level, format, arguments, sizeof...(T));
+            }
+
+            bool drain ();
+
+            void flush ();
+
+            uint32_t getDropped ();
+    };
+
+    extern asyncLogger logger;
+}
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) logger.log(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) logger.log(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) logger.log(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logger.log(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+#endif /* LOGGER_H */
@@ -0,0 +1,275 @@
+#include "Max3010xFifo.h"
+
+using namespace std;
+
+// MAX3010x FIFO registers
+#define MAX3010X_FIFO_WRITE_POINTER 0x04
+#define MAX3010X_FIFO_DATA 0x07
+
+#ifndef I2C_BUFFER_LENGTH
+#define I2C_BUFFER_LENGTH 32
+#endif
+
+/** MAX3010x FIFO constructor
+ * 
+ * @brief This is the constructor of the MAX3010x FIFO class.
+ * 
+ * @param pInterruptPin Pin connected to the INT pin of the sensor.
+ * @param pAlmostFullThreshold Number of samples in the FIFO that asserts the INT pin (17 to 32).
+ * @param pSampleRate Sample rate of the LEDs in Hz (50 to 3200).
+ * @param pSampleAverage Number of samples averaged in each sample of the FIFO (1 to 32).
+ * 
+ * @see initMAX30102().
+ * 
+ */
+max3010xFifo::max3010xFifo ( uint8_t pInterruptPin, uint8_t pAlmostFullThreshold, 
+                             uint16_t pSampleRate, uint8_t pSampleAverage )
+{
+    this -> interruptPin = pInterruptPin;
+    this -> almostFullThreshold = pAlmostFullThreshold;
+    this -> sampleRate = pSampleRate;
+    this -> sampleAverage = pSampleAverage;
+}
+
+/** Begin function
+ * 
+ * @brief This function initializes the sensor and attaches the INT pin interrupt.
+ * 
+ * @return True if the sensor is ready.
+ * 
+ * @see initMAX30102().
+ * 
+ */
+bool max3010xFifo::begin ( )
+{
+    initMAX30102(0x1F, sampleAverage, 2, sampleRate);
+
+    // INT pin is open drain and active low
+    pinMode(interruptPin, INPUT_PULLUP);
+    attachInterruptArg(digitalPinToInterrupt(interruptPin), onInterrupt, this, FALLING);
+    return true;
+}
+
+/** Init MAX30102 function
+ * 
+ * @brief This function initializes the MAX30102 sensor.
+ * 
+ * @param ledBrightness LED brightness.
+ * @param sampleAverage Sample average.
+ * @param ledMode LED mode.
+ * @param sampleRate Sample rate.
+ * @param pulseWidth Pulse width.
+ * @param adcRange ADC range.
+ * 
+ * @note The parameters are set to the default values, which give 25 samples per second
+ *       in the FIFO (100 Hz averaged 4 times). begin() uses the sample rate and average
+ *       of the constructor. The different options are:
+ *      - ledBrightness: 0 = Off to 255 = 50mA
+ *      - sampleAverage: 1, 2, 4, 8, 16, 32
+ *      - ledMode: 1 = Red only, 2 = Red + IR, 3 = Red + IR + Green
+ *      - sampleRate: 50, 100, 200, 400, 800, 1000, 1600, 3200
+ *      - pulseWidth: 69, 118, 215, 411
+ *      - adcRange: 2048, 4096, 8192, 16384
+ * 
+ * @see begin().
+ * 
+ */
+void max3010xFifo::initMAX30102 ( byte ledBrightness, byte sampleAverage, byte ledMode, 
+                                  int sampleRate, int pulseWidth, int adcRange )
+{
+    // Initialize sensor
+    if (!particleSensor.begin(Wire, I2C_SPEED_FAST)) //Use default I2C port, 400kHz speed
+    {
+        LOG_ERROR("MAX30105 was not found. Please check wiring/power.");
+        logger.flush();
+        while (1);
+    }
+    particleSensor.setup(ledBrightness, sampleAverage, ledMode, sampleRate, pulseWidth, adcRange); 
+    activeLEDs = ledMode;
+    this -> sampleRate = sampleRate;
+    this -> sampleAverage = sampleAverage;
+
+    // Assert the INT pin when the FIFO has almostFullThreshold samples
+    particleSensor.setFIFOAlmostFull(SENSOR_FIFO_DEPTH - almostFullThreshold);
+    particleSensor.enableAFULL();
+    particleSensor.getINT1(); // clear the power ready interrupt
+}
+
+/** Get sample rate function
+ * 
+ * @brief This function returns the rate of the samples in the FIFO.
+ * 
+ * @return Sample rate divided by the sample average in Hz.
+ * 
+ */
+uint16_t max3010xFifo::getSampleRate ( )
+{
+    return sampleRate / sampleAverage;
+}
+
+/** Interrupt function
+ * 
+ * @brief This function is called when the INT pin of the sensor is asserted.
+ * 
+ * @param arg Pointer to the MAX3010x FIFO object.
+ * 
+ */
+void IRAM_ATTR max3010xFifo::onInterrupt ( void* arg )
+{
+    static_cast<max3010xFifo*>(arg) -> interruptPending = true;
+}
+
+/** Data pending function
+ * 
+ * @brief This function returns if the FIFO has reached the almost full threshold.
+ * 
+ * @return True if the FIFO should be read.
+ * 
+ * @note The level of the INT pin is also checked, so a missed edge does not stop the
+ *       acquisition.
+ * 
+ */
+bool max3010xFifo::dataPending ( )
+{
+    return interruptPending || digitalRead(interruptPin) == LOW;
+}
+
+/** Check function
+ * 
+ * @brief This function reads all the samples in the FIFO of the sensor.
+ * 
+ * @return Number of samples read.
+ * 
+ * @details This function first reads the Interrupt Status 1 register, which is the
+ *          only way to clear the almost full flag and release the INT pin. It is read
+ *          before the FIFO, so a threshold reached during the burst asserts the pin
+ *          again. Then it reads the write pointer, the overflow counter and the read
+ *          pointer in one transaction and then the FIFO data in bursts as long as the
+ *          I2C buffer allows. Each sample has 3 bytes per active LED, red first. The
+ *          overflow counter is the number of samples lost because the FIFO was full,
+ *          and it is cleared by the sensor when the data is read.
+ * 
+ */
+uint16_t max3010xFifo::check ( )
+{
+    interruptPending = false;
+    storedSamples = 0;
+    readSamples = 0;
+    checkTime = millis();
+
+    // clear the almost full interrupt, reading the FIFO does not
+    particleSensor.getINT1();
+
+    Wire.beginTransmission(MAX30105_ADDRESS);
+    Wire.write(MAX3010X_FIFO_WRITE_POINTER);
+    Wire.endTransmission(false);
+    Wire.requestFrom((uint8_t)MAX30105_ADDRESS, (uint8_t)3);
+    uint8_t writePointer = Wire.read();
+    uint8_t overflowCounter = Wire.read();
+    uint8_t readPointer = Wire.read();
+    overflowSamples = overflowCounter;
+
+    // if both pointers are equal the FIFO is either empty or full
+    uint8_t numberOfSamples = (writePointer - readPointer) & (SENSOR_FIFO_DEPTH - 1);
+    if ( numberOfSamples == 0 && overflowCounter > 0 ) numberOfSamples = SENSOR_FIFO_DEPTH;
+    if ( numberOfSamples == 0 ) return 0;
+
+    uint8_t bytesPerSample = 3 * activeLEDs;
+    uint8_t samplesPerBurst = I2C_BUFFER_LENGTH / bytesPerSample;
+
+    Wire.beginTransmission(MAX30105_ADDRESS);
+    Wire.write(MAX3010X_FIFO_DATA);
+    Wire.endTransmission(false);
+    while ( storedSamples < numberOfSamples )
+    {
+        uint8_t burst = numberOfSamples - storedSamples;
+        if ( burst > samplesPerBurst ) burst = samplesPerBurst;
+        Wire.requestFrom((uint8_t)MAX30105_ADDRESS, (uint8_t)(burst * bytesPerSample));
+
+        for (uint8_t i = 0; i < burst; i++)
+        {
+            uint32_t slots[3] = {0, 0, 0};
+            for (uint8_t led = 0; led < activeLEDs; led++)
+            {
+                uint32_t value = uint32_t(Wire.read()) << 16;
+                value |= uint32_t(Wire.read()) << 8;
+                value |= uint32_t(Wire.read());
+                slots[led] = value & 0x3FFFF; // 18 bits
+            }
+            redSamples[storedSamples] = slots[0];
+            irSamples[storedSamples] = slots[1];
+            storedSamples++;
+        }
+    }
+    return storedSamples;
+}
+
+/** Get check time function
+ * 
+ * @brief This function returns the time of the last burst.
+ * 
+ * @return Time since boot of the last check() in ms.
+ * 
+ */
+uint32_t max3010xFifo::getCheckTime ( )
+{
+    return checkTime;
+}
+
+/** Get overflows function
+ * 
+ * @brief This function returns the samples lost before the last burst.
+ * 
+ * @return Value of the overflow counter of the sensor (up to 31) in the last check().
+ * 
+ */
+uint8_t max3010xFifo::getOverflows ( )
+{
+    return overflowSamples;
+}
+
+/** Available function
+ * 
+ * @brief This function returns the number of samples read and not consumed yet.
+ * 
+ * @return Number of samples available.
+ * 
+ */
+uint8_t max3010xFifo::available ( )
+{
+    return storedSamples - readSamples;
+}
+
+/** Get FIFO IR function
+ * 
+ * @brief This function returns the IR value of the current sample.
+ * 
+ * @return IR value.
+ * 
+ */
+uint32_t max3010xFifo::getFIFOIR ( )
+{
+    return irSamples[readSamples];
+}
+
+/** Get FIFO red function
+ * 
+ * @brief This function returns the red value of the current sample.
+ * 
+ * @return Red value.
+ * 
+ */
+uint32_t max3010xFifo::getFIFORed ( )
+{
+    return redSamples[readSamples];
+}
+
+/** Next sample function
+ * 
+ * @brief This function advances to the next sample.
+ * 
+ */
+void max3010xFifo::nextSample ( )
+{
+    if ( readSamples < storedSamples ) readSamples++;
+}
@@ -0,0 +1,85 @@
+#ifndef MAX3010XFIFO_H
+#define MAX3010XFIFO_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "MAX30105.h"
+
+#include "Logger.h"
+#include "SensorFifo.h"
+
+namespace std
+{
+    /** MAX3010x FIFO class
+     *
+     * @brief This class is the FIFO of the MAX3010x sensor.
+     *
+     * @details This class configures the FIFO almost full interrupt of the sensor and
+     *          reads the whole FIFO in one I2C burst when the INT pin is asserted. The
+     *          samples are kept in its own storage because the SparkFun library only
+     *          stores the last 4 samples read.
+     *
+     * @param particleSensor MAX30105 object
+     * @param interruptPin Pin connected to the INT pin of the sensor
+     * @param almostFullThreshold Number of samples in the FIFO that asserts the INT pin
+     * @param activeLEDs Number of active LEDs (slots per sample in the FIFO)
+     * @param sampleRate Sample rate of the LEDs in Hz
+     * @param sampleAverage Number of samples averaged in each sample of the FIFO
+     * @param interruptPending Flag set by the INT pin interrupt
+     * @param irSamples IR samples read in the last burst
+     * @param redSamples Red samples read in the last burst
+     * @param storedSamples Number of samples read in the last burst
+     * @param readSamples Number of samples already consumed
+     * @param checkTime Time since boot of the last burst in ms
+     * @param overflowSamples Samples lost by the FIFO before the last burst
+     *
+     */
+    class max3010xFifo : public sensorFifo {
+        MAX30105 particleSensor;
+        uint8_t interruptPin;
+        uint8_t almostFullThreshold;
+        uint8_t activeLEDs = 2;
+        uint16_t sampleRate;
+        uint8_t sampleAverage;
+        volatile bool interruptPending = false;
+
+        uint32_t irSamples[SENSOR_FIFO_DEPTH];
+        uint32_t redSamples[SENSOR_FIFO_DEPTH];
+        uint8_t storedSamples = 0;
+        uint8_t readSamples = 0;
+        uint32_t checkTime = 0;
+        uint8_t overflowSamples = 0;
+
+        static void IRAM_ATTR onInterrupt ( void* arg );
+
+        public:
+            max3010xFifo ( uint8_t pInterruptPin, uint8_t pAlmostFullThreshold = 24, 
+                           uint16_t pSampleRate = 100, uint8_t pSampleAverage = 4 );
+
+            bool begin ();
+
+            uint16_t getSampleRate ();
+
+            void initMAX30102 ( byte ledBrightness = 0x1F, byte sampleAverage = 4, byte ledMode = 2, 
+                                int sampleRate = 100, int pulseWidth = 411, int adcRange = 4096 );
+
+            bool dataPending ();
+
+            uint16_t check ();
+
+            uint32_t getCheckTime ();
+
+            uint8_t getOverflows ();
+
+            uint8_t available ();
+
+            uint32_t getFIFOIR ();
+
+            uint32_t getFIFORed ();
+
+            void nextSample ();
+    };
+}
+
+#endif /* MAX3010XFIFO_H */
@@ -0,0 +1,149 @@
+#ifndef MPMCQUEUE_H
+#define MPMCQUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace std
+{
+    /** Multiple producer multiple consumer queue class
+     *
+     * @brief This class is a fixed capacity FIFO shared by any number of tasks and
+     *        interrupts without locks.
+     *
+     * @details Each cell has a sequence number that tells if it is free for the producer
+     *          of a position or full for its consumer. A producer reserves a position by
+     *          incrementing the enqueue position with a compare and swap, writes the value
+     *          and then publishes it with the sequence number, and the consumers do the
+     *          same with the dequeue position. When the queue is full, the new value is
+     *          discarded and the dropped counter is incremented, so a producer never waits.
+     *
+     * @param cells Cells of the queue, CAPACITY has to be a power of two
+     * @param enqueuePosition Next position to write
+     * @param dequeuePosition Next position to read
+     * @param dropped Number of values discarded because the queue was full
+     *
+     */
+    template <typename T, size_t CAPACITY>
+    class mpmcQueue {
+        static_assert((CAPACITY & (CAPACITY - 1)) == 0 && CAPACITY >= 2, "The capacity has to be a power of two");
+
+        /** Cell struct
+         *
+         * @param sequence Position that can use the cell next: the position itself if it
+         *                 is free, the position + 1 if it holds the value of the position
+         * @param value Value of the cell
+         *
+         */
+        struct cell {
+            atomic<size_t> sequence;
+            T value;
+        };
+
+        cell cells[CAPACITY];
+        atomic<size_t> enqueuePosition;
+        atomic<size_t> dequeuePosition;
+        atomic<uint32_t> dropped;
+
+        public:
+            mpmcQueue () : enqueuePosition(0), dequeuePosition(0), dropped(0)
+            {
+                for (size_t i = 0; i < CAPACITY; i++)
+                {
+                    cells[i].sequence.store(i, memory_order_relaxed);
+                }
+            }
+
+            /** Push function
+             *
+             * @brief This function adds a value to the queue. It can be called by any task
+             *        or interrupt.
+             *
+             * @param value Value to add.
+             *
+             * @return True if the value has been added, false if the queue is full.
+             *
+             */
+            bool push ( const T& value )
+            {
+                size_t position = enqueuePosition.load(memory_order_relaxed);
+                for (;;)
+                {
+                    cell& target = cells[position & (CAPACITY - 1)];
+                    size_t sequence = target.sequence.load(memory_order_acquire);
+                    intptr_t difference = intptr_t(sequence) - intptr_t(position);
+                    if ( difference == 0 )
+                    {
+                        if ( enqueuePosition.compare_exchange_weak(position, position + 1, memory_order_relaxed) )
+                        {
+                            target.value = value;
+                            target.sequence.store(position + 1, memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if ( difference < 0 )
+                    {
+                        dropped.fetch_add(1, memory_order_relaxed);
+                        return false;
+                    }
+                    else
+                    {
+                        position = enqueuePosition.load(memory_order_relaxed);
+                    }
+                }
+            }
+
+            /** Pop function
+             *
+             * @brief This function removes the oldest value. It can be called by any task.
+             *
+             * @param value Oldest value.
+             *
+             * @return True if there was a value, false if the queue is empty.
+             *
+             */
+            bool pop ( T& value )
+            {
+                size_t position = dequeuePosition.load(memory_order_relaxed);
+                for (;;)
+                {
+                    cell& source = cells[position & (CAPACITY - 1)];
+                    size_t sequence = source.sequence.load(memory_order_acquire);
+                    intptr_t difference = intptr_t(sequence) - intptr_t(position + 1);
+                    if ( difference == 0 )
+                    {
+                        if ( dequeuePosition.compare_exchange_weak(position, position + 1, memory_order_relaxed) )
+                        {
+                            value = source.value;
+                            source.sequence.store(position + CAPACITY, memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if ( difference < 0 )
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        position = dequeuePosition.load(memory_order_relaxed);
+                    }
+                }
+            }
+
+            /** Get dropped function
+             *
+             * @brief This function returns the number of values discarded because the
+             *        queue was full.
+             *
+             * @return Number of dropped values.
+             *
+             */
+            uint32_t getDropped () const
+            {
+                return dropped.load(memory_order_relaxed);
+            }
+    };
+}
+
+#endif /* MPMCQUEUE_H */
@@ -0,0 +1,164 @@
+#include "PeakExtractor.h"
+
+using namespace std;
+
+/** Extract function
+ *
+ * @brief This function finds the main peaks of a spectrum.
+ *
+ * @param magnitudes Magnitudes of the bins.
+ * @param count Number of bins.
+ * @param firstFrequency Frequency of the first bin in Hz.
+ * @param step Frequency between bins in Hz.
+ *
+ * @return Number of peaks found, at most MAX_PEAKS.
+ *
+ * @details The first and the last bins are never peaks, as they have no neighbours to
+ *          interpolate, so the DC bin of an FFT is left out. A flat top counts as one
+ *          maximum, at its first bin. A harmonic is never higher than its fundamental, so
+ *          a strong pulse is not taken as a harmonic of the breathing.
+ *
+ * @see getPeaks().
+ *
+ */
+uint8_t peakExtractor::extract ( const float* magnitudes, uint16_t count, float firstFrequency, float step )
+{
+    // partial selection of the highest local maxima
+    uint8_t candidatesCount = 0;
+    for (uint16_t i = 1; i + 1 < count; i++)
+    {
+        float amplitude = magnitudes[i];
+        if ( !(amplitude > magnitudes[i-1] && amplitude >= magnitudes[i+1]) ) continue;
+        if ( candidatesCount == PEAK_CANDIDATES && amplitude <= candidates[PEAK_CANDIDATES - 1].amplitude ) continue;
+
+        uint8_t j = candidatesCount < PEAK_CANDIDATES ? candidatesCount++ : PEAK_CANDIDATES - 1;
+        while ( j > 0 && candidates[j-1].amplitude < amplitude )
+        {
+            candidates[j] = candidates[j-1];
+            j--;
+        }
+        candidates[j].amplitude = amplitude;
+        candidates[j].bin = i;
+    }
+
+    // interpolation, and sort by frequency
+    for (uint8_t c = 0; c < candidatesCount; c++) interpolate(magnitudes, firstFrequency, step, candidates[c]);
+    for (uint8_t c = 1; c < candidatesCount; c++)
+    {
+        spectralPeak peak = candidates[c];
+        uint8_t j = c;
+        while ( j > 0 && candidates[j-1].freqsHz > peak.freqsHz )
+        {
+            candidates[j] = candidates[j-1];
+            j--;
+        }
+        candidates[j] = peak;
+    }
+
+    // harmonic grouping, and sort by score
+    uint8_t groupsCount = 0;
+    for (uint8_t c = 0; c < candidatesCount; c++)
+    {
+        spectralPeak& peak = candidates[c];
+        bool harmonic = false;
+        for (uint8_t g = 0; g < groupsCount && !harmonic; g++)
+        {
+            if ( peak.amplitude > groups[g].amplitude ) continue;
+            float fundamental = groups[g].freqsHz;
+            int32_t n = lroundf(peak.freqsHz / fundamental);
+            if ( n < 2 || n > PEAK_MAX_HARMONIC ) continue;
+            if ( fabsf(peak.freqsHz - n * fundamental) > PEAK_HARMONIC_TOLERANCE * n * fundamental ) continue;
+            groups[g].score += peak.amplitude;
+            harmonic = true;
+        }
+        if ( harmonic ) continue;
+        groups[groupsCount] = peak;
+        groups[groupsCount].score = peak.amplitude;
+        groupsCount++;
+    }
+    for (uint8_t g = 1; g < groupsCount; g++)
+    {
+        spectralPeak group = groups[g];
+        uint8_t j = g;
+        while ( j > 0 && groups[j-1].score < group.score )
+        {
+            groups[j] = groups[j-1];
+            j--;
+        }
+        groups[j] = group;
+    }
+
+    peaksCount = groupsCount < MAX_PEAKS ? groupsCount : MAX_PEAKS;
+    for (uint8_t p = 0; p < peaksCount; p++)
+    {
+        peaks[p].freqsHz = groups[p].freqsHz;
+        peaks[p].amplitude = groups[p].amplitude;
+    }
+    return peaksCount;
+}
+
+/** Interpolate function
+ *
+ * @brief This function interpolates the frequency and the amplitude of a local maximum.
+ *
+ * @param magnitudes Magnitudes of the bins.
+ * @param firstFrequency Frequency of the first bin in Hz.
+ * @param step Frequency between bins in Hz.
+ * @param peak Local maximum, with the bin and its amplitude.
+ *
+ * @details The offset from the bin is d = (a - c) / (2 * (a - 2 * b + c)) and the amplitude
+ *          is b - (a - c) * d / 4, being a, b and c the logarithms of the magnitudes of the
+ *          previous bin, the bin and the next bin. If a neighbour is zero, the parabola goes
+ *          through the magnitudes instead.
+ *
+ */
+void peakExtractor::interpolate ( const float* magnitudes, float firstFrequency, float step, spectralPeak& peak )
+{
+    float previous = magnitudes[peak.bin - 1];
+    float center = magnitudes[peak.bin];
+    float next = magnitudes[peak.bin + 1];
+    bool logarithmic = previous > 0 && next > 0;
+    if ( logarithmic )
+    {
+        previous = logf(previous);
+        center = logf(center);
+        next = logf(next);
+    }
+
+    float offset = 0;
+    float amplitude = center;
+    float curvature = previous - 2 * center + next;
+    if ( curvature < 0 )
+    {
+        offset = 0.5f * (previous - next) / curvature;
+        amplitude = center - 0.25f * (previous - next) * offset;
+    }
+    peak.freqsHz = firstFrequency + (peak.bin + offset) * step;
+    peak.amplitude = logarithmic ? expf(amplitude) : amplitude;
+}
+
+/** Get peaks function
+ *
+ * @brief This function returns the peaks of the last spectrum.
+ *
+ * @return Peaks, from the highest group, valid until the next extract().
+ *
+ * @see getPeaksCount().
+ *
+ */
+const fundamentalsFreqs* peakExtractor::getPeaks ( )
+{
+    return peaks;
+}
+
+/** Get peaks count function
+ *
+ * @brief This function returns the number of peaks of the last spectrum.
+ *
+ * @return Number of peaks.
+ *
+ */
+uint8_t peakExtractor::getPeaksCount ( )
+{
+    return peaksCount;
+}
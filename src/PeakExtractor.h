@@ -0,0 +1,73 @@
+#ifndef PEAKEXTRACTOR_H
+#define PEAKEXTRACTOR_H
+
+#include <stdint.h>
+#include <math.h>
+
+#include "GlobalValues.h"
+
+namespace std
+{
+    // Local maxima kept by the selection, more than the peaks as the harmonics are grouped
+    const uint8_t PEAK_CANDIDATES = 2 * MAX_PEAKS;
+    // Highest harmonic grouped with its fundamental
+    const uint8_t PEAK_MAX_HARMONIC = 4;
+    // Maximum distance of a harmonic from n times its fundamental, relative to it
+    const float PEAK_HARMONIC_TOLERANCE = 0.03;
+
+    /** Spectral peak struct
+     *
+     * @brief This struct is a local maximum of a spectrum.
+     *
+     * @param freqsHz Frequency in Hz, interpolated between the bins
+     * @param amplitude Amplitude, interpolated between the bins
+     * @param score Amplitude of the peak plus the ones of its harmonics
+     * @param bin Index of the bin of the maximum
+     *
+     */
+    struct spectralPeak{
+        float freqsHz;
+        float amplitude;
+        float score;
+        uint16_t bin;
+    };
+
+    /** Peak extractor class
+     *
+     * @brief This class finds the MAX_PEAKS main peaks of a spectrum.
+     *
+     * @details It works in three steps. First, the PEAK_CANDIDATES highest local maxima
+     *          are kept sorted in a small array while the bins are scanned once, instead of
+     *          sorting the whole spectrum. Then, the frequency and the amplitude of each
+     *          one are interpolated with a parabola through the logarithm of the bin and
+     *          its neighbours (Gaussian interpolation), which is almost exact for the main
+     *          lobe of the window. Last, a peak close to 2 to PEAK_MAX_HARMONIC times a lower
+     *          and higher one is grouped with it as a harmonic, and the groups are ranked by the sum
+     *          of their amplitudes, so the harmonics of the pulse do not take the place of
+     *          other peaks and a strong harmonic makes its fundamental rank higher. The
+     *          peaks are the fundamentals of the groups with their own amplitude.
+     *
+     * @param candidates Highest local maxima, by amplitude and then by frequency
+     * @param groups Fundamentals of the harmonic groups
+     * @param peaks Main peaks, from the highest group
+     * @param peaksCount Number of main peaks
+     *
+     */
+    class peakExtractor {
+        spectralPeak candidates[PEAK_CANDIDATES];
+        spectralPeak groups[PEAK_CANDIDATES];
+        fundamentalsFreqs peaks[MAX_PEAKS];
+        uint8_t peaksCount = 0;
+
+        static void interpolate ( const float* magnitudes, float firstFrequency, float step, spectralPeak& peak );
+
+        public:
+            uint8_t extract ( const float* magnitudes, uint16_t count, float firstFrequency, float step );
+
+            const fundamentalsFreqs* getPeaks ();
+
+            uint8_t getPeaksCount ();
+    };
+}
+
+#endif /* PEAKEXTRACTOR_H */
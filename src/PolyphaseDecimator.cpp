@@ -0,0 +1,96 @@
+#include "PolyphaseDecimator.h"
+
+using namespace std;
+
+/** Polyphase decimator constructor
+ *
+ * @brief This is the constructor of the polyphase decimator class.
+ *
+ * @param pCoefs Coefficients of the low pass filter, being 0 the one applied to the newest sample.
+ * @param pTaps Number of coefficients.
+ * @param pFactor Decimation factor.
+ *
+ */
+polyphaseDecimator::polyphaseDecimator ( const float* pCoefs, int pTaps, uint8_t pFactor ) :
+                                         taps(pTaps), factor(pFactor), coefs(pTaps), delayLine(4 * pTaps, 0.0f)
+{
+    if ( factor == 0 ) factor = 1;
+    reverse_copy(pCoefs, pCoefs + pTaps, coefs.begin());
+}
+
+/** Push function
+ *
+ * @brief This function adds a sample of each channel and computes the output when it
+ *        is kept.
+ *
+ * @param valueIR IR sample, replaced by the IR output if there is one.
+ * @param valueRed Red sample, replaced by the red output if there is one.
+ *
+ * @return True if the values are an output, false if the sample has only been stored.
+ *
+ */
+bool polyphaseDecimator::push ( float& valueIR, float& valueRed )
+{
+    float* first = &delayLine[2 * head];
+    float* mirror = &delayLine[2 * (head + taps)];
+    first[0] = mirror[0] = valueIR;
+    first[1] = mirror[1] = valueRed;
+
+    head++;
+    if ( head == taps ) head = 0;
+    if ( storedSamples < taps ) storedSamples++;
+
+    if ( ++phase < factor ) return false;
+    phase = 0;
+    if ( storedSamples < taps ) return false;
+
+    const float* window = &delayLine[2 * head];
+    const float* coef = coefs.data();
+    float accIR = 0.0f;
+    float accRed = 0.0f;
+    for (int n = 0; n < taps; n++)
+    {
+        accIR += coef[n] * window[2 * n];
+        accRed += coef[n] * window[2 * n + 1];
+    }
+    valueIR = accIR;
+    valueRed = accRed;
+    return true;
+}
+
+/** Get taps function
+ *
+ * @brief This function returns the number of taps of the filter.
+ *
+ * @return Number of taps.
+ *
+ */
+int polyphaseDecimator::getTaps ()
+{
+    return taps;
+}
+
+/** Get factor function
+ *
+ * @brief This function returns the decimation factor.
+ *
+ * @return Number of inputs of each output.
+ *
+ */
+uint8_t polyphaseDecimator::getFactor ()
+{
+    return factor;
+}
+
+/** Reset function
+ *
+ * @brief This function empties the delay line.
+ *
+ */
+void polyphaseDecimator::reset ()
+{
+    fill(delayLine.begin(), delayLine.end(), 0.0f);
+    head = 0;
+    storedSamples = 0;
+    phase = 0;
+}
@@ -0,0 +1,54 @@
+#ifndef POLYPHASEDECIMATOR_H
+#define POLYPHASEDECIMATOR_H
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+namespace std
+{
+    /** Polyphase decimator class
+     *
+     * @brief This class is a FIR low pass filter of the IR and red channels that keeps
+     *        one output of every factor inputs.
+     *
+     * @details The inputs are only stored, and the filter is evaluated once every factor
+     *          inputs, for the output that is kept. This is the polyphase decomposition of
+     *          the decimator with its branches summed at the output: taps multiply
+     *          accumulates per output instead of factor * taps. The delay line is mirrored
+     *          and interleaved as the one of firFilter, so the window never wraps and both
+     *          channels share each coefficient. There is no output until the delay line is
+     *          full. Memory is allocated once in the constructor.
+     *
+     * @param taps Number of taps of the filter
+     * @param factor Decimation factor
+     * @param coefs Coefficients of the filter, stored in reverse order
+     * @param delayLine Interleaved IR/red delay line of 2 * taps samples per channel
+     * @param head Position of the oldest sample in the delay line
+     * @param storedSamples Number of samples stored until the delay line is full
+     * @param phase Number of inputs since the last output
+     *
+     */
+    class polyphaseDecimator {
+        int taps;
+        uint8_t factor;
+        vector<float> coefs;
+        vector<float> delayLine;
+        int head = 0;
+        int storedSamples = 0;
+        uint8_t phase = 0;
+
+        public:
+            polyphaseDecimator ( const float* pCoefs, int pTaps, uint8_t pFactor );
+
+            bool push ( float& valueIR, float& valueRed );
+
+            int getTaps ();
+
+            uint8_t getFactor ();
+
+            void reset ();
+    };
+}
+
+#endif /* POLYPHASEDECIMATOR_H */
@@ -0,0 +1,184 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "DataView.h"
+
+namespace std
+{
+    /** Ring buffer class
+     *
+     * @brief This class is a fixed capacity FIFO of values.
+     *
+     * @details The memory is allocated with the object, so its footprint never changes.
+     *          Pushing and advancing are O(1). When the buffer is full, pushing a new 
+     *          value overwrites the oldest one and increments the dropped counter.
+     *
+     * @param buffer Storage of the values
+     * @param head Position of the oldest value
+     * @param count Number of values stored
+     * @param dropped Number of values overwritten before being read
+     *
+     */
+    template <typename T, size_t CAPACITY>
+    class ringBuffer {
+        T buffer[CAPACITY];
+        size_t head = 0;
+        size_t count = 0;
+        uint32_t dropped = 0;
+
+        public:
+            ringBuffer () : buffer() {}
+
+            /** Push back function
+             *
+             * @brief This function adds a value after the newest one.
+             *
+             * @param value Value to add.
+             *
+             */
+            void pushBack ( const T& value )
+            {
+                size_t tail = head + count;
+                if ( tail >= CAPACITY ) tail -= CAPACITY;
+                buffer[tail] = value;
+
+                if ( count < CAPACITY )
+                {
+                    count++;
+                } else {
+                    // overwrite the oldest value
+                    head = (tail + 1 == CAPACITY) ? 0 : tail + 1;
+                    dropped++;
+                }
+            }
+
+            /** Push back function
+             *
+             * @brief This function adds an array of values after the newest one.
+             *
+             * @param values Values to add.
+             * @param size Number of values.
+             *
+             */
+            void pushBack ( const T* values, size_t size )
+            {
+                for (size_t i = 0; i < size; i++)
+                {
+                    pushBack(values[i]);
+                }
+            }
+
+            /** Advance function
+             *
+             * @brief This function removes the oldest values.
+             *
+             * @param n Number of values to remove.
+             *
+             */
+            void advance ( size_t n = 1 )
+            {
+                if ( n > count ) n = count;
+                head += n;
+                if ( head >= CAPACITY ) head -= CAPACITY;
+                count -= n;
+            }
+
+            /** [] operator
+             *
+             * @brief This function returns a value of the buffer.
+             *
+             * @param i Index of the value, being 0 the oldest one.
+             *
+             * @return Value.
+             *
+             */
+            T& operator [] ( size_t i )
+            {
+                size_t position = head + i;
+                if ( position >= CAPACITY ) position -= CAPACITY;
+                return buffer[position];
+            }
+
+            const T& operator [] ( size_t i ) const
+            {
+                size_t position = head + i;
+                if ( position >= CAPACITY ) position -= CAPACITY;
+                return buffer[position];
+            }
+
+            /** View function
+             *
+             * @brief This function returns a read only view of the values.
+             *
+             * @param offset Index of the first value of the view, being 0 the oldest one.
+             * @param n Number of values of the view.
+             *
+             * @return View of the values.
+             *
+             */
+            dataView<T> view ( size_t offset, size_t n ) const
+            {
+                if ( offset > count ) offset = count;
+                if ( n > count - offset ) n = count - offset;
+
+                size_t position = head + offset;
+                if ( position >= CAPACITY ) position -= CAPACITY;
+                size_t firstSize = CAPACITY - position;
+                if ( firstSize >= n ) return dataView<T>(&buffer[position], n);
+                return dataView<T>(&buffer[position], firstSize, &buffer[0], n - firstSize);
+            }
+
+            /** Size function
+             *
+             * @brief This function returns the number of values stored.
+             *
+             * @return Number of values.
+             *
+             */
+            size_t size () const
+            {
+                return count;
+            }
+
+            /** Capacity function
+             *
+             * @brief This function returns the maximum number of values.
+             *
+             * @return Capacity of the buffer.
+             *
+             */
+            size_t capacity () const
+            {
+                return CAPACITY;
+            }
+
+            /** Empty function
+             *
+             * @brief This function returns if the buffer is empty.
+             *
+             * @return True if there are no values, false if not.
+             *
+             */
+            bool empty () const
+            {
+                return count == 0;
+            }
+
+            /** Get dropped function
+             *
+             * @brief This function returns the number of values overwritten before being read.
+             *
+             * @return Number of dropped values.
+             *
+             */
+            uint32_t getDropped () const
+            {
+                return dropped;
+            }
+    };
+}
+
+#endif /* RINGBUFFER_H */
@@ -0,0 +1,115 @@
+#include "SampleClock.h"
+
+using namespace std;
+
+/** Begin function
+ *
+ * @brief This function starts the clock at the nominal rate.
+ *
+ * @param pNominalRate Configured sample rate in Hz.
+ *
+ */
+void sampleClock::begin ( float pNominalRate )
+{
+    this -> nominalRate = pNominalRate;
+    stats.rate = pNominalRate;
+}
+
+/** Update function
+ *
+ * @brief This function adds a batch of samples read from the sensor FIFO.
+ *
+ * @param checkTime Time since boot when the batch was read in ms.
+ * @param pBatchSize Number of samples of the batch.
+ * @param overflowSamples Number of samples lost by the FIFO before the batch.
+ *
+ * @details The samples expected from the time since the last batch are compared with
+ *          the samples read and lost. After the warm up, CLOCK_DROP_THRESHOLD or more
+ *          missing samples are counted as a gap. The batches with a gap or an overflow
+ *          do not update the rate or the jitter, as their samples do not cover the time.
+ *
+ */
+void sampleClock::update ( uint32_t checkTime, uint8_t pBatchSize, uint8_t overflowSamples )
+{
+    if ( stats.rate <= 0 ) stats.rate = nominalRate > 0 ? nominalRate : 1;
+
+    uint32_t lost = overflowSamples;
+    if ( batches > 0 )
+    {
+        float interval = checkTime - lastTime;
+        uint16_t produced = pBatchSize + overflowSamples;
+        int32_t missing = lroundf(interval * stats.rate / 1000) - produced;
+        if ( batches >= CLOCK_WARMUP_BATCHES && missing >= CLOCK_DROP_THRESHOLD )
+        {
+            lost += missing;
+            stats.drops += missing;
+        }
+        else if ( overflowSamples == 0 && interval > 0 )
+        {
+            float deviation = interval - produced * 1000 / stats.rate;
+            jitterVariance += CLOCK_SMOOTHING * (deviation * deviation - jitterVariance);
+            stats.jitter = sqrtf(jitterVariance);
+            stats.rate += CLOCK_SMOOTHING * (produced * 1000 / interval - stats.rate);
+        }
+    }
+    stats.overflows += overflowSamples;
+    stats.samples += pBatchSize;
+
+    batchSequence = batchSequence + batchSize + lost;
+    batchSize = pBatchSize;
+    batchTime = checkTime;
+    lastTime = checkTime;
+    batches++;
+}
+
+/** Get sequence function
+ *
+ * @brief This function returns the sequence number of a sample of the last batch.
+ *
+ * @param index Position of the sample in the batch.
+ *
+ * @return Number of samples taken by the sensor before this one since the start.
+ *
+ */
+uint32_t sampleClock::getSequence ( uint8_t index )
+{
+    return batchSequence + index;
+}
+
+/** Get timestamp function
+ *
+ * @brief This function returns the time when a sample of the last batch was taken.
+ *
+ * @param index Position of the sample in the batch.
+ *
+ * @return Time since boot in ms.
+ *
+ */
+uint32_t sampleClock::getTimestamp ( uint8_t index )
+{
+    return batchTime - lroundf((batchSize - 1 - index) * 1000 / stats.rate);
+}
+
+/** Get rate function
+ *
+ * @brief This function returns the measured sample rate.
+ *
+ * @return Sample rate in Hz.
+ *
+ */
+float sampleClock::getRate ( )
+{
+    return stats.rate;
+}
+
+/** Get stats function
+ *
+ * @brief This function returns the statistics of the clock.
+ *
+ * @return Statistics of the clock.
+ *
+ */
+sampleClockStats sampleClock::getStats ( )
+{
+    return stats;
+}
@@ -0,0 +1,83 @@
+#ifndef SAMPLECLOCK_H
+#define SAMPLECLOCK_H
+
+#include <Arduino.h>
+
+namespace std
+{
+    // Weight of each batch in the averages of the rate and the jitter
+    const float CLOCK_SMOOTHING = 0.125;
+    // Batches used to settle the rate before the gaps are detected
+    const uint8_t CLOCK_WARMUP_BATCHES = 8;
+    // Missing samples between two batches counted as a gap
+    const int32_t CLOCK_DROP_THRESHOLD = 2;
+
+    /** Sample clock statistics struct
+     *
+     * @brief Statistics of the sample clock.
+     *
+     * @param rate Measured sample rate in Hz
+     * @param jitter Deviation of the batch times from the measured rate in ms (RMS)
+     * @param samples Number of samples read
+     * @param overflows Number of samples lost by the sensor FIFO overflow
+     * @param drops Number of samples missing in the gaps between batches
+     *
+     */
+    struct sampleClockStats{
+        float rate;
+        float jitter;
+        uint32_t samples;
+        uint32_t overflows;
+        uint32_t drops;
+    };
+
+    /** Sample clock class
+     *
+     * @brief This class tags the samples with a timestamp and a sequence number and
+     *        measures the real sample rate.
+     *
+     * @details The samples come from the sensor FIFO in batches, and only the time when
+     *          each batch is read is known. The rate is the average of the samples of each
+     *          batch over the time since the last batch, starting at the nominal rate. The
+     *          last sample of a batch gets the time of the batch and the rest are spaced by
+     *          the measured rate. The samples lost by a FIFO overflow, or missing because
+     *          a batch came later than its samples account for, skip sequence numbers, so
+     *          the gaps can be seen downstream. The jitter is how much the time between
+     *          batches deviates from the time of their samples at the measured rate.
+     *
+     * @param nominalRate Configured sample rate in Hz
+     * @param stats Statistics of the clock
+     * @param jitterVariance Average of the squared deviations in ms²
+     * @param batches Number of batches read
+     * @param lastTime Time of the last batch in ms
+     * @param batchTime Time of the current batch in ms
+     * @param batchSize Number of samples of the current batch
+     * @param batchSequence Sequence number of the first sample of the current batch
+     *
+     */
+    class sampleClock {
+        float nominalRate = 0;
+        sampleClockStats stats = { 0, 0, 0, 0, 0 };
+        float jitterVariance = 0;
+        uint32_t batches = 0;
+        uint32_t lastTime = 0;
+        uint32_t batchTime = 0;
+        uint8_t batchSize = 0;
+        uint32_t batchSequence = 0;
+
+        public:
+            void begin ( float pNominalRate );
+
+            void update ( uint32_t checkTime, uint8_t pBatchSize, uint8_t overflowSamples );
+
+            uint32_t getSequence ( uint8_t index );
+
+            uint32_t getTimestamp ( uint8_t index );
+
+            float getRate ();
+
+            sampleClockStats getStats ();
+    };
+}
+
+#endif /* SAMPLECLOCK_H */
@@ -0,0 +1,52 @@
+#ifndef SENSORFIFO_H
+#define SENSORFIFO_H
+
+#include <stdint.h>
+
+namespace std
+{
+    // Number of samples that the MAX3010x FIFO can hold
+    const uint8_t SENSOR_FIFO_DEPTH = 32;
+
+    /** Sensor FIFO interface
+     *
+     * @brief This class is the interface of the FIFO of the pulse sensor.
+     *
+     * @details This class hides the I2C and FIFO access of the sensor, so the acquisition
+     *          can be driven by any implementation (the MAX3010x or a mock on the host).
+     *          It follows the check()/available()/getFIFOIR() pattern of the SparkFun
+     *          library: check() reads all the new samples in one burst and the rest of
+     *          the functions iterate over them. getCheckTime() returns the time of the
+     *          last check(), so a recorded trace can be replayed with its own times, and
+     *          getOverflows() the samples lost because the FIFO was full, if the
+     *          implementation knows them. getSampleRate() is the rate of the samples in
+     *          the FIFO, which the reader decimates to the rate of the analysis.
+     *
+     */
+    class sensorFifo {
+        public:
+            virtual ~sensorFifo () {}
+
+            virtual bool begin () = 0;
+
+            virtual uint16_t getSampleRate () = 0;
+
+            virtual bool dataPending () = 0;
+
+            virtual uint16_t check () = 0;
+
+            virtual uint32_t getCheckTime () = 0;
+
+            virtual uint8_t getOverflows () { return 0; }
+
+            virtual uint8_t available () = 0;
+
+            virtual uint32_t getFIFOIR () = 0;
+
+            virtual uint32_t getFIFORed () = 0;
+
+            virtual void nextSample () = 0;
+    };
+}
+
+#endif /* SENSORFIFO_H */
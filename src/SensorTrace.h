@@ -0,0 +1,39 @@
+#ifndef SENSORTRACE_H
+#define SENSORTRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "SensorFifo.h"
+
+namespace std
+{
+    /* Binary trace of the raw samples of the sensor, in little endian:
+     *  - Header: magic "PPGT", uint16 version, uint16 sample rate (Hz).
+     *  - One record per burst read from the FIFO: marker 0xA5 0x5A, uint8 number of 
+     *    samples, uint8 overflow counter, uint32 check time (ms), the samples and a 
+     *    checksum. Each sample is the IR and the red values in 3 bytes each (the sensor
+     *    gives 18 bits). The checksum is the sum of the bytes after the marker, modulo 256.
+     *    The records of version 1 have no overflow counter.
+     * The marker and the checksum let the replay skip the text mixed with the records
+     * when the trace is captured from the serial port. */
+
+    // Version of the trace format
+    const uint16_t TRACE_VERSION = 2;
+    // Oldest version of the trace format that can be replayed
+    const uint16_t TRACE_OLDEST_VERSION = 1;
+    // Size of the header of a trace
+    const size_t TRACE_HEADER_SIZE = 8;
+    // First byte of the marker of a record
+    const uint8_t TRACE_MARKER_FIRST = 0xA5;
+    // Second byte of the marker of a record
+    const uint8_t TRACE_MARKER_SECOND = 0x5A;
+    // Size of a record without its samples: marker, count, overflows, check time and checksum
+    const size_t TRACE_RECORD_OVERHEAD = 9;
+    // Size of a sample of a record: IR and red values
+    const size_t TRACE_SAMPLE_SIZE = 6;
+    // Maximum size of a record
+    const size_t TRACE_MAX_RECORD_SIZE = TRACE_RECORD_OVERHEAD + SENSOR_FIFO_DEPTH * TRACE_SAMPLE_SIZE;
+}
+
+#endif /* SENSORTRACE_H */
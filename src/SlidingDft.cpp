@@ -0,0 +1,196 @@
+#include "SlidingDft.h"
+
+using namespace std;
+
+/** Begin function
+ *
+ * @brief This function chooses the bins of the band and allocates the buffers.
+ *
+ * @param sampleRate Rate of the samples in Hz.
+ * @param pLength Number of samples of the window, from 4 to SLIDING_DFT_MAX_LENGTH. The
+ *                bins are sampleRate / pLength Hz apart.
+ * @param lowFrequency Lowest frequency of the band in Hz.
+ * @param highFrequency Highest frequency of the band in Hz.
+ * @param window Window of the samples.
+ *
+ * @return True if the band has bins, false if not, in which case nothing is computed.
+ *
+ * @details The band is rounded inwards to the bins, and it never includes the DC nor the
+ *          bins whose neighbours for the window would be past the DC or half the rate.
+ *          The state starts at zero, as the spectrum of a window of zeros.
+ *
+ */
+bool slidingDft::begin ( float sampleRate, uint16_t pLength, float lowFrequency, float highFrequency, fftWindow window )
+{
+    length = 0;
+    if ( pLength < 4 || pLength > SLIDING_DFT_MAX_LENGTH || sampleRate <= 0 ) return false;
+
+    // w[n] = a0 - a1 * cos(2 * pi * n / N) + a2 * cos(4 * pi * n / N)
+    switch ( window )
+    {
+        case FFT_WINDOW_HANN:
+            guardBins = 1;
+            kernel[0] = 0.5f;
+            kernel[1] = -0.25f;
+            break;
+        case FFT_WINDOW_BLACKMAN:
+            guardBins = 2;
+            kernel[0] = 0.42f;
+            kernel[1] = -0.25f;
+            kernel[2] = 0.04f;
+            break;
+        default:
+            guardBins = 0;
+            kernel[0] = 1.0f;
+            break;
+    }
+
+    int32_t low = ceilf(lowFrequency * pLength / sampleRate);
+    int32_t high = floorf(highFrequency * pLength / sampleRate);
+    if ( low < guardBins + 1 ) low = guardBins + 1;
+    if ( high > pLength / 2 - 1 - guardBins ) high = pLength / 2 - 1 - guardBins;
+    if ( high < low ) return false;
+    this -> firstBin = low;
+    this -> bins = high - low + 1;
+
+    uint16_t computed = bins + 2 * guardBins;
+    twiddles.resize(2 * computed);
+    rotations.resize(2 * computed);
+    for (uint16_t i = 0; i < computed; i++)
+    {
+        float angle = 2 * M_PI * (firstBin - guardBins + i) / pLength;
+        rotations[2 * i] = cos(angle);
+        rotations[2 * i + 1] = sin(angle);
+        twiddles[2 * i] = SLIDING_DFT_DAMPING * rotations[2 * i];
+        twiddles[2 * i + 1] = SLIDING_DFT_DAMPING * rotations[2 * i + 1];
+    }
+    oldestWeight = pow(SLIDING_DFT_DAMPING, pLength);
+
+    history.assign(pLength, 0.0f);
+    state.assign(2 * computed, 0.0f);
+    spectrum.assign(2 * computed, 0.0f);
+    output.assign(bins, 0.0f);
+    position = 0;
+    pushed = 0;
+    this -> length = pLength;
+    return true;
+}
+
+/** Push function
+ *
+ * @brief This function adds a sample to the window and removes the oldest one.
+ *
+ * @param sample New sample.
+ *
+ * @details It updates the recursion of every bin of the band and of the guard bins, a
+ *          complex multiplication and an addition each.
+ *
+ */
+void slidingDft::push ( float sample )
+{
+    if ( length == 0 ) return;
+
+    float difference = sample - oldestWeight * history[position];
+    history[position] = sample;
+    if ( ++position == length ) position = 0;
+    if ( pushed < length ) pushed++;
+
+    uint16_t computed = bins + 2 * guardBins;
+    for (uint16_t i = 0; i < computed; i++)
+    {
+        float* t = &state[2 * i];
+        const float* w = &twiddles[2 * i];
+        float real = w[0] * t[0] - w[1] * t[1] + difference;
+        float imag = w[0] * t[1] + w[1] * t[0];
+        t[0] = real;
+        t[1] = imag;
+    }
+}
+
+/** Magnitudes function
+ *
+ * @brief This function computes the magnitude of the spectrum of the window in the band.
+ *
+ * @return Magnitudes of the getBins() bins from getFirstBin(), valid until the next call,
+ *         or NULL if the window has not been filled yet.
+ *
+ * @details X[k] = W * T[k] is the DFT of the window with the phase of its oldest sample,
+ *          and the window gives a0 * X[k] - a1 / 2 * (X[k - 1] + X[k + 1])
+ *          + a2 / 2 * (X[k - 2] + X[k + 2]).
+ *
+ */
+const float* slidingDft::magnitudes ( )
+{
+    if ( !isReady() ) return NULL;
+
+    uint16_t computed = bins + 2 * guardBins;
+    for (uint16_t i = 0; i < computed; i++)
+    {
+        const float* t = &state[2 * i];
+        const float* w = &rotations[2 * i];
+        spectrum[2 * i] = w[0] * t[0] - w[1] * t[1];
+        spectrum[2 * i + 1] = w[0] * t[1] + w[1] * t[0];
+    }
+
+    for (uint16_t b = 0; b < bins; b++)
+    {
+        const float* x = &spectrum[2 * (b + guardBins)];
+        float real = kernel[0] * x[0];
+        float imag = kernel[0] * x[1];
+        for (uint8_t j = 1; j <= guardBins; j++)
+        {
+            real += kernel[j] * (x[-2 * j] + x[2 * j]);
+            imag += kernel[j] * (x[-2 * j + 1] + x[2 * j + 1]);
+        }
+        output[b] = sqrtf(real * real + imag * imag);
+    }
+    return output.data();
+}
+
+/** Is ready function
+ *
+ * @brief This function returns if the window is full of samples.
+ *
+ * @return True if length samples have been pushed since begin(), false if not.
+ *
+ */
+bool slidingDft::isReady ( )
+{
+    return length > 0 && pushed == length;
+}
+
+/** Get length function
+ *
+ * @brief This function returns the number of samples of the window.
+ *
+ * @return Number of samples, 0 if the DFT has not begun.
+ *
+ */
+uint16_t slidingDft::getLength ( )
+{
+    return length;
+}
+
+/** Get first bin function
+ *
+ * @brief This function returns the index of the first bin of the band.
+ *
+ * @return Index of the bin, whose frequency is the index * sample rate / length.
+ *
+ */
+uint16_t slidingDft::getFirstBin ( )
+{
+    return firstBin;
+}
+
+/** Get bins function
+ *
+ * @brief This function returns the number of bins of the band.
+ *
+ * @return Number of bins.
+ *
+ */
+uint16_t slidingDft::getBins ( )
+{
+    return bins;
+}
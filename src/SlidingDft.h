@@ -0,0 +1,83 @@
+#ifndef SLIDINGDFT_H
+#define SLIDINGDFT_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "FftWindow.h"
+
+namespace std
+{
+    // Maximum number of samples of the window of the sliding DFT
+    const uint16_t SLIDING_DFT_MAX_LENGTH = 1024;
+    // Damping of the state of each bin per sample, so the rounding errors fade away
+    const float SLIDING_DFT_DAMPING = 0.99999;
+    // Maximum number of bins on each side of a bin used by the window
+    const uint8_t SLIDING_DFT_GUARD_BINS = 2;
+
+    /** Sliding DFT class
+     *
+     * @brief This class is the spectrum of the last samples in a band of frequencies,
+     *        updated with every sample.
+     *
+     * @details Only the bins of the band are computed, each one with the recursion
+     *          T[n] = r * W * T[n - 1] + x[n] - r^N * x[n - N], being N the length of the
+     *          window, W = exp(j * 2 * pi * k / N) and r SLIDING_DFT_DAMPING, so a sample
+     *          costs a complex multiplication per bin instead of a block FFT. The damping
+     *          keeps the recursion stable in float: without it, the rounding errors of
+     *          each sample would add up forever. The window is applied in the frequency
+     *          domain, as a combination of the bins next to each one, so the band has
+     *          SLIDING_DFT_GUARD_BINS more bins on each side when the window needs them.
+     *          The magnitudes are scaled as the DFT of the windowed samples, the same as
+     *          fftPlan without zero padding. All the buffers are allocated by begin().
+     *
+     * @param length Number of samples of the window, 0 until begin() is called
+     * @param firstBin Index of the first bin of the band
+     * @param bins Number of bins of the band
+     * @param guardBins Bins computed on each side of the band for the window
+     * @param kernel Weights of the bin and its neighbours that apply the window
+     * @param oldestWeight Damping of the sample that leaves the window, r^N
+     * @param history Last samples, the oldest one at the position
+     * @param position Position of the oldest sample in the history
+     * @param pushed Number of samples pushed, up to the length
+     * @param twiddles Cosine and sine of the bins, damped
+     * @param rotations Cosine and sine of the bins, which refer the phase to the oldest sample
+     * @param state Real and imaginary parts of the recursion of each bin
+     * @param spectrum Windowless spectrum of the computed bins
+     * @param output Magnitudes of the bins of the band
+     *
+     */
+    class slidingDft {
+        uint16_t length = 0;
+        uint16_t firstBin = 0;
+        uint16_t bins = 0;
+        uint8_t guardBins = 0;
+        float kernel[SLIDING_DFT_GUARD_BINS + 1];
+        float oldestWeight = 1.0f;
+        vector<float> history;
+        uint16_t position = 0;
+        uint16_t pushed = 0;
+        vector<float> twiddles;
+        vector<float> rotations;
+        vector<float> state;
+        vector<float> spectrum;
+        vector<float> output;
+
+        public:
+            bool begin ( float sampleRate, uint16_t pLength, float lowFrequency, float highFrequency, fftWindow window );
+
+            void push ( float sample );
+
+            const float* magnitudes ();
+
+            bool isReady ();
+
+            uint16_t getLength ();
+
+            uint16_t getFirstBin ();
+
+            uint16_t getBins ();
+    };
+}
+
+#endif /* SLIDINGDFT_H */
@@ -0,0 +1,125 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace std
+{
+    /** Single producer single consumer queue class
+     *
+     * @brief This class is a fixed capacity FIFO shared by one producer task and one 
+     *        consumer task without locks.
+     *
+     * @details The producer only writes the tail and the consumer only writes the head,
+     *          so each index has a single writer. When the queue is full, the new value
+     *          is discarded and the dropped counter is incremented, as the producer cannot
+     *          remove values that the consumer may be reading.
+     *
+     * @param buffer Storage of the values, one position is always left empty
+     * @param head Position of the oldest value, written by the consumer
+     * @param tail Position of the next value, written by the producer
+     * @param dropped Number of values discarded because the queue was full
+     *
+     */
+    template <typename T, size_t CAPACITY>
+    class spscQueue {
+        T buffer[CAPACITY + 1];
+        atomic<size_t> head;
+        atomic<size_t> tail;
+        atomic<uint32_t> dropped;
+
+        static size_t next ( size_t position )
+        {
+            return position == CAPACITY ? 0 : position + 1;
+        }
+
+        public:
+            spscQueue () : buffer(), head(0), tail(0), dropped(0) {}
+
+            /** Push function
+             *
+             * @brief This function adds a value to the queue. Only called by the producer.
+             *
+             * @param value Value to add.
+             *
+             * @return True if the value has been added, false if the queue is full.
+             *
+             */
+            bool push ( const T& value )
+            {
+                size_t position = tail.load(memory_order_relaxed);
+                size_t nextPosition = next(position);
+                if ( nextPosition == head.load(memory_order_acquire) )
+                {
+                    dropped.fetch_add(1, memory_order_relaxed);
+                    return false;
+                }
+                buffer[position] = value;
+                tail.store(nextPosition, memory_order_release);
+                return true;
+            }
+
+            /** Front function
+             *
+             * @brief This function returns the oldest value without removing it. Only 
+             *        called by the consumer.
+             *
+             * @param value Oldest value.
+             *
+             * @return True if there is a value, false if the queue is empty.
+             *
+             */
+            bool front ( T& value )
+            {
+                size_t position = head.load(memory_order_relaxed);
+                if ( position == tail.load(memory_order_acquire) ) return false;
+                value = buffer[position];
+                return true;
+            }
+
+            /** Pop function
+             *
+             * @brief This function removes the oldest value. Only called by the consumer.
+             *
+             * @see front().
+             *
+             */
+            void pop ()
+            {
+                size_t position = head.load(memory_order_relaxed);
+                if ( position == tail.load(memory_order_acquire) ) return;
+                head.store(next(position), memory_order_release);
+            }
+
+            /** Size function
+             *
+             * @brief This function returns the number of values in the queue.
+             *
+             * @return Number of values, which may grow if the producer is pushing.
+             *
+             */
+            size_t size () const
+            {
+                size_t first = head.load(memory_order_acquire);
+                size_t last = tail.load(memory_order_acquire);
+                return last >= first ? last - first : CAPACITY + 1 - first + last;
+            }
+
+            /** Get dropped function
+             *
+             * @brief This function returns the number of values discarded because the 
+             *        queue was full.
+             *
+             * @return Number of dropped values.
+             *
+             */
+            uint32_t getDropped () const
+            {
+                return dropped.load(memory_order_relaxed);
+            }
+    };
+}
+
+#endif /* SPSCQUEUE_H */
@@ -0,0 +1,190 @@
+#include "StageMetrics.h"
+
+#ifdef STAGE_METRICS
+
+using namespace std;
+
+stageMetrics std::metrics;
+
+static const char* STAGE_NAMES[STAGE_COUNT] = { "sensor_read", "decimation", "filter", "spectrum", "heart_rate", "fft",
+                                                "peaks", "log", "display", "web_send", "web_stream" };
+
+/** stageMetrics default constructor
+ *
+ * @brief This function is the constructor of the stage metrics.
+ *
+ */
+stageMetrics::stageMetrics ( )
+{
+    reset();
+}
+
+/** Reset function
+ *
+ * @brief This function empties the histograms of all the stages.
+ *
+ */
+void stageMetrics::reset ( )
+{
+    portENTER_CRITICAL(&metricsMux);
+    memset(stages, 0, sizeof(stages));
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) stages[i].min = UINT32_MAX;
+    portEXIT_CRITICAL(&metricsMux);
+}
+
+/** Get bucket function
+ *
+ * @brief This function gets the bucket of a number of cycles.
+ *
+ * @param cycles Cycles measured.
+ *
+ * @return Index of the bucket.
+ *
+ * @details The first buckets hold one value each. Then, each power of two is split in
+ *          METRICS_SUB_BUCKETS buckets by the bits that follow the most significant one.
+ *
+ */
+uint8_t stageMetrics::getBucket ( uint32_t cycles )
+{
+    if ( cycles < METRICS_SUB_BUCKETS ) return cycles;
+    uint8_t msb = 31 - __builtin_clz(cycles);
+    return (msb - 1) * METRICS_SUB_BUCKETS + ((cycles >> (msb - 2)) & (METRICS_SUB_BUCKETS - 1));
+}
+
+/** Get bucket limit function
+ *
+ * @brief This function gets the highest number of cycles of a bucket.
+ *
+ * @param bucket Index of the bucket.
+ *
+ * @return Highest number of cycles of the bucket.
+ *
+ * @see getBucket().
+ *
+ */
+uint32_t stageMetrics::getBucketLimit ( uint8_t bucket )
+{
+    if ( bucket < METRICS_SUB_BUCKETS ) return bucket;
+    uint8_t msb = bucket / METRICS_SUB_BUCKETS + 1;
+    uint64_t width = uint64_t(1) << (msb - 2);
+    return (METRICS_SUB_BUCKETS + bucket % METRICS_SUB_BUCKETS) * width + width - 1;
+}
+
+/** Record function
+ *
+ * @brief This function adds a measure to the histogram of a stage.
+ *
+ * @param stage Stage measured.
+ * @param cycles Cycles of the stage.
+ *
+ */
+void stageMetrics::record ( metricStage stage, uint32_t cycles )
+{
+    stageHistogram& histogram = stages[stage];
+    uint8_t bucket = getBucket(cycles);
+    portENTER_CRITICAL(&metricsMux);
+    histogram.count++;
+    histogram.sum += cycles;
+    if ( cycles < histogram.min ) histogram.min = cycles;
+    if ( cycles > histogram.max ) histogram.max = cycles;
+    histogram.buckets[bucket]++;
+    portEXIT_CRITICAL(&metricsMux);
+}
+
+/** Get summary function
+ *
+ * @brief This function gets the statistics of a stage.
+ *
+ * @param stage Stage.
+ *
+ * @return Statistics of the stage, all zero if it has not been measured.
+ *
+ * @details The percentile 99 is the upper limit of the bucket where it falls, so it is
+ *          at most 25 % above the real one, and never above the maximum.
+ *
+ */
+stageSummary stageMetrics::getSummary ( metricStage stage )
+{
+    stageSummary summary = { 0, 0, 0, 0, 0 };
+    portENTER_CRITICAL(&metricsMux);
+    const stageHistogram& histogram = stages[stage];
+    if ( histogram.count > 0 )
+    {
+        summary.count = histogram.count;
+        summary.min = histogram.min;
+        summary.avg = histogram.sum / histogram.count;
+        summary.max = histogram.max;
+
+        uint32_t rank = (uint64_t(histogram.count) * 99 + 99) / 100;
+        uint32_t accumulated = 0;
+        for (uint8_t i = 0; i < METRICS_BUCKETS; i++)
+        {
+            accumulated += histogram.buckets[i];
+            if ( accumulated < rank ) continue;
+            summary.p99 = min(getBucketLimit(i), histogram.max);
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&metricsMux);
+    return summary;
+}
+
+/** Get stage name function
+ *
+ * @brief This function gets the name of a stage.
+ *
+ * @param stage Stage.
+ *
+ * @return Name of the stage.
+ *
+ */
+const char* stageMetrics::getStageName ( metricStage stage )
+{
+    return STAGE_NAMES[stage];
+}
+
+/** Print metrics function
+ *
+ * @brief This function prints the statistics of the stages in the text format of the
+ *        metrics endpoints.
+ *
+ * @param output Output of the metrics.
+ *
+ * @details Each statistic is a line with the name of the metric, the stage and the value:
+ *          stage_cycles{stage="filter",quantile="0.99"} 12345
+ *
+ */
+void stageMetrics::printMetrics ( Print& output )
+{
+    output.printf("# HELP stage_cycles CPU cycles of the processing stages at %u MHz\n", ESP.getCpuFreqMHz());
+    output.print("# TYPE stage_cycles summary\n");
+    for (uint8_t i = 0; i < STAGE_COUNT; i++)
+    {
+        stageSummary summary = getSummary(metricStage(i));
+        const char* name = getStageName(metricStage(i));
+        output.printf("stage_cycles{stage=\"%s\",quantile=\"0.99\"} %u\n", name, summary.p99);
+        output.printf("stage_cycles_count{stage=\"%s\"} %u\n", name, summary.count);
+        output.printf("stage_cycles_min{stage=\"%s\"} %u\n", name, summary.min);
+        output.printf("stage_cycles_avg{stage=\"%s\"} %u\n", name, summary.avg);
+        output.printf("stage_cycles_max{stage=\"%s\"} %u\n", name, summary.max);
+    }
+}
+
+/** Log table function
+ *
+ * @brief This function logs the statistics of the stages as a table, for the serial port.
+ *
+ */
+void stageMetrics::logTable ( )
+{
+    LOG_INFO("Stage cycles at %u MHz:", ESP.getCpuFreqMHz());
+    LOG_INFO("%-13s %8s %10s %10s %10s %10s", "stage", "count", "min", "avg", "p99", "max");
+    for (uint8_t i = 0; i < STAGE_COUNT; i++)
+    {
+        stageSummary summary = getSummary(metricStage(i));
+        LOG_INFO("%-13s %8u %10u %10u %10u %10u", getStageName(metricStage(i)),
+                 summary.count, summary.min, summary.avg, summary.p99, summary.max);
+    }
+}
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef STAGEMETRICS_H
+#define STAGEMETRICS_H
+
+#include <Arduino.h>
+
+#include "Logger.h"
+
+// STAGE METRICS : define STAGE_METRICS (e.g. in build_flags) to measure the cycles of each
+// processing stage. When it is not defined, STAGE_TIMER is empty and nothing is compiled.
+// #define STAGE_METRICS
+
+namespace std
+{
+    /** Metric stages
+     *
+     * @brief Processing stages measured by the stage timers.
+     *
+     */
+    enum metricStage { STAGE_SENSOR_READ, STAGE_DECIMATION, STAGE_FILTER, STAGE_SPECTRUM, STAGE_HEART_RATE, STAGE_FFT, STAGE_PEAKS,
+                       STAGE_LOG, STAGE_DISPLAY, STAGE_WEB_SEND, STAGE_WEB_STREAM, STAGE_COUNT };
+
+#ifdef STAGE_METRICS
+    // Buckets of each power of two of the histograms, so a bucket is at most 25 % wide
+    const uint8_t METRICS_SUB_BUCKETS = 4;
+    // Buckets of the histograms, enough for any 32 bits count of cycles
+    const uint8_t METRICS_BUCKETS = 124;
+    // Period of the serial dump of the metrics in ms
+    const uint32_t METRICS_DUMP_PERIOD = 10000;
+
+    /** Stage summary struct
+     *
+     * @brief Statistics of the cycles of a stage.
+     *
+     * @param count Number of measures
+     * @param min Minimum cycles
+     * @param avg Average cycles
+     * @param p99 Percentile 99 of the cycles, the upper limit of its bucket
+     * @param max Maximum cycles
+     *
+     */
+    struct stageSummary {
+        uint32_t count;
+        uint32_t min;
+        uint32_t avg;
+        uint32_t p99;
+        uint32_t max;
+    };
+
+    /** Stage histogram struct
+     *
+     * @brief Measures of a stage.
+     *
+     * @param count Number of measures
+     * @param sum Sum of the cycles
+     * @param min Minimum cycles
+     * @param max Maximum cycles
+     * @param buckets Number of measures of each bucket
+     *
+     */
+    struct stageHistogram {
+        uint32_t count;
+        uint64_t sum;
+        uint32_t min;
+        uint32_t max;
+        uint32_t buckets[METRICS_BUCKETS];
+    };
+
+    /** Stage metrics class
+     *
+     * @brief This class keeps the histograms of the cycles of the processing stages.
+     *
+     * @details The histograms have a fixed size and logarithmic buckets, so recording a
+     *          measure is a few additions and does not allocate memory. The stages are
+     *          measured by the reader and the visualizer tasks and read by the web server,
+     *          so the histograms are protected by a spinlock. Each stage has to start and
+     *          end in the same task, as the cycle counters of the cores are not the same.
+     *
+     * @param stages Histograms of the stages
+     * @param metricsMux Spinlock of the histograms
+     *
+     */
+    class stageMetrics {
+        stageHistogram stages[STAGE_COUNT];
+        portMUX_TYPE metricsMux = portMUX_INITIALIZER_UNLOCKED;
+
+        static uint8_t getBucket ( uint32_t cycles );
+
+        static uint32_t getBucketLimit ( uint8_t bucket );
+
+        public:
+            stageMetrics ();
+
+            void record ( metricStage stage, uint32_t cycles );
+
+            stageSummary getSummary ( metricStage stage );
+
+            void reset ();
+
+            void printMetrics ( Print& output );
+
+            void logTable ();
+
+            static const char* getStageName ( metricStage stage );
+    };
+
+    extern stageMetrics metrics;
+
+    /** Stage timer class
+     *
+     * @brief This class measures the cycles of a stage from its construction to the end
+     *        of its scope.
+     *
+     * @param stage Stage measured
+     * @param start Cycle count at the start of the stage
+     *
+     */
+    class stageTimer {
+        metricStage stage;
+        uint32_t start;
+
+        public:
+            stageTimer ( metricStage pStage ) : stage(pStage), start(ESP.getCycleCount()) {}
+
+            ~stageTimer ()
+            {
+                metrics.record(stage, ESP.getCycleCount() - start);
+            }
+    };
+#endif
+}
+
+#ifdef STAGE_METRICS
+#define STAGE_TIMER_NAME(line) stageTimerAt##line
+#define STAGE_TIMER_AT(stage, line) stageTimer STAGE_TIMER_NAME(line)(stage)
+// Measures the cycles until the end of the current scope
+#define STAGE_TIMER(stage) STAGE_TIMER_AT(stage, __LINE__)
+#else
+#define STAGE_TIMER(stage)
+#endif
+
+#endif /* STAGEMETRICS_H */
@@ -0,0 +1,174 @@
+#ifndef TEXTBUFFER_H
+#define TEXTBUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace std
+{
+    /** Text buffer class
+     *
+     * @brief This class is a fixed capacity text that can be built without allocating
+     *        memory.
+     *
+     * @details Numbers are formatted with integer arithmetic. If the text does not fit,
+     *          it is truncated and the overflow flag is set.
+     *
+     * @param text Characters of the text, always null terminated
+     * @param length Number of characters of the text
+     * @param overflow True if some text did not fit
+     *
+     */
+    template <size_t CAPACITY>
+    class textBuffer {
+        char text[CAPACITY];
+        size_t length = 0;
+        bool overflow = false;
+
+        public:
+            textBuffer ()
+            {
+                text[0] = '\0';
+            }
+
+            /** Clear function
+             *
+             * @brief This function empties the text.
+             *
+             */
+            void clear ()
+            {
+                length = 0;
+                overflow = false;
+                text[0] = '\0';
+            }
+
+            /** Append function
+             *
+             * @brief This function appends a string to the text.
+             *
+             * @param value Null terminated string.
+             *
+             * @return Reference to the text buffer.
+             *
+             */
+            textBuffer& append ( const char* value )
+            {
+                while ( *value != '\0' )
+                {
+                    if ( length + 1 >= CAPACITY )
+                    {
+                        overflow = true;
+                        break;
+                    }
+                    text[length++] = *value++;
+                }
+                text[length] = '\0';
+                return *this;
+            }
+
+            /** Append integer function
+             *
+             * @brief This function appends an integer to the text.
+             *
+             * @param value Integer.
+             *
+             * @return Reference to the text buffer.
+             *
+             */
+            textBuffer& appendInteger ( int64_t value )
+            {
+                char digits[21];
+                uint8_t n = 0;
+                uint64_t magnitude = value < 0 ? uint64_t(-(value + 1)) + 1 : uint64_t(value);
+                do
+                {
+                    digits[n++] = '0' + magnitude % 10;
+                    magnitude /= 10;
+                } while ( magnitude > 0 );
+
+                if ( value < 0 ) append("-");
+                char reversed[21];
+                for (uint8_t i = 0; i < n; i++)
+                {
+                    reversed[i] = digits[n - 1 - i];
+                }
+                reversed[n] = '\0';
+                return append(reversed);
+            }
+
+            /** Append float function
+             *
+             * @brief This function appends a real number to the text.
+             *
+             * @param value Real number.
+             * @param decimals Number of decimals, 2 by default like String(float).
+             *
+             * @return Reference to the text buffer.
+             *
+             */
+            textBuffer& appendFloat ( float value, uint8_t decimals = 2 )
+            {
+                if ( value != value ) return append("nan");
+
+                int64_t scale = 1;
+                for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+
+                bool negative = value < 0;
+                double magnitude = negative ? -double(value) : double(value);
+                if ( magnitude * scale > 9.2e18 ) return append(negative ? "-inf" : "inf");
+                int64_t scaled = int64_t(magnitude * scale + 0.5);
+                if ( negative && scaled != 0 ) append("-");
+                appendInteger(scaled / scale);
+                if ( decimals == 0 ) return *this;
+
+                char fraction[20];
+                int64_t rest = scaled % scale;
+                for (int i = decimals - 1; i >= 0; i--)
+                {
+                    fraction[i] = '0' + rest % 10;
+                    rest /= 10;
+                }
+                fraction[decimals] = '\0';
+                return append(".").append(fraction);
+            }
+
+            /** C string function
+             *
+             * @brief This function returns the text.
+             *
+             * @return Null terminated text.
+             *
+             */
+            const char* c_str () const
+            {
+                return text;
+            }
+
+            /** Size function
+             *
+             * @brief This function returns the number of characters of the text.
+             *
+             * @return Length of the text.
+             *
+             */
+            size_t size () const
+            {
+                return length;
+            }
+
+            /** Overflowed function
+             *
+             * @brief This function returns if some text did not fit in the buffer.
+             *
+             * @return True if the text is truncated, false if not.
+             *
+             */
+            bool overflowed () const
+            {
+                return overflow;
+            }
+    };
+}
+
+#endif /* TEXTBUFFER_H */
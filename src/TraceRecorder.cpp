@@ -0,0 +1,278 @@
+#include "TraceRecorder.h"
+
+using namespace std;
+
+/** Write little endian function
+ * 
+ * @brief This function writes a little endian unsigned integer.
+ * 
+ * @param data Pointer to the first byte.
+ * @param value Value to write.
+ * @param bytes Number of bytes of the integer.
+ * 
+ */
+static void writeLittleEndian ( uint8_t* data, uint32_t value, uint8_t bytes )
+{
+    for (uint8_t i = 0; i < bytes; i++)
+    {
+        data[i] = uint8_t(value >> (8 * i));
+    }
+}
+
+/** Trace recorder constructor
+ * 
+ * @brief This is the constructor of the trace recorder class that writes the trace to
+ *        an output.
+ * 
+ * @param pSource FIFO of the sensor.
+ * @param pOutput Output of the trace, e.g. Serial.
+ * @param pSampleRate Sample rate of the sensor FIFO in Hz.
+ * 
+ */
+traceRecorder::traceRecorder ( sensorFifo& pSource, Print& pOutput, uint16_t pSampleRate ) : source(pSource)
+{
+    this -> output = &pOutput;
+    this -> fileName = NULL;
+    this -> sampleRate = pSampleRate;
+}
+
+/** Trace recorder constructor
+ * 
+ * @brief This is the constructor of the trace recorder class that writes the trace to
+ *        a file of the SPIFFS.
+ * 
+ * @param pSource FIFO of the sensor.
+ * @param pFileName Name of the file of the trace. It is replaced when the recorder begins.
+ * @param pSampleRate Sample rate of the sensor FIFO in Hz.
+ * 
+ */
+traceRecorder::traceRecorder ( sensorFifo& pSource, const char* pFileName, uint16_t pSampleRate ) : source(pSource)
+{
+    this -> output = NULL;
+    this -> fileName = pFileName;
+    this -> sampleRate = pSampleRate;
+}
+
+/** Begin function
+ * 
+ * @brief This function initializes the sensor and writes the header of the trace.
+ * 
+ * @return True if the sensor is ready. If the trace can not be written, the samples 
+ *         are given to the reader without recording them.
+ * 
+ * @note The SPIFFS has to be mounted before.
+ * 
+ */
+bool traceRecorder::begin ( )
+{
+    if ( fileName != NULL )
+    {
+        file = SPIFFS.open(fileName, FILE_WRITE);
+        output = file ? &file : NULL;
+    }
+
+    uint8_t header[TRACE_HEADER_SIZE] = { 'P', 'P', 'G', 'T' };
+    writeLittleEndian(header + 4, TRACE_VERSION, 2);
+    writeLittleEndian(header + 6, sampleRate, 2);
+    recording = output != NULL && output -> write(header, TRACE_HEADER_SIZE) == TRACE_HEADER_SIZE;
+    if ( !recording )
+    {
+        LOG_ERROR("Failed to start the sensor trace");
+    }
+    return source.begin();
+}
+
+/** Stop function
+ * 
+ * @brief This function stops the recording and closes the file of the trace.
+ * 
+ */
+void traceRecorder::stop ( )
+{
+    recording = false;
+    if ( fileName != NULL ) file.close();
+}
+
+/** Is recording function
+ * 
+ * @brief This function returns if the trace is being recorded.
+ * 
+ * @return True if the trace is being recorded.
+ * 
+ */
+bool traceRecorder::isRecording ( )
+{
+    return recording;
+}
+
+/** Get recorded samples function
+ * 
+ * @brief This function returns the number of samples recorded.
+ * 
+ * @return Number of samples recorded.
+ * 
+ */
+uint32_t traceRecorder::getRecordedSamples ( )
+{
+    return recordedSamples;
+}
+
+/** Data pending function
+ * 
+ * @brief This function returns if the sensor FIFO should be read.
+ * 
+ * @return True if the sensor FIFO should be read.
+ * 
+ */
+bool traceRecorder::dataPending ( )
+{
+    return source.dataPending();
+}
+
+/** Check function
+ * 
+ * @brief This function reads a burst of the sensor and records it.
+ * 
+ * @return Number of samples read.
+ * 
+ * @see writeRecord().
+ * 
+ */
+uint16_t traceRecorder::check ( )
+{
+    source.check();
+    storedSamples = 0;
+    readSamples = 0;
+    while ( source.available() && storedSamples < SENSOR_FIFO_DEPTH )
+    {
+        irSamples[storedSamples] = source.getFIFOIR();
+        redSamples[storedSamples] = source.getFIFORed();
+        source.nextSample();
+        storedSamples++;
+    }
+
+    if ( recording && storedSamples > 0 && !writeRecord() )
+    {
+        LOG_ERROR("Sensor trace stopped: the record could not be written");
+        stop();
+    }
+    return storedSamples;
+}
+
+/** Write record function
+ * 
+ * @brief This function writes the last burst as a record of the trace.
+ * 
+ * @return True if the record has been written completely.
+ * 
+ * @details The record is built in one buffer and written at once, so it is not mixed 
+ *          with other output of the serial port. The overflow counter of the burst is 
+ *          recorded, so the replay reports the same lost samples. The file is flushed after each record,
+ *          so the trace is valid if the device is turned off.
+ * 
+ */
+bool traceRecorder::writeRecord ( )
+{
+    record[0] = TRACE_MARKER_FIRST;
+    record[1] = TRACE_MARKER_SECOND;
+    record[2] = storedSamples;
+    record[3] = source.getOverflows();
+    writeLittleEndian(record + 4, source.getCheckTime(), 4);
+    uint8_t* sample = record + 8;
+    for (uint8_t i = 0; i < storedSamples; i++, sample += TRACE_SAMPLE_SIZE)
+    {
+        writeLittleEndian(sample, irSamples[i], 3);
+        writeLittleEndian(sample + 3, redSamples[i], 3);
+    }
+    uint8_t checksum = 0;
+    for (uint8_t* data = record + 2; data < sample; data++) checksum += *data;
+    *sample = checksum;
+
+    size_t size = TRACE_RECORD_OVERHEAD + storedSamples * TRACE_SAMPLE_SIZE;
+    if ( output -> write(record, size) != size ) return false;
+    if ( fileName != NULL ) file.flush();
+    recordedSamples += storedSamples;
+    return true;
+}
+
+/** Get sample rate function
+ * 
+ * @brief This function returns the sample rate of the recorded FIFO.
+ * 
+ * @return Sample rate in Hz, as written in the header of the trace.
+ * 
+ */
+uint16_t traceRecorder::getSampleRate ( )
+{
+    return sampleRate;
+}
+
+/** Get check time function
+ * 
+ * @brief This function returns the time of the last burst.
+ * 
+ * @return Time of the last burst of the sensor in ms.
+ * 
+ */
+uint32_t traceRecorder::getCheckTime ( )
+{
+    return source.getCheckTime();
+}
+
+/** Get overflows function
+ * 
+ * @brief This function returns the samples lost by the FIFO before the last check.
+ * 
+ * @return Samples lost by the recorded FIFO.
+ * 
+ */
+uint8_t traceRecorder::getOverflows ( )
+{
+    return source.getOverflows();
+}
+
+/** Available function
+ * 
+ * @brief This function returns the number of samples read and not consumed yet.
+ * 
+ * @return Number of samples available.
+ * 
+ */
+uint8_t traceRecorder::available ( )
+{
+    return storedSamples - readSamples;
+}
+
+/** Get FIFO IR function
+ * 
+ * @brief This function returns the IR value of the current sample.
+ * 
+ * @return IR value.
+ * 
+ */
+uint32_t traceRecorder::getFIFOIR ( )
+{
+    return irSamples[readSamples];
+}
+
+/** Get FIFO red function
+ * 
+ * @brief This function returns the red value of the current sample.
+ * 
+ * @return Red value.
+ * 
+ */
+uint32_t traceRecorder::getFIFORed ( )
+{
+    return redSamples[readSamples];
+}
+
+/** Next sample function
+ * 
+ * @brief This function advances to the next sample.
+ * 
+ */
+void traceRecorder::nextSample ( )
+{
+    if ( readSamples < storedSamples ) readSamples++;
+}
@@ -0,0 +1,88 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+
+#include "Logger.h"
+#include "SensorFifo.h"
+#include "SensorTrace.h"
+
+namespace std
+{
+    /** Trace recorder class
+     *
+     * @brief This class records the raw samples of a sensor FIFO in a binary trace.
+     *
+     * @details This class is placed between the sensor FIFO and the data reader. Each
+     *          burst is read from the sensor, written as a record of the trace and then
+     *          given to the reader unchanged. The trace is written to a file of the 
+     *          SPIFFS or to any output, like the serial port. If a record can not be 
+     *          written completely (e.g. the flash is full), the recording stops and the
+     *          samples keep going to the reader.
+     *
+     * @param source FIFO of the sensor
+     * @param output Output of the trace
+     * @param file File of the trace, if it is recorded in the SPIFFS
+     * @param fileName Name of the file of the trace, NULL if it is not recorded in the SPIFFS
+     * @param sampleRate Sample rate of the sensor FIFO in Hz
+     * @param recording True while the trace is being recorded
+     * @param recordedSamples Number of samples recorded
+     * @param irSamples IR samples of the last burst
+     * @param redSamples Red samples of the last burst
+     * @param storedSamples Number of samples of the last burst
+     * @param readSamples Number of samples already consumed
+     * @param record Last record written
+     *
+     */
+    class traceRecorder : public sensorFifo {
+        sensorFifo& source;
+        Print* output;
+        File file;
+        const char* fileName;
+        uint16_t sampleRate;
+        bool recording = false;
+        uint32_t recordedSamples = 0;
+
+        uint32_t irSamples[SENSOR_FIFO_DEPTH];
+        uint32_t redSamples[SENSOR_FIFO_DEPTH];
+        uint8_t storedSamples = 0;
+        uint8_t readSamples = 0;
+        uint8_t record[TRACE_MAX_RECORD_SIZE];
+
+        bool writeRecord ();
+
+        public:
+            traceRecorder ( sensorFifo& pSource, Print& pOutput, uint16_t pSampleRate );
+
+            traceRecorder ( sensorFifo& pSource, const char* pFileName, uint16_t pSampleRate );
+
+            bool begin ();
+
+            uint16_t getSampleRate ();
+
+            void stop ();
+
+            bool isRecording ();
+
+            uint32_t getRecordedSamples ();
+
+            bool dataPending ();
+
+            uint16_t check ();
+
+            uint32_t getCheckTime ();
+
+            uint8_t getOverflows ();
+
+            uint8_t available ();
+
+            uint32_t getFIFOIR ();
+
+            uint32_t getFIFORed ();
+
+            void nextSample ();
+    };
+}
+
+#endif /* TRACERECORDER_H */
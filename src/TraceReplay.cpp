@@ -0,0 +1,374 @@
+#include "TraceReplay.h"
+
+using namespace std;
+
+/** Read little endian function
+ * 
+ * @brief This function reads a little endian unsigned integer.
+ * 
+ * @param data Pointer to the first byte.
+ * @param bytes Number of bytes of the integer.
+ * 
+ * @return Value read.
+ * 
+ */
+static uint32_t readLittleEndian ( const uint8_t* data, uint8_t bytes )
+{
+    uint32_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--)
+    {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+/** Trace replay constructor
+ * 
+ * @brief This is the constructor of the trace replay class that reads a file of the SPIFFS.
+ * 
+ * @param pFileName Name of the file of the trace. It is opened when the replay begins.
+ * @param pRealTime True to give the bursts at their recorded times, false to give them
+ *                  as fast as they are read. By default is false.
+ * 
+ */
+traceReplay::traceReplay ( const char* pFileName, bool pRealTime )
+{
+    this -> fileName = pFileName;
+    this -> realTime = pRealTime;
+}
+
+/** Trace replay constructor
+ * 
+ * @brief This is the constructor of the trace replay class that reads an opened file.
+ * 
+ * @param pFile File of the trace.
+ * @param pRealTime True to give the bursts at their recorded times, false to give them
+ *                  as fast as they are read. By default is false.
+ * 
+ */
+traceReplay::traceReplay ( File pFile, bool pRealTime ) : file(pFile)
+{
+    this -> fileName = NULL;
+    this -> realTime = pRealTime;
+}
+
+/** Begin function
+ * 
+ * @brief This function opens the trace and reads its first record.
+ * 
+ * @return True if the trace is valid.
+ * 
+ * @note The SPIFFS has to be mounted before.
+ * 
+ * @see rewind().
+ * 
+ */
+bool traceReplay::begin ( )
+{
+    if ( fileName != NULL ) file = SPIFFS.open(fileName, FILE_READ);
+    if ( !file )
+    {
+        LOG_ERROR("Failed to open the sensor trace");
+        finished = true;
+        return false;
+    }
+    return rewind();
+}
+
+/** Rewind function
+ * 
+ * @brief This function starts the replay again from the first record.
+ * 
+ * @return True if the trace is valid.
+ * 
+ * @see readHeader(), readRecord().
+ * 
+ */
+bool traceReplay::rewind ( )
+{
+    storedSamples = 0;
+    readSamples = 0;
+    skippedRecords = 0;
+    replayedSamples = 0;
+    replayedOverflows = 0;
+    overflowSamples = 0;
+    finished = false;
+    if ( !file.seek(0) || !readHeader() )
+    {
+        LOG_ERROR("Sensor trace is not valid");
+        finished = true;
+        return false;
+    }
+    readRecord();
+    firstRecordTime = recordTime;
+    startTime = millis();
+    return true;
+}
+
+/** Read header function
+ * 
+ * @brief This function reads the header of the trace.
+ * 
+ * @return True if the header has been found and its version is supported.
+ * 
+ * @details The bytes before the magic are skipped, as a trace captured from the serial
+ *          port can start with text. The version sets the fields of the records, which
+ *          have the overflow counter since version 2.
+ * 
+ */
+bool traceReplay::readHeader ( )
+{
+    const char magic[] = "PPGT";
+    uint8_t matched = 0;
+    while ( matched < 4 )
+    {
+        int value = file.read();
+        if ( value < 0 ) return false;
+        if ( value == magic[matched] ) matched++;
+        else matched = value == magic[0] ? 1 : 0;
+    }
+
+    uint8_t header[TRACE_HEADER_SIZE - 4];
+    if ( file.read(header, sizeof(header)) != sizeof(header) ) return false;
+    uint16_t version = readLittleEndian(header, 2);
+    if ( version < TRACE_OLDEST_VERSION || version > TRACE_VERSION ) return false;
+    // count, overflows (since version 2) and check time
+    recordFields = version >= 2 ? 6 : 5;
+    sampleRate = readLittleEndian(header + 2, 2);
+    return true;
+}
+
+/** Read record function
+ * 
+ * @brief This function reads the next valid record of the trace.
+ * 
+ * @return True if a record has been read, false if the trace has finished.
+ * 
+ * @details The trace is scanned for the marker of a record. If the number of samples 
+ *          or the checksum of the record are not valid, the marker was part of other
+ *          data, so the scan goes on from the byte after it.
+ * 
+ */
+bool traceReplay::readRecord ( )
+{
+    hasRecord = false;
+    int previous = -1;
+    for (;;)
+    {
+        int value = file.read();
+        if ( value < 0 )
+        {
+            finished = true;
+            return false;
+        }
+        if ( previous != TRACE_MARKER_FIRST || value != TRACE_MARKER_SECOND )
+        {
+            previous = value;
+            continue;
+        }
+        previous = -1;
+
+        size_t recordStart = file.position();
+        uint8_t samples = 0;
+        size_t size = 0;
+        if ( file.read(record, recordFields) == recordFields )
+        {
+            samples = record[0];
+            size = samples * TRACE_SAMPLE_SIZE + 1;
+        }
+        bool valid = samples > 0 && samples <= SENSOR_FIFO_DEPTH && file.read(record + recordFields, size) == size;
+        if ( valid )
+        {
+            uint8_t checksum = 0;
+            for (size_t i = 0; i < recordFields + size - 1; i++) checksum += record[i];
+            valid = checksum == record[recordFields + size - 1];
+        }
+        if ( !valid )
+        {
+            skippedRecords++;
+            file.seek(recordStart);
+            continue;
+        }
+
+        recordSamples = samples;
+        recordOverflows = recordFields > 5 ? record[1] : 0;
+        recordTime = readLittleEndian(record + recordFields - 4, 4);
+        hasRecord = true;
+        return true;
+    }
+}
+
+/** Is finished function
+ * 
+ * @brief This function returns if all the records of the trace have been given.
+ * 
+ * @return True if the replay has finished.
+ * 
+ */
+bool traceReplay::isFinished ( )
+{
+    return finished && !hasRecord;
+}
+
+/** Get sample rate function
+ * 
+ * @brief This function returns the sample rate of the trace.
+ * 
+ * @return Sample rate in Hz.
+ * 
+ */
+uint16_t traceReplay::getSampleRate ( )
+{
+    return sampleRate;
+}
+
+/** Get skipped records function
+ * 
+ * @brief This function returns the number of records skipped because they are not valid.
+ * 
+ * @return Number of records skipped.
+ * 
+ */
+uint32_t traceReplay::getSkippedRecords ( )
+{
+    return skippedRecords;
+}
+
+/** Get replayed samples function
+ * 
+ * @brief This function returns the number of samples given since the start of the replay.
+ * 
+ * @return Number of samples replayed.
+ * 
+ */
+uint32_t traceReplay::getReplayedSamples ( )
+{
+    return replayedSamples;
+}
+
+/** Get replayed overflows function
+ * 
+ * @brief This function returns the number of samples lost by the FIFO since the start of
+ *        the replay, as recorded in the trace.
+ * 
+ * @return Sum of the overflow counters of the bursts given.
+ * 
+ */
+uint32_t traceReplay::getReplayedOverflows ( )
+{
+    return replayedOverflows;
+}
+
+/** Data pending function
+ * 
+ * @brief This function returns if the next burst can be given.
+ * 
+ * @return True if there is a record left and, in real time, its time has come.
+ * 
+ */
+bool traceReplay::dataPending ( )
+{
+    if ( !hasRecord ) return false;
+    if ( !realTime ) return true;
+    return millis() - startTime >= recordTime - firstRecordTime;
+}
+
+/** Check function
+ * 
+ * @brief This function gives the record read as a burst and reads the next one.
+ * 
+ * @return Number of samples of the burst.
+ * 
+ */
+uint16_t traceReplay::check ( )
+{
+    storedSamples = 0;
+    readSamples = 0;
+    overflowSamples = 0;
+    if ( !hasRecord ) return 0;
+
+    const uint8_t* sample = record + recordFields;
+    for (uint8_t i = 0; i < recordSamples; i++, sample += TRACE_SAMPLE_SIZE)
+    {
+        irSamples[i] = readLittleEndian(sample, 3);
+        redSamples[i] = readLittleEndian(sample + 3, 3);
+    }
+    storedSamples = recordSamples;
+    checkTime = recordTime;
+    overflowSamples = recordOverflows;
+    replayedSamples += storedSamples;
+    replayedOverflows += overflowSamples;
+
+    readRecord();
+    return storedSamples;
+}
+
+/** Get check time function
+ * 
+ * @brief This function returns the recorded time of the last burst.
+ * 
+ * @return Check time of the last burst in ms.
+ * 
+ */
+uint32_t traceReplay::getCheckTime ( )
+{
+    return checkTime;
+}
+
+/** Get overflows function
+ * 
+ * @brief This function returns the samples lost by the FIFO before the last burst.
+ * 
+ * @return Recorded overflow counter of the last burst.
+ * 
+ */
+uint8_t traceReplay::getOverflows ( )
+{
+    return overflowSamples;
+}
+
+/** Available function
+ * 
+ * @brief This function returns the number of samples read and not consumed yet.
+ * 
+ * @return Number of samples available.
+ * 
+ */
+uint8_t traceReplay::available ( )
+{
+    return storedSamples - readSamples;
+}
+
+/** Get FIFO IR function
+ * 
+ * @brief This function returns the IR value of the current sample.
+ * 
+ * @return IR value.
+ * 
+ */
+uint32_t traceReplay::getFIFOIR ( )
+{
+    return irSamples[readSamples];
+}
+
+/** Get FIFO red function
+ * 
+ * @brief This function returns the red value of the current sample.
+ * 
+ * @return Red value.
+ * 
+ */
+uint32_t traceReplay::getFIFORed ( )
+{
+    return redSamples[readSamples];
+}
+
+/** Next sample function
+ * 
+ * @brief This function advances to the next sample.
+ * 
+ */
+void traceReplay::nextSample ( )
+{
+    if ( readSamples < storedSamples ) readSamples++;
+}
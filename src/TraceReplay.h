@@ -0,0 +1,117 @@
+#ifndef TRACEREPLAY_H
+#define TRACEREPLAY_H
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+
+#include "Logger.h"
+#include "SensorFifo.h"
+#include "SensorTrace.h"
+
+namespace std
+{
+    /** Trace replay class
+     *
+     * @brief This class is a sensor FIFO that reads the samples from a binary trace.
+     *
+     * @details Each record of the trace is given as a burst of the FIFO with its recorded
+     *          check time, so the data reader gets the same samples and times as when the
+     *          trace was recorded, and its results are the same in every replay. At full
+     *          speed a new burst is always pending; in real time a burst is pending when 
+     *          the time since the start of the replay reaches its recorded time. Records 
+     *          with a wrong checksum are skipped. The overflow counter of each record is
+     *          given by getOverflows() with its burst, and it is 0 in the traces of
+     *          version 1, which did not record it.
+     *
+     * @param file File of the trace
+     * @param fileName Name of the file of the trace, NULL if the file is given opened
+     * @param realTime True to give the bursts at their recorded times
+     * @param sampleRate Sample rate of the trace in Hz
+     * @param recordFields Size of the fields of a record between the marker and the samples
+     * @param startTime Time since boot when the replay started in ms
+     * @param firstRecordTime Check time of the first record in ms
+     * @param hasRecord True if a record has been read and not given yet
+     * @param finished True when there are no more records
+     * @param skippedRecords Number of records skipped because they are not valid
+     * @param replayedSamples Number of samples given since the start of the replay
+     * @param replayedOverflows Number of samples lost by the FIFO since the start of the replay
+     * @param recordTime Check time of the record read
+     * @param recordSamples Number of samples of the record read
+     * @param recordOverflows Overflow counter of the record read
+     * @param record Record read
+     * @param irSamples IR samples of the last burst
+     * @param redSamples Red samples of the last burst
+     * @param storedSamples Number of samples of the last burst
+     * @param readSamples Number of samples already consumed
+     * @param checkTime Check time of the last burst in ms
+     * @param overflowSamples Samples lost by the FIFO before the last burst
+     *
+     */
+    class traceReplay : public sensorFifo {
+        File file;
+        const char* fileName;
+        bool realTime;
+        uint16_t sampleRate = 0;
+        uint8_t recordFields = 0;
+        uint32_t startTime = 0;
+        uint32_t firstRecordTime = 0;
+        bool hasRecord = false;
+        bool finished = true;
+        uint32_t skippedRecords = 0;
+        uint32_t replayedSamples = 0;
+        uint32_t replayedOverflows = 0;
+
+        uint32_t recordTime = 0;
+        uint8_t recordSamples = 0;
+        uint8_t recordOverflows = 0;
+        uint8_t record[TRACE_MAX_RECORD_SIZE];
+
+        uint32_t irSamples[SENSOR_FIFO_DEPTH];
+        uint32_t redSamples[SENSOR_FIFO_DEPTH];
+        uint8_t storedSamples = 0;
+        uint8_t readSamples = 0;
+        uint32_t checkTime = 0;
+        uint8_t overflowSamples = 0;
+
+        bool readHeader ();
+
+        bool readRecord ();
+
+        public:
+            traceReplay ( const char* pFileName, bool pRealTime = false );
+
+            traceReplay ( File pFile, bool pRealTime = false );
+
+            bool begin ();
+
+            bool rewind ();
+
+            bool isFinished ();
+
+            uint16_t getSampleRate ();
+
+            uint32_t getSkippedRecords ();
+
+            uint32_t getReplayedSamples ();
+
+            uint32_t getReplayedOverflows ();
+
+            bool dataPending ();
+
+            uint16_t check ();
+
+            uint32_t getCheckTime ();
+
+            uint8_t getOverflows ();
+
+            uint8_t available ();
+
+            uint32_t getFIFOIR ();
+
+            uint32_t getFIFORed ();
+
+            void nextSample ();
+    };
+}
+
+#endif /* TRACEREPLAY_H */
@@ -0,0 +1,96 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <stdint.h>
+#include <atomic>
+
+namespace std
+{
+    /** Triple buffer class
+     *
+     * @brief This class hands complete frames from one producer task to one consumer task
+     *        without locks.
+     *
+     * @details The producer owns one buffer, the consumer owns another one and the third
+     *          one is shared. Publishing and updating only swap the index of the shared
+     *          buffer with an atomic exchange, so neither side ever blocks and the consumer
+     *          always reads a complete frame, the newest one published.
+     *
+     * @param buffers The three frames
+     * @param writeIndex Index of the frame owned by the producer
+     * @param readIndex Index of the frame owned by the consumer
+     * @param sharedIndex Index of the shared frame and flag of new frame
+     *
+     */
+    template <typename T>
+    class tripleBuffer {
+        static const uint8_t INDEX_MASK = 0x03;
+        static const uint8_t NEW_FRAME = 0x04;
+
+        T buffers[3];
+        uint8_t writeIndex = 0;
+        uint8_t readIndex = 1;
+        atomic<uint8_t> sharedIndex;
+
+        public:
+            tripleBuffer () : buffers(), sharedIndex(2) {}
+
+            /** Get write buffer function
+             *
+             * @brief This function returns the frame owned by the producer.
+             *
+             * @return Frame to fill before publishing it.
+             *
+             * @note The frame may contain old data, so it has to be filled completely.
+             *
+             */
+            T& getWriteBuffer ()
+            {
+                return buffers[writeIndex];
+            }
+
+            /** Publish function
+             *
+             * @brief This function makes the write buffer available to the consumer.
+             *
+             * @see getWriteBuffer().
+             *
+             */
+            void publish ()
+            {
+                uint8_t previous = sharedIndex.exchange(writeIndex | NEW_FRAME, memory_order_acq_rel);
+                writeIndex = previous & INDEX_MASK;
+            }
+
+            /** Update function
+             *
+             * @brief This function takes the newest published frame, if there is one.
+             *
+             * @return True if a new frame has been taken, false if not.
+             *
+             * @see getReadBuffer().
+             *
+             */
+            bool update ()
+            {
+                if ( !(sharedIndex.load(memory_order_acquire) & NEW_FRAME) ) return false;
+                uint8_t previous = sharedIndex.exchange(readIndex, memory_order_acq_rel);
+                readIndex = previous & INDEX_MASK;
+                return true;
+            }
+
+            /** Get read buffer function
+             *
+             * @brief This function returns the frame owned by the consumer.
+             *
+             * @return Last frame taken by update().
+             *
+             */
+            const T& getReadBuffer () const
+            {
+                return buffers[readIndex];
+            }
+    };
+}
+
+#endif /* TRIPLEBUFFER_H */
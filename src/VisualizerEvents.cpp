@@ -0,0 +1,70 @@
+#include "VisualizerEvents.h"
+
+using namespace std;
+
+/** Begin function
+ * 
+ * @brief This function creates the event group.
+ * 
+ * @details It has to be called before the tasks and the interrupts that use the events
+ *          are started.
+ * 
+ */
+void visualizerEvents::begin ( )
+{
+    group = xEventGroupCreate();
+    if ( group == NULL )
+    {
+        LOG_ERROR("Error creating the visualizer events");
+        logger.flush();
+        for (;;);
+    }
+}
+
+/** Signal function
+ * 
+ * @brief This function sets some events from a task.
+ * 
+ * @param events Events to set.
+ * 
+ */
+void visualizerEvents::signal ( EventBits_t events )
+{
+    xEventGroupSetBits(group, events);
+}
+
+/** Signal from ISR function
+ * 
+ * @brief This function sets some events from an interrupt.
+ * 
+ * @param events Events to set.
+ * 
+ * @details The events are set by the timer daemon task, so a context switch is requested
+ *          if it has a higher priority than the interrupted task.
+ * 
+ */
+void IRAM_ATTR visualizerEvents::signalFromISR ( EventBits_t events )
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    if ( xEventGroupSetBitsFromISR(group, events, &higherPriorityTaskWoken) == pdPASS && 
+         higherPriorityTaskWoken == pdTRUE )
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/** Wait function
+ * 
+ * @brief This function waits until any of the events is set.
+ * 
+ * @param events Events to wait for.
+ * @param timeout Maximum time to wait in ms, portMAX_DELAY to wait forever.
+ * 
+ * @return Events that were set, 0 if the timeout expired. They are cleared before returning.
+ * 
+ */
+EventBits_t visualizerEvents::wait ( EventBits_t events, uint32_t timeout )
+{
+    TickType_t ticks = timeout == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(timeout);
+    return xEventGroupWaitBits(group, events, pdTRUE, pdFALSE, ticks) & events;
+}
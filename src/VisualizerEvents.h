@@ -0,0 +1,48 @@
+#ifndef VISUALIZEREVENTS_H
+#define VISUALIZEREVENTS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+#include "Logger.h"
+
+namespace std
+{
+    // A new block of values has been published
+    const EventBits_t EVENT_NEW_BLOCK = 0x01;
+    // The buttons have changed the data shown in the display
+    const EventBits_t EVENT_MODE_CHANGE = 0x02;
+    // New filtered samples have been pushed to the waveform stream
+    const EventBits_t EVENT_NEW_SAMPLES = 0x04;
+    // A new spectrum of the sliding DFT has been published
+    const EventBits_t EVENT_NEW_SPECTRUM = 0x08;
+    // All the events of the visualizer
+    const EventBits_t EVENT_ALL = EVENT_NEW_BLOCK | EVENT_MODE_CHANGE | EVENT_NEW_SAMPLES | EVENT_NEW_SPECTRUM;
+
+    /** Visualizer events class
+     *
+     * @brief This class signals the visualizer task when there is something new to show.
+     *
+     * @details This class wraps a FreeRTOS event group. The reader task and the buttons
+     *          interrupt set the events, and the visualizer task sleeps until one of them
+     *          is set or until its next refresh is due.
+     *
+     * @param group Event group of the events
+     *
+     */
+    class visualizerEvents {
+        EventGroupHandle_t group = NULL;
+
+        public:
+            void begin ();
+
+            void signal ( EventBits_t events );
+
+            void signalFromISR ( EventBits_t events );
+
+            EventBits_t wait ( EventBits_t events, uint32_t timeout );
+    };
+}
+
+#endif /* VISUALIZEREVENTS_H */
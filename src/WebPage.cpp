@@ -1,4 +1,7 @@
 #include "WebPage.h"
+#include "FrameEncoder.h"
+
+using namespace std;
 
 /** webPage default constructor
  * 
@@ -9,7 +12,19 @@
  */
 webPage::webPage(int port):webServer(port), webSocket("/ws")
 {
-    globalClient = NULL;
+    for (uint8_t i = 0; i < MAX_WS_CLIENTS; i++)
+    {
+        clients[i].state = WS_CLIENT_FREE;
+        clients[i].head = 0;
+        clients[i].count = 0;
+    }
+    for (uint8_t i = 0; i < MAX_WS_SHARED_MESSAGES; i++)
+    {
+        messages[i].buffer = NULL;
+        messages[i].references = 0;
+    }
+    unsentMessages = 0;
+    newClient = false;
 }
 
 /** webPage begin function
@@ -46,23 +61,23 @@ void webPage::initWiFi(const char* ssid, const char* password)
 {
     WiFi.begin(ssid, password);
 
-    Serial.print("Connecting to WiFi..");
+    LOG_INFO("Connecting to WiFi %s", ssid);
     while (WiFi.status() != WL_CONNECTED) {
         delay(1000);
-        Serial.print(".");
+        LOG_DEBUG("Waiting for WiFi");
     }
 
-    Serial.println("");
-    Serial.println("IP: ");
-    Serial.print(WiFi.localIP());
-    Serial.println("");
+    IPAddress ip = WiFi.localIP();
+    LOG_INFO("IP: %u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
 }
 
 /** Server initialization function
  * 
  * @brief This function initializes the server.
  *  
- * @details This function defines the websocket and the html, css and js files.
+ * @details This function defines the websocket, the html, css and js files, the
+ *          statistics of the clients and, if STAGE_METRICS is defined, the metrics of
+ *          the processing stages.
  *  
  * @see begin(), onWsEvent().
  * 
@@ -99,6 +114,20 @@ void webPage::initServer()
         request->send(SPIFFS, "/js/frequencies-chart.js", "text/javascript");
     });
 
+    // define clients statistics
+    webServer.on("/clients", HTTP_GET, [this](AsyncWebServerRequest *request){
+        this->sendClientsStats(request);
+    });
+
+#ifdef STAGE_METRICS
+    // define stage metrics
+    webServer.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request){
+        AsyncResponseStream * response = request->beginResponseStream("text/plain");
+        metrics.printMetrics(*response);
+        request->send(response);
+    });
+#endif
+
     webServer.begin();
 }
 
@@ -114,8 +143,11 @@ void webPage::initServer()
  * @param len size_t object.
  *  
  * @details This function defines what to do when a websocket event occurs depending on the type of event.
+ *          When a client connects, arg is the request of the connection, and the client takes a free slot.
+ *          If there is no free slot, the connection is closed. When a client disconnects, its slot is 
+ *          closed and it is released by the task that sends the messages.
  *  
- * @see begin(), initServer().
+ * @see begin(), initServer(), getRequestedProtocol().
  * 
  */
 void webPage::onWsEvent (AsyncWebSocket * server, AsyncWebSocketClient * client, 
@@ -123,29 +155,451 @@ void webPage::onWsEvent (AsyncWebSocket * server, AsyncWebSocketClient * client,
 {
     if (type == WS_EVT_CONNECT)
     {
-        Serial.println("Websocket client connection received");
-        globalClient = client;
+        LOG_INFO("Websocket client %u connected", client->id());
+        wsProtocol protocol = getRequestedProtocol((AsyncWebServerRequest *)arg);
+        bool accepted = false;
+        portENTER_CRITICAL(&clientsMux);
+        for (uint8_t i = 0; i < MAX_WS_CLIENTS && !accepted; i++)
+        {
+            if (clients[i].state != WS_CLIENT_FREE) continue;
+            wsClientStats stats = { client->id(), protocol, 0, 0, 0, 0, 0, 0 };
+            clients[i].stats = stats;
+            clients[i].head = 0;
+            clients[i].count = 0;
+            clients[i].state = WS_CLIENT_ACTIVE;
+            accepted = true;
+        }
+        portEXIT_CRITICAL(&clientsMux);
+        if (accepted) newClient = true;
+        if (!accepted)
+        {
+            LOG_WARN("Too many websocket clients");
+            client->close();
+        }
     } 
     else if (type == WS_EVT_DISCONNECT)
     {
-        Serial.println("Client disconnected");
-        globalClient = NULL;
+        LOG_INFO("Websocket client %u disconnected", client->id());
+        portENTER_CRITICAL(&clientsMux);
+        for (uint8_t i = 0; i < MAX_WS_CLIENTS; i++)
+        {
+            if (clients[i].state == WS_CLIENT_ACTIVE && clients[i].stats.id == client->id())
+            {
+                clients[i].state = WS_CLIENT_CLOSED;
+            }
+        }
+        portEXIT_CRITICAL(&clientsMux);
     }
 }
 
+/** Get requested protocol function
+ * 
+ * @brief This function returns the protocol requested by a WebSocket client.
+ * 
+ * @param request Request of the WebSocket connection.
+ * 
+ * @return WS_PROTOCOL_BINARY if the client asked for the binary subprotocol or added
+ *         protocol=binary to the URL, WS_PROTOCOL_JSON if not.
+ * 
+ * @see onWsEvent(), frameEncoder.
+ * 
+ */
+wsProtocol webPage::getRequestedProtocol(AsyncWebServerRequest * request)
+{
+    if(request == NULL) return WS_PROTOCOL_JSON;
+
+    if(request->hasParam("protocol") && request->getParam("protocol")->value() == "binary")
+    {
+        return WS_PROTOCOL_BINARY;
+    }
+    if(request->hasHeader("Sec-WebSocket-Protocol") && 
+       request->getHeader("Sec-WebSocket-Protocol")->value().indexOf(BINARY_PROTOCOL_NAME) >= 0)
+    {
+        return WS_PROTOCOL_BINARY;
+    }
+    return WS_PROTOCOL_JSON;
+}
+
+/** Has client function
+ * 
+ * @brief This function returns if there is a client connected with a protocol.
+ * 
+ * @param protocol Protocol of the client.
+ * 
+ * @return True if there is at least one client connected with that protocol.
+ * 
+ */
+bool webPage::hasClient(wsProtocol protocol)
+{
+    bool found = false;
+    portENTER_CRITICAL(&clientsMux);
+    for (uint8_t i = 0; i < MAX_WS_CLIENTS && !found; i++)
+    {
+        found = clients[i].state == WS_CLIENT_ACTIVE && clients[i].stats.protocol == protocol;
+    }
+    portEXIT_CRITICAL(&clientsMux);
+    return found;
+}
+
 /** Send websocket message function
  * 
  * @brief This function sends a websocket message.
  * 
  * @param message Message to send.
+ * @param length Length of the message.
+ * @param kind Kind of the message.
  *  
- * @details This function sends a websocket message if there is a client connected.
+ * @details This function sends a websocket message to all the JSON clients connected.
+ * 
+ * @see broadcast().
  * 
  */
-void webPage::sendWsMessage(String message)
+void webPage::sendWsMessage(const char* message, size_t length, wsMessageKind kind)
 {
-    if(globalClient != NULL && globalClient->status() == WS_CONNECTED)
+    broadcast((const uint8_t *)message, length, WS_PROTOCOL_JSON, kind);
+}
+
+/** Send websocket binary function
+ * 
+ * @brief This function sends a binary websocket message.
+ * 
+ * @param data Frame to send.
+ * @param length Length of the frame.
+ * @param kind Kind of the message.
+ *  
+ * @details This function sends a binary websocket message to all the binary clients connected.
+ * 
+ * @see broadcast(), frameEncoder.
+ * 
+ */
+void webPage::sendWsBinary(const uint8_t* data, size_t length, wsMessageKind kind)
+{
+    broadcast(data, length, WS_PROTOCOL_BINARY, kind);
+}
+
+/** Broadcast function
+ * 
+ * @brief This function queues a message to all the clients with a protocol.
+ * 
+ * @param data Message to send.
+ * @param length Length of the message.
+ * @param protocol Protocol of the message.
+ * @param kind Kind of the message.
+ * 
+ * @details The message is copied once in a shared buffer, which is referenced by the queue
+ *          of each client. Then, the queues are flushed.
+ * 
+ * @see enqueueMessage(), flushClients().
+ * 
+ */
+void webPage::broadcast(const uint8_t* data, size_t length, wsProtocol protocol, wsMessageKind kind)
+{
+    releaseClosedClients();
+    if(!hasClient(protocol)) return;
+
+    int16_t index = allocateMessage(data, length, kind);
+    if(index < 0)
+    {
+        unsentMessages++;
+        flushClients();
+        return;
+    }
+
+    // keep a reference until all the queues have the message
+    messages[index].references = 1;
+    portENTER_CRITICAL(&clientsMux);
+    for (uint8_t i = 0; i < MAX_WS_CLIENTS; i++)
+    {
+        if (clients[i].state == WS_CLIENT_ACTIVE && clients[i].stats.protocol == protocol)
+        {
+            enqueueMessage(clients[i], index);
+        }
+    }
+    releaseMessage(index);
+    portEXIT_CRITICAL(&clientsMux);
+
+    flushClients();
+}
+
+/** Flush clients function
+ * 
+ * @brief This function hands the queued messages to the WebSocket.
+ * 
+ * @details The messages of each client are handed while the WebSocket can queue more messages
+ *          for that client, so a slow client does not hold the messages of the others. The 
+ *          remaining messages wait for the next call.
+ * 
+ * @see broadcast().
+ * 
+ */
+void webPage::flushClients()
+{
+    releaseClosedClients();
+    for (uint8_t i = 0; i < MAX_WS_CLIENTS; i++)
+    {
+        wsClientSlot& slot = clients[i];
+        if (slot.state != WS_CLIENT_ACTIVE) continue;
+
+        AsyncWebSocketClient * client = webSocket.client(slot.stats.id);
+        while (slot.count > 0 && client != NULL && client->status() == WS_CONNECTED && client->canSend())
+        {
+            uint8_t index = slot.queue[slot.head];
+            AsyncWebSocketMessageBuffer * buffer = messages[index].buffer;
+            if (slot.stats.protocol == WS_PROTOCOL_BINARY) client->binary(buffer);
+            else client->text(buffer);
+
+            portENTER_CRITICAL(&clientsMux);
+            slot.head = (slot.head + 1) % WS_CLIENT_QUEUE_SIZE;
+            slot.count--;
+            slot.stats.sentMessages++;
+            slot.stats.sentBytes += buffer->length();
+            slot.stats.queuedMessages--;
+            slot.stats.queuedBytes -= buffer->length();
+            releaseMessage(index);
+            portEXIT_CRITICAL(&clientsMux);
+        }
+    }
+    webSocket.cleanupClients(MAX_WS_CLIENTS);
+}
+
+/** Has queued messages function
+ * 
+ * @brief This function returns if some client has messages waiting in its queue.
+ * 
+ * @return True if there are messages waiting, false if not.
+ * 
+ * @see flushClients().
+ * 
+ */
+bool webPage::hasQueuedMessages()
+{
+    bool queued = false;
+    portENTER_CRITICAL(&clientsMux);
+    for (uint8_t i = 0; i < MAX_WS_CLIENTS && !queued; i++)
     {
-        globalClient->text(message);
+        queued = clients[i].state == WS_CLIENT_ACTIVE && clients[i].count > 0;
     }
-}
\ No newline at end of file
+    portEXIT_CRITICAL(&clientsMux);
+    return queued;
+}
+
+/** Take new client function
+ * 
+ * @brief This function returns if a client has connected since the last call.
+ * 
+ * @return True if a client has connected, false if not.
+ * 
+ * @details It is used to send the last values to the new client without waiting for the next block.
+ * 
+ */
+bool webPage::takeNewClient()
+{
+    if (!newClient) return false;
+    newClient = false;
+    return true;
+}
+
+/** Allocate message function
+ * 
+ * @brief This function copies a message to a free shared message.
+ * 
+ * @param data Message.
+ * @param length Length of the message.
+ * @param kind Kind of the message.
+ * 
+ * @return Index of the shared message, -1 if there is no free shared message.
+ * 
+ * @details The buffers that are not referenced by any queue nor by the WebSocket are deleted
+ *          first. The new buffer is locked, so the WebSocket does not delete it while a queue
+ *          references it.
+ * 
+ * @see releaseMessage().
+ * 
+ */
+int16_t webPage::allocateMessage(const uint8_t* data, size_t length, wsMessageKind kind)
+{
+    int16_t index = -1;
+    for (uint8_t i = 0; i < MAX_WS_SHARED_MESSAGES; i++)
+    {
+        wsSharedMessage& message = messages[i];
+        if (message.buffer != NULL && message.references == 0 && message.buffer->canDelete())
+        {
+            delete message.buffer;
+            message.buffer = NULL;
+        }
+        if (message.buffer == NULL && index < 0) index = i;
+    }
+    if (index < 0) return -1;
+
+    AsyncWebSocketMessageBuffer * buffer = new AsyncWebSocketMessageBuffer((uint8_t *)data, length);
+    if (buffer == NULL) return -1;
+    if (buffer->get() == NULL)
+    {
+        delete buffer;
+        return -1;
+    }
+    buffer->lock();
+    messages[index].buffer = buffer;
+    messages[index].kind = kind;
+    messages[index].references = 0;
+    return index;
+}
+
+/** Release message function
+ * 
+ * @brief This function removes a reference to a shared message.
+ * 
+ * @param index Index of the shared message.
+ * 
+ * @details When no queue references the message, its buffer is unlocked and it is deleted
+ *          once the WebSocket has sent it.
+ * 
+ * @see allocateMessage().
+ * 
+ */
+void webPage::releaseMessage(uint8_t index)
+{
+    wsSharedMessage& message = messages[index];
+    if (message.references > 0) message.references--;
+    if (message.references == 0) message.buffer->unlock();
+}
+
+/** Enqueue message function
+ * 
+ * @brief This function adds a shared message to the queue of a client.
+ * 
+ * @param slot Slot of the client.
+ * @param index Index of the shared message.
+ * 
+ * @details A state message replaces the state message already waiting in the queue. If the
+ *          queue is full, its oldest message is dropped. It is called with the spinlock taken.
+ * 
+ * @see broadcast().
+ * 
+ */
+void webPage::enqueueMessage(wsClientSlot& slot, uint8_t index)
+{
+    size_t length = messages[index].buffer->length();
+    if (messages[index].kind == WS_MESSAGE_STATE)
+    {
+        for (uint8_t i = 0; i < slot.count; i++)
+        {
+            uint8_t position = (slot.head + i) % WS_CLIENT_QUEUE_SIZE;
+            uint8_t queued = slot.queue[position];
+            if (messages[queued].kind != WS_MESSAGE_STATE) continue;
+
+            size_t queuedLength = messages[queued].buffer->length();
+            slot.stats.droppedMessages++;
+            slot.stats.droppedBytes += queuedLength;
+            slot.stats.queuedBytes += length - queuedLength;
+            releaseMessage(queued);
+            slot.queue[position] = index;
+            messages[index].references++;
+            return;
+        }
+    }
+
+    if (slot.count == WS_CLIENT_QUEUE_SIZE)
+    {
+        uint8_t oldest = slot.queue[slot.head];
+        size_t oldestLength = messages[oldest].buffer->length();
+        slot.head = (slot.head + 1) % WS_CLIENT_QUEUE_SIZE;
+        slot.count--;
+        slot.stats.droppedMessages++;
+        slot.stats.droppedBytes += oldestLength;
+        slot.stats.queuedMessages--;
+        slot.stats.queuedBytes -= oldestLength;
+        releaseMessage(oldest);
+    }
+
+    slot.queue[(slot.head + slot.count) % WS_CLIENT_QUEUE_SIZE] = index;
+    slot.count++;
+    slot.stats.queuedMessages++;
+    slot.stats.queuedBytes += length;
+    messages[index].references++;
+}
+
+/** Release closed clients function
+ * 
+ * @brief This function releases the queues of the disconnected clients.
+ * 
+ * @details The queue is released by the task that sends the messages, as it is the only one
+ *          that changes the queues. Then, the slot is free for a new client.
+ * 
+ * @see onWsEvent().
+ * 
+ */
+void webPage::releaseClosedClients()
+{
+    portENTER_CRITICAL(&clientsMux);
+    for (uint8_t i = 0; i < MAX_WS_CLIENTS; i++)
+    {
+        wsClientSlot& slot = clients[i];
+        if (slot.state != WS_CLIENT_CLOSED) continue;
+
+        while (slot.count > 0)
+        {
+            releaseMessage(slot.queue[slot.head]);
+            slot.head = (slot.head + 1) % WS_CLIENT_QUEUE_SIZE;
+            slot.count--;
+        }
+        slot.state = WS_CLIENT_FREE;
+    }
+    portEXIT_CRITICAL(&clientsMux);
+}
+
+/** Get clients statistics function
+ * 
+ * @brief This function copies the counters of the connected clients.
+ * 
+ * @param stats Array of MAX_WS_CLIENTS counters where they are copied.
+ * 
+ * @return Number of connected clients.
+ * 
+ */
+uint8_t webPage::getClientsStats(wsClientStats* stats)
+{
+    uint8_t count = 0;
+    portENTER_CRITICAL(&clientsMux);
+    for (uint8_t i = 0; i < MAX_WS_CLIENTS; i++)
+    {
+        if (clients[i].state == WS_CLIENT_ACTIVE) stats[count++] = clients[i].stats;
+    }
+    portEXIT_CRITICAL(&clientsMux);
+    return count;
+}
+
+/** Send clients statistics function
+ * 
+ * @brief This function answers a request with the counters of the connected clients.
+ * 
+ * @param request Request of the statistics.
+ * 
+ * @details The JSON is structured as follows:
+ *         {
+ *              "unsentMessages": unsentMessages,
+ *              "clients": [{"id", "protocol", "sentMessages", "sentBytes", "droppedMessages", 
+ *                           "droppedBytes", "queuedMessages", "queuedBytes"}]
+ *          }
+ * 
+ * @see getClientsStats().
+ * 
+ */
+void webPage::sendClientsStats(AsyncWebServerRequest * request)
+{
+    wsClientStats stats[MAX_WS_CLIENTS];
+    uint8_t count = getClientsStats(stats);
+
+    AsyncResponseStream * response = request->beginResponseStream("application/json");
+    response->printf("{\"unsentMessages\": %u, \"clients\": [", unsentMessages);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        response->printf("{\"id\": %u, \"protocol\": \"%s\", \"sentMessages\": %u, \"sentBytes\": %u, "
+                         "\"droppedMessages\": %u, \"droppedBytes\": %u, \"queuedMessages\": %u, \"queuedBytes\": %u}%s",
+                         stats[i].id, stats[i].protocol == WS_PROTOCOL_BINARY ? "binary" : "json",
+                         stats[i].sentMessages, stats[i].sentBytes, stats[i].droppedMessages, stats[i].droppedBytes,
+                         stats[i].queuedMessages, stats[i].queuedBytes, i + 1 < count ? ", " : "");
+    }
+    response->print("]}");
+    request->send(response);
+}
@@ -6,20 +6,139 @@
 #include <WiFi.h>
 #include <SPIFFS.h>
 
+#include "Logger.h"
+#include "StageMetrics.h"
+
+// Maximum number of WebSocket clients connected at the same time
+const uint8_t MAX_WS_CLIENTS = 4;
+// Maximum number of messages waiting to be sent to each client
+const uint8_t WS_CLIENT_QUEUE_SIZE = 8;
+// Maximum number of messages shared by the client queues and the WebSocket queues, 
+// whose size is set with WS_MAX_QUEUED_MESSAGES in platformio.ini
+const uint8_t MAX_WS_SHARED_MESSAGES = MAX_WS_CLIENTS * (WS_CLIENT_QUEUE_SIZE + WS_MAX_QUEUED_MESSAGES);
+
+/** WebSocket protocols
+ * 
+ * @brief Formats of the messages sent to the WebSocket clients.
+ * 
+ */
+enum wsProtocol { WS_PROTOCOL_JSON, WS_PROTOCOL_BINARY };
+
+/** WebSocket message kinds
+ * 
+ * @brief Policy of the messages when they wait in a client queue.
+ * 
+ * @details A state message replaces the state message already waiting in the queue,
+ *          as only the newest values are interesting. A stream message is kept until
+ *          it is sent, and the oldest message is dropped if the queue is full.
+ * 
+ */
+enum wsMessageKind { WS_MESSAGE_STATE, WS_MESSAGE_STREAM };
+
+/** WebSocket client states
+ * 
+ * @brief States of a client slot.
+ * 
+ * @details A slot is closed when the client disconnects, and it is free again when
+ *          its queue has been released by the task that sends the messages.
+ * 
+ */
+enum wsClientState { WS_CLIENT_FREE, WS_CLIENT_ACTIVE, WS_CLIENT_CLOSED };
+
+/** WebSocket client statistics struct
+ * 
+ * @brief Counters of the messages sent to a client.
+ * 
+ * @param id Identifier of the client
+ * @param protocol Protocol requested by the client
+ * @param sentMessages Messages handed to the WebSocket
+ * @param sentBytes Bytes handed to the WebSocket
+ * @param droppedMessages Messages dropped or replaced before being sent
+ * @param droppedBytes Bytes dropped or replaced before being sent
+ * @param queuedMessages Messages waiting in the queue
+ * @param queuedBytes Bytes waiting in the queue
+ * 
+ */
+struct wsClientStats {
+    uint32_t id;
+    wsProtocol protocol;
+    uint32_t sentMessages;
+    uint32_t sentBytes;
+    uint32_t droppedMessages;
+    uint32_t droppedBytes;
+    uint32_t queuedMessages;
+    uint32_t queuedBytes;
+};
+
+/** WebSocket shared message struct
+ * 
+ * @brief A message serialized once and shared by the client queues.
+ * 
+ * @param buffer Message buffer, locked while some queue references it
+ * @param kind Kind of the message
+ * @param references Number of client queues with the message
+ * 
+ */
+struct wsSharedMessage {
+    AsyncWebSocketMessageBuffer * buffer;
+    wsMessageKind kind;
+    uint8_t references;
+};
+
+/** WebSocket client slot struct
+ * 
+ * @brief A connected client with its outgoing queue.
+ * 
+ * @param state State of the slot
+ * @param stats Counters of the client
+ * @param queue Indexes of the shared messages waiting to be sent
+ * @param head Position of the oldest message of the queue
+ * @param count Number of messages of the queue
+ * 
+ */
+struct wsClientSlot {
+    wsClientState state;
+    wsClientStats stats;
+    uint8_t queue[WS_CLIENT_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+};
+
 /** Web page class 
  * @brief Class to manage the web page
  * 
- * @details This class is used to manage the web page
+ * @details This class is used to manage the web page. Each message is serialized once
+ *          in a shared buffer and queued to every client with its protocol, so a slow
+ *          client only fills its own queue. The slots are changed by the WebSocket events
+ *          and by the task that sends the messages, so they are protected by a spinlock.
  * 
  * @param webServer AsyncWebServer object
  * @param webSocket AsyncWebSocket object
- * @param globalClient AsyncWebSocketClient object
+ * @param clients Slots of the connected clients
+ * @param messages Messages shared by the client queues
+ * @param clientsMux Spinlock of the slots
+ * @param unsentMessages Messages not queued because there was no free shared message
+ * @param newClient True if a client has connected since the last check
  * 
  */
 class webPage{
     AsyncWebServer webServer;
     AsyncWebSocket webSocket;
-    AsyncWebSocketClient * globalClient;
+    wsClientSlot clients[MAX_WS_CLIENTS];
+    wsSharedMessage messages[MAX_WS_SHARED_MESSAGES];
+    portMUX_TYPE clientsMux = portMUX_INITIALIZER_UNLOCKED;
+    uint32_t unsentMessages;
+    volatile bool newClient;
+
+    int16_t allocateMessage(const uint8_t* data, size_t length, wsMessageKind kind);
+
+    void releaseMessage(uint8_t index);
+
+    void enqueueMessage(wsClientSlot& slot, uint8_t index);
+
+    void releaseClosedClients();
+
+    void broadcast(const uint8_t* data, size_t length, wsProtocol protocol, wsMessageKind kind);
 
     public:
         webPage(int port = 80);
@@ -33,7 +152,23 @@ class webPage{
         void onWsEvent (AsyncWebSocket * server, AsyncWebSocketClient * client, 
                         AwsEventType type, void * arg, uint8_t *data, size_t len);
 
-        void sendWsMessage(String message);
+        wsProtocol getRequestedProtocol(AsyncWebServerRequest * request);
+
+        bool hasClient(wsProtocol protocol);
+
+        void sendWsMessage(const char* message, size_t length, wsMessageKind kind = WS_MESSAGE_STATE);
+
+        void sendWsBinary(const uint8_t* data, size_t length, wsMessageKind kind = WS_MESSAGE_STATE);
+
+        void flushClients();
+
+        bool hasQueuedMessages();
+
+        bool takeNewClient();
+
+        uint8_t getClientsStats(wsClientStats* stats);
+
+        void sendClientsStats(AsyncWebServerRequest * request);
 };
 
-#endif /* WEBPAGE_H */
\ No newline at end of file
+#endif /* WEBPAGE_H */
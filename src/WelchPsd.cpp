@@ -0,0 +1,222 @@
+#include "WelchPsd.h"
+
+using namespace std;
+
+/** Begin function
+ *
+ * @brief This function prepares the FFT of the segments and allocates the buffers.
+ *
+ * @param pLength Number of samples of a segment, a power of 2 from 4 to FFT_MAX_SIZE.
+ * @param overlap Part of a segment shared with the next one, from 0 to less than 1.
+ * @param pDepth Number of segments of the average, at least 1.
+ * @param pAverage How the periodograms are averaged.
+ * @param window Window of the segments.
+ *
+ * @return True if the parameters are valid, false if not, in which case nothing is
+ *         computed.
+ *
+ */
+bool welchPsd::begin ( uint16_t pLength, float overlap, uint8_t pDepth, welchAverage pAverage, fftWindow window )
+{
+    length = 0;
+    if ( pDepth == 0 || !(overlap >= 0 && overlap < 1) || !plan.begin(pLength, pLength, window) ) return false;
+
+    windowPower = 0;
+    for (uint16_t n = 0; n < pLength; n++)
+    {
+        float value = fftWindowValue(window, n, pLength);
+        windowPower += value * value;
+    }
+    int32_t samplesHop = lroundf(pLength * (1 - overlap));
+    this -> hop = samplesHop < 1 ? 1 : samplesHop;
+
+    history.assign(pLength, 0);
+    segment.assign(pLength, 0);
+    accumulator.assign(pLength / 2, 0.0f);
+    density.assign(pLength / 2, 0.0f);
+    reference.assign(pLength / 2, 0.0f);
+    position = 0;
+    filled = 0;
+    sinceSegment = 0;
+    accumulated = 0;
+    ready = false;
+    hasReference = false;
+    this -> depth = pDepth;
+    this -> average = pAverage;
+    this -> length = pLength;
+    return true;
+}
+
+/** Push function
+ *
+ * @brief This function pushes a block of samples and averages the segments it completes.
+ *
+ * @param input Samples, as signed 32 bits integers, following the ones of the last push.
+ * @param count Number of samples.
+ * @param sampleRate Rate of the samples in Hz.
+ *
+ * @return Number of segments averaged, 0 if the ring is not full yet or if the PSD has
+ *         not begun.
+ *
+ * @details The first segment is averaged when the ring is full for the first time, and
+ *          then every hop samples.
+ *
+ * @see addSegment(), getDensity().
+ *
+ */
+uint8_t welchPsd::push ( const int32_t* input, uint16_t count, float sampleRate )
+{
+    if ( length == 0 || sampleRate <= 0 ) return 0;
+
+    uint8_t segments = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        history[position] = input[i];
+        position = position + 1 < length ? position + 1 : 0;
+        if ( filled < length )
+        {
+            if ( ++filled < length ) continue;
+        }
+        else if ( ++sinceSegment < hop ) continue;
+
+        sinceSegment = 0;
+        addSegment(sampleRate);
+        segments++;
+    }
+    return segments;
+}
+
+/** Add segment function
+ *
+ * @brief This function averages the periodogram of the last segment.
+ *
+ * @param sampleRate Rate of the samples in Hz.
+ *
+ * @details The periodogram is 2 * |X[k]|^2 / (sampleRate * windowPower), and half of it
+ *          for the DC bin, which is only counted once.
+ *
+ */
+void welchPsd::addSegment ( float sampleRate )
+{
+    for (uint16_t n = 0; n < length; n++)
+    {
+        uint16_t index = position + n;
+        segment[n] = history[index < length ? index : index - length];
+    }
+    const float* magnitudes = plan.magnitudes(segment.data());
+
+    float scale = 2 / (sampleRate * windowPower);
+    uint16_t bins = length / 2;
+    if ( average == WELCH_AVERAGE_EXPONENTIAL )
+    {
+        if ( accumulated < depth ) accumulated++;
+        float weight = 1.0f / accumulated;
+        for (uint16_t k = 0; k < bins; k++)
+        {
+            float power = magnitudes[k] * magnitudes[k] * (k == 0 ? 0.5f * scale : scale);
+            density[k] += weight * (power - density[k]);
+        }
+        ready = true;
+        return;
+    }
+
+    for (uint16_t k = 0; k < bins; k++)
+    {
+        accumulator[k] += magnitudes[k] * magnitudes[k] * (k == 0 ? 0.5f * scale : scale);
+    }
+    if ( ++accumulated < depth ) return;
+    for (uint16_t k = 0; k < bins; k++)
+    {
+        density[k] = accumulator[k] / depth;
+        accumulator[k] = 0.0f;
+    }
+    accumulated = 0;
+    ready = true;
+}
+
+/** Get density function
+ *
+ * @brief This function returns the power spectral density.
+ *
+ * @return Density of the bins 0 to length / 2 - 1, sampleRate / length Hz apart and
+ *         valid until the next push, or NULL if no average has been computed yet.
+ *
+ */
+const float* welchPsd::getDensity ( )
+{
+    return ready ? density.data() : NULL;
+}
+
+/** Get change function
+ *
+ * @brief This function measures how much the density has changed since the reference,
+ *        which is the stability metric of the spectrum.
+ *
+ * @return Sum of the absolute differences of the bins divided by the sum of the bins of
+ *         the reference: 0 if the spectrum is stable, 1 if there is no reference.
+ *
+ * @see setReference().
+ *
+ */
+float welchPsd::getChange ( )
+{
+    if ( !ready || !hasReference ) return 1.0f;
+
+    float difference = 0;
+    float total = 0;
+    for (uint16_t k = 0; k < length / 2; k++)
+    {
+        difference += fabsf(density[k] - reference[k]);
+        total += reference[k];
+    }
+    return total > 0 ? difference / total : 1.0f;
+}
+
+/** Set reference function
+ *
+ * @brief This function keeps the current density as the reference of getChange(), for
+ *        example when it is published.
+ *
+ */
+void welchPsd::setReference ( )
+{
+    if ( !ready ) return;
+    for (uint16_t k = 0; k < length / 2; k++) reference[k] = density[k];
+    hasReference = true;
+}
+
+/** Get bins function
+ *
+ * @brief This function returns the number of bins of the density.
+ *
+ * @return Number of bins, length / 2.
+ *
+ */
+uint16_t welchPsd::getBins ( )
+{
+    return length / 2;
+}
+
+/** Get length function
+ *
+ * @brief This function returns the number of samples of a segment.
+ *
+ * @return Number of samples, 0 if the PSD has not begun.
+ *
+ */
+uint16_t welchPsd::getLength ( )
+{
+    return length;
+}
+
+/** Get hop function
+ *
+ * @brief This function returns the number of samples between the starts of two segments.
+ *
+ * @return Number of samples.
+ *
+ */
+uint16_t welchPsd::getHop ( )
+{
+    return hop;
+}
@@ -0,0 +1,102 @@
+#ifndef WELCHPSD_H
+#define WELCHPSD_H
+
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "FftPlan.h"
+#include "FftWindow.h"
+
+namespace std
+{
+    /** Welch average enum
+     *
+     * @brief This enum is how the periodograms of the segments are averaged.
+     *
+     */
+    enum welchAverage {
+        WELCH_AVERAGE_EXPONENTIAL,
+        WELCH_AVERAGE_FIXED_COUNT
+    };
+
+    /** Welch PSD class
+     *
+     * @brief This class is the power spectral density of a stream of real samples, averaged
+     *        over overlapping segments with the Welch method.
+     *
+     * @details The samples are pushed block by block into a ring of one segment, so the
+     *          segments can overlap two blocks without keeping them. Every hop samples, the
+     *          segment is transformed by its own fftPlan, without zero padding, and its
+     *          periodogram is averaged in place: with WELCH_AVERAGE_EXPONENTIAL, the
+     *          density moves 1 / depth of the way to each periodogram (1 / n for the first
+     *          depth ones, so it starts as a plain mean), and with WELCH_AVERAGE_FIXED_COUNT
+     *          the periodograms are added up and the density is their mean every depth
+     *          segments. The density is one sided, in units of the samples squared per Hz,
+     *          so it does not depend on the window nor on the length of the segments. The
+     *          change of the density since a reference tells if it is worth publishing
+     *          again. All the buffers are allocated by begin(), so a push never allocates
+     *          memory.
+     *
+     * @param length Number of samples of a segment, 0 until begin() is called
+     * @param hop Samples between the starts of two segments
+     * @param depth Number of segments of the average
+     * @param average How the periodograms are averaged
+     * @param plan FFT of the segments
+     * @param windowPower Sum of the squares of the window
+     * @param history Last samples, a ring of one segment
+     * @param position Position of the next sample in the history
+     * @param filled Number of samples in the history, up to length
+     * @param sinceSegment Samples pushed since the last segment
+     * @param segment Samples of a segment in order, from the oldest one
+     * @param accumulator Sum of the periodograms of the current count, with
+     *                    WELCH_AVERAGE_FIXED_COUNT
+     * @param accumulated Number of periodograms of the accumulator or of the exponential
+     *                    average, up to depth
+     * @param density Power spectral density of the bins 0 to length / 2 - 1
+     * @param reference Density when setReference() was called
+     * @param ready True if the density has been computed
+     * @param hasReference True if setReference() has been called since begin()
+     *
+     */
+    class welchPsd {
+        uint16_t length = 0;
+        uint16_t hop = 0;
+        uint8_t depth = 0;
+        welchAverage average = WELCH_AVERAGE_EXPONENTIAL;
+        fftPlan plan;
+        float windowPower = 0;
+        vector<int32_t> history;
+        uint16_t position = 0;
+        uint16_t filled = 0;
+        uint16_t sinceSegment = 0;
+        vector<int32_t> segment;
+        vector<float> accumulator;
+        uint8_t accumulated = 0;
+        vector<float> density;
+        vector<float> reference;
+        bool ready = false;
+        bool hasReference = false;
+
+        void addSegment ( float sampleRate );
+
+        public:
+            bool begin ( uint16_t pLength, float overlap, uint8_t pDepth, welchAverage pAverage, fftWindow window );
+
+            uint8_t push ( const int32_t* input, uint16_t count, float sampleRate );
+
+            const float* getDensity ();
+
+            float getChange ();
+
+            void setReference ();
+
+            uint16_t getBins ();
+
+            uint16_t getLength ();
+
+            uint16_t getHop ();
+    };
+}
+
+#endif /* WELCHPSD_H */
@@ -2,15 +2,31 @@
 #include "DataVisualizer.h"
 #include "DataReader.h"
 #include "GlobalValues.h"
+#include "Logger.h"
+#include "Max3010xFifo.h"
+#include "TraceRecorder.h"
+#include "TraceReplay.h"
+#include "StageMetrics.h"
+#include "VisualizerEvents.h"
 
 using namespace std;
 
 // MAX30105 VARIABLES
-#define I2C_SPEED_FAST 400000 // Set I2C frequency to 400kHz
 #define MAX_BRIGHTNESS 255    // Set maximum brightness
+#define SENSOR_INT_PIN 19     // INT pin of the sensor
+
+// SENSOR RATE : the FIFO of the sensor gets SENSOR_SAMPLE_RATE / SENSOR_SAMPLE_AVERAGE samples
+// per second, which the reader decimates to SAMPLING_FREQUENCY (it has to be a multiple)
+#define SENSOR_SAMPLE_RATE 400    // Sample rate of the LEDs in Hz
+#define SENSOR_SAMPLE_AVERAGE 4   // Samples averaged by the sensor in each sample of the FIFO
+
+// SENSOR TRACE : define one of them (e.g. in build_flags) to record or replay the raw samples
+// #define RECORD_TRACE "/trace.bin"   // Record the samples of the sensor in a file of the SPIFFS
+// #define RECORD_TRACE_SERIAL         // Record the samples of the sensor in the serial port
+// #define REPLAY_TRACE "/trace.bin"   // Read the samples from a trace of the SPIFFS in real time
 
 // FILTER and FFT variables
-#define SAMPLES 64            // Número de muestras para la FFT
+#define FFT_SIZE 256          // Número de puntos de la FFT, el bloque completado con ceros
 #define SAMPLING_FREQUENCY 25 // Frecuencia de muestreo en Hz
 
 // DISPLAY PINS
@@ -28,9 +44,21 @@ const int SPO2_PIN = 25;
 const int FUNDAMENTALS_PIN = 27;
 const char *ssid = "*****"; // SSID of the WiFi
 const char *password = "*****"; // Password of the WiFi
+const uint32_t LOOP_PERIOD = 1000; // Time the loop sleeps in ms, it has nothing to do
 globalValues dataStorage;
+visualizerEvents events;
 globalDataVisualizer dataVisualizer(U8G2_R0, SCL, SI, CS, RS, RSE);
-globalDataReader dataReader;
+max3010xFifo sensor(SENSOR_INT_PIN, 24, SENSOR_SAMPLE_RATE, SENSOR_SAMPLE_AVERAGE);
+#if defined(REPLAY_TRACE)
+traceReplay sampleSource(REPLAY_TRACE, true);
+#elif defined(RECORD_TRACE)
+traceRecorder sampleSource(sensor, RECORD_TRACE, SENSOR_SAMPLE_RATE / SENSOR_SAMPLE_AVERAGE);
+#elif defined(RECORD_TRACE_SERIAL)
+traceRecorder sampleSource(sensor, Serial, SENSOR_SAMPLE_RATE / SENSOR_SAMPLE_AVERAGE);
+#else
+sensorFifo& sampleSource = sensor;
+#endif
+globalDataReader dataReader(sampleSource);
 hw_timer_t *timer = NULL;
 
 // FUNCTIONS DECLARATION
@@ -38,6 +66,7 @@ void initSPIFFS();
 void initGlobalVisualizer();
 void IRAM_ATTR readButtonsWrapper();
 void readData(void *parameter);
+void analyzeData(void *parameter);
 void visualizeData(void *parameter);
 void fillDataTests(void *parameter);
 
@@ -57,6 +86,12 @@ void setup()
     // Serial initialization
     Serial.begin(115200);
 
+    // Logger initialization, the messages are written by its task
+    logger.begin();
+
+    // Events initialization, before the tasks and the buttons interrupt
+    events.begin();
+
     // SPIFFS initialization
     initSPIFFS();
 
@@ -64,18 +99,28 @@ void setup()
     initGlobalVisualizer();
 
     // Data reader initialization
-    dataReader.setup();
+    dataReader.setup(SAMPLING_FREQUENCY, FFT_SIZE);
 
-    // Create task for reading
+    // Create task for reading, above the analysis so the sensor is never late
     xTaskCreatePinnedToCore(
         readData,   /* Task function. */
         "readData", /* name of task. */
-        10000,      /* Stack size of task */
+        4096,       /* Stack size of task */
         NULL,       /* parameter of the task */
-        1,          /* priority of the task */
+        2,          /* priority of the task */
         NULL,       /* Task handle to keep track of created task */
         0);         /* pin task to core 0 */
 
+    // Create task for the analysis of the blocks
+    xTaskCreatePinnedToCore(
+        analyzeData,   /* Task function. */
+        "analyzeData", /* name of task. */
+        10000,         /* Stack size of task */
+        NULL,          /* parameter of the task */
+        1,             /* priority of the task */
+        NULL,          /* Task handle to keep track of created task */
+        0);            /* pin task to core 0 */
+
     // Create task for visualization
     xTaskCreatePinnedToCore(
         visualizeData,   /* Task function. */
@@ -93,12 +138,22 @@ void setup()
  *
  * @return void.
  *
- * @details This function is empty because all the program is executed in the task.
+ * @details All the program is executed in the tasks. If STAGE_METRICS is defined, this
+ * function prints the metrics of the processing stages every METRICS_DUMP_PERIOD ms, and
+ * if not it sleeps LOOP_PERIOD ms. It always blocks, so the tasks of core 1 are not starved.
  *
- * @see setup().
+ * @see setup(), stageMetrics::logTable().
  *
  */
-void loop() {}
+void loop()
+{
+#ifdef STAGE_METRICS
+    delay(METRICS_DUMP_PERIOD);
+    metrics.logTable();
+#else
+    delay(LOOP_PERIOD);
+#endif
+}
 
 /** SPIFFS initialization function
  *
@@ -113,7 +168,8 @@ void initSPIFFS()
 {
     if (!SPIFFS.begin())
     {
-        Serial.println("An Error has occurred while mounting SPIFFS");
+        LOG_ERROR("An Error has occurred while mounting SPIFFS");
+        logger.flush();
         for (;;);
     }
 }
@@ -155,7 +211,8 @@ void initGlobalVisualizer()
  *
  * @return void.
  *
- * @details This function is the wrapper of the read buttons function.
+ * @details This function is the wrapper of the read buttons function. If the order of the
+ * buttons changes, it signals the visualizer.
  *
  * @note This function is called when the timer is activated.
  *
@@ -164,7 +221,10 @@ void initGlobalVisualizer()
  */
 void IRAM_ATTR readButtonsWrapper()
 {
-    dataVisualizer.buttons.readButtons();
+    if (dataVisualizer.buttons.readButtons())
+    {
+        events.signalFromISR(EVENT_MODE_CHANGE);
+    }
 }
 
 /** Visualize data function
@@ -174,21 +234,18 @@ void IRAM_ATTR readButtonsWrapper()
  * @return void.
  *
  * @details This function visualizes the data in the display and in the web page. This
- * function is executed in one core of the ESP32.
+ * function is executed in one core of the ESP32, and it sleeps until the events signal
+ * new data or a refresh is due.
  *
  * @see setup().
  *
  */
 void visualizeData(void *parameter)
 {
-    Serial.println(" Calculating... ");
-    while(!dataReader.isDataReady())
-    {
-        dataVisualizer.workInProgressMessage();
-    }
+    LOG_INFO("Calculating...");
     for (;;)
     {
-        dataVisualizer.generateVisualization(dataStorage);
+        dataVisualizer.generateVisualization(dataStorage, events);
     }
 }
 
@@ -198,15 +255,37 @@ void visualizeData(void *parameter)
  *
  * @return void.
  *
- * @details This function gets the data. This function is executed in one core of the ESP32.
+ * @details This function reads and filters the samples of the sensor and fills the blocks
+ * of the analysis. This function is executed in one core of the ESP32, with a higher
+ * priority than the analysis.
  *
- * @see setup().
+ * @see setup(), analyzeData().
  *
  */
 void readData(void *parameter)
 {
     for (;;)
     {
-        dataReader.readData(dataStorage, SAMPLES, SAMPLING_FREQUENCY);
+        dataReader.readData(dataStorage, events);
+    }
+}
+
+/** Analyze data function
+ *
+ * @brief This function analyzes the blocks of data.
+ *
+ * @return void.
+ *
+ * @details This function calculates the heart rate, the SpO2 and the FFT of each block
+ * filled by the reader task, and publishes them. It sleeps until a block is ready.
+ *
+ * @see setup(), readData().
+ *
+ */
+void analyzeData(void *parameter)
+{
+    for (;;)
+    {
+        dataReader.analyzeData(dataStorage, events);
     }
 }
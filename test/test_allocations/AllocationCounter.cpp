@@ -0,0 +1,60 @@
+#include "AllocationCounter.h"
+
+#include <stdlib.h>
+#include <new>
+
+using namespace std;
+
+// Allocations made by the thread of the test since it started counting
+static uint32_t allocations = 0;
+// True while the allocations of this thread are counted, the web server has its own thread
+static thread_local bool counting = false;
+
+void* operator new ( size_t size )
+{
+    if ( counting ) allocations++;
+    void* memory = malloc(size ? size : 1);
+    if ( memory == NULL ) throw bad_alloc();
+    return memory;
+}
+
+void* operator new[] ( size_t size )
+{
+    return operator new(size);
+}
+
+void operator delete ( void* memory ) noexcept
+{
+    free(memory);
+}
+
+void operator delete[] ( void* memory ) noexcept
+{
+    operator delete(memory);
+}
+
+/** Start counting allocations function
+ *
+ * @brief This function starts counting the allocations of the calling thread from 0.
+ *
+ * @see stopCountingAllocations().
+ *
+ */
+void startCountingAllocations ( )
+{
+    allocations = 0;
+    counting = true;
+}
+
+/** Stop counting allocations function
+ *
+ * @brief This function stops counting the allocations of the calling thread.
+ *
+ * @return Number of allocations since startCountingAllocations().
+ *
+ */
+uint32_t stopCountingAllocations ( )
+{
+    counting = false;
+    return allocations;
+}
@@ -0,0 +1,10 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <stdint.h>
+
+void startCountingAllocations ();
+
+uint32_t stopCountingAllocations ();
+
+#endif /* ALLOCATIONCOUNTER_H */
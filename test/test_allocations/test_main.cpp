@@ -0,0 +1,120 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "AllocationCounter.h"
+#include "DataVisualizer.h"
+#include "GlobalValues.h"
+#include "VisualizerEvents.h"
+
+using namespace std;
+
+// Frames of each display mode before counting, so every buffer has reached its size
+const uint8_t WARM_UP_FRAMES = 8;
+// Frames of each display mode whose allocations are counted
+const uint8_t STEADY_FRAMES = 50;
+// Heart rate samples of each block, one second at the sampling frequency of the firmware
+const uint16_t ALLOCATION_TEST_SAMPLES = 25;
+// Display modes, the button whose order is set
+const uint8_t DISPLAY_MODES = 3;
+
+/** Publish block function
+ *
+ * @brief This function publishes a block of values as the analysis and the sampler do.
+ *
+ * @param values Global values.
+ * @param events Events of the visualizer.
+ * @param block Number of the block, which changes the values.
+ *
+ */
+void publishBlock ( globalValues& values, visualizerEvents& events, uint32_t block )
+{
+    int32_t samples[ALLOCATION_TEST_SAMPLES];
+    for (uint16_t i = 0; i < ALLOCATION_TEST_SAMPLES; i++)
+    {
+        samples[i] = 1000 * ((block + i) % 7) - 3000;
+        values.pushWaveformSample(samples[i], block * 1000 + i * 40);
+    }
+    fundamentalsFreqs freqs[MAX_PEAKS];
+    for (uint8_t i = 0; i < MAX_PEAKS; i++)
+    {
+        freqs[i].freqsHz = 1.2f * (i + 1) + 0.01f * (block % 5);
+        freqs[i].amplitude = 1000.0f / (i + 1);
+    }
+    values.pushBackHeartRateDataArray(samples, ALLOCATION_TEST_SAMPLES);
+    values.setBeatsPerMinute(70 + block % 10);
+    values.setSpo2Percentage(95 + block % 4);
+    values.setFreqs(freqs, MAX_PEAKS);
+    values.publish();
+    events.signal(EVENT_NEW_BLOCK | EVENT_NEW_SAMPLES);
+}
+
+/** Test steady state function
+ *
+ * @brief This function checks that the frames of the visualizer allocate no memory once
+ *        their buffers have reached their size, in the three display modes.
+ *
+ * @details Each frame takes a new block, draws every page of the display, scrolls the
+ *          heart rate, streams the waveform and serializes the values and a batch of
+ *          samples in JSON and in binary, which is what is sent to the clients. The refresh
+ *          periods are 0 so every frame does all of it. The buffers of the WebSocket that
+ *          hold the messages until they are sent are not part of the visualizer, and there
+ *          is no client connected, so they are not counted.
+ *
+ * @see globalDataVisualizer::generateVisualization().
+ *
+ */
+void testSteadyState ( )
+{
+    globalValues values;
+    visualizerEvents events;
+    globalDataVisualizer visualizer(U8G2_R0, 0, 0, 0, 0, 0);
+    vector<int> buttonPins(DISPLAY_MODES);
+    for (uint8_t i = 0; i < DISPLAY_MODES; i++) buttonPins[i] = i;
+
+    events.begin();
+    visualizer.setup(buttonPins, "", "");
+    visualizer.setRefreshPeriods(0, 0);
+    visualizer.setWaveformStreaming(ALLOCATION_TEST_SAMPLES, 0);
+
+    waveformSample samples[ALLOCATION_TEST_SAMPLES];
+    for (uint16_t i = 0; i < ALLOCATION_TEST_SAMPLES; i++) samples[i] = { i, i * 40u, int32_t(i) - 12 };
+
+    uint32_t block = 0;
+    uint32_t allocations = 0;
+    for (uint8_t mode = 0; mode < DISPLAY_MODES; mode++)
+    {
+        for (uint8_t i = 0; i < DISPLAY_MODES; i++) visualizer.buttons[i].order = i == mode;
+        events.signal(EVENT_MODE_CHANGE);
+
+        for (uint8_t frame = 0; frame < WARM_UP_FRAMES + STEADY_FRAMES; frame++)
+        {
+            publishBlock(values, events, block++);
+            if ( frame >= WARM_UP_FRAMES ) startCountingAllocations();
+            visualizer.generateVisualization(values, events);
+            visualizer.getJSON(values);
+            visualizer.getBinaryFrame(values);
+            visualizer.getWaveformJSON(samples, ALLOCATION_TEST_SAMPLES);
+            visualizer.getWaveformFrame(samples, ALLOCATION_TEST_SAMPLES);
+            if ( frame >= WARM_UP_FRAMES ) allocations += stopCountingAllocations();
+        }
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, allocations, "a steady state frame allocated memory");
+    }
+}
+
+void setUp ( ) {}
+
+void tearDown ( ) {}
+
+/** Main function
+ *
+ * @brief This function runs the tests of the memory of the visualizer: pio test -e native.
+ *
+ * @return Number of failed tests.
+ *
+ */
+int main ( int argc, char** argv )
+{
+    UNITY_BEGIN();
+    RUN_TEST(testSteadyState);
+    return UNITY_END();
+}
@@ -0,0 +1,182 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <thread>
+
+#include "GlobalValues.h"
+#include "TripleBuffer.h"
+
+using namespace std;
+
+// Frames published by the producer thread of each test
+const uint32_t CONCURRENCY_TEST_FRAMES = 200000;
+// Values of the frames of the triple buffer test, all derived from the sequence
+const uint16_t FRAME_TEST_VALUES = 64;
+// Heart rate samples of each block of the global values test
+const uint16_t BLOCK_TEST_SAMPLES = 25;
+
+/** Test frame struct
+ *
+ * @brief This struct is a frame of the triple buffer test, big enough for a torn copy to be
+ *        caught.
+ *
+ * @param sequence Number of the frame, from 1
+ * @param values Values of the frame, sequence + i
+ *
+ */
+struct testFrame{
+    uint32_t sequence;
+    uint32_t values[FRAME_TEST_VALUES];
+};
+
+/** Test triple buffer function
+ *
+ * @brief This function publishes frames from one thread and updates them from another one,
+ *        checking that every frame taken is complete and newer than the previous one.
+ *
+ * @details The consumer is the thread of the test, as the assertions can not be called from
+ *          another thread. Built with -fsanitize=thread (pio test -e native_tsan), any data
+ *          race between the buffers fails the test too.
+ *
+ */
+void testTripleBuffer ( )
+{
+    tripleBuffer<testFrame> buffer;
+    atomic<bool> done(false);
+
+    thread producer([&buffer, &done] ( ) {
+        for (uint32_t sequence = 1; sequence <= CONCURRENCY_TEST_FRAMES; sequence++)
+        {
+            testFrame& frame = buffer.getWriteBuffer();
+            frame.sequence = sequence;
+            for (uint16_t i = 0; i < FRAME_TEST_VALUES; i++) frame.values[i] = sequence + i;
+            buffer.publish();
+        }
+        done.store(true, memory_order_release);
+    });
+
+    uint32_t lastSequence = 0;
+    uint32_t taken = 0;
+    bool torn = false;
+    bool older = false;
+    for (;;)
+    {
+        bool finished = done.load(memory_order_acquire);
+        if ( buffer.update() )
+        {
+            const testFrame& frame = buffer.getReadBuffer();
+            for (uint16_t i = 0; i < FRAME_TEST_VALUES; i++)
+            {
+                if ( frame.values[i] != frame.sequence + i ) torn = true;
+            }
+            if ( frame.sequence <= lastSequence ) older = true;
+            lastSequence = frame.sequence;
+            taken++;
+        }
+        else if ( finished ) break;
+    }
+    producer.join();
+
+    TEST_ASSERT_FALSE_MESSAGE(torn, "a frame was taken half written");
+    TEST_ASSERT_FALSE_MESSAGE(older, "a frame was taken after a newer one");
+    TEST_ASSERT_EQUAL_UINT32(CONCURRENCY_TEST_FRAMES, lastSequence);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, taken);
+}
+
+/** Test global values function
+ *
+ * @brief This function runs the reader side of the global values in one thread and the
+ *        visualizer side in another one, checking that the values of each frame taken
+ *        belong to the same publish.
+ *
+ * @details Every publish n sets the beats per minute, the SPO2, the frequencies, a block of
+ *          heart rate samples and a spectrum to n, and pushes a waveform sample of value n,
+ *          so the visualizer can tell a mix of two frames. The waveform samples have to
+ *          arrive in order, with the dropped ones as the only gaps.
+ *
+ */
+void testGlobalValues ( )
+{
+    globalValues values;
+    atomic<bool> done(false);
+
+    thread producer([&values, &done] ( ) {
+        int32_t block[BLOCK_TEST_SAMPLES];
+        for (uint32_t sequence = 1; sequence <= CONCURRENCY_TEST_FRAMES; sequence++)
+        {
+            fundamentalsFreqs freqs = { float(sequence), float(sequence) };
+            for (uint16_t i = 0; i < BLOCK_TEST_SAMPLES; i++) block[i] = sequence;
+            values.pushBackHeartRateDataArray(block, BLOCK_TEST_SAMPLES);
+            values.setBeatsPerMinute(sequence);
+            values.setSpo2Percentage(sequence);
+            values.setFreqs(&freqs, 1);
+            values.publish();
+            values.publishSpectrum(&freqs, 1);
+            values.pushWaveformSample(sequence, sequence);
+        }
+        done.store(true, memory_order_release);
+    });
+
+    int32_t lastBeatsPerMinute = 0;
+    int32_t expectedSample = 1;
+    uint32_t received = 0;
+    waveformSample samples[WAVEFORM_STREAM_SIZE];
+    bool mixed = false;
+    bool older = false;
+    bool unordered = false;
+    for (;;)
+    {
+        bool finished = done.load(memory_order_acquire);
+        bool updated = values.update();
+        if ( updated )
+        {
+            int32_t beatsPerMinute = values.getBeatsPerMinute();
+            dataView<int32_t> heartRate = values.getHeartRateDataArray();
+            if ( values.getSpo2Percentage() != beatsPerMinute ) mixed = true;
+            if ( heartRate[heartRate.size() - 1] != beatsPerMinute ) mixed = true;
+            if ( beatsPerMinute <= lastBeatsPerMinute ) older = true;
+            lastBeatsPerMinute = beatsPerMinute;
+        }
+        if ( values.updateSpectrum() )
+        {
+            dataView<fundamentalsFreqs> freqs = values.getFreqs();
+            if ( freqs.size() != 1 || freqs[0].freqsHz != freqs[0].amplitude ) mixed = true;
+        }
+        size_t count = values.popWaveformSamples(samples, WAVEFORM_STREAM_SIZE);
+        for (size_t i = 0; i < count; i++)
+        {
+            if ( uint32_t(samples[i].value) != samples[i].timestamp ) mixed = true;
+            if ( samples[i].value < expectedSample ) unordered = true;
+            expectedSample = samples[i].value + 1;
+        }
+        received += count;
+        if ( finished && !updated && count == 0 ) break;
+    }
+    producer.join();
+
+    TEST_ASSERT_FALSE_MESSAGE(mixed, "a frame mixed the values of two publishes");
+    TEST_ASSERT_FALSE_MESSAGE(older, "a frame was taken after a newer one");
+    TEST_ASSERT_FALSE_MESSAGE(unordered, "the waveform samples were not in order");
+    TEST_ASSERT_EQUAL_INT32(CONCURRENCY_TEST_FRAMES, lastBeatsPerMinute);
+    TEST_ASSERT_EQUAL_UINT32(CONCURRENCY_TEST_FRAMES, received + values.getDroppedWaveformSamples());
+}
+
+void setUp ( ) {}
+
+void tearDown ( ) {}
+
+/** Main function
+ *
+ * @brief This function runs the tests of the lock free exchange between the tasks, with
+ *        one thread for each side: pio test -e native_tsan.
+ *
+ * @return Number of failed tests.
+ *
+ */
+int main ( int argc, char** argv )
+{
+    UNITY_BEGIN();
+    RUN_TEST(testTripleBuffer);
+    RUN_TEST(testGlobalValues);
+    return UNITY_END();
+}
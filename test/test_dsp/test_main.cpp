@@ -0,0 +1,591 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <algorithm>
+#include <complex>
+#include <math.h>
+#include <stdlib.h>
+
+#include "spo2_algorithm.h"
+
+#include "BiquadFilter.h"
+#include "ChirpZ.h"
+#include "DataReader.h"
+#include "FftPlan.h"
+#include "FilterCoefficients.h"
+#include "FilterSections.h"
+#include "FirFilter.h"
+#include "FixedFft.h"
+#include "FixedFirFilter.h"
+#include "PeakExtractor.h"
+#include "SlidingDft.h"
+#include "WelchPsd.h"
+
+using namespace std;
+
+// Parameters of the firmware (see main.cpp)
+#define FFT_SIZE 256
+#define SAMPLING_FREQUENCY 25
+
+// Heart rate of the synthetic PPG of the comparison of the filters in bpm
+const int32_t FILTER_TEST_HEART_RATE = 72;
+// Blocks of the heart rate algorithm checked with each filter
+const uint8_t FILTER_TEST_BLOCKS = 16;
+// Samples filtered before the first block, so both filters have settled
+const uint32_t FILTER_SETTLING_SAMPLES = 2 * FILTER_TAPS;
+// Maximum error of the median heart rate of the blocks in bpm: the algorithm rounds the
+// interval between beats down to whole samples (20 samples are 75 bpm, 19 are 78), and a
+// block can have a false beat at its last samples, which are not averaged (18 are 83)
+const int32_t HEART_RATE_ERROR_BOUND = 8;
+// Frequencies of the stopband checks in Hz: a baseline drift and an interference above the
+// harmonics of the pulse, both added to the PPG of the heart rate checks
+const float STOPBAND_FREQUENCIES[] = { 0.1, 8.0 };
+// Amplitudes of the drift and of the interference of the PPG, the pulse being 2000
+const float DRIFT_AMPLITUDE = 800;
+const float INTERFERENCE_AMPLITUDE = 1000;
+// Minimum attenuation of both filters at the stopband frequencies in dB
+const float STOPBAND_ATTENUATION = 35;
+// Duration of the sine of each stopband check in samples
+const uint32_t RESPONSE_SAMPLES = 3000;
+// Amplitude of the sine of the stopband checks
+const float RESPONSE_AMPLITUDE = 1000;
+// Samples of the comparison of the fixed point path
+const uint32_t FIXED_POINT_SAMPLES = 2000;
+// Maximum error of the fixed point FIR filter in units of the sensor: the truncation of the
+// result and the rounding of the Q31 coefficients
+const float FIXED_FIR_ERROR_BOUND = 1.01;
+// Maximum error of the fixed point FFT relative to the highest bin
+const float FIXED_FFT_ERROR_BOUND = 0.01;
+// Maximum error of the float FFT relative to the highest bin
+const float FFT_ERROR_BOUND = 0.0001;
+// Samples of the comparison of the sliding DFT, long enough for the rounding errors to
+// build up (about 13 minutes at 25 Hz)
+const uint32_t SLIDING_DFT_SAMPLES = 20000;
+// Maximum error of the sliding DFT relative to the highest bin: the damping weighs the
+// oldest sample of the window by r^N
+const float SLIDING_DFT_ERROR_BOUND = 0.005;
+// Frequency of the pulse of the comparisons of the spectra in Hz, between two bins of the FFT
+const float PULSE_FREQUENCY = 1.23;
+// Second band of the comparison of the zoom spectrum in Hz, and its bins
+const float ZOOM_TEST_LOW_FREQUENCY = 1.0;
+const float ZOOM_TEST_HIGH_FREQUENCY = 2.0;
+const uint16_t ZOOM_TEST_BINS = 32;
+// Frequency of the breathing tone of the comparison of the peaks in Hz
+const float PEAK_BREATHING_FREQUENCY = 0.3;
+// Maximum error of the interpolated frequency of the peaks in Hz, a tenth of a bin of the FFT
+const float PEAK_ERROR_BOUND = 0.01;
+// Segments of the comparison of the Welch PSD
+const uint16_t WELCH_TEST_SEGMENTS = 64;
+// Amplitude of the uniform noise of the comparison of the Welch PSD
+const float WELCH_NOISE_AMPLITUDE = 2000;
+// Maximum error of the power of the Welch PSD relative to the one of the samples
+const float WELCH_POWER_BOUND = 0.1;
+
+/** Exact DFT function
+ *
+ * @brief This function computes the magnitudes of a windowed block at any frequencies in
+ *        double precision, the reference of the transforms.
+ *
+ * @param block Samples of the block.
+ * @param length Number of samples of the block.
+ * @param firstFrequency Frequency of the first bin in Hz.
+ * @param step Frequency between two bins in Hz.
+ * @param bins Number of bins.
+ * @param sampleRate Rate of the samples in Hz.
+ * @param exact Magnitudes of the bins.
+ *
+ * @return Highest magnitude.
+ *
+ * @details The mean of the block is removed before the window, as the firmware does.
+ *
+ */
+template <typename T>
+double exactDft ( const T* block, uint16_t length, double firstFrequency, double step, uint16_t bins,
+                  double sampleRate, vector<double>& exact )
+{
+    double mean = 0;
+    for (uint16_t n = 0; n < length; n++) mean += block[n];
+    mean /= length;
+
+    exact.assign(bins, 0.0);
+    double highest = 0;
+    for (uint16_t k = 0; k < bins; k++)
+    {
+        complex<double> bin = 0;
+        for (uint16_t n = 0; n < length; n++)
+        {
+            double windowed = (block[n] - mean) * fftWindowValue(FFT_ANALYSIS_WINDOW, n, length);
+            bin += windowed * polar(1.0, -2 * M_PI * (firstFrequency + k * step) * n / sampleRate);
+        }
+        exact[k] = abs(bin);
+        highest = max(highest, exact[k]);
+    }
+    return highest;
+}
+
+/** Check heart rate function
+ *
+ * @brief This function checks the heart rate that the Maxim algorithm finds in a
+ *        synthetic PPG filtered by a filter.
+ *
+ * @param filter FIR or biquad filter.
+ *
+ * @details The PPG is a pulse of FILTER_TEST_HEART_RATE with its second harmonic, a slow
+ *          drift and an interference at the STOPBAND_FREQUENCIES over the DC of the sensor,
+ *          plus a small noise. Without filtering, the interference makes false beats.
+ *          After the filter has settled, the filtered samples are stored as signed
+ *          integers in blocks of MAX_BLOCK_SAMPLES, as the reader does, and each block is
+ *          given to the algorithm through the same window as the reader. The heart rate of 
+ *          every block has to be valid, and their median within HEART_RATE_ERROR_BOUND.
+ *
+ * @see globalDataReader::getHeartRateWindow().
+ *
+ */
+template <typename F>
+void checkHeartRate ( F& filter )
+{
+    filter.reset();
+    int32_t irSamples[MAX_BLOCK_SAMPLES];
+    int32_t redSamples[MAX_BLOCK_SAMPLES];
+    uint32_t irWindow[BUFFER_SIZE];
+    uint32_t redWindow[BUFFER_SIZE];
+    int32_t heartRates[FILTER_TEST_BLOCKS];
+    uint16_t storedSamples = 0;
+    uint8_t blocks = 0;
+    uint32_t noise = 1;
+    for (uint32_t n = 0; blocks < FILTER_TEST_BLOCKS; n++)
+    {
+        float time = float(n) / SAMPLING_FREQUENCY;
+        float phase = 2 * M_PI * FILTER_TEST_HEART_RATE / 60 * time;
+        float pulse = sin(phase) + 0.3 * sin(2 * phase);
+        float drift = DRIFT_AMPLITUDE * sin(2 * M_PI * STOPBAND_FREQUENCIES[0] * time);
+        float interference = INTERFERENCE_AMPLITUDE * sin(2 * M_PI * STOPBAND_FREQUENCIES[1] * time);
+        noise = noise * 1664525 + 1013904223;
+        filter.pushSample(50000 + 2000 * pulse + drift + interference + float(noise >> 24), 
+                          40000 + 1200 * pulse + drift + interference);
+        if ( !filter.isReady() ) continue;
+
+        float valueIR = 0.0;
+        float valueRed = 0.0;
+        filter.filter(valueIR, valueRed);
+        if ( n < FILTER_SETTLING_SAMPLES ) continue;
+        irSamples[storedSamples] = int32_t(valueIR);
+        redSamples[storedSamples] = int32_t(valueRed);
+        if ( ++storedSamples < MAX_BLOCK_SAMPLES ) continue;
+
+        int32_t spo2Percentage = 0;
+        int8_t validSPO2 = 0;
+        int32_t heartRate = 0;
+        int8_t validHeartRate = 0;
+        uint16_t windowSize = globalDataReader::getHeartRateWindow(irSamples, MAX_BLOCK_SAMPLES, irWindow);
+        globalDataReader::getHeartRateWindow(redSamples, MAX_BLOCK_SAMPLES, redWindow);
+        maxim_heart_rate_and_oxygen_saturation(irWindow, windowSize, redWindow, &spo2Percentage, &validSPO2,
+                                               &heartRate, &validHeartRate);
+        TEST_ASSERT_TRUE_MESSAGE(validHeartRate, "no valid heart rate");
+        heartRates[blocks++] = heartRate * SAMPLING_FREQUENCY / FreqS;
+        storedSamples = 0;
+    }
+    sort(heartRates, heartRates + FILTER_TEST_BLOCKS);
+    TEST_ASSERT_INT_WITHIN(HEART_RATE_ERROR_BOUND, FILTER_TEST_HEART_RATE, heartRates[FILTER_TEST_BLOCKS / 2]);
+}
+
+/** Measure gain function
+ *
+ * @brief This function measures the gain of a filter for a sine.
+ *
+ * @param filter FIR or biquad filter.
+ * @param frequency Frequency of the sine in Hz.
+ *
+ * @return Gain of the filter at the frequency, not in dB.
+ *
+ * @details The sine is added to a DC like the one of the sensor. After the first half of
+ *          the RESPONSE_SAMPLES samples, the output is correlated with the input.
+ *
+ */
+template <typename F>
+float measureGain ( F& filter, float frequency )
+{
+    filter.reset();
+    complex<float> correlation = 0;
+    uint32_t correlated = 0;
+    for (uint32_t n = 0; n < RESPONSE_SAMPLES; n++)
+    {
+        float phase = 2 * M_PI * frequency * n / SAMPLING_FREQUENCY;
+        filter.pushSample(50000 + RESPONSE_AMPLITUDE * sin(phase), 0.0);
+        if ( !filter.isReady() ) continue;
+
+        float valueIR = 0.0;
+        float valueRed = 0.0;
+        filter.filter(valueIR, valueRed);
+        if ( n < RESPONSE_SAMPLES / 2 ) continue;
+        correlation += valueIR * polar(1.0f, float(-phase));
+        correlated++;
+    }
+    return abs(correlation) * 2.0f / (correlated * RESPONSE_AMPLITUDE);
+}
+
+/** Test FIR heart rate function
+ *
+ * @brief This function checks the heart rate of the PPG filtered by the FIR filter of
+ *        data/coefficients.txt.
+ *
+ * @see checkHeartRate().
+ *
+ */
+void testFirHeartRate ( )
+{
+    static firFilter fir(FILTER_TAPS);
+    fir.setCoefficients(FILTER_COEFFICIENTS, FILTER_TAPS);
+    checkHeartRate(fir);
+}
+
+/** Test biquad heart rate function
+ *
+ * @brief This function checks the heart rate of the PPG filtered by the biquad filter of
+ *        data/sections.txt (FILTER_IIR).
+ *
+ * @see checkHeartRate().
+ *
+ */
+void testBiquadHeartRate ( )
+{
+    static biquadFilter biquad(FILTER_SECTIONS);
+    biquad.setCoefficients(FILTER_SECTION_COEFFICIENTS, BIQUAD_COEFFICIENTS * FILTER_SECTIONS);
+    checkHeartRate(biquad);
+}
+
+/** Test stopband function
+ *
+ * @brief This function checks that the FIR and the biquad filters attenuate the
+ *        STOPBAND_FREQUENCIES at least STOPBAND_ATTENUATION dB.
+ *
+ */
+void testStopband ( )
+{
+    static firFilter fir(FILTER_TAPS);
+    static biquadFilter biquad(FILTER_SECTIONS);
+    fir.setCoefficients(FILTER_COEFFICIENTS, FILTER_TAPS);
+    biquad.setCoefficients(FILTER_SECTION_COEFFICIENTS, BIQUAD_COEFFICIENTS * FILTER_SECTIONS);
+
+    float maximumGain = powf(10, -STOPBAND_ATTENUATION / 20);
+    for (size_t i = 0; i < sizeof(STOPBAND_FREQUENCIES) / sizeof(float); i++)
+    {
+        TEST_ASSERT_FLOAT_WITHIN(maximumGain, 0.0f, measureGain(fir, STOPBAND_FREQUENCIES[i]));
+        TEST_ASSERT_FLOAT_WITHIN(maximumGain, 0.0f, measureGain(biquad, STOPBAND_FREQUENCIES[i]));
+    }
+}
+
+/** Test fixed point filter function
+ *
+ * @brief This function checks the fixed point and the float FIR filters against a double
+ *        precision filter.
+ *
+ * @details The input is a pulse of 1.2 Hz with a slow drift and noise over the DC of the
+ *          sensor, as 18 bits integers. The fixed point error has to be within
+ *          FIXED_FIR_ERROR_BOUND units of the sensor, which the float filter also meets.
+ *
+ */
+void testFixedPointFilter ( )
+{
+    static firFilter floatFilter(FILTER_TAPS);
+    static fixedFirFilter fixedFilter(FILTER_TAPS);
+    floatFilter.setCoefficients(FILTER_COEFFICIENTS, FILTER_TAPS);
+    fixedFilter.setCoefficients(FILTER_COEFFICIENTS, FILTER_TAPS);
+
+    vector<int32_t> input(FIXED_POINT_SAMPLES);
+    srand(1);
+    for (uint32_t n = 0; n < FIXED_POINT_SAMPLES; n++)
+    {
+        float time = float(n) / SAMPLING_FREQUENCY;
+        input[n] = 120000 + 3000 * sin(2 * M_PI * 1.2 * time) + 800 * sin(2 * M_PI * 0.1 * time) + rand() % 201 - 100;
+    }
+
+    float floatError = 0.0;
+    float fixedError = 0.0;
+    for (uint32_t n = 0; n < FIXED_POINT_SAMPLES; n++)
+    {
+        floatFilter.pushSample(input[n], input[n]);
+        fixedFilter.pushSample(input[n], input[n]);
+        if ( !fixedFilter.isReady() ) continue;
+
+        double exact = 0;
+        for (int k = 0; k < FILTER_TAPS; k++) exact += double(FILTER_COEFFICIENTS[k]) * input[n - k];
+        float floatIR = 0.0;
+        float floatRed = 0.0;
+        int32_t fixedIR = 0;
+        int32_t fixedRed = 0;
+        floatFilter.filter(floatIR, floatRed);
+        fixedFilter.filter(fixedIR, fixedRed);
+        floatError = max(floatError, float(fabs(floatIR - exact)));
+        fixedError = max(fixedError, float(fabs(fixedIR - exact)));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(FIXED_FIR_ERROR_BOUND, 0.0f, fixedError);
+    TEST_ASSERT_FLOAT_WITHIN(FIXED_FIR_ERROR_BOUND, 0.0f, floatError);
+}
+
+/** Test FFT function
+ *
+ * @brief This function checks the fixed point FFT and the float FFT plan against a double
+ *        precision DFT of the same windowed blocks.
+ *
+ * @details The blocks are a pulse of 1.2 Hz with its second harmonic and noise, like the
+ *          filtered samples. The errors are relative to the highest bin, without the DC, and
+ *          have to be within FIXED_FFT_ERROR_BOUND and FFT_ERROR_BOUND.
+ *
+ */
+void testFft ( )
+{
+    static fftPlan plan;
+    static fixedFft transform;
+    plan.begin(FFT_SIZE, MAX_BLOCK_SAMPLES, FFT_ANALYSIS_WINDOW);
+    transform.begin(FFT_SIZE, MAX_BLOCK_SAMPLES, FFT_ANALYSIS_WINDOW);
+
+    float planError = 0.0;
+    float fftError = 0.0;
+    int32_t block[MAX_BLOCK_SAMPLES];
+    uint32_t noise = 1;
+    for (int b = 0; b < 8; b++)
+    {
+        for (int n = 0; n < MAX_BLOCK_SAMPLES; n++)
+        {
+            float phase = 2 * M_PI * 1.2 * (b * MAX_BLOCK_SAMPLES + n) / SAMPLING_FREQUENCY;
+            noise = noise * 1664525 + 1013904223;
+            block[n] = lroundf(3000 * sin(phase) + 900 * sin(2 * phase)) + int32_t(noise >> 24) - 128;
+        }
+        vector<double> exact;
+        double step = double(SAMPLING_FREQUENCY) / FFT_SIZE;
+        double highest = exactDft(block, MAX_BLOCK_SAMPLES, step, step, FFT_SIZE / 2 - 1, SAMPLING_FREQUENCY, exact);
+
+        const float* planBins = plan.magnitudes(block);
+        const float* fixedBins = transform.magnitudes(block);
+        for (int k = 1; k < FFT_SIZE / 2; k++)
+        {
+            planError = max(planError, float(fabs(planBins[k] - exact[k - 1]) / highest));
+            fftError = max(fftError, float(fabs(fixedBins[k] - exact[k - 1]) / highest));
+        }
+    }
+    TEST_ASSERT_FLOAT_WITHIN(FFT_ERROR_BOUND, 0.0f, planError);
+    TEST_ASSERT_FLOAT_WITHIN(FIXED_FFT_ERROR_BOUND, 0.0f, fftError);
+}
+
+/** Test sliding DFT function
+ *
+ * @brief This function checks the sliding DFT against a double precision DFT of the same
+ *        window.
+ *
+ * @details The input is a filtered pulse of 1.2 Hz with its second harmonic and noise,
+ *          pushed for SLIDING_DFT_SAMPLES samples. Then the bins of the band are compared
+ *          with the DFT of the last SLIDING_DFT_LENGTH samples with the window, and the
+ *          error relative to the highest bin has to be within SLIDING_DFT_ERROR_BOUND.
+ *
+ */
+void testSlidingDft ( )
+{
+    static slidingDft spectrum;
+    spectrum.begin(SAMPLING_FREQUENCY, SLIDING_DFT_LENGTH, SPECTRUM_LOW_FREQUENCY, SPECTRUM_HIGH_FREQUENCY,
+                   FFT_ANALYSIS_WINDOW);
+
+    vector<float> input(SLIDING_DFT_SAMPLES);
+    uint32_t noise = 1;
+    for (uint32_t n = 0; n < SLIDING_DFT_SAMPLES; n++)
+    {
+        float phase = 2 * M_PI * 1.2 * n / SAMPLING_FREQUENCY;
+        noise = noise * 1664525 + 1013904223;
+        input[n] = 2000 * sin(phase) + 600 * sin(2 * phase) + float(noise >> 24) - 127.5f;
+        spectrum.push(input[n]);
+    }
+    const float* magnitudes = spectrum.magnitudes();
+
+    const float* first = &input[SLIDING_DFT_SAMPLES - SLIDING_DFT_LENGTH];
+    vector<double> exact(spectrum.getBins());
+    double highest = 0;
+    for (uint16_t b = 0; b < spectrum.getBins(); b++)
+    {
+        complex<double> bin = 0;
+        for (uint16_t i = 0; i < SLIDING_DFT_LENGTH; i++)
+        {
+            double windowed = first[i] * fftWindowValue(FFT_ANALYSIS_WINDOW, i, SLIDING_DFT_LENGTH);
+            bin += windowed * polar(1.0, -2 * M_PI * (spectrum.getFirstBin() + b) * i / SLIDING_DFT_LENGTH);
+        }
+        exact[b] = abs(bin);
+        highest = max(highest, exact[b]);
+    }
+    float error = 0;
+    for (uint16_t b = 0; b < spectrum.getBins(); b++) error = max(error, float(fabs(magnitudes[b] - exact[b]) / highest));
+    TEST_ASSERT_FLOAT_WITHIN(SLIDING_DFT_ERROR_BOUND, 0.0f, error);
+}
+
+/** Test zoom function
+ *
+ * @brief This function checks the chirp Z transform against a double precision DFT at the
+ *        same frequencies.
+ *
+ * @details The input is a block of a pulse of PULSE_FREQUENCY with its second harmonic.
+ *          It is transformed in the band of the firmware, then in a second band with less
+ *          bins and again in the first one, as the band can change in every call. The
+ *          error relative to the highest bin has to be within FFT_ERROR_BOUND, and the
+ *          highest bin has to be the nearest one to the pulse.
+ *
+ */
+void testZoom ( )
+{
+    static chirpZ zoom;
+    zoom.begin(MAX_BLOCK_SAMPLES, MAX_FREQS, FFT_ANALYSIS_WINDOW);
+
+    int32_t block[MAX_BLOCK_SAMPLES];
+    for (int n = 0; n < MAX_BLOCK_SAMPLES; n++)
+    {
+        float phase = 2 * M_PI * PULSE_FREQUENCY * n / SAMPLING_FREQUENCY;
+        block[n] = lroundf(2000 * sin(phase) + 600 * sin(2 * phase));
+    }
+
+    const float lows[3] = { ZOOM_LOW_FREQUENCY, ZOOM_TEST_LOW_FREQUENCY, ZOOM_LOW_FREQUENCY };
+    const float highs[3] = { ZOOM_HIGH_FREQUENCY, ZOOM_TEST_HIGH_FREQUENCY, ZOOM_HIGH_FREQUENCY };
+    const uint16_t bins[3] = { ZOOM_BINS, ZOOM_TEST_BINS, ZOOM_BINS };
+    for (int c = 0; c < 3; c++)
+    {
+        const float* magnitudes = zoom.magnitudes(block, lows[c], highs[c], bins[c], SAMPLING_FREQUENCY);
+        float step = (highs[c] - lows[c]) / (bins[c] - 1);
+        vector<double> exact;
+        double highest = exactDft(block, MAX_BLOCK_SAMPLES, lows[c], step, bins[c], SAMPLING_FREQUENCY, exact);
+
+        float error = 0;
+        uint16_t peak = 0;
+        for (uint16_t k = 0; k < bins[c]; k++)
+        {
+            error = max(error, float(fabs(magnitudes[k] - exact[k]) / highest));
+            if ( magnitudes[k] > magnitudes[peak] ) peak = k;
+        }
+        TEST_ASSERT_FLOAT_WITHIN(FFT_ERROR_BOUND, 0.0f, error);
+        TEST_ASSERT_FLOAT_WITHIN(step / 2, PULSE_FREQUENCY, lows[c] + peak * step);
+    }
+}
+
+/** Test peaks function
+ *
+ * @brief This function checks the peaks of the FFT plan found by the peak extractor.
+ *
+ * @details The input is a block of a pulse of PULSE_FREQUENCY with its second harmonic,
+ *          plus a breathing tone of PEAK_BREATHING_FREQUENCY. The pulse and the breathing
+ *          tone have to be the two highest peaks, within PEAK_ERROR_BOUND of their
+ *          frequencies, and the second harmonic has to be grouped with the pulse.
+ *
+ */
+void testPeaks ( )
+{
+    static fftPlan plan;
+    static peakExtractor extractor;
+    plan.begin(FFT_SIZE, MAX_BLOCK_SAMPLES, FFT_ANALYSIS_WINDOW);
+
+    int32_t block[MAX_BLOCK_SAMPLES];
+    for (int n = 0; n < MAX_BLOCK_SAMPLES; n++)
+    {
+        float phase = 2 * M_PI * PULSE_FREQUENCY * n / SAMPLING_FREQUENCY;
+        float breathing = 2 * M_PI * PEAK_BREATHING_FREQUENCY * n / SAMPLING_FREQUENCY;
+        block[n] = lroundf(2000 * sin(phase) + 1200 * sin(2 * phase) + 800 * sin(breathing));
+    }
+    const float* magnitudes = plan.magnitudes(block);
+    float step = float(SAMPLING_FREQUENCY) / FFT_SIZE;
+    uint8_t count = extractor.extract(magnitudes, FFT_SIZE / 2, 0, step);
+    const fundamentalsFreqs* peaks = extractor.getPeaks();
+
+    TEST_ASSERT_GREATER_OR_EQUAL(2, count);
+    TEST_ASSERT_FLOAT_WITHIN(PEAK_ERROR_BOUND, PULSE_FREQUENCY, peaks[0].freqsHz);
+    TEST_ASSERT_FLOAT_WITHIN(PEAK_ERROR_BOUND, PEAK_BREATHING_FREQUENCY, peaks[1].freqsHz);
+    for (uint8_t p = 0; p < count; p++)
+    {
+        TEST_ASSERT_FALSE_MESSAGE(fabsf(peaks[p].freqsHz - 2 * PULSE_FREQUENCY) < 2 * PEAK_ERROR_BOUND,
+                                  "second harmonic not grouped with the pulse");
+    }
+}
+
+/** Test Welch function
+ *
+ * @brief This function checks the power and the stability of the Welch PSD.
+ *
+ * @details The input is a pulse of PULSE_FREQUENCY plus a uniform noise, pushed hop
+ *          samples at a time into three PSDs with the segments of the firmware: an
+ *          exponential average of WELCH_DEPTH segments, a mean of WELCH_DEPTH segments and
+ *          a single periodogram. The power of the mean has to be within WELCH_POWER_BOUND
+ *          of the one of the samples, the average change between segments of the
+ *          exponential average has to be less than half the one of the single periodogram,
+ *          and its highest peak has to be within PEAK_ERROR_BOUND of the pulse.
+ *
+ */
+void testWelch ( )
+{
+    static welchPsd exponential;
+    static welchPsd fixedCount;
+    static welchPsd periodogram;
+    exponential.begin(FFT_SIZE, WELCH_OVERLAP, WELCH_DEPTH, WELCH_AVERAGE_EXPONENTIAL, FFT_ANALYSIS_WINDOW);
+    fixedCount.begin(FFT_SIZE, WELCH_OVERLAP, WELCH_DEPTH, WELCH_AVERAGE_FIXED_COUNT, FFT_ANALYSIS_WINDOW);
+    periodogram.begin(FFT_SIZE, WELCH_OVERLAP, 1, WELCH_AVERAGE_EXPONENTIAL, FFT_ANALYSIS_WINDOW);
+    uint16_t hop = exponential.getHop();
+
+    vector<int32_t> samples(FFT_SIZE + WELCH_TEST_SEGMENTS * hop);
+    uint32_t noise = 12345;
+    for (size_t n = 0; n < samples.size(); n++)
+    {
+        noise = noise * 1664525u + 1013904223u;
+        float uniform = WELCH_NOISE_AMPLITUDE * (2 * float(noise >> 8) / (1 << 24) - 1);
+        samples[n] = lroundf(1000 * sin(2 * M_PI * PULSE_FREQUENCY * n / SAMPLING_FREQUENCY) + uniform);
+    }
+    double power = 500000.0 + WELCH_NOISE_AMPLITUDE * WELCH_NOISE_AMPLITUDE / 3.0;
+
+    welchPsd* psds[3] = { &exponential, &fixedCount, &periodogram };
+    float changes[3] = { 0, 0, 0 };
+    for (int p = 0; p < 3; p++)
+    {
+        psds[p] -> push(samples.data(), FFT_SIZE, SAMPLING_FREQUENCY);
+        psds[p] -> setReference();
+    }
+    for (uint16_t s = 0; s < WELCH_TEST_SEGMENTS; s++)
+    {
+        for (int p = 0; p < 3; p++)
+        {
+            psds[p] -> push(&samples[FFT_SIZE + s * hop], hop, SAMPLING_FREQUENCY);
+            if ( p == 1 ) continue;
+            changes[p] += psds[p] -> getChange() / WELCH_TEST_SEGMENTS;
+            psds[p] -> setReference();
+        }
+    }
+
+    float step = float(SAMPLING_FREQUENCY) / FFT_SIZE;
+    const float* density = fixedCount.getDensity();
+    TEST_ASSERT_NOT_NULL(density);
+    double total = 0;
+    for (uint16_t k = 0; k < fixedCount.getBins(); k++) total += density[k] * step;
+    TEST_ASSERT_FLOAT_WITHIN(WELCH_POWER_BOUND, 0.0f, float(fabs(total - power) / power));
+    TEST_ASSERT_TRUE_MESSAGE(2 * changes[0] < changes[2], "the average does not halve the change of a periodogram");
+
+    static peakExtractor extractor;
+    uint8_t count = extractor.extract(exponential.getDensity(), exponential.getBins(), 0, step);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, count);
+    TEST_ASSERT_FLOAT_WITHIN(PEAK_ERROR_BOUND, PULSE_FREQUENCY, extractor.getPeaks()[0].freqsHz);
+}
+
+void setUp ( ) {}
+
+void tearDown ( ) {}
+
+/** Main function
+ *
+ * @brief This function runs the tests of the signal processing against double precision
+ *        references: pio test -e native.
+ *
+ * @return Number of failed tests.
+ *
+ */
+int main ( int argc, char** argv )
+{
+    UNITY_BEGIN();
+    RUN_TEST(testFirHeartRate);
+    RUN_TEST(testBiquadHeartRate);
+    RUN_TEST(testStopband);
+    RUN_TEST(testFixedPointFilter);
+    RUN_TEST(testFft);
+    RUN_TEST(testSlidingDft);
+    RUN_TEST(testZoom);
+    RUN_TEST(testPeaks);
+    RUN_TEST(testWelch);
+    return UNITY_END();
+}